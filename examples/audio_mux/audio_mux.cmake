@@ -39,6 +39,11 @@ set(APP_LINK_OPTIONS
 set(APP_COMMON_LINK_LIBRARIES
     rtos::freertos_usb
     sdk::lib_src
+    sln_voice::pipeline_profiler
+    sln_voice::frame_pool
+    sln_voice::frame_codec
+    sln_voice::audio_ring
+    sln_voice::src_block
     sln_voice::example::audio_mux::xcore_ai_explorer
 )
 
@@ -73,6 +73,14 @@
 #define appconfI2S_MODE            appconfI2S_MODE_MASTER
 #endif
 
+/*
+ * Format of the audio sent from the tile 1 to the tile 0 audio pipeline,
+ * one of the FRAME_CODEC_* formats in frame_codec.h.
+ */
+#ifndef appconfAUDIO_PIPELINE_WIRE_FORMAT
+#define appconfAUDIO_PIPELINE_WIRE_FORMAT   FRAME_CODEC_INT32
+#endif
+
 #include "app_conf_check.h"
 
 /* I/O and interrupt cores for Tile 0 */
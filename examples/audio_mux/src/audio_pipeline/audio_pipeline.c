@@ -14,6 +14,10 @@
 
 /* Library headers */
 #include "generic_pipeline.h"
+#include "pipeline_profiler.h"
+#include "frame_pool.h"
+#include "frame_codec.h"
+
 /* App headers */
 #include "app_conf.h"
 #include "audio_pipeline.h"
@@ -25,16 +29,31 @@ typedef struct {
     int32_t samples[appconfAUDIO_PIPELINE_CHANNELS][appconfAUDIO_PIPELINE_FRAME_ADVANCE];
 } frame_data_t;
 
+/* Number of bytes of a frame on the intertile link */
+#define FRAME_DATA_WIRE_SIZE (appconfAUDIO_PIPELINE_CHANNELS * \
+        FRAME_CODEC_ENCODED_SIZE(appconfAUDIO_PIPELINE_WIRE_FORMAT, appconfAUDIO_PIPELINE_FRAME_ADVANCE))
+
 #if appconfAUDIO_PIPELINE_FRAME_ADVANCE != 240
 #error This pipeline is only configured for 240 frame advance
 #endif
 
+#define AUDIO_PIPELINE_STAGE_COUNT      1
+
+/*
+ * The input, stage and output all run in the one stage task, so it only
+ * ever holds one frame
+ */
+#define AUDIO_PIPELINE_FRAME_POOL_SIZE  FRAME_POOL_PIPELINE_FRAMES(AUDIO_PIPELINE_STAGE_COUNT)
+
+FRAME_POOL_STORAGE(audio_pipeline_frames, frame_data_t, AUDIO_PIPELINE_FRAME_POOL_SIZE);
+static frame_pool_t frame_pool;
+
 #if ON_TILE(0)
 static void *audio_pipeline_input_i(void *input_app_data)
 {
     frame_data_t *frame_data;
 
-    frame_data = pvPortMalloc(sizeof(frame_data_t));
+    frame_data = frame_pool_acquire(&frame_pool);
     memset(frame_data, 0x00, sizeof(frame_data_t));
 
     size_t bytes_received = 0;
@@ -43,12 +62,29 @@ static void *audio_pipeline_input_i(void *input_app_data)
             appconfAUDIOPIPELINE_PORT,
             portMAX_DELAY);
 
+#if appconfAUDIO_PIPELINE_WIRE_FORMAT == FRAME_CODEC_INT32
     xassert(bytes_received == sizeof(frame_data_t));
 
     rtos_intertile_rx_data(
             intertile_ctx,
             frame_data,
             bytes_received);
+#else
+    static uint32_t wire[(FRAME_DATA_WIRE_SIZE + sizeof(uint32_t) - 1) / sizeof(uint32_t)];
+    size_t len = 0;
+
+    xassert(bytes_received == FRAME_DATA_WIRE_SIZE);
+
+    rtos_intertile_rx_data(
+            intertile_ctx,
+            wire,
+            bytes_received);
+
+    for (int ch = 0; ch < appconfAUDIO_PIPELINE_CHANNELS; ch++) {
+        len += frame_codec_decode(appconfAUDIO_PIPELINE_WIRE_FORMAT, frame_data->samples[ch],
+                                  (const uint8_t *)wire + len, appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+    }
+#endif
 
     return frame_data;
 }
@@ -56,10 +92,15 @@ static void *audio_pipeline_input_i(void *input_app_data)
 static int audio_pipeline_output_i(frame_data_t *frame_data,
                                    void *output_app_data)
 {
-    return audio_pipeline_output(output_app_data,
-                               (int32_t **)frame_data->samples,
-                               2,
-                               appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+    int ret = audio_pipeline_output(output_app_data,
+                                    (int32_t **)frame_data->samples,
+                                    2,
+                                    appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+
+    if (ret == AUDIO_PIPELINE_FREE_FRAME) {
+        frame_pool_release(&frame_pool, frame_data);
+    }
+    return AUDIO_PIPELINE_DONT_FREE_FRAME;
 }
 #endif
 
@@ -68,7 +109,7 @@ static void *audio_pipeline_input_i(void *input_app_data)
 {
     frame_data_t *frame_data;
 
-    frame_data = pvPortMalloc(sizeof(frame_data_t));
+    frame_data = frame_pool_acquire(&frame_pool);
 
     audio_pipeline_input(input_app_data,
                        (int32_t **)frame_data->samples,
@@ -80,11 +121,27 @@ static void *audio_pipeline_input_i(void *input_app_data)
 static int audio_pipeline_output_i(frame_data_t *frame_data,
                                    void *output_app_data)
 {
+#if appconfAUDIO_PIPELINE_WIRE_FORMAT == FRAME_CODEC_INT32
     rtos_intertile_tx(intertile_ctx,
                       appconfAUDIOPIPELINE_PORT,
                       frame_data,
                       sizeof(frame_data_t));
-    return AUDIO_PIPELINE_FREE_FRAME;
+#else
+    static uint32_t wire[(FRAME_DATA_WIRE_SIZE + sizeof(uint32_t) - 1) / sizeof(uint32_t)];
+    size_t len = 0;
+
+    for (int ch = 0; ch < appconfAUDIO_PIPELINE_CHANNELS; ch++) {
+        len += frame_codec_encode(appconfAUDIO_PIPELINE_WIRE_FORMAT, (uint8_t *)wire + len,
+                                  frame_data->samples[ch], appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+    }
+
+    rtos_intertile_tx(intertile_ctx,
+                      appconfAUDIOPIPELINE_PORT,
+                      wire,
+                      len);
+#endif
+    frame_pool_release(&frame_pool, frame_data);
+    return AUDIO_PIPELINE_DONT_FREE_FRAME;
 }
 #endif
 
@@ -93,22 +150,32 @@ static void stage_dummy(frame_data_t *frame_data)
     (void) frame_data;
 }
 
+PIPELINE_PROFILER_DEFINE_INPUT(audio_pipeline_input_i)
+PIPELINE_PROFILER_DEFINE_OUTPUT(audio_pipeline_output_i)
+PIPELINE_PROFILER_DEFINE_STAGE(stage_dummy)
+
 void audio_pipeline_init(
     void *input_app_data,
     void *output_app_data)
 {
-    const int stage_count = 1;
+    const int stage_count = AUDIO_PIPELINE_STAGE_COUNT;
 
     const pipeline_stage_t stages[] = {
-        (pipeline_stage_t)stage_dummy,
+        (pipeline_stage_t)PIPELINE_PROFILED(stage_dummy),
     };
 
     const configSTACK_DEPTH_TYPE stage_stack_sizes[] = {
-        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_dummy) + RTOS_THREAD_STACK_SIZE(audio_pipeline_input_i) + RTOS_THREAD_STACK_SIZE(audio_pipeline_output_i),
+        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_dummy) + RTOS_THREAD_STACK_SIZE(audio_pipeline_input_i) + RTOS_THREAD_STACK_SIZE(audio_pipeline_output_i) + PIPELINE_PROFILER_STACK_SIZE,
     };
 
-    generic_pipeline_init((pipeline_input_t)audio_pipeline_input_i,
-                        (pipeline_output_t)audio_pipeline_output_i,
+    FRAME_POOL_INIT(&frame_pool, audio_pipeline_frames, frame_data_t, AUDIO_PIPELINE_FRAME_POOL_SIZE);
+
+    PIPELINE_PROFILER_REGISTER(audio_pipeline_input_i);
+    PIPELINE_PROFILER_REGISTER(stage_dummy);
+    PIPELINE_PROFILER_REGISTER(audio_pipeline_output_i);
+
+    generic_pipeline_init((pipeline_input_t)PIPELINE_PROFILED(audio_pipeline_input_i),
+                        (pipeline_output_t)PIPELINE_PROFILED(audio_pipeline_output_i),
                         input_app_data,
                         output_app_data,
                         stages,
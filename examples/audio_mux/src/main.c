@@ -21,6 +21,8 @@
 #include "usb_support.h"
 #include "usb_audio.h"
 #include "audio_pipeline.h"
+#include "pipeline_profiler.h"
+#include "frame_pool.h"
 
 void audio_pipeline_input(void *input_app_data,
                         int32_t **input_audio_frames,
@@ -135,6 +137,10 @@ static void mem_analysis(void)
 {
 	for (;;) {
 		rtos_printf("Tile[%d]:\n\tMinimum heap free: %d\n\tCurrent heap free: %d\n", THIS_XCORE_TILE, xPortGetMinimumEverFreeHeapSize(), xPortGetFreeHeapSize());
+		frame_pool_report();
+#if PIPELINE_PROFILER_ENABLED
+		pipeline_profiler_report();
+#endif
 		vTaskDelay(pdMS_TO_TICKS(5000));
 	}
 }
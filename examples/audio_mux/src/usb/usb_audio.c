@@ -33,13 +33,14 @@
 #include <src.h>
 
 #include "FreeRTOS.h"
-#include "stream_buffer.h"
 
 #include "usb_descriptors.h"
 #include "tusb.h"
 
 #include "rtos_intertile.h"
 
+#include "audio_ring.h"
+#include "src_block.h"
 #include "audio_pipeline.h"
 
 #include "app_conf.h"
@@ -58,8 +59,8 @@ audio_control_range_4_n_t(1) sampleFreqRng; 						// Sample frequency range stat
 static volatile bool mic_interface_open = false;
 static volatile bool spkr_interface_open = false;
 
-static StreamBufferHandle_t samples_to_host_stream_buf;
-static StreamBufferHandle_t samples_from_host_stream_buf;
+static audio_ring_t samples_to_host_ring;
+static audio_ring_t samples_from_host_ring;
 static TaskHandle_t usb_audio_out_task_handle;
 
 #define RATE_MULTIPLIER (appconfUSB_AUDIO_SAMPLE_RATE / appconfAUDIO_PIPELINE_SAMPLE_RATE)
@@ -103,18 +104,27 @@ void tud_resume_cb(void)
 
 #if CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 2
 typedef int16_t samp_t;
+#define src_block_ds3_samp src_block_ds3_s16
+#define src_block_us3_samp src_block_us3_s16
 #elif CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 4
 typedef int32_t samp_t;
+#define src_block_ds3_samp src_block_ds3_s32
+#define src_block_us3_samp src_block_us3_s32
 #else
 #error CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX must be either 2 or 4
 #endif
 
+static samp_t samples_from_host_storage[2 * appconfAUDIO_PIPELINE_FRAME_ADVANCE][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
+static samp_t samples_to_host_storage[3 * appconfAUDIO_PIPELINE_FRAME_ADVANCE][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
+
 void usb_audio_send(rtos_intertile_t *intertile_ctx,
                     size_t frame_count,
                     int32_t **frame_buffers,
                     size_t num_chans)
 {
-    samp_t usb_audio_in_frame[appconfAUDIO_PIPELINE_FRAME_ADVANCE][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
+    samp_t (*usb_audio_in_frame)[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
+    const size_t frame_bytes = sizeof(samp_t) * appconfAUDIO_PIPELINE_FRAME_ADVANCE * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX;
+    size_t space;
     int32_t *frame_buf_ptr = (int32_t *) frame_buffers;
 
 #if CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 2
@@ -123,10 +133,24 @@ void usb_audio_send(rtos_intertile_t *intertile_ctx,
     const int src_32_shift = 0;
 #endif
 
-    memset(usb_audio_in_frame, 0, sizeof(samp_t) * appconfAUDIO_PIPELINE_FRAME_ADVANCE * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX);
-
     xassert(frame_count == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
 
+    if (!mic_interface_open) {
+        return;
+    }
+
+    /*
+     * The frame is formatted straight into the ring. Only whole frames are
+     * written to it and it holds a whole number of them, so the free space
+     * always starts with a contiguous frame.
+     */
+    usb_audio_in_frame = audio_ring_write_reserve(&samples_to_host_ring, &space);
+    if (space < frame_bytes) {
+        rtos_printf("lost VFE output samples\n");
+        return;
+    }
+    memset(usb_audio_in_frame, 0, frame_bytes);
+
     // for(int ch=0; ch<CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX; ch++) {
         for (int i=0; i<appconfAUDIO_PIPELINE_FRAME_ADVANCE; i++) {
             // if (ch < num_chans) {
@@ -137,11 +161,7 @@ void usb_audio_send(rtos_intertile_t *intertile_ctx,
         }
     // }
 
-    if (mic_interface_open) {
-        if (xStreamBufferSend(samples_to_host_stream_buf, usb_audio_in_frame, sizeof(usb_audio_in_frame), 0) != sizeof(usb_audio_in_frame)) {
-            rtos_printf("lost VFE output samples\n");
-        }
-    }
+    audio_ring_write_commit(&samples_to_host_ring, frame_bytes);
 }
 
 void usb_audio_recv(rtos_intertile_t *intertile_ctx,
@@ -243,20 +263,22 @@ void usb_audio_out_task(void *arg)
         size_t bytes_received = 0;
 
         /*
-         * Only wake up when the stream buffer contains a whole audio
+         * Only wake up when the ring contains a whole audio
          * pipeline frame.
          */
         (void) ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
 
-        bytes_received = xStreamBufferReceive(samples_from_host_stream_buf, usb_audio_out_frame, sizeof(usb_audio_out_frame), 0);
+        /*
+         * Copied out rather than sent from the ring in place so that the
+         * space is released before rtos_intertile_tx() blocks.
+         */
+        bytes_received = audio_ring_read(&samples_from_host_ring, usb_audio_out_frame, sizeof(usb_audio_out_frame));
 
         /*
          * This shouldn't normally be zero, but it could be possible that
-         * the stream buffer is reset after this task has been notified.
+         * the ring is discarded after this task has been notified.
          */
         if (bytes_received > 0) {
-            xassert(bytes_received == sizeof(usb_audio_out_frame));
-
             rtos_intertile_tx(
                     intertile_ctx,
                     appconfUSB_AUDIO_PORT,
@@ -545,6 +567,8 @@ bool tud_audio_rx_done_post_read_cb(uint8_t rhport,
   (void)rhport;
 
   samp_t usb_audio_frames[AUDIO_FRAMES_PER_USB_FRAME][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
+  samp_t (*stream_buffer_audio_frames)[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
+  size_t space;
 
   const size_t stream_buffer_send_byte_count = sizeof(usb_audio_frames) / RATE_MULTIPLIER;
 
@@ -563,13 +587,19 @@ bool tud_audio_rx_done_post_read_cb(uint8_t rhport,
       spkr_interface_open = true;
   }
 
-  tud_audio_read(usb_audio_frames, n_bytes_received);
+  /*
+   * Exactly one USB frame's worth is written to the ring at a time and it
+   * holds a whole number of them, so the free space always starts with a
+   * contiguous USB frame.
+   */
+  stream_buffer_audio_frames = audio_ring_write_reserve(&samples_from_host_ring, &space);
 
-  if (xStreamBufferSpacesAvailable(samples_from_host_stream_buf) >= stream_buffer_send_byte_count) {
+  if (space >= stream_buffer_send_byte_count) {
 
       if (RATE_MULTIPLIER == 3) {
-          static int32_t src_data[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX][SRC_FF3V_FIR_NUM_PHASES][SRC_FF3V_FIR_TAPS_PER_PHASE] __attribute__((aligned (8)));
-          samp_t stream_buffer_audio_frames[AUDIO_FRAMES_PER_USB_FRAME / RATE_MULTIPLIER][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
+          static src_block_ds3_t src_state[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
+
+          tud_audio_read(usb_audio_frames, n_bytes_received);
 
           /*
            * TODO: For adaptive mode, use the actual number of audio frames
@@ -578,20 +608,16 @@ bool tud_audio_rx_done_post_read_cb(uint8_t rhport,
            * USB packet. It would also require the number of frames to be a multiple
            * of RATE_MULTIPLIER. Maybe we need to keep a static buffer around, and then
            * run this bit as is, still sending only AUDIO_FRAMES_PER_USB_FRAME at a time
-           * to the stream buffer.
+           * to the ring.
            */
-          for (int i = 0; i < AUDIO_FRAMES_PER_USB_FRAME / RATE_MULTIPLIER; i++) {
-              for (int j = 0; j < CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX; j++) {
-                  int64_t sum = 0;
-                  sum = src_ds3_voice_add_sample(sum, src_data[j][0], src_ff3v_fir_coefs[0], usb_audio_frames[3*i + 0][j]);
-                  sum = src_ds3_voice_add_sample(sum, src_data[j][1], src_ff3v_fir_coefs[1], usb_audio_frames[3*i + 1][j]);
-                  stream_buffer_audio_frames[i][j] = src_ds3_voice_add_final_sample(sum, src_data[j][2], src_ff3v_fir_coefs[2], usb_audio_frames[3*i + 2][j]);
-              }
-          }
-          xStreamBufferSend(samples_from_host_stream_buf, stream_buffer_audio_frames, stream_buffer_send_byte_count, 0);
+          src_block_ds3_samp(src_state, CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX,
+                             &stream_buffer_audio_frames[0][0], &usb_audio_frames[0][0],
+                             AUDIO_FRAMES_PER_USB_FRAME / RATE_MULTIPLIER);
       } else {
-          xStreamBufferSend(samples_from_host_stream_buf, usb_audio_frames, stream_buffer_send_byte_count, 0);
+          /* At the pipeline rate the packet is read straight into the ring */
+          tud_audio_read(stream_buffer_audio_frames, n_bytes_received);
       }
+      audio_ring_write_commit(&samples_from_host_ring, stream_buffer_send_byte_count);
 
       /*
        * Wake up the task waiting on this buffer whenever there is one more
@@ -599,20 +625,21 @@ bool tud_audio_rx_done_post_read_cb(uint8_t rhport,
        * be input into the pipeline.
        *
        * This way the task will not wake up each time this task puts another
-       * milliseconds of audio into the stream buffer, but rather once every
+       * milliseconds of audio into the ring, but rather once every
        * pipeline frame time.
        */
       const size_t buffer_notify_level = stream_buffer_send_byte_count * (1 + USB_FRAMES_PER_VFE_FRAME);
 
       /*
        * TODO: If the above is modified such that not exactly AUDIO_FRAMES_PER_USB_FRAME / RATE_MULTIPLIER
-       * frames are written to the stream buffer at a time, then this will need to change to >=.
+       * frames are written to the ring at a time, then this will need to change to >=.
        */
-      if (xStreamBufferBytesAvailable(samples_from_host_stream_buf) == buffer_notify_level) {
+      if (audio_ring_fill(&samples_from_host_ring) == buffer_notify_level) {
           xTaskNotifyGive(usb_audio_out_task_handle);
       }
 
   } else {
+      tud_audio_read(usb_audio_frames, n_bytes_received);
     //   rtos_printf("lost USB output samples\n");
   }
 
@@ -625,7 +652,7 @@ bool tud_audio_tx_done_pre_load_cb(uint8_t rhport,
                                    uint8_t cur_alt_setting)
 {
     static int ready;
-    samp_t stream_buffer_audio_frames[AUDIO_FRAMES_PER_USB_FRAME / RATE_MULTIPLIER][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
+    const size_t tx_size_bytes = sizeof(samp_t) * (AUDIO_FRAMES_PER_USB_FRAME / RATE_MULTIPLIER) * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX;
     size_t bytes_available;
 
     (void) rhport;
@@ -646,14 +673,14 @@ bool tud_audio_tx_done_pre_load_cb(uint8_t rhport,
      * If the buffer becomes full, reset it in an attempt to
      * maintain a good fill level again.
      */
-    if (xStreamBufferIsFull(samples_to_host_stream_buf)) {
-        xStreamBufferReset(samples_to_host_stream_buf);
+    if (audio_ring_space(&samples_to_host_ring) == 0) {
+        audio_ring_flush(&samples_to_host_ring);
         ready = 0;
         rtos_printf("oops buffer is full\n");
         return true;
     }
 
-    bytes_available = xStreamBufferBytesAvailable(samples_to_host_stream_buf);
+    bytes_available = audio_ring_fill(&samples_to_host_ring);
     if (bytes_available >= 2 * sizeof(samp_t) * appconfAUDIO_PIPELINE_FRAME_ADVANCE * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX) {
         /* wait until we have 2 full audio pipeline output frames in the buffer */
         ready = 1;
@@ -663,24 +690,30 @@ bool tud_audio_tx_done_pre_load_cb(uint8_t rhport,
         return true;
     }
 
-    if (bytes_available >= sizeof(stream_buffer_audio_frames)) {
-        xStreamBufferReceive(samples_to_host_stream_buf, stream_buffer_audio_frames, sizeof(stream_buffer_audio_frames), 0);
+    if (bytes_available >= tx_size_bytes) {
+        size_t len;
+
+        /*
+         * Frames are only written to the ring whole, and it holds a whole
+         * number of them, each a whole number of USB frames, so this is always
+         * contiguous.
+         */
+        samp_t (*stream_buffer_audio_frames)[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX] = audio_ring_read_reserve(&samples_to_host_ring, &len);
+        xassert(len >= tx_size_bytes);
 
         if (RATE_MULTIPLIER == 3) {
-            static int32_t src_data[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX][SRC_FF3V_FIR_TAPS_PER_PHASE] __attribute__((aligned (8)));
+            static src_block_us3_t src_state[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
             samp_t usb_audio_frames[AUDIO_FRAMES_PER_USB_FRAME][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
 
-            for (int i = 0; i < AUDIO_FRAMES_PER_USB_FRAME / RATE_MULTIPLIER; i++) {
-                for (int j = 0; j < CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX; j++) {
-                    usb_audio_frames[3*i + 0][j] = src_us3_voice_input_sample(src_data[j], src_ff3v_fir_coefs[2], stream_buffer_audio_frames[i][j]);
-                    usb_audio_frames[3*i + 1][j] = src_us3_voice_get_next_sample(src_data[j], src_ff3v_fir_coefs[1]);
-                    usb_audio_frames[3*i + 2][j] = src_us3_voice_get_next_sample(src_data[j], src_ff3v_fir_coefs[0]);
-                }
-            }
+            src_block_us3_samp(src_state, CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX,
+                               &usb_audio_frames[0][0], &stream_buffer_audio_frames[0][0],
+                               AUDIO_FRAMES_PER_USB_FRAME / RATE_MULTIPLIER);
             tud_audio_write(usb_audio_frames, sizeof(usb_audio_frames));
         } else {
-            tud_audio_write(stream_buffer_audio_frames, sizeof(stream_buffer_audio_frames));
+            tud_audio_write(stream_buffer_audio_frames, tx_size_bytes);
         }
+
+        audio_ring_read_commit(&samples_to_host_ring, tx_size_bytes);
     } else {
         rtos_printf("Oops buffer is empty!\n");
     }
@@ -715,7 +748,9 @@ bool tud_audio_set_itf_cb(uint8_t rhport,
         /* In case the interface is reset without
          * closing it first */
         spkr_interface_open = false;
-        xStreamBufferReset(samples_from_host_stream_buf);
+        audio_ring_discard(&samples_from_host_ring);
+        /* Wake the task to drop the discarded bytes and so free their space */
+        xTaskNotifyGive(usb_audio_out_task_handle);
     }
 #endif
 #if AUDIO_INPUT_ENABLED
@@ -723,7 +758,7 @@ bool tud_audio_set_itf_cb(uint8_t rhport,
         /* In case the interface is reset without
          * closing it first */
         mic_interface_open = false;
-        xStreamBufferReset(samples_to_host_stream_buf);
+        audio_ring_flush(&samples_to_host_ring);
     }
 #endif
 
@@ -771,16 +806,15 @@ void usb_audio_init(rtos_intertile_t *intertile_ctx,
      * Note: Given the way that the USB callback notifies usb_audio_out_task,
      * the size of this buffer MUST NOT be greater than 2 VFE frames.
      */
-    samples_from_host_stream_buf = xStreamBufferCreate(2 * sizeof(samp_t) * appconfAUDIO_PIPELINE_FRAME_ADVANCE * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX,
-                                            0);
+    audio_ring_init(&samples_from_host_ring, samples_from_host_storage, sizeof(samples_from_host_storage));
 
     /*
      * Note: The USB callback waits until there are at least 2 VFE frames
      * in this buffer before starting to send to the host, so the size of
-     * this buffer MUST be AT LEAST 2 VFE frames.
+     * this buffer MUST be AT LEAST 2 VFE frames. It is a whole number of
+     * frames so that the USB callback can always read a USB frame in place.
      */
-    samples_to_host_stream_buf = xStreamBufferCreate(2.5 * sizeof(samp_t) * appconfAUDIO_PIPELINE_FRAME_ADVANCE * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX,
-                                            0);
+    audio_ring_init(&samples_to_host_ring, samples_to_host_storage, sizeof(samples_to_host_storage));
 
     xTaskCreate((TaskFunction_t) usb_audio_out_task, "usb_audio_out_task", portTASK_STACK_DEPTH(usb_audio_out_task), intertile_ctx, priority, &usb_audio_out_task_handle);
 }
@@ -65,6 +65,27 @@ uint32_t dsp_math_divide_unsigned(uint32_t dividend, uint32_t divisor, uint32_t
 #endif //__xcore__
 
 
+#if __xcore__
+uint32_t dsp_math_divide_unsigned_64(uint64_t dividend, uint32_t divisor, uint32_t q_format )
+{
+    uint64_t shifted = dividend << q_format;
+    uint32_t h = (uint32_t)(shifted >> 32);
+    uint32_t l = (uint32_t)shifted;
+    uint32_t quotient, remainder;
+
+    // ldivu needs the quotient to fit in 32 bits, which it always does for a
+    // sane rate. Otherwise fall back to the library divide so the truncated
+    // result is the same as it would be on x86.
+    if (h >= divisor)
+    {
+        return (uint32_t)(shifted / divisor);
+    }
+
+    asm("ldivu %0,%1,%2,%3,%4":"=r"(quotient),"=r"(remainder):"r"(h),"r"(l),"r"(divisor));
+
+    return quotient;
+}
+#else //__xcore__
 uint32_t dsp_math_divide_unsigned_64(uint64_t dividend, uint32_t divisor, uint32_t q_format )
 {
     uint64_t h = dividend << q_format;
@@ -72,16 +93,7 @@ uint32_t dsp_math_divide_unsigned_64(uint64_t dividend, uint32_t divisor, uint32
 
     return (uint32_t)quotient;
 }
-
-uint32_t sum_array(uint32_t * array_to_sum, uint32_t array_length)
-{
-    uint32_t acc = 0;
-    for (uint32_t i = 0; i < array_length; i++)
-    {
-        acc += array_to_sum[i];
-    }
-    return acc;
-}
+#endif //__xcore__
 
 void reset_state()
 {
@@ -103,9 +115,13 @@ uint32_t determine_USB_audio_rate(uint32_t timestamp,
 {
     static uint32_t data_lengths[2][TOTAL_STORED];
     static uint32_t time_buckets[2][TOTAL_STORED];
+    // Running sums of data_lengths and time_buckets, kept up to date as buckets
+    // are replaced so that each packet costs the same however many are stored.
+    // Like the sums they replace these wrap modulo 2^32.
+    static uint32_t data_lengths_total[2];
+    static uint32_t time_buckets_total[2];
     static uint32_t current_data_bucket_size[2];
     static uint32_t first_timestamp[2];
-    static bool buckets_full[2];
     static uint32_t times_overflowed[2];
     static uint32_t previous_result[2] = {NOMINAL_RATE, NOMINAL_RATE};
 
@@ -131,7 +147,6 @@ uint32_t determine_USB_audio_rate(uint32_t timestamp,
         // reset all the static variables to default.
         current_data_bucket_size[direction] = 0;
         times_overflowed[direction] = 0;
-        buckets_full[direction] = false;
 
         for (int i = 0; i < TOTAL_STORED - STORED_PER_SECOND; i++)
         {
@@ -144,6 +159,8 @@ uint32_t determine_USB_audio_rate(uint32_t timestamp,
             data_lengths[direction][i] = bucket_expected[direction];
             time_buckets[direction][i] = REF_CLOCK_TICKS_PER_STORED_AVG;
         }
+        data_lengths_total[direction] = STORED_PER_SECOND * bucket_expected[direction];
+        time_buckets_total[direction] = STORED_PER_SECOND * REF_CLOCK_TICKS_PER_STORED_AVG;
 
         return NOMINAL_RATE;
     }
@@ -159,43 +176,29 @@ uint32_t determine_USB_audio_rate(uint32_t timestamp,
     // If current_data_bucket_size overflows we have bigger issues, so this case is not guarded.
 
     uint32_t timespan = timestamp - first_timestamp[direction];
-    uint32_t total_data_intermed = current_data_bucket_size[direction] + sum_array(data_lengths[direction], TOTAL_STORED);
+    uint32_t total_data_intermed = current_data_bucket_size[direction] + data_lengths_total[direction];
     uint64_t total_data = (uint64_t)(total_data_intermed) * 12500;
-    uint32_t total_timespan = timespan + sum_array(time_buckets[direction], TOTAL_STORED);
+    uint32_t total_timespan = timespan + time_buckets_total[direction];
 
     uint32_t data_per_sample = dsp_math_divide_unsigned_64(total_data, (total_timespan / 8), 19);
     uint32_t result = dsp_math_divide_unsigned(data_per_sample, expected[direction], 12);
 
     if (update && (timespan >= REF_CLOCK_TICKS_PER_STORED_AVG))
     {
-        if (buckets_full[direction])
-        {
-            // We've got enough data for a new bucket - replace the oldest bucket data with this new data
-            uint32_t oldest_bucket = times_overflowed[direction] % TOTAL_STORED;
+        // We've got enough data for a new bucket - replace the oldest bucket data with this new data.
+        // Until the buckets are full the oldest is the next one in order, which may hold the seed.
+        uint32_t oldest_bucket = times_overflowed[direction] % TOTAL_STORED;
 
-            time_buckets[direction][oldest_bucket] = timespan;
-            data_lengths[direction][oldest_bucket] = current_data_bucket_size[direction];
+        time_buckets_total[direction] += timespan - time_buckets[direction][oldest_bucket];
+        data_lengths_total[direction] += current_data_bucket_size[direction] - data_lengths[direction][oldest_bucket];
 
-            current_data_bucket_size[direction] = 0;
-            first_timestamp[direction] = timestamp;
+        time_buckets[direction][oldest_bucket] = timespan;
+        data_lengths[direction][oldest_bucket] = current_data_bucket_size[direction];
 
-            times_overflowed[direction]++;
-        }
-        else
-        {
-            // We've got enough data for this bucket - save this one and start the next one
-            time_buckets[direction][times_overflowed[direction]] = timespan;
-            data_lengths[direction][times_overflowed[direction]] = current_data_bucket_size[direction];
-
-            current_data_bucket_size[direction] = 0;
-            first_timestamp[direction] = timestamp;
-
-            times_overflowed[direction]++;
-            if (times_overflowed[direction] == TOTAL_STORED)
-            {
-                buckets_full[direction] = true;
-            }
-        }
+        current_data_bucket_size[direction] = 0;
+        first_timestamp[direction] = timestamp;
+
+        times_overflowed[direction]++;
     }
 
 #ifdef DEBUG_ADAPTIVE
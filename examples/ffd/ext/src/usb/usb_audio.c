@@ -32,13 +32,13 @@
 #include <xcore/hwtimer.h>
 
 #include "FreeRTOS.h"
-#include "stream_buffer.h"
 
 #include "usb_descriptors.h"
 #include "tusb.h"
 
 #include "rtos_intertile.h"
 
+#include "audio_ring.h"
 #include "audio_pipeline/audio_pipeline.h"
 
 #include "app_conf.h"
@@ -61,9 +61,9 @@ static volatile bool spkr_interface_open = false;
 static uint32_t prev_n_bytes_received = 0;
 static bool host_streaming_out = false;
 
-static StreamBufferHandle_t samples_to_host_stream_buf;
-static StreamBufferHandle_t samples_from_host_stream_buf;
-static StreamBufferHandle_t rx_buffer;
+static audio_ring_t samples_to_host_ring;
+static audio_ring_t samples_from_host_ring;
+static audio_ring_t rx_ring;
 static TaskHandle_t usb_audio_out_task_handle;
 
 #define USB_FRAMES_PER_VFE_FRAME (appconfAUDIO_PIPELINE_FRAME_ADVANCE / (appconfAUDIO_PIPELINE_SAMPLE_RATE / 1000))
@@ -113,6 +113,10 @@ typedef int32_t samp_t;
 #error CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX must be either 2 or 4
 #endif
 
+static uint8_t rx_ring_storage[CFG_TUD_AUDIO_FUNC_1_EP_OUT_SW_BUF_SZ] __attribute__((aligned (4)));
+static samp_t samples_from_host_storage[2 * appconfAUDIO_PIPELINE_FRAME_ADVANCE][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
+static samp_t samples_to_host_storage[3 * appconfAUDIO_PIPELINE_FRAME_ADVANCE][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
+
 void usb_audio_send(rtos_intertile_t *intertile_ctx,
                     size_t frame_count,
                     int32_t **frame_buffers,
@@ -200,7 +204,9 @@ void usb_audio_in_task(void *arg)
 
     for (;;) {
         samp_t usb_audio_in_frame[appconfAUDIO_PIPELINE_FRAME_ADVANCE][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
+        void *frame_ptr;
         size_t frame_length;
+        size_t space;
 
         frame_length = rtos_intertile_rx_len(
                 intertile_ctx,
@@ -209,17 +215,26 @@ void usb_audio_in_task(void *arg)
 
         xassert(frame_length == sizeof(usb_audio_in_frame));
 
+        /*
+         * The frame is received straight into the ring when there is room for
+         * it, and into usb_audio_in_frame only to be dropped. Only whole frames
+         * are written to the ring and it holds a whole number of them, so the
+         * free space always starts with a contiguous frame.
+         */
+        frame_ptr = audio_ring_write_reserve(&samples_to_host_ring, &space);
+        if (!mic_interface_open || space < frame_length) {
+            frame_ptr = usb_audio_in_frame;
+        }
+
         rtos_intertile_rx_data(
                 intertile_ctx,
-                usb_audio_in_frame,
+                frame_ptr,
                 frame_length);
 
-        if (mic_interface_open) {
-            if (xStreamBufferSpacesAvailable(samples_to_host_stream_buf) >= sizeof(usb_audio_in_frame)) {
-                xStreamBufferSend(samples_to_host_stream_buf, usb_audio_in_frame, sizeof(usb_audio_in_frame), 0);
-            } else {
-                rtos_printf("lost VFE output samples\n");
-            }
+        if (frame_ptr != usb_audio_in_frame) {
+            audio_ring_write_commit(&samples_to_host_ring, frame_length);
+        } else if (mic_interface_open) {
+            rtos_printf("lost VFE output samples\n");
         }
     }
 }
@@ -233,19 +248,22 @@ void usb_audio_out_task(void *arg)
         size_t bytes_received = 0;
 
         /*
-         * Only wake up when the stream buffer contains a whole audio
+         * Only wake up when the ring contains a whole audio
          * pipeline frame.
          */
         (void) ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
-        bytes_received = xStreamBufferReceive(samples_from_host_stream_buf, usb_audio_out_frame, sizeof(usb_audio_out_frame), 0);
+
+        /*
+         * Copied out rather than sent from the ring in place so that the
+         * space is released before rtos_intertile_tx() blocks.
+         */
+        bytes_received = audio_ring_read(&samples_from_host_ring, usb_audio_out_frame, sizeof(usb_audio_out_frame));
 
         /*
          * This shouldn't normally be zero, but it could be possible that
-         * the stream buffer is reset after this task has been notified.
+         * the ring is discarded after this task has been notified.
          */
         if (bytes_received > 0) {
-            xassert(bytes_received == sizeof(usb_audio_out_frame));
-
             rtos_intertile_tx(
                     intertile_ctx,
                     appconfUSB_AUDIO_PORT,
@@ -533,9 +551,9 @@ bool tud_audio_rx_done_post_read_cb(uint8_t rhport,
 {
     (void)rhport;
   
-    samp_t rx_data[CFG_TUD_AUDIO_FUNC_1_EP_OUT_SW_BUF_SZ];
-    samp_t usb_audio_frames[AUDIO_FRAMES_PER_USB_FRAME][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
-    const size_t stream_buffer_send_byte_count = sizeof(usb_audio_frames);
+    const size_t stream_buffer_send_byte_count = sizeof(samp_t) * AUDIO_FRAMES_PER_USB_FRAME * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX;
+    void *ring_ptr;
+    size_t len;
 
     host_streaming_out = true;
     prev_n_bytes_received = n_bytes_received;
@@ -545,53 +563,43 @@ bool tud_audio_rx_done_post_read_cb(uint8_t rhport,
     }
 
     /* 
-     * rx_data is a holding space to recieve the latest USB transaction.
-     * If it fits, we then push into rx_buffer. This could be a nominal-size transaction, or it could not be.
-     * We then only push nominal size transactions into the stream buffer.
+     * The latest USB transaction is read straight out of the endpoint FIFO
+     * into rx_ring. This could be a nominal-size transaction, or it could not be.
+     * We then only pass nominal size transactions on to samples_from_host_ring.
      * Hopefully this doesn't cause timing issues in the pipeline.
      */
-
-    if (sizeof(rx_data) >= n_bytes_received)
-    {
-        tud_audio_read(rx_data, n_bytes_received);
-    }
-    else
-    {
-        /* 
-         * I don't believe we ever get here because I think the EP FIFO will complain before this, 
-         * but better safe than sorry
-         */
-        rtos_printf("Rx'd too much USB data in one transaction, cannot read\n");
-        return false;
-    }
-
-    if (xStreamBufferSpacesAvailable(rx_buffer) >= n_bytes_received)
-    {
-        xStreamBufferSend(rx_buffer, rx_data, n_bytes_received, 0);
-    }
-    else
+    if (audio_ring_space(&rx_ring) < n_bytes_received)
     {
         rtos_printf("Rx'd too much total USB data, cannot buffer\n");
         return false;
     }
-    
-    if (xStreamBufferBytesAvailable(rx_buffer) >= sizeof(usb_audio_frames))
-    {
-        size_t num_rx_total = 0;
-        while(num_rx_total < sizeof(usb_audio_frames)){
-            size_t num_rx = xStreamBufferReceive(rx_buffer, &usb_audio_frames[num_rx_total], sizeof(usb_audio_frames)-num_rx_total, 0);
-            num_rx_total += num_rx;
-        }          
+
+    for (size_t n = n_bytes_received; n > 0; n -= len) {
+        ring_ptr = audio_ring_write_reserve(&rx_ring, &len);
+        if (len > n) {
+            len = n;
+        }
+        tud_audio_read(ring_ptr, len);
+        audio_ring_write_commit(&rx_ring, len);
     }
-    else
+
+    if (audio_ring_fill(&rx_ring) < stream_buffer_send_byte_count)
     {
         rtos_printf("Not enough data to send to stream buffer, cycling again");
         return true;
     }
 
-    if (xStreamBufferSpacesAvailable(samples_from_host_stream_buf) >= stream_buffer_send_byte_count)
+    /*
+     * Exactly one USB frame's worth is written at a time and the ring holds
+     * a whole number of them, so the free space always starts with a
+     * contiguous USB frame, which is copied straight into it from rx_ring.
+     */
+    ring_ptr = audio_ring_write_reserve(&samples_from_host_ring, &len);
+
+    if (len >= stream_buffer_send_byte_count)
     {
-        xStreamBufferSend(samples_from_host_stream_buf, usb_audio_frames, stream_buffer_send_byte_count, 0);
+        audio_ring_read(&rx_ring, ring_ptr, stream_buffer_send_byte_count);
+        audio_ring_write_commit(&samples_from_host_ring, stream_buffer_send_byte_count);
   
         /*
          * Wake up the task waiting on this buffer whenever there is one more
@@ -599,19 +607,20 @@ bool tud_audio_rx_done_post_read_cb(uint8_t rhport,
          * be input into the pipeline.
          *
          * This way the task will not wake up each time this task puts another
-         * milliseconds of audio into the stream buffer, but rather once every
+         * milliseconds of audio into the ring, but rather once every
          * pipeline frame time.
          */
         const size_t buffer_notify_level = stream_buffer_send_byte_count * (1 + USB_FRAMES_PER_VFE_FRAME);
   
         /*
          * TODO: If the above is modified such that not exactly AUDIO_FRAMES_PER_USB_FRAME
-         * frames are written to the stream buffer at a time, then this will need to change to >=.
+         * frames are written to the ring at a time, then this will need to change to >=.
          */
-        if (xStreamBufferBytesAvailable(samples_from_host_stream_buf) == buffer_notify_level) {
+        if (audio_ring_fill(&samples_from_host_ring) == buffer_notify_level) {
             xTaskNotifyGive(usb_audio_out_task_handle);
         }
     } else {
+        audio_ring_read_commit(&rx_ring, stream_buffer_send_byte_count);
         rtos_printf("lost USB output samples\n");
     }
   
@@ -629,9 +638,10 @@ bool tud_audio_tx_done_pre_load_cb(uint8_t rhport,
     size_t tx_size_frames;
     /*
      * This buffer needs to be large enough to hold any size of transaction,
-     * but if it's any bigger than twice nominal then we have bigger issues
+     * but if it's any bigger than twice nominal then we have bigger issues.
+     * It is only used to send zeros before the ring is ready.
      */
-    samp_t stream_buffer_audio_frames[2 * AUDIO_FRAMES_PER_USB_FRAME][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
+    samp_t zero_audio_frames[2 * AUDIO_FRAMES_PER_USB_FRAME][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
 
     /*
      * Copying XUA_lite logic basically verbatim - if the host is streaming out, 
@@ -666,14 +676,14 @@ bool tud_audio_tx_done_pre_load_cb(uint8_t rhport,
      * If the buffer becomes full, reset it in an attempt to
      * maintain a good fill level again.
      */
-    if (xStreamBufferIsFull(samples_to_host_stream_buf)) {
-        xStreamBufferReset(samples_to_host_stream_buf);
+    if (audio_ring_space(&samples_to_host_ring) == 0) {
+        audio_ring_flush(&samples_to_host_ring);
         ready = 0;
         rtos_printf("oops buffer is full\n");
         return true;
     }
 
-    bytes_available = xStreamBufferBytesAvailable(samples_to_host_stream_buf);
+    bytes_available = audio_ring_fill(&samples_to_host_ring);
     if (bytes_available >= 2 * sizeof(samp_t) * appconfAUDIO_PIPELINE_FRAME_ADVANCE * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX) {
         /* wait until we have 2 full audio pipeline output frames in the buffer */
         ready = 1;
@@ -682,20 +692,28 @@ bool tud_audio_tx_done_pre_load_cb(uint8_t rhport,
     if (!ready) {
         // we need to send something despite not being fully ready
         //  so, send all zeros
-        memset(stream_buffer_audio_frames, 0, tx_size_bytes);
-        tud_audio_write(stream_buffer_audio_frames, tx_size_bytes);
+        memset(zero_audio_frames, 0, tx_size_bytes);
+        tud_audio_write(zero_audio_frames, tx_size_bytes);
         return true;
     }
 
     if (bytes_available >= tx_size_bytes) {
 
+        /*
+         * The samples are written to the endpoint straight from the ring, in
+         * two parts when they wrap around its end.
+         */
         size_t num_rx_total = 0;
         while(num_rx_total < tx_size_bytes){
-            size_t num_rx =  xStreamBufferReceive(samples_to_host_stream_buf, &stream_buffer_audio_frames[num_rx_total], tx_size_bytes-num_rx_total, 0);
+            size_t num_rx;
+            void *ring_ptr = audio_ring_read_reserve(&samples_to_host_ring, &num_rx);
+            if (num_rx > tx_size_bytes - num_rx_total) {
+                num_rx = tx_size_bytes - num_rx_total;
+            }
+            tud_audio_write(ring_ptr, num_rx);
+            audio_ring_read_commit(&samples_to_host_ring, num_rx);
             num_rx_total += num_rx;
         }
-
-        tud_audio_write(stream_buffer_audio_frames, tx_size_bytes);
     } else {
         rtos_printf("Oops buffer is empty!\n");
     }
@@ -730,8 +748,10 @@ bool tud_audio_set_itf_cb(uint8_t rhport,
         /* In case the interface is reset without
          * closing it first */
         spkr_interface_open = false;
-        xStreamBufferReset(samples_from_host_stream_buf);
-        xStreamBufferReset(rx_buffer);
+        audio_ring_discard(&samples_from_host_ring);
+        /* Wake the task to drop the discarded bytes and so free their space */
+        xTaskNotifyGive(usb_audio_out_task_handle);
+        audio_ring_init(&rx_ring, rx_ring_storage, sizeof(rx_ring_storage));
     }
 #endif
 #if AUDIO_INPUT_ENABLED
@@ -739,7 +759,7 @@ bool tud_audio_set_itf_cb(uint8_t rhport,
         /* In case the interface is reset without
          * closing it first */
         mic_interface_open = false;
-        xStreamBufferReset(samples_to_host_stream_buf);
+        audio_ring_flush(&samples_to_host_ring);
     }
 #endif
 
@@ -783,22 +803,21 @@ void usb_audio_init(rtos_intertile_t *intertile_ctx,
     sampleFreqRng.subrange[0].bMax = appconfUSB_AUDIO_SAMPLE_RATE;
     sampleFreqRng.subrange[0].bRes = 0;
 
-    rx_buffer = xStreamBufferCreate(CFG_TUD_AUDIO_FUNC_1_EP_OUT_SW_BUF_SZ, 0);
+    audio_ring_init(&rx_ring, rx_ring_storage, sizeof(rx_ring_storage));
 
     /*
      * Note: Given the way that the USB callback notifies usb_audio_out_task,
      * the size of this buffer MUST NOT be greater than 2 VFE frames.
      */
-    samples_from_host_stream_buf = xStreamBufferCreate(2 * sizeof(samp_t) * appconfAUDIO_PIPELINE_FRAME_ADVANCE * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX,
-                                            0);
+    audio_ring_init(&samples_from_host_ring, samples_from_host_storage, sizeof(samples_from_host_storage));
 
     /*
      * Note: The USB callback waits until there are at least 2 VFE frames
      * in this buffer before starting to send to the host, so the size of
-     * this buffer MUST be AT LEAST 2 VFE frames.
+     * this buffer MUST be AT LEAST 2 VFE frames. It is a whole number of
+     * frames so that usb_audio_in_task can always receive one in place.
      */
-    samples_to_host_stream_buf = xStreamBufferCreate(2.5 * sizeof(samp_t) * appconfAUDIO_PIPELINE_FRAME_ADVANCE * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX,
-                                            0);
+    audio_ring_init(&samples_to_host_ring, samples_to_host_storage, sizeof(samples_to_host_storage));
 
     xTaskCreate((TaskFunction_t) usb_audio_in_task, "usb_audio_in_task", portTASK_STACK_DEPTH(usb_audio_in_task), intertile_ctx, priority, NULL);
     xTaskCreate((TaskFunction_t) usb_audio_out_task, "usb_audio_out_task", portTASK_STACK_DEPTH(usb_audio_out_task), intertile_ctx, priority, &usb_audio_out_task_handle);
@@ -11,6 +11,9 @@ set(RTOS_CONF_INCLUDES
     ${CMAKE_CURRENT_LIST_DIR}/src/rtos_conf
 )
 
+set(FFD_INFERENCE_BACKEND wanson CACHE STRING "Keyword recognition backend acted on, wanson or kws")
+set(FFD_INFERENCE_BENCHMARK_BACKEND none CACHE STRING "Keyword recognition backend run alongside for comparison, none, wanson or kws")
+
 include(${CMAKE_CURRENT_LIST_DIR}/bsp_config/bsp_config.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/inference/inference.cmake)
 
@@ -27,10 +30,15 @@ set(APP_COMPILER_FLAGS
     ${CMAKE_CURRENT_LIST_DIR}/src/config.xscope
 )
 
+string(TOUPPER ${FFD_INFERENCE_BACKEND} FFD_INFERENCE_BACKEND_NAME)
+string(TOUPPER ${FFD_INFERENCE_BENCHMARK_BACKEND} FFD_INFERENCE_BENCHMARK_BACKEND_NAME)
+
 set(APP_COMPILE_DEFINITIONS
     DEBUG_PRINT_ENABLE=1
     PLATFORM_USES_TILE_0=1
     PLATFORM_USES_TILE_1=1
+    appconfINFERENCE_BACKEND=appconfINFERENCE_BACKEND_${FFD_INFERENCE_BACKEND_NAME}
+    appconfINFERENCE_BENCHMARK_BACKEND=appconfINFERENCE_BACKEND_${FFD_INFERENCE_BENCHMARK_BACKEND_NAME}
 )
 
 set(APP_LINK_OPTIONS
@@ -39,14 +47,23 @@ set(APP_LINK_OPTIONS
 )
 
 set(APP_COMMON_LINK_LIBRARIES
-    sln_voice::app::ffd::inference_engine::wanson
+    sln_voice::app::ffd::inference_engine
+    sln_voice::app::ffd::inference_engine::${FFD_INFERENCE_BACKEND}
     fwk_voice::agc
     fwk_voice::ic
     fwk_voice::ns
     fwk_voice::vnr::features
     fwk_voice::vnr::inference
+    sln_voice::pipeline_profiler
+    sln_voice::frame_pool
+    sln_voice::page_cache
+    sln_voice::page_trace
 )
 
+if(NOT FFD_INFERENCE_BENCHMARK_BACKEND STREQUAL "none")
+    list(APPEND APP_COMMON_LINK_LIBRARIES sln_voice::app::ffd::inference_engine::${FFD_INFERENCE_BENCHMARK_BACKEND})
+endif()
+
 #**********************
 # Tile Targets
 #**********************
@@ -109,9 +126,23 @@ add_custom_command(
     VERBATIM
 )
 
-add_custom_target(flash_fs_example_ffd
-    COMMAND xflash --quad-spi-clock 50MHz --factory example_ffd.xe --boot-partition-size 0x100000 --data ${CMAKE_CURRENT_LIST_DIR}/filesystem_support/example_ffd_fat.fs
+# The raw model partition follows the filesystem image in the data partition,
+# at the offset appconfMODEL_PARTITION_FLASH_ADDRESS expects.
+find_package(Python3 COMPONENTS Interpreter)
+add_custom_command(
+    OUTPUT example_ffd_data.bin
+    COMMAND ${Python3_EXECUTABLE} ${CMAKE_CURRENT_LIST_DIR}/../../tools/model_partition/model_partition_mkimage.py --model model.bin --fs example_ffd_fat.fs --partition-offset 0x200000 --output example_ffd_data.bin
     DEPENDS example_ffd_fat.fs
+    COMMENT
+        "Create model partition"
+    WORKING_DIRECTORY
+        ${CMAKE_CURRENT_LIST_DIR}/filesystem_support
+    VERBATIM
+)
+
+add_custom_target(flash_fs_example_ffd
+    COMMAND xflash --quad-spi-clock 50MHz --factory example_ffd.xe --boot-partition-size 0x100000 --data ${CMAKE_CURRENT_LIST_DIR}/filesystem_support/example_ffd_data.bin
+    DEPENDS example_ffd_data.bin
     COMMENT
         "Flash filesystem"
     VERBATIM
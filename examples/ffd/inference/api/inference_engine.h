@@ -4,10 +4,54 @@
 #ifndef INFERENCE_ENGINE_H_
 #define INFERENCE_ENGINE_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 /* Generic interface for inference engines */
 int32_t inference_engine_create(uint32_t priority, void *args);
 int32_t inference_engine_sample_push(int32_t *buf, size_t bytes);
+void inference_engine_report(void);
+
+/*
+ * Called by a backend from process_block() for each keyword it recognises,
+ * with the ID of the keyword and, if there is one, its text. IDs are those
+ * of the Wanson engine, which the intent handling is written for: 1 and 2
+ * are wake words and 3 and up commands.
+ */
+typedef void (*inference_engine_result_cb_t)(void *ctx, int id, const char *text);
+
+/*
+ * A keyword recognition backend. The inference engine passes it blocks of
+ * block_size 16 bit samples at appconfAUDIO_PIPELINE_SAMPLE_RATE, one at a
+ * time, from its own task.
+ */
+typedef struct {
+    const char *name;
+
+    /* Samples per call to process_block(), at most appconfINFERENCE_MAX_BLOCK_SIZE */
+    size_t block_size;
+
+    /* Loads the model, returning 0 on success. result_cb is called with result_ctx. */
+    int32_t (*init)(inference_engine_result_cb_t result_cb, void *result_ctx);
+
+    /* Forgets any audio seen so far, returning 0 on success */
+    int32_t (*reset)(void);
+
+    /* Recognises one block of samples, returning 0 on success */
+    int32_t (*process_block)(const int16_t *samples);
+
+    /* Returns the RAM the application holds for the backend, in bytes */
+    size_t (*memory_footprint)(void);
+} inference_engine_backend_t;
+
+extern const inference_engine_backend_t inference_engine_backend_wanson;
+extern const inference_engine_backend_t inference_engine_backend_kws;
+
+/*
+ * Used by inference_engine_create() to start the engine tasks, and by
+ * inference_engine_sample_push() to send them the pipeline output.
+ */
+void inference_engine_tasks_create(uint32_t priority);
+void inference_engine_samples_send(int32_t *buf, size_t frames);
 
 #endif /* INFERENCE_ENGINE_H_ */
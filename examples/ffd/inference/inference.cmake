@@ -1,11 +1,25 @@
-## Create wanson inference engine target
+## Create inference engine target, which runs the selected backends on the pipeline output
+add_library(sln_voice_app_ffd_inference_engine INTERFACE)
+target_sources(sln_voice_app_ffd_inference_engine
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/inference_engine.c
+        ${CMAKE_CURRENT_LIST_DIR}/wanson/wanson_inf_eng_port.c
+)
+target_include_directories(sln_voice_app_ffd_inference_engine
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/api
+        ${CMAKE_CURRENT_LIST_DIR}/wanson
+)
+
+## Create an alias
+add_library(sln_voice::app::ffd::inference_engine ALIAS sln_voice_app_ffd_inference_engine)
+
+## Create wanson inference engine backend target
 add_library(sln_voice_app_ffd_inference_engine_wanson INTERFACE)
 target_sources(sln_voice_app_ffd_inference_engine_wanson
     INTERFACE
         ${CMAKE_CURRENT_LIST_DIR}/wanson/lib_xcore_math_compat.c
         ${CMAKE_CURRENT_LIST_DIR}/wanson/wanson_inf_eng.c
-        ${CMAKE_CURRENT_LIST_DIR}/wanson/wanson_inf_eng_port.c
-        ${CMAKE_CURRENT_LIST_DIR}/wanson/wanson_inf_eng_support.c
 )
 target_include_directories(sln_voice_app_ffd_inference_engine_wanson
     INTERFACE
@@ -24,3 +38,24 @@ target_compile_definitions(sln_voice_app_ffd_inference_engine_wanson
 
 ## Create an alias
 add_library(sln_voice::app::ffd::inference_engine::wanson ALIAS sln_voice_app_ffd_inference_engine_wanson)
+
+## Create TFLite Micro keyword spotting inference engine backend target
+add_library(sln_voice_app_ffd_inference_engine_kws INTERFACE)
+target_sources(sln_voice_app_ffd_inference_engine_kws
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/kws/kws_features.c
+        ${CMAKE_CURRENT_LIST_DIR}/kws/kws_inf_eng.c
+        ${CMAKE_CURRENT_LIST_DIR}/kws/kws_model.cc
+)
+target_include_directories(sln_voice_app_ffd_inference_engine_kws
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/api
+        ${CMAKE_CURRENT_LIST_DIR}/kws
+)
+target_link_libraries(sln_voice_app_ffd_inference_engine_kws
+    INTERFACE
+        core::lib_tflite_micro
+)
+
+## Create an alias
+add_library(sln_voice::app::ffd::inference_engine::kws ALIAS sln_voice_app_ffd_inference_engine_kws)
@@ -0,0 +1,420 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+/* STD headers */
+#include <string.h>
+#include <platform.h>
+#include <xs1.h>
+#include <xcore/hwtimer.h>
+
+/* FreeRTOS headers */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "stream_buffer.h"
+#include "queue.h"
+
+/* Library headers */
+#include "rtos_printf.h"
+
+/* App headers */
+#include "app_conf.h"
+#include "platform/driver_instances.h"
+#include "inference_engine.h"
+#include "wanson_inf_eng.h"
+
+#if appconfINFERENCE_BACKEND == appconfINFERENCE_BACKEND_WANSON
+#define PRIMARY_BACKEND     (&inference_engine_backend_wanson)
+#elif appconfINFERENCE_BACKEND == appconfINFERENCE_BACKEND_KWS
+#define PRIMARY_BACKEND     (&inference_engine_backend_kws)
+#endif
+
+#if appconfINFERENCE_BENCHMARK_BACKEND == appconfINFERENCE_BACKEND_WANSON
+#define BENCHMARK_BACKEND   (&inference_engine_backend_wanson)
+#elif appconfINFERENCE_BENCHMARK_BACKEND == appconfINFERENCE_BACKEND_KWS
+#define BENCHMARK_BACKEND   (&inference_engine_backend_kws)
+#endif
+
+#ifdef BENCHMARK_BACKEND
+#define ENGINE_COUNT        2
+#else
+#define ENGINE_COUNT        1
+#endif
+
+/*
+ * Blocks of samples for each engine. Each is owned either by the samples in
+ * task, which fills it, or by the engine task, and is passed between them
+ * through the free and ready queues, so that the next block is filled while
+ * the engine works on the current one.
+ */
+#define ENGINE_BLOCK_COUNT  2
+
+typedef struct {
+    uint32_t blocks;            /* Blocks processed */
+    uint32_t results;           /* Keywords recognised */
+    uint32_t block_waits;       /* Times the engine held every block when the next was due */
+    uint32_t blocks_dropped;    /* Blocks a benchmark engine was too busy to take */
+    uint32_t process_ticks_max;
+    uint64_t process_ticks;
+} engine_stats_t;
+
+typedef struct {
+    const inference_engine_backend_t *backend;
+    int benchmark;
+    volatile int running;
+
+    int16_t blocks[ENGINE_BLOCK_COUNT][appconfINFERENCE_MAX_BLOCK_SIZE];
+    QueueHandle_t free_blocks;
+    QueueHandle_t ready_blocks;
+
+    /* Block being filled by the samples in task, or NULL, and its fill */
+    int16_t *filling;
+    size_t filled;
+
+    engine_stats_t stats;
+} engine_t;
+
+static engine_t engines[ENGINE_COUNT];
+
+static StreamBufferHandle_t samples_to_engine_stream_buf = 0;
+
+/* Frames lost as the stream buffer was full, and its peak fill in bytes */
+static uint32_t frames_dropped;
+static uint32_t fill_max;
+
+typedef enum inference_state {
+    STATE_EXPECTING_WAKEWORD,
+    STATE_EXPECTING_COMMAND,
+    STATE_PROCESSING_COMMAND
+} inference_state_t;
+
+static inference_state_t inference_state;
+static TimerHandle_t display_clear_timer;
+
+static void vDisplayClearCallback(TimerHandle_t pxTimer)
+{
+    if ((inference_state == STATE_EXPECTING_COMMAND) || (inference_state == STATE_PROCESSING_COMMAND)) {
+        wanson_engine_proc_keyword_result(NULL, 50);    /* 50 is a special id that will play the no longer listening for command sound */
+    }
+    inference_state = STATE_EXPECTING_WAKEWORD;
+}
+
+/* Acts on a keyword recognised by the primary engine */
+static void inference_engine_result(void *ctx, int id, const char *text)
+{
+    engine_t *engine = ctx;
+    const char **text_ptr = text != NULL ? &text : NULL;
+
+    engine->stats.results++;
+
+#if appconfINFERENCE_RAW_OUTPUT
+    wanson_engine_proc_keyword_result(text_ptr, id);
+#else
+    if (inference_state == STATE_EXPECTING_WAKEWORD && IS_WAKEWORD(id)) {
+        xTimerReset(display_clear_timer, 0);
+        wanson_engine_proc_keyword_result(text_ptr, id);
+        inference_state = STATE_EXPECTING_COMMAND;
+    } else if (inference_state == STATE_EXPECTING_COMMAND && IS_COMMAND(id)) {
+        xTimerReset(display_clear_timer, 0);
+        wanson_engine_proc_keyword_result(text_ptr, id);
+        inference_state = STATE_PROCESSING_COMMAND;
+    } else if (inference_state == STATE_EXPECTING_COMMAND && IS_WAKEWORD(id)) {
+        xTimerReset(display_clear_timer, 0);
+        wanson_engine_proc_keyword_result(text_ptr, id);
+        // remain in STATE_EXPECTING_COMMAND state
+    } else if (inference_state == STATE_PROCESSING_COMMAND && IS_WAKEWORD(id)) {
+        xTimerReset(display_clear_timer, 0);
+        wanson_engine_proc_keyword_result(text_ptr, id);
+        inference_state = STATE_EXPECTING_COMMAND;
+    } else if (inference_state == STATE_PROCESSING_COMMAND && IS_COMMAND(id)) {
+        xTimerReset(display_clear_timer, 0);
+        wanson_engine_proc_keyword_result(text_ptr, id);
+        // remain in STATE_PROCESSING_COMMAND state
+    }
+#endif
+}
+
+/* Logs a keyword recognised by the benchmark engine, which is not acted on */
+static void inference_engine_benchmark_result(void *ctx, int id, const char *text)
+{
+    engine_t *engine = ctx;
+
+    engine->stats.results++;
+    rtos_printf("BENCHMARK %s KEYWORD: 0x%x, %s\n", engine->backend->name, id, text != NULL ? text : "");
+}
+
+/*
+ * Backends are called through function pointers, so the stack they need
+ * cannot be worked out by the tools. This covers both the Wanson library
+ * and TFLite Micro.
+ */
+#pragma stackfunction 2000
+static void inference_engine_task(void *arg)
+{
+    engine_t *engine = arg;
+    const inference_engine_backend_t *backend = engine->backend;
+    int32_t ret;
+
+    rtos_printf("%s init\n", backend->name);
+    ret = backend->init(engine->benchmark ? inference_engine_benchmark_result : inference_engine_result, engine);
+    if (ret != 0) {
+        rtos_printf("ERROR: Failed to initialise the %s inference engine, no keywords will be recognised\n", backend->name);
+    } else {
+        ret = backend->reset();
+        rtos_printf("%s init done, reset ret: %d, %u bytes\n", backend->name, ret, (unsigned) backend->memory_footprint());
+        engine->running = 1;
+    }
+
+    if (!engine->benchmark) {
+        /*
+         * Alert other tile to start the audio pipeline. This is sent even if
+         * the engine failed, as the pipeline waits for it and its other
+         * outputs must still run.
+         */
+        int dummy = 0;
+        rtos_intertile_tx(intertile_ctx, appconfWANSON_READY_SYNC_PORT, &dummy, sizeof(dummy));
+    }
+
+    if (!engine->running) {
+        vTaskDelete(NULL);
+    }
+
+    for (;;) {
+        int16_t *block;
+        uint32_t start;
+        uint32_t ticks;
+
+        xQueueReceive(engine->ready_blocks, &block, portMAX_DELAY);
+
+        start = get_reference_time();
+        backend->process_block(block);
+        ticks = get_reference_time() - start;
+
+        xQueueSend(engine->free_blocks, &block, portMAX_DELAY);
+
+        engine->stats.blocks++;
+        engine->stats.process_ticks += ticks;
+        if (ticks > engine->stats.process_ticks_max) {
+            engine->stats.process_ticks_max = ticks;
+        }
+    }
+}
+
+/*
+ * Appends count samples to the block each engine is filling, handing full
+ * blocks on to it. The primary engine is waited on when it holds every
+ * block, while a benchmark engine that does is skipped, so that it never
+ * holds up the primary.
+ */
+static void inference_engine_samples_deliver(const int16_t *samples, size_t count)
+{
+    for (int e = 0; e < ENGINE_COUNT; e++) {
+        engine_t *engine = &engines[e];
+        const size_t block_size = engine->backend->block_size;
+        size_t done = 0;
+
+        if (!engine->running) {
+            continue;
+        }
+
+        while (done < count) {
+            size_t n;
+
+            if (engine->filling == NULL) {
+                if (xQueueReceive(engine->free_blocks, &engine->filling, 0) != pdTRUE) {
+                    if (engine->benchmark) {
+                        engine->stats.blocks_dropped++;
+                        break;
+                    }
+                    engine->stats.block_waits++;
+                    xQueueReceive(engine->free_blocks, &engine->filling, portMAX_DELAY);
+                }
+                engine->filled = 0;
+            }
+
+            n = block_size - engine->filled;
+            if (n > count - done) {
+                n = count - done;
+            }
+            memcpy(&engine->filling[engine->filled], &samples[done], n * sizeof(int16_t));
+            engine->filled += n;
+            done += n;
+
+            if (engine->filled == block_size) {
+                xQueueSend(engine->ready_blocks, &engine->filling, portMAX_DELAY);
+                engine->filling = NULL;
+            }
+        }
+    }
+}
+
+/*
+ * Receives the samples sent to the engines, converts them to 16 bit and
+ * hands them on a block at a time.
+ */
+static void inference_engine_samples_in_task(void *arg)
+{
+    (void) arg;
+
+    for (;;) {
+        int32_t buf[appconfINFERENCE_SAMPLE_BLOCK_LENGTH];
+        int16_t buf_short[appconfINFERENCE_SAMPLE_BLOCK_LENGTH];
+        uint8_t *buf_ptr = (uint8_t*)buf;
+        size_t buf_len = sizeof(buf);
+        size_t fill;
+
+        do {
+            size_t bytes_rxed = xStreamBufferReceive(samples_to_engine_stream_buf,
+                                                     buf_ptr,
+                                                     buf_len,
+                                                     portMAX_DELAY);
+            buf_len -= bytes_rxed;
+            buf_ptr += bytes_rxed;
+        } while(buf_len > 0);
+
+        fill = xStreamBufferBytesAvailable(samples_to_engine_stream_buf);
+        if (fill > fill_max) {
+            fill_max = fill;
+        }
+
+        for (int i = 0; i < appconfINFERENCE_SAMPLE_BLOCK_LENGTH; i++) {
+            buf_short[i] = buf[i] >> 16;
+        }
+
+        inference_engine_samples_deliver(buf_short, appconfINFERENCE_SAMPLE_BLOCK_LENGTH);
+    }
+}
+
+#if INFERENCE_TILE_NO != AUDIO_PIPELINE_TILE_NO
+static void inference_engine_intertile_samples_in_task(void *arg)
+{
+    (void) arg;
+
+    for (;;) {
+        int32_t samples[appconfAUDIO_PIPELINE_FRAME_ADVANCE];
+        size_t bytes_received;
+
+        bytes_received = rtos_intertile_rx_len(
+                intertile_ctx,
+                appconfINTENT_MODEL_RUNNER_SAMPLES_PORT,
+                portMAX_DELAY);
+
+        xassert(bytes_received == sizeof(samples));
+
+        rtos_intertile_rx_data(
+                intertile_ctx,
+                samples,
+                bytes_received);
+
+        if (xStreamBufferSend(samples_to_engine_stream_buf, samples, sizeof(samples), 0) != sizeof(samples)) {
+            frames_dropped++;
+            rtos_printf("lost output samples for inference\n");
+        }
+    }
+}
+#endif
+
+void inference_engine_samples_send(int32_t *buf, size_t frames)
+{
+    configASSERT(frames == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+
+#if INFERENCE_TILE_NO == AUDIO_PIPELINE_TILE_NO
+    if(samples_to_engine_stream_buf != NULL) {
+        size_t bytes_to_send = sizeof(int32_t) * frames;
+        if (xStreamBufferSend(samples_to_engine_stream_buf, buf, bytes_to_send, 0) != bytes_to_send) {
+            frames_dropped++;
+            rtos_printf("lost local output samples for inference\n");
+        }
+    } else {
+        rtos_printf("inference engine streambuffer not ready\n");
+    }
+#else
+    rtos_intertile_tx(intertile_ctx,
+                      appconfINTENT_MODEL_RUNNER_SAMPLES_PORT,
+                      buf,
+                      sizeof(int32_t) * frames);
+#endif
+}
+
+static void inference_engine_start(engine_t *engine, const inference_engine_backend_t *backend, int benchmark)
+{
+    engine->backend = backend;
+    engine->benchmark = benchmark;
+    engine->free_blocks = xQueueCreate(ENGINE_BLOCK_COUNT, sizeof(int16_t *));
+    engine->ready_blocks = xQueueCreate(ENGINE_BLOCK_COUNT, sizeof(int16_t *));
+    for (int i = 0; i < ENGINE_BLOCK_COUNT; i++) {
+        int16_t *block = engine->blocks[i];
+        xQueueSend(engine->free_blocks, &block, 0);
+    }
+
+    configASSERT(backend->block_size > 0 && backend->block_size <= appconfINFERENCE_MAX_BLOCK_SIZE);
+
+    /* A benchmark engine runs below the primary, so that it only takes spare time */
+    xTaskCreate((TaskFunction_t)inference_engine_task,
+                benchmark ? "inf_eng_bench" : "inf_eng",
+                RTOS_THREAD_STACK_SIZE(inference_engine_task),
+                engine,
+                uxTaskPriorityGet(NULL) - benchmark,
+                NULL);
+}
+
+void inference_engine_tasks_create(uint32_t priority)
+{
+    samples_to_engine_stream_buf = xStreamBufferCreate(
+                                           appconfINFERENCE_FRAME_BUFFER_MULT * appconfAUDIO_PIPELINE_FRAME_ADVANCE,
+                                           appconfINFERENCE_SAMPLE_BLOCK_LENGTH);
+
+    inference_state = STATE_EXPECTING_WAKEWORD;
+    display_clear_timer = xTimerCreate(
+        "disp_clr",
+        pdMS_TO_TICKS(appconfINFERENCE_RESET_DELAY_MS),
+        pdFALSE,
+        NULL,
+        vDisplayClearCallback);
+
+    inference_engine_start(&engines[0], PRIMARY_BACKEND, 0);
+#ifdef BENCHMARK_BACKEND
+    inference_engine_start(&engines[1], BENCHMARK_BACKEND, 1);
+#endif
+
+#if INFERENCE_TILE_NO != AUDIO_PIPELINE_TILE_NO
+    xTaskCreate((TaskFunction_t)inference_engine_intertile_samples_in_task,
+                "inf_intertile_rx",
+                RTOS_THREAD_STACK_SIZE(inference_engine_intertile_samples_in_task),
+                NULL,
+                priority-1,
+                NULL);
+#endif
+    xTaskCreate((TaskFunction_t)inference_engine_samples_in_task,
+                "inf_samples_in",
+                RTOS_THREAD_STACK_SIZE(inference_engine_samples_in_task),
+                NULL,
+                uxTaskPriorityGet(NULL),
+                NULL);
+}
+
+void inference_engine_report(void)
+{
+    const size_t capacity = appconfINFERENCE_FRAME_BUFFER_MULT * appconfAUDIO_PIPELINE_FRAME_ADVANCE;
+
+    rtos_printf("inference: %u frames dropped; samples buffered %u, peak %u of %u bytes\n",
+                frames_dropped,
+                (unsigned) xStreamBufferBytesAvailable(samples_to_engine_stream_buf),
+                fill_max, (unsigned) capacity);
+    frames_dropped = 0;
+    fill_max = 0;
+
+    for (int e = 0; e < ENGINE_COUNT; e++) {
+        const engine_stats_t stats = engines[e].stats;
+        const inference_engine_backend_t *backend = engines[e].backend;
+
+        memset(&engines[e].stats, 0, sizeof(engine_stats_t));
+
+        rtos_printf("  %s%s: %u blocks, %u keywords, %u waits, %u dropped, %u us per block (max %u), %u bytes\n",
+                    backend->name, engines[e].benchmark ? " (benchmark)" : "",
+                    stats.blocks, stats.results, stats.block_waits, stats.blocks_dropped,
+                    stats.blocks ? (unsigned) (stats.process_ticks / stats.blocks / 100) : 0,
+                    (unsigned) (stats.process_ticks_max / 100),
+                    engines[e].running ? (unsigned) backend->memory_footprint() : 0);
+    }
+}
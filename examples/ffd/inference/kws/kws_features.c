@@ -0,0 +1,136 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+/* STD headers */
+#include <math.h>
+#include <string.h>
+
+/* App headers */
+#include "kws_features.h"
+
+#define KWS_PI  3.14159265358979f
+
+static float kws_hz_to_mel(float hz)
+{
+    return 1127.0f * logf(1.0f + hz / 700.0f);
+}
+
+void kws_features_init(kws_features_t *ctx)
+{
+    float mel[KWS_FEATURES_CHANNELS + 2];
+    const float mel_lower = kws_hz_to_mel(KWS_FEATURES_LOWER_HZ);
+    const float mel_step = (kws_hz_to_mel(KWS_FEATURES_UPPER_HZ) - mel_lower) / (KWS_FEATURES_CHANNELS + 1);
+
+    /* Periodic Hann window */
+    for (int i = 0; i < KWS_FEATURES_WINDOW_SIZE; i++) {
+        ctx->window[i] = 0.5f - 0.5f * cosf(2.0f * KWS_PI * i / KWS_FEATURES_WINDOW_SIZE);
+    }
+
+    for (int k = 0; k < KWS_FEATURES_FFT_SIZE / 2; k++) {
+        ctx->twiddle_cos[k] = cosf(2.0f * KWS_PI * k / KWS_FEATURES_FFT_SIZE);
+        ctx->twiddle_sin[k] = sinf(2.0f * KWS_PI * k / KWS_FEATURES_FFT_SIZE);
+    }
+
+    /* The edges of the filters, channel c rising from mel[c] to mel[c + 1] and falling to mel[c + 2] */
+    for (int j = 0; j < KWS_FEATURES_CHANNELS + 2; j++) {
+        mel[j] = mel_lower + j * mel_step;
+    }
+
+    for (int k = 0; k < KWS_FEATURES_BINS; k++) {
+        const float m = kws_hz_to_mel((float) k * KWS_FEATURES_SAMPLE_RATE / KWS_FEATURES_FFT_SIZE);
+
+        ctx->bin_channel[k] = -1;
+        ctx->bin_weight[k] = 0.0f;
+        for (int j = 0; j < KWS_FEATURES_CHANNELS + 1; j++) {
+            if (m >= mel[j] && m < mel[j + 1]) {
+                ctx->bin_channel[k] = j;
+                ctx->bin_weight[k] = (m - mel[j]) / (mel[j + 1] - mel[j]);
+                break;
+            }
+        }
+    }
+
+    kws_features_reset(ctx);
+}
+
+void kws_features_reset(kws_features_t *ctx)
+{
+    memset(ctx->history, 0, sizeof(ctx->history));
+}
+
+/* In place radix 2 FFT of fft_re and fft_im */
+static void kws_features_fft(kws_features_t *ctx)
+{
+    float *re = ctx->fft_re;
+    float *im = ctx->fft_im;
+
+    for (int i = 1, j = 0; i < KWS_FEATURES_FFT_SIZE; i++) {
+        int bit = KWS_FEATURES_FFT_SIZE >> 1;
+
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+
+        if (i < j) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    for (int size = 2; size <= KWS_FEATURES_FFT_SIZE; size <<= 1) {
+        const int half = size >> 1;
+        const int step = KWS_FEATURES_FFT_SIZE / size;
+
+        for (int i = 0; i < KWS_FEATURES_FFT_SIZE; i += size) {
+            for (int j = 0; j < half; j++) {
+                const float wr = ctx->twiddle_cos[j * step];
+                const float wi = -ctx->twiddle_sin[j * step];
+                const int a = i + j;
+                const int b = a + half;
+                const float tr = wr * re[b] - wi * im[b];
+                const float ti = wr * im[b] + wi * re[b];
+
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+void kws_features_compute(kws_features_t *ctx, const int16_t *samples, float *features)
+{
+    memmove(ctx->history, &ctx->history[KWS_FEATURES_STEP_SIZE],
+            (KWS_FEATURES_WINDOW_SIZE - KWS_FEATURES_STEP_SIZE) * sizeof(float));
+    for (int i = 0; i < KWS_FEATURES_STEP_SIZE; i++) {
+        ctx->history[KWS_FEATURES_WINDOW_SIZE - KWS_FEATURES_STEP_SIZE + i] = samples[i] * (1.0f / 32768.0f);
+    }
+
+    for (int i = 0; i < KWS_FEATURES_FFT_SIZE; i++) {
+        ctx->fft_re[i] = i < KWS_FEATURES_WINDOW_SIZE ? ctx->history[i] * ctx->window[i] : 0.0f;
+        ctx->fft_im[i] = 0.0f;
+    }
+    kws_features_fft(ctx);
+
+    memset(features, 0, KWS_FEATURES_CHANNELS * sizeof(float));
+    for (int k = 0; k < KWS_FEATURES_BINS; k++) {
+        const int c = ctx->bin_channel[k];
+        const float power = ctx->fft_re[k] * ctx->fft_re[k] + ctx->fft_im[k] * ctx->fft_im[k];
+
+        if (c < 0) {
+            continue;
+        }
+        if (c < KWS_FEATURES_CHANNELS) {
+            features[c] += ctx->bin_weight[k] * power;
+        }
+        if (c > 0) {
+            features[c - 1] += (1.0f - ctx->bin_weight[k]) * power;
+        }
+    }
+
+    for (int c = 0; c < KWS_FEATURES_CHANNELS; c++) {
+        features[c] = logf(features[c] + KWS_FEATURES_LOG_FLOOR);
+    }
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef KWS_FEATURES_H_
+#define KWS_FEATURES_H_
+
+#include <stdint.h>
+
+/*
+ * Log mel filterbank front end of the keyword spotting backend. Each slice
+ * of features is computed from the last KWS_FEATURES_WINDOW_SIZE samples,
+ * Hann windowed and zero padded to a KWS_FEATURES_FFT_SIZE point FFT, as
+ * the natural log of the power in KWS_FEATURES_CHANNELS triangular mel
+ * filters spaced from KWS_FEATURES_LOWER_HZ to KWS_FEATURES_UPPER_HZ, and
+ * a new slice is computed every KWS_FEATURES_STEP_SIZE samples.
+ *
+ * tools/kws/kws_features.py computes the same features, for training
+ * models to run on them, and must be kept in step with this front end.
+ */
+#define KWS_FEATURES_SAMPLE_RATE    16000
+#define KWS_FEATURES_WINDOW_SIZE    480
+#define KWS_FEATURES_STEP_SIZE      320
+#define KWS_FEATURES_FFT_SIZE       512
+#define KWS_FEATURES_CHANNELS       40
+#define KWS_FEATURES_LOWER_HZ       125.0f
+#define KWS_FEATURES_UPPER_HZ       7500.0f
+
+/* Added to the power of each channel, giving the features of silence */
+#define KWS_FEATURES_LOG_FLOOR      1e-6f
+
+#define KWS_FEATURES_BINS           (KWS_FEATURES_FFT_SIZE / 2 + 1)
+
+typedef struct {
+    /* Last KWS_FEATURES_WINDOW_SIZE samples, oldest first, scaled to +/-1 */
+    float history[KWS_FEATURES_WINDOW_SIZE];
+
+    float window[KWS_FEATURES_WINDOW_SIZE];
+    float twiddle_cos[KWS_FEATURES_FFT_SIZE / 2];
+    float twiddle_sin[KWS_FEATURES_FFT_SIZE / 2];
+
+    /*
+     * Each FFT bin is on the rising edge of channel bin_channel[k], with a
+     * weight of bin_weight[k], and on the falling edge of the channel below
+     * it, with a weight of 1 - bin_weight[k]. Bins outside all the filters
+     * have a bin_channel of -1.
+     */
+    int8_t bin_channel[KWS_FEATURES_BINS];
+    float bin_weight[KWS_FEATURES_BINS];
+
+    float fft_re[KWS_FEATURES_FFT_SIZE];
+    float fft_im[KWS_FEATURES_FFT_SIZE];
+} kws_features_t;
+
+/* Computes the window, FFT twiddles and filterbank, and resets ctx */
+void kws_features_init(kws_features_t *ctx);
+
+/* Forgets the samples seen so far, as if preceded by silence */
+void kws_features_reset(kws_features_t *ctx);
+
+/*
+ * Adds KWS_FEATURES_STEP_SIZE samples to the window and writes the
+ * KWS_FEATURES_CHANNELS features of the new slice to features.
+ */
+void kws_features_compute(kws_features_t *ctx, const int16_t *samples, float *features);
+
+#endif /* KWS_FEATURES_H_ */
@@ -0,0 +1,164 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+/* STD headers */
+#include <math.h>
+#include <string.h>
+
+/* Library headers */
+#include "rtos_printf.h"
+
+/* App headers */
+#include "app_conf.h"
+#include "inference_engine.h"
+#include "kws_features.h"
+#include "kws_model.h"
+
+#if appconfAUDIO_PIPELINE_SAMPLE_RATE != KWS_FEATURES_SAMPLE_RATE
+#error The KWS backend front end is for 16 kHz audio
+#endif
+
+#if appconfKWS_BLOCK_SIZE % KWS_FEATURES_STEP_SIZE != 0
+#error appconfKWS_BLOCK_SIZE must be a multiple of KWS_FEATURES_STEP_SIZE
+#endif
+
+#define KWS_SLICES_PER_BLOCK    (appconfKWS_BLOCK_SIZE / KWS_FEATURES_STEP_SIZE)
+
+static const int class_ids[] = appconfKWS_CLASS_IDS;
+static const char *const class_names[] = appconfKWS_CLASS_NAMES;
+
+#define KWS_CLASS_COUNT     (sizeof(class_ids) / sizeof(class_ids[0]))
+
+_Static_assert(sizeof(class_names) / sizeof(class_names[0]) == KWS_CLASS_COUNT,
+               "appconfKWS_CLASS_NAMES must name each of appconfKWS_CLASS_IDS");
+
+static kws_features_t features;
+static kws_model_info_t model;
+
+/* Quantised features of the last slice_count slices, oldest first */
+static int8_t window[appconfKWS_INPUT_MAX_SLICES][KWS_FEATURES_CHANNELS];
+static size_t slice_count;
+
+/* Class probabilities of the last appconfKWS_AVERAGE_BLOCKS runs, in percent */
+static uint8_t history[appconfKWS_AVERAGE_BLOCKS][KWS_CLASS_COUNT];
+static unsigned history_next;
+static unsigned suppress;
+
+static inference_engine_result_cb_t result_cb;
+static void *result_ctx;
+
+static int8_t kws_quantise(float feature)
+{
+    int32_t q = (int32_t) lroundf(feature / model.input_scale) + model.input_zero_point;
+
+    return (int8_t) (q < -128 ? -128 : (q > 127 ? 127 : q));
+}
+
+static int32_t kws_engine_init(inference_engine_result_cb_t cb, void *ctx)
+{
+    result_cb = cb;
+    result_ctx = ctx;
+
+    if (kws_model_init(&model) != 0) {
+        return -1;
+    }
+
+    slice_count = model.input_size / KWS_FEATURES_CHANNELS;
+    if (model.input_size % KWS_FEATURES_CHANNELS != 0 || slice_count == 0 || slice_count > appconfKWS_INPUT_MAX_SLICES) {
+        rtos_printf("ERROR: %s must take from 1 to appconfKWS_INPUT_MAX_SLICES slices of %d features\n",
+                    appconfKWS_MODEL_FILE, KWS_FEATURES_CHANNELS);
+        return -1;
+    }
+    if (model.output_size != KWS_CLASS_COUNT) {
+        rtos_printf("ERROR: %s must give a probability for each of appconfKWS_CLASS_IDS\n", appconfKWS_MODEL_FILE);
+        return -1;
+    }
+
+    kws_features_init(&features);
+
+    return 0;
+}
+
+static int32_t kws_engine_reset(void)
+{
+    const int8_t silence = kws_quantise(logf(KWS_FEATURES_LOG_FLOOR));
+
+    kws_features_reset(&features);
+    memset(window, silence, sizeof(window));
+    memset(history, 0, sizeof(history));
+    history_next = 0;
+    suppress = 0;
+
+    return 0;
+}
+
+static int32_t kws_engine_process_block(const int16_t *samples)
+{
+    float probabilities[KWS_CLASS_COUNT];
+    int best = -1;
+    unsigned best_percent = 0;
+
+    /* Slide the window along by the new slices */
+    for (int s = 0; s < KWS_SLICES_PER_BLOCK; s++) {
+        float slice[KWS_FEATURES_CHANNELS];
+
+        memmove(window[0], window[1], (slice_count - 1) * KWS_FEATURES_CHANNELS);
+        kws_features_compute(&features, &samples[s * KWS_FEATURES_STEP_SIZE], slice);
+        for (int c = 0; c < KWS_FEATURES_CHANNELS; c++) {
+            window[slice_count - 1][c] = kws_quantise(slice[c]);
+        }
+    }
+
+    memcpy(model.input, window, model.input_size);
+    if (kws_model_invoke(probabilities) != 0) {
+        return -1;
+    }
+
+    for (size_t c = 0; c < KWS_CLASS_COUNT; c++) {
+        const float p = probabilities[c];
+
+        history[history_next][c] = (uint8_t) (p <= 0.0f ? 0 : (p >= 1.0f ? 100 : p * 100.0f + 0.5f));
+    }
+    history_next = (history_next + 1) % appconfKWS_AVERAGE_BLOCKS;
+
+    if (suppress > 0) {
+        suppress--;
+        return 0;
+    }
+
+    for (size_t c = 0; c < KWS_CLASS_COUNT; c++) {
+        unsigned sum = 0;
+
+        if (class_ids[c] == 0) {
+            continue;
+        }
+        for (int i = 0; i < appconfKWS_AVERAGE_BLOCKS; i++) {
+            sum += history[i][c];
+        }
+        if (sum / appconfKWS_AVERAGE_BLOCKS > best_percent) {
+            best_percent = sum / appconfKWS_AVERAGE_BLOCKS;
+            best = c;
+        }
+    }
+
+    if (best >= 0 && best_percent >= appconfKWS_THRESHOLD_PERCENT) {
+        suppress = appconfKWS_SUPPRESS_BLOCKS;
+        result_cb(result_ctx, class_ids[best], class_names[best]);
+    }
+
+    return 0;
+}
+
+static size_t kws_engine_memory_footprint(void)
+{
+    return sizeof(features) + sizeof(window) + sizeof(history) + kws_model_memory_footprint();
+}
+
+const inference_engine_backend_t inference_engine_backend_kws = {
+    .name = "TFLite Micro KWS",
+    .block_size = appconfKWS_BLOCK_SIZE,
+    .init = kws_engine_init,
+    .reset = kws_engine_reset,
+    .process_block = kws_engine_process_block,
+    .memory_footprint = kws_engine_memory_footprint,
+};
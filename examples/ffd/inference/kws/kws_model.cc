@@ -0,0 +1,172 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+/* STD headers */
+#include <new>
+
+/* Library headers */
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "xcore_ops.h"
+
+extern "C" {
+/* FreeRTOS headers */
+#include "FreeRTOS.h"
+
+/* Library headers */
+#include "rtos_printf.h"
+
+/* App headers */
+#include "app_conf.h"
+#include "ff.h"
+#include "kws_model.h"
+}
+
+namespace xc = tflite::ops::micro::xcore;
+
+namespace {
+
+/* The builtin operators of typical int8 keyword spotting networks, and the xcore operators xformer gives them */
+constexpr int op_count = 14 + 4;
+
+/* The flatbuffer is used in place, so is kept in RAM for as long as the interpreter */
+alignas(16) uint8_t model_data[appconfKWS_MODEL_MAX_SIZE];
+alignas(16) uint8_t tensor_arena[appconfKWS_TENSOR_ARENA_SIZE];
+alignas(tflite::MicroInterpreter) uint8_t interpreter_storage[sizeof(tflite::MicroInterpreter)];
+
+tflite::MicroErrorReporter error_reporter;
+tflite::MicroMutableOpResolver<op_count> op_resolver;
+tflite::MicroInterpreter *interpreter;
+bool ops_added;
+
+size_t kws_model_load(void)
+{
+    FIL file;
+    UINT bytes_read = 0;
+    size_t size;
+
+    if (f_open(&file, appconfKWS_MODEL_FILE, FA_READ) != FR_OK) {
+        rtos_printf("ERROR: Failed to open %s\n", appconfKWS_MODEL_FILE);
+        return 0;
+    }
+    size = f_size(&file);
+    if (size > sizeof(model_data)) {
+        rtos_printf("ERROR: %s is %u bytes, more than appconfKWS_MODEL_MAX_SIZE\n", appconfKWS_MODEL_FILE, (unsigned) size);
+        size = 0;
+    } else if (f_read(&file, model_data, size, &bytes_read) != FR_OK || bytes_read != size) {
+        size = 0;
+    }
+    f_close(&file);
+
+    return size;
+}
+
+/* The resolver only has room for each operator once, so they are added on the first init only */
+void kws_model_ops_add(void)
+{
+    if (ops_added) {
+        return;
+    }
+
+    op_resolver.AddAdd();
+    op_resolver.AddAveragePool2D();
+    op_resolver.AddConv2D();
+    op_resolver.AddDepthwiseConv2D();
+    op_resolver.AddExpandDims();
+    op_resolver.AddFullyConnected();
+    op_resolver.AddLogistic();
+    op_resolver.AddMaxPool2D();
+    op_resolver.AddMean();
+    op_resolver.AddMul();
+    op_resolver.AddPad();
+    op_resolver.AddQuantize();
+    op_resolver.AddReshape();
+    op_resolver.AddSoftmax();
+
+    op_resolver.AddCustom(xc::XC_conv2d_v2_OpCode, xc::Register_XC_conv2d_v2());
+    op_resolver.AddCustom(xc::XC_add_OpCode, xc::Register_XC_add());
+    op_resolver.AddCustom(xc::XC_lookup_OpCode, xc::Register_XC_lookup());
+    op_resolver.AddCustom(xc::XC_pad_OpCode, xc::Register_XC_pad());
+
+    ops_added = true;
+}
+
+size_t kws_tensor_size(const TfLiteTensor *tensor)
+{
+    size_t size = 1;
+
+    for (int i = 0; i < tensor->dims->size; i++) {
+        size *= tensor->dims->data[i];
+    }
+    return size;
+}
+
+} // namespace
+
+int32_t kws_model_init(kws_model_info_t *info)
+{
+    const tflite::Model *model;
+    TfLiteTensor *input;
+    const TfLiteTensor *output;
+
+    if (kws_model_load() == 0) {
+        return -1;
+    }
+
+    model = tflite::GetModel(model_data);
+    if (model->version() != TFLITE_SCHEMA_VERSION) {
+        rtos_printf("ERROR: %s has schema version %u, not %u\n", appconfKWS_MODEL_FILE,
+                    (unsigned) model->version(), (unsigned) TFLITE_SCHEMA_VERSION);
+        return -1;
+    }
+
+    kws_model_ops_add();
+
+    interpreter = new (interpreter_storage) tflite::MicroInterpreter(
+            model, op_resolver, tensor_arena, sizeof(tensor_arena), &error_reporter);
+
+    if (interpreter->AllocateTensors() != kTfLiteOk) {
+        rtos_printf("ERROR: %s does not fit appconfKWS_TENSOR_ARENA_SIZE\n", appconfKWS_MODEL_FILE);
+        return -1;
+    }
+
+    input = interpreter->input(0);
+    output = interpreter->output(0);
+    if (input->type != kTfLiteInt8 || output->type != kTfLiteInt8) {
+        rtos_printf("ERROR: %s must have int8 input and output tensors\n", appconfKWS_MODEL_FILE);
+        return -1;
+    }
+
+    info->input = input->data.int8;
+    info->input_size = kws_tensor_size(input);
+    info->input_scale = input->params.scale;
+    info->input_zero_point = input->params.zero_point;
+    info->output_size = kws_tensor_size(output);
+
+    rtos_printf("%s: %u features in, %u bytes of tensor arena used\n", appconfKWS_MODEL_FILE,
+                (unsigned) info->input_size, (unsigned) interpreter->arena_used_bytes());
+    return 0;
+}
+
+int32_t kws_model_invoke(float *probabilities)
+{
+    const TfLiteTensor *output;
+
+    if (interpreter->Invoke() != kTfLiteOk) {
+        return -1;
+    }
+
+    output = interpreter->output(0);
+    for (size_t c = 0; c < kws_tensor_size(output); c++) {
+        probabilities[c] = (output->data.int8[c] - output->params.zero_point) * output->params.scale;
+    }
+
+    return 0;
+}
+
+size_t kws_model_memory_footprint(void)
+{
+    return sizeof(model_data) + sizeof(tensor_arena) + sizeof(interpreter_storage);
+}
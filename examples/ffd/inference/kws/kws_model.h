@@ -0,0 +1,42 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef KWS_MODEL_H_
+#define KWS_MODEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The int8 input tensor of the model, and the size of its output */
+typedef struct {
+    int8_t *input;
+    size_t input_size;
+    float input_scale;
+    int32_t input_zero_point;
+    size_t output_size;
+} kws_model_info_t;
+
+/*
+ * Loads appconfKWS_MODEL_FILE from the filesystem and allocates its
+ * tensors, returning 0 and filling in info on success.
+ */
+int32_t kws_model_init(kws_model_info_t *info);
+
+/*
+ * Runs the model on the input tensor, writing the probability of each of
+ * its output_size classes to probabilities. Returns 0 on success.
+ */
+int32_t kws_model_invoke(float *probabilities);
+
+/* Returns the RAM held for the model and its interpreter, in bytes */
+size_t kws_model_memory_footprint(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KWS_MODEL_H_ */
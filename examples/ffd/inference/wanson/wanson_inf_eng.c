@@ -9,42 +9,25 @@
 /* FreeRTOS headers */
 #include "FreeRTOS.h"
 #include "task.h"
-#include "stream_buffer.h"
 
 /* App headers */
 #include "app_conf.h"
 #include "platform/driver_instances.h"
 #include "inference_engine.h"
 #include "rtos_swmem.h"
-#include "ssd1306_rtos_support.h"
 #include "wanson_inf_eng.h"
 #include "wanson_api.h"
 #include "xcore_device_memory.h"
 
-#define WANSON_SAMPLES_PER_INFERENCE    (2 * appconfINFERENCE_SAMPLE_BLOCK_LENGTH) 
+static inference_engine_result_cb_t result_cb;
+static void *result_ctx;
 
-typedef enum inference_state {
-    STATE_EXPECTING_WAKEWORD,
-    STATE_EXPECTING_COMMAND,
-    STATE_PROCESSING_COMMAND
-} inference_state_t;
-
-static inference_state_t inference_state;
-
-void vDisplayClearCallback(TimerHandle_t pxTimer)
-{
-    if ((inference_state == STATE_EXPECTING_COMMAND) || (inference_state == STATE_PROCESSING_COMMAND)) {
-        wanson_engine_proc_keyword_result(NULL, 50);    /* 50 is a special id that will play the no longer listening for command sound */
-    }
-    inference_state = STATE_EXPECTING_WAKEWORD;
-}
-static uint32_t in_last = 0;
-#pragma stackfunction 1500
-void wanson_engine_task(void *args)
+static int32_t wanson_engine_init(inference_engine_result_cb_t cb, void *ctx)
 {
     assert(WANSON_SAMPLES_PER_INFERENCE == 480); // Wanson ASR engine expects 480 samples per inference
 
-    inference_state = STATE_EXPECTING_WAKEWORD;
+    result_cb = cb;
+    result_ctx = ctx;
 
 #if ON_TILE(0)
     // NOTE: The Wanson model uses the .SwMem_data attribute but no SwMem event handling code is required.
@@ -53,104 +36,57 @@ void wanson_engine_task(void *args)
     rtos_swmem_init(0);
 #endif
 
-    size_t model_file_size;
-    model_file_size = model_file_init();
-    if (model_file_size == 0) {
+    if (model_file_init() == 0) {
         rtos_printf("ERROR: Failed to load model file\n");
-        vTaskDelete(NULL);
+        return -1;
     }
 
-    rtos_printf("Wanson init\n");
     Wanson_ASR_Init();
-    rtos_printf("Wanson init done\n");
-
-    StreamBufferHandle_t input_queue = (StreamBufferHandle_t)args;
-    TimerHandle_t display_clear_timer = xTimerCreate(
-        "disp_clr",
-        pdMS_TO_TICKS(appconfINFERENCE_RESET_DELAY_MS),
-        pdFALSE,
-        NULL,
-        vDisplayClearCallback);
+    return 0;
+}
 
-    int32_t buf[appconfINFERENCE_SAMPLE_BLOCK_LENGTH] = {0};
-    int16_t buf_short[WANSON_SAMPLES_PER_INFERENCE] = {0};
+static int32_t wanson_engine_reset(void)
+{
+    int ret;
 
-    /* Perform any initialization here */
 #if 1   // domain doesn't do anything right now, 0 is both wakeup and asr
-    rtos_printf("Wanson reset for wakeup\n");
-    int ret = Wanson_ASR_Reset(0);
+    ret = Wanson_ASR_Reset(0);
 #else
-    rtos_printf("Wanson reset for asr\n");
-    int ret = Wanson_ASR_Reset(1);
+    ret = Wanson_ASR_Reset(1);
 #endif
-    rtos_printf("Wanson reset ret: %d\n", ret);
-
-    /* Alert other tile to start the audio pipeline */
-    int dummy = 0;
-    rtos_intertile_tx(intertile_ctx, appconfWANSON_READY_SYNC_PORT, &dummy, sizeof(dummy));
+    return ret;
+}
 
+static int32_t wanson_engine_process_block(const int16_t *samples)
+{
     char *text_ptr = NULL;
     int id = 0;
-    size_t buf_short_index = 0;
-
-    while (1)
-    {
-        /* Receive audio frames */
-        uint8_t *buf_ptr = (uint8_t*)buf;
-        size_t buf_len = appconfINFERENCE_SAMPLE_BLOCK_LENGTH * sizeof(int32_t);
-
-        do {
-            size_t bytes_rxed = xStreamBufferReceive(input_queue,
-                                                     buf_ptr,
-                                                     buf_len,
-                                                     portMAX_DELAY);
-            buf_len -= bytes_rxed;
-            buf_ptr += bytes_rxed;
-        } while(buf_len > 0);
-
-        for (int i=0; i<appconfINFERENCE_SAMPLE_BLOCK_LENGTH; i++) {
-            buf_short[buf_short_index++] = buf[i] >> 16;
-        }
-
-        if (buf_short_index >= WANSON_SAMPLES_PER_INFERENCE)
-        {
-            /* Perform inference here */
-            ret = Wanson_ASR_Recog(buf_short, WANSON_SAMPLES_PER_INFERENCE, (const char **)&text_ptr, &id);
-
-
-    // rtos_printf("inf times diff:%d\n", get_reference_time() - in_last);
-    // in_last = get_reference_time();
-            if (ret) {
-    #if appconfINFERENCE_RAW_OUTPUT
-                wanson_engine_proc_keyword_result((const char **)&text_ptr, id);
-    #else
-                if (inference_state == STATE_EXPECTING_WAKEWORD && IS_WAKEWORD(id)) {
-                    xTimerReset(display_clear_timer, 0);
-                    wanson_engine_proc_keyword_result((const char **)&text_ptr, id);
-                    inference_state = STATE_EXPECTING_COMMAND;
-                } else if (inference_state == STATE_EXPECTING_COMMAND && IS_COMMAND(id)) {
-                    xTimerReset(display_clear_timer, 0);
-                    wanson_engine_proc_keyword_result((const char **)&text_ptr, id);
-                    inference_state = STATE_PROCESSING_COMMAND;
-                } else if (inference_state == STATE_EXPECTING_COMMAND && IS_WAKEWORD(id)) {
-                    xTimerReset(display_clear_timer, 0);
-                    wanson_engine_proc_keyword_result((const char **)&text_ptr, id);
-                    // remain in STATE_EXPECTING_COMMAND state
-                } else if (inference_state == STATE_PROCESSING_COMMAND && IS_WAKEWORD(id)) {
-                    xTimerReset(display_clear_timer, 0);
-                    wanson_engine_proc_keyword_result((const char **)&text_ptr, id);
-                    inference_state = STATE_EXPECTING_COMMAND;
-                } else if (inference_state == STATE_PROCESSING_COMMAND && IS_COMMAND(id)) {
-                    xTimerReset(display_clear_timer, 0);
-                    wanson_engine_proc_keyword_result((const char **)&text_ptr, id);
-                    // remain in STATE_PROCESSING_COMMAND state
-                }
-    #endif
-            }
-    
-            buf_short_index = 0; // reset the offest into the buffer of int16s.  
-                                 // Note, we do not need to overlap the window of samples.
-                                 // This is handled in the Wanson ASR engine.
-        }
+    int ret;
+
+    model_data_inference_start();
+    ret = Wanson_ASR_Recog((short *) samples, WANSON_SAMPLES_PER_INFERENCE, (const char **)&text_ptr, &id);
+    model_data_inference_end();
+
+    if (ret) {
+        result_cb(result_ctx, id, text_ptr);
     }
+
+    // Note, we do not need to overlap the window of samples.
+    // This is handled in the Wanson ASR engine.
+    return 0;
 }
+
+/* Only the model cache is known, as the library allocates its own memory */
+static size_t wanson_engine_memory_footprint(void)
+{
+    return model_data_ram_size();
+}
+
+const inference_engine_backend_t inference_engine_backend_wanson = {
+    .name = "Wanson",
+    .block_size = WANSON_SAMPLES_PER_INFERENCE,
+    .init = wanson_engine_init,
+    .reset = wanson_engine_reset,
+    .process_block = wanson_engine_process_block,
+    .memory_footprint = wanson_engine_memory_footprint,
+};
@@ -7,19 +7,12 @@
 #define IS_WAKEWORD(id)   (id <= 2)
 #define IS_COMMAND(id)    (id > 2)
 
-void wanson_engine_task(void *args);
-
-void wanson_engine_task_create(unsigned priority);
-void wanson_engine_samples_send_local(
-        size_t frame_count,
-        int32_t *processed_audio_frame);
-
-void wanson_engine_intertile_task_create(uint32_t priority);
-void wanson_engine_samples_send_remote(
-        rtos_intertile_t *intertile_ctx,
-        size_t frame_count,
-        int32_t *processed_audio_frame);
+#define WANSON_SAMPLES_PER_INFERENCE    (2 * appconfINFERENCE_SAMPLE_BLOCK_LENGTH)
 
+/*
+ * Handles a keyword recognised by the primary inference engine backend,
+ * whichever it is, as the IDs are the Wanson ones.
+ */
 void wanson_engine_proc_keyword_result(const char **text, int id);
 
 #endif /* WANSON_INF_ENG_H_ */
@@ -139,11 +139,7 @@ int32_t inference_engine_create(uint32_t priority, void *args)
     q_intent = (QueueHandle_t) args;
 
 #if appconfINFERENCE_ENABLED
-#if INFERENCE_TILE_NO == AUDIO_PIPELINE_TILE_NO
-    wanson_engine_task_create(priority);
-#else
-    wanson_engine_intertile_task_create(priority);
-#endif
+    inference_engine_tasks_create(priority);
 #endif
     return 0;
 }
@@ -151,16 +147,7 @@ int32_t inference_engine_create(uint32_t priority, void *args)
 int32_t inference_engine_sample_push(int32_t *buf, size_t frames)
 {
 #if appconfINFERENCE_ENABLED
-#if INFERENCE_TILE_NO == AUDIO_PIPELINE_TILE_NO
-    wanson_engine_samples_send_local(
-            frames,
-            buf);
-#else
-    wanson_engine_samples_send_remote(
-            intertile_ctx,
-            frames,
-            buf);
-#endif
+    inference_engine_samples_send(buf, frames);
 #endif
     return 0;
 }
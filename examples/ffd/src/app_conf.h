@@ -36,6 +36,142 @@
 #define appconfINFERENCE_ENABLED   1
 #endif
 
+/*
+ * Keyword recognition backend acted on, and a second one that may be run
+ * on the same audio for comparison, with its keywords only logged.
+ */
+#define appconfINFERENCE_BACKEND_NONE       0
+#define appconfINFERENCE_BACKEND_WANSON     1
+#define appconfINFERENCE_BACKEND_KWS        2
+#ifndef appconfINFERENCE_BACKEND
+#define appconfINFERENCE_BACKEND            appconfINFERENCE_BACKEND_WANSON
+#endif
+
+#ifndef appconfINFERENCE_BENCHMARK_BACKEND
+#define appconfINFERENCE_BENCHMARK_BACKEND  appconfINFERENCE_BACKEND_NONE
+#endif
+
+/* Largest block of samples any backend may take at once */
+#define appconfINFERENCE_MAX_BLOCK_SIZE     480
+
+/*
+ * TFLite Micro keyword spotting backend. Every appconfKWS_BLOCK_SIZE
+ * samples, a multiple of the 320 sample step of its log mel front end, the
+ * int8 model is run on the features of the most recent slices, at most
+ * appconfKWS_INPUT_MAX_SLICES of 40 features. The model is loaded from
+ * appconfKWS_MODEL_FILE in the filesystem, and must be trained on features
+ * from tools/kws/kws_features.py. appconfKWS_CLASS_IDS gives the keyword ID
+ * reported for each output class, 0 for classes such as silence that are
+ * not keywords, and appconfKWS_CLASS_NAMES its text. A keyword is reported
+ * once its probability, averaged over appconfKWS_AVERAGE_BLOCKS runs,
+ * reaches appconfKWS_THRESHOLD_PERCENT, and not again for
+ * appconfKWS_SUPPRESS_BLOCKS runs.
+ */
+#ifndef appconfKWS_MODEL_FILE
+#define appconfKWS_MODEL_FILE               "kws.tflite"
+#endif
+
+#ifndef appconfKWS_MODEL_MAX_SIZE
+#define appconfKWS_MODEL_MAX_SIZE           (64 * 1024)
+#endif
+
+#ifndef appconfKWS_TENSOR_ARENA_SIZE
+#define appconfKWS_TENSOR_ARENA_SIZE        (64 * 1024)
+#endif
+
+#ifndef appconfKWS_INPUT_MAX_SLICES
+#define appconfKWS_INPUT_MAX_SLICES         49
+#endif
+
+#ifndef appconfKWS_BLOCK_SIZE
+#define appconfKWS_BLOCK_SIZE               320
+#endif
+
+#ifndef appconfKWS_CLASS_IDS
+#define appconfKWS_CLASS_IDS                {0, 0, 1}
+#endif
+
+#ifndef appconfKWS_CLASS_NAMES
+#define appconfKWS_CLASS_NAMES              {"silence", "unknown", "wake word"}
+#endif
+
+#ifndef appconfKWS_AVERAGE_BLOCKS
+#define appconfKWS_AVERAGE_BLOCKS           4
+#endif
+
+#ifndef appconfKWS_THRESHOLD_PERCENT
+#define appconfKWS_THRESHOLD_PERCENT        80
+#endif
+
+#ifndef appconfKWS_SUPPRESS_BLOCKS
+#define appconfKWS_SUPPRESS_BLOCKS          50
+#endif
+
+/*
+ * The model is read through an LRU cache of appconfMODEL_CACHE_PAGE_COUNT
+ * pages of 1 << appconfMODEL_CACHE_PAGE_SIZE_LOG2 bytes. A page count of 0
+ * reads every model access from flash.
+ */
+#ifndef appconfMODEL_CACHE_PAGE_SIZE_LOG2
+#define appconfMODEL_CACHE_PAGE_SIZE_LOG2   10
+#endif
+
+#ifndef appconfMODEL_CACHE_PAGE_COUNT
+#define appconfMODEL_CACHE_PAGE_COUNT       16
+#endif
+
+/*
+ * Read model.bin straight from its place in flash, rather than through
+ * FatFs, when it is stored in one contiguous run of clusters.
+ * appconfMODEL_FS_FLASH_ADDRESS is the flash address of the filesystem,
+ * which must match the boot partition size the filesystem is flashed with.
+ */
+#ifndef appconfMODEL_DIRECT_FLASH_READ
+#define appconfMODEL_DIRECT_FLASH_READ      0
+#endif
+
+#ifndef appconfMODEL_FS_FLASH_ADDRESS
+#define appconfMODEL_FS_FLASH_ADDRESS       0x100000
+#endif
+
+/*
+ * Read the model from the raw model partition written by
+ * tools/model_partition/model_partition_mkimage.py at
+ * appconfMODEL_PARTITION_FLASH_ADDRESS, straight after the 2 MiB filesystem
+ * image, falling back to model.bin in the filesystem if the partition is not
+ * valid. With appconfMODEL_PARTITION_VERIFY_CRC the whole model is checked
+ * against its CRC at startup.
+ */
+#ifndef appconfMODEL_PARTITION_ENABLED
+#define appconfMODEL_PARTITION_ENABLED      0
+#endif
+
+#ifndef appconfMODEL_PARTITION_FLASH_ADDRESS
+#define appconfMODEL_PARTITION_FLASH_ADDRESS    (appconfMODEL_FS_FLASH_ADDRESS + 0x200000)
+#endif
+
+#ifndef appconfMODEL_PARTITION_VERIFY_CRC
+#define appconfMODEL_PARTITION_VERIFY_CRC   1
+#endif
+
+/*
+ * Learn the order the model pages are read in on each inference, and read
+ * the next appconfMODEL_PREFETCH_DEPTH of them into the cache on a separate
+ * task while the current ones are in use. The order of up to
+ * appconfMODEL_PREFETCH_TRACE_LENGTH page changes per inference is kept.
+ */
+#ifndef appconfMODEL_PREFETCH_ENABLED
+#define appconfMODEL_PREFETCH_ENABLED       0
+#endif
+
+#ifndef appconfMODEL_PREFETCH_DEPTH
+#define appconfMODEL_PREFETCH_DEPTH         4
+#endif
+
+#ifndef appconfMODEL_PREFETCH_TRACE_LENGTH
+#define appconfMODEL_PREFETCH_TRACE_LENGTH  4096
+#endif
+
 /* Maximum delay between a wake up phrase and command phrase */
 #ifndef appconfINFERENCE_RESET_DELAY_MS
 #define appconfINFERENCE_RESET_DELAY_MS         3000
@@ -4,4 +4,32 @@
 #ifndef APP_CONF_CHECK_H_
 #define APP_CONF_CHECK_H_
 
+#if appconfINFERENCE_BACKEND != appconfINFERENCE_BACKEND_WANSON && appconfINFERENCE_BACKEND != appconfINFERENCE_BACKEND_KWS
+#error appconfINFERENCE_BACKEND must be appconfINFERENCE_BACKEND_WANSON or appconfINFERENCE_BACKEND_KWS
+#endif
+
+#if appconfINFERENCE_BENCHMARK_BACKEND == appconfINFERENCE_BACKEND
+#error appconfINFERENCE_BENCHMARK_BACKEND must differ from appconfINFERENCE_BACKEND
+#endif
+
+#if appconfKWS_BLOCK_SIZE > appconfINFERENCE_MAX_BLOCK_SIZE
+#error appconfKWS_BLOCK_SIZE must not exceed appconfINFERENCE_MAX_BLOCK_SIZE
+#endif
+
+#if appconfMODEL_PREFETCH_ENABLED && appconfMODEL_CACHE_PAGE_COUNT == 0
+#error appconfMODEL_PREFETCH_ENABLED requires the model cache
+#endif
+
+#if appconfMODEL_PREFETCH_ENABLED && !(appconfMODEL_DIRECT_FLASH_READ || appconfMODEL_PARTITION_ENABLED)
+#error appconfMODEL_PREFETCH_ENABLED requires appconfMODEL_DIRECT_FLASH_READ or appconfMODEL_PARTITION_ENABLED
+#endif
+
+#if appconfMODEL_PARTITION_ENABLED && (appconfMODEL_PARTITION_FLASH_ADDRESS & 0xFFF) != 0
+#error appconfMODEL_PARTITION_FLASH_ADDRESS must be aligned to a 4 KiB flash sector
+#endif
+
+#if appconfMODEL_PREFETCH_ENABLED && appconfMODEL_PREFETCH_DEPTH >= appconfMODEL_CACHE_PAGE_COUNT
+#error appconfMODEL_PREFETCH_DEPTH must be less than appconfMODEL_CACHE_PAGE_COUNT
+#endif
+
 #endif /* APP_CONF_CHECK_H_ */
@@ -14,6 +14,8 @@
 
 /* Library headers */
 #include "generic_pipeline.h"
+#include "pipeline_profiler.h"
+#include "frame_pool.h"
 #include "agc_api.h"
 #include "ic_api.h"
 #include "ns_api.h"
@@ -31,8 +33,40 @@ typedef struct {
     int32_t samples[appconfAUDIO_PIPELINE_CHANNELS][appconfAUDIO_PIPELINE_FRAME_ADVANCE];
     int32_t mic_samples_passthrough[appconfAUDIO_PIPELINE_CHANNELS][appconfAUDIO_PIPELINE_FRAME_ADVANCE];
     int32_t vnr_pred_flag;
+
+    /* Selects, per channel, whether the current samples are in samples or samples_alt */
+    int32_t sample_plane[appconfAUDIO_PIPELINE_CHANNELS];
+
+    /* Stages write their output here, or back into samples, instead of copying it */
+    int32_t DWORD_ALIGNED samples_alt[appconfAUDIO_PIPELINE_CHANNELS][appconfAUDIO_PIPELINE_FRAME_ADVANCE];
 } frame_data_t;
 
+static inline int32_t *frame_samples_in(frame_data_t *frame_data, int ch)
+{
+    return frame_data->sample_plane[ch] ? frame_data->samples_alt[ch] : frame_data->samples[ch];
+}
+
+static inline int32_t *frame_samples_out(frame_data_t *frame_data, int ch)
+{
+    return frame_data->sample_plane[ch] ? frame_data->samples[ch] : frame_data->samples_alt[ch];
+}
+
+static inline void frame_samples_swap(frame_data_t *frame_data, int ch)
+{
+    frame_data->sample_plane[ch] ^= 1;
+}
+
+/* The output expects every channel back in samples, ahead of the passthrough mics */
+static inline void frame_samples_resolve(frame_data_t *frame_data)
+{
+    for (int ch = 0; ch < appconfAUDIO_PIPELINE_CHANNELS; ch++) {
+        if (frame_data->sample_plane[ch]) {
+            memcpy(frame_data->samples[ch], frame_data->samples_alt[ch], sizeof(frame_data->samples[ch]));
+            frame_data->sample_plane[ch] = 0;
+        }
+    }
+}
+
 #if appconfAUDIO_PIPELINE_FRAME_ADVANCE != 240
 #error This pipeline is only configured for 240 frame advance
 #endif
@@ -61,11 +95,19 @@ static vnr_pred_stage_ctx_t DWORD_ALIGNED vnr_pred_stage_state = {};
 static ns_stage_ctx_t DWORD_ALIGNED ns_stage_state = {};
 static agc_stage_ctx_t DWORD_ALIGNED agc_stage_state = {};
 
+#define AUDIO_PIPELINE_STAGE_COUNT      4
+
+/* One frame in each stage task plus a full queue between each pair of stages */
+#define AUDIO_PIPELINE_FRAME_POOL_SIZE  FRAME_POOL_PIPELINE_FRAMES(AUDIO_PIPELINE_STAGE_COUNT)
+
+FRAME_POOL_STORAGE(audio_pipeline_frames, frame_data_t, AUDIO_PIPELINE_FRAME_POOL_SIZE);
+static frame_pool_t frame_pool;
+
 static void *audio_pipeline_input_i(void *input_app_data)
 {
     frame_data_t *frame_data;
 
-    frame_data = pvPortMalloc(sizeof(frame_data_t));
+    frame_data = frame_pool_acquire(&frame_pool);
 
 // rtos_printf("frame\n");
     audio_pipeline_input(input_app_data,
@@ -73,6 +115,7 @@ static void *audio_pipeline_input_i(void *input_app_data)
                        2,
                        appconfAUDIO_PIPELINE_FRAME_ADVANCE);
     frame_data->vnr_pred_flag = 0;
+    memset(frame_data->sample_plane, 0x00, sizeof(frame_data->sample_plane));
 
     memcpy(frame_data->mic_samples_passthrough, frame_data->samples, sizeof(frame_data->mic_samples_passthrough));
 
@@ -82,10 +125,17 @@ static void *audio_pipeline_input_i(void *input_app_data)
 static int audio_pipeline_output_i(frame_data_t *frame_data,
                                    void *output_app_data)
 {
-    return audio_pipeline_output(output_app_data,
-                               (int32_t **)frame_data->samples,
-                               4,
-                               appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+    frame_samples_resolve(frame_data);
+
+    int ret = audio_pipeline_output(output_app_data,
+                                    (int32_t **)frame_data->samples,
+                                    4,
+                                    appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+
+    if (ret == AUDIO_PIPELINE_FREE_FRAME) {
+        frame_pool_release(&frame_pool, frame_data);
+    }
+    return AUDIO_PIPELINE_DONT_FREE_FRAME;
 }
 
 static void stage_vnr_and_ic_0(frame_data_t *frame_data)
@@ -98,19 +148,10 @@ static void stage_vnr_and_ic_1(frame_data_t *frame_data)
 #if appconfAUDIO_PIPELINE_SKIP_IC_AND_VNR
     (void) frame_data;
 #else
-    int32_t DWORD_ALIGNED ic_output[appconfAUDIO_PIPELINE_FRAME_ADVANCE];
-
-
-// uint32_t start = get_reference_time();
-
-    // uint32_t end = get_reference_time();
-
-    // rtos_printf("times diff:%d start:%d end:%d\n", end-start, start, end);
-
     ic_filter(&ic_stage_state.state,
-              frame_data->samples[0],
-              frame_data->samples[1],
-              ic_output);
+              frame_samples_in(frame_data, 0),
+              frame_samples_in(frame_data, 1),
+              frame_samples_out(frame_data, 0));
 
     // VNR
     bfp_s32_t feature_patch;
@@ -138,12 +179,7 @@ static void stage_vnr_and_ic_1(frame_data_t *frame_data)
 
     ic_adapt(&ic_stage_state.state, vnr_pred_stage_state.vnr_pred_state.input_vnr_pred);
 
-    memcpy(frame_data->samples, ic_output, appconfAUDIO_PIPELINE_FRAME_ADVANCE * sizeof(int32_t));
-
-    // uint32_t end = get_reference_time();
-
-    // rtos_printf("times diff:%d start:%d end:%d\n", end-start, start, end);
-
+    frame_samples_swap(frame_data, 0);
 #endif
 }
 
@@ -152,13 +188,12 @@ static void stage_ns(frame_data_t *frame_data)
 #if appconfAUDIO_PIPELINE_SKIP_NS
     (void) frame_data;
 #else
-    int32_t DWORD_ALIGNED ns_output[appconfAUDIO_PIPELINE_FRAME_ADVANCE];
     configASSERT(NS_FRAME_ADVANCE == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
     ns_process_frame(
                 &ns_stage_state.state,
-                ns_output,
-                frame_data->samples[0]);
-    memcpy(frame_data->samples, ns_output, appconfAUDIO_PIPELINE_FRAME_ADVANCE * sizeof(int32_t));
+                frame_samples_out(frame_data, 0),
+                frame_samples_in(frame_data, 0));
+    frame_samples_swap(frame_data, 0);
 #endif
 }
 
@@ -167,20 +202,26 @@ static void stage_agc(frame_data_t *frame_data)
 #if appconfAUDIO_PIPELINE_SKIP_AGC
     (void) frame_data;
 #else
-    int32_t DWORD_ALIGNED agc_output[appconfAUDIO_PIPELINE_FRAME_ADVANCE];
     configASSERT(AGC_FRAME_ADVANCE == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
 
     agc_stage_state.md.vnr_flag = frame_data->vnr_pred_flag;
 
     agc_process_frame(
             &agc_stage_state.state,
-            agc_output,
-            frame_data->samples[0],
+            frame_samples_out(frame_data, 0),
+            frame_samples_in(frame_data, 0),
             &agc_stage_state.md);
-    memcpy(frame_data->samples, agc_output, appconfAUDIO_PIPELINE_FRAME_ADVANCE * sizeof(int32_t));
+    frame_samples_swap(frame_data, 0);
 #endif
 }
 
+PIPELINE_PROFILER_DEFINE_INPUT(audio_pipeline_input_i)
+PIPELINE_PROFILER_DEFINE_OUTPUT(audio_pipeline_output_i)
+PIPELINE_PROFILER_DEFINE_STAGE(stage_vnr_and_ic_0)
+PIPELINE_PROFILER_DEFINE_STAGE(stage_vnr_and_ic_1)
+PIPELINE_PROFILER_DEFINE_STAGE(stage_ns)
+PIPELINE_PROFILER_DEFINE_STAGE(stage_agc)
+
 static void initialize_pipeline_stages(void) {
     ic_init(&ic_stage_state.state);
 
@@ -203,26 +244,34 @@ void audio_pipeline_init(
     void *input_app_data,
     void *output_app_data)
 {
-    const int stage_count = 4;
+    const int stage_count = AUDIO_PIPELINE_STAGE_COUNT;
 
     const pipeline_stage_t stages[] = {
-        (pipeline_stage_t)stage_vnr_and_ic_0,
-        (pipeline_stage_t)stage_vnr_and_ic_1,
-        (pipeline_stage_t)stage_ns,
-        (pipeline_stage_t)stage_agc,
+        (pipeline_stage_t)PIPELINE_PROFILED(stage_vnr_and_ic_0),
+        (pipeline_stage_t)PIPELINE_PROFILED(stage_vnr_and_ic_1),
+        (pipeline_stage_t)PIPELINE_PROFILED(stage_ns),
+        (pipeline_stage_t)PIPELINE_PROFILED(stage_agc),
     };
 
     const configSTACK_DEPTH_TYPE stage_stack_sizes[] = {
-        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_vnr_and_ic_0) + RTOS_THREAD_STACK_SIZE(audio_pipeline_input_i),
-        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_vnr_and_ic_1),
-        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_ns),
-        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_agc) + RTOS_THREAD_STACK_SIZE(audio_pipeline_output_i),
+        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_vnr_and_ic_0) + RTOS_THREAD_STACK_SIZE(audio_pipeline_input_i) + PIPELINE_PROFILER_STACK_SIZE,
+        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_vnr_and_ic_1) + PIPELINE_PROFILER_STACK_SIZE,
+        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_ns) + PIPELINE_PROFILER_STACK_SIZE,
+        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_agc) + RTOS_THREAD_STACK_SIZE(audio_pipeline_output_i) + PIPELINE_PROFILER_STACK_SIZE,
     };
 
     initialize_pipeline_stages();
+    FRAME_POOL_INIT(&frame_pool, audio_pipeline_frames, frame_data_t, AUDIO_PIPELINE_FRAME_POOL_SIZE);
+
+    PIPELINE_PROFILER_REGISTER(audio_pipeline_input_i);
+    PIPELINE_PROFILER_REGISTER(stage_vnr_and_ic_0);
+    PIPELINE_PROFILER_REGISTER(stage_vnr_and_ic_1);
+    PIPELINE_PROFILER_REGISTER(stage_ns);
+    PIPELINE_PROFILER_REGISTER(stage_agc);
+    PIPELINE_PROFILER_REGISTER(audio_pipeline_output_i);
 
-    generic_pipeline_init((pipeline_input_t)audio_pipeline_input_i,
-                        (pipeline_output_t)audio_pipeline_output_i,
+    generic_pipeline_init((pipeline_input_t)PIPELINE_PROFILED(audio_pipeline_input_i),
+                        (pipeline_output_t)PIPELINE_PROFILED(audio_pipeline_output_i),
                         input_app_data,
                         output_app_data,
                         stages,
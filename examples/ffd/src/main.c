@@ -21,6 +21,8 @@
 #include "platform/platform_init.h"
 #include "platform/driver_instances.h"
 #include "audio_pipeline/audio_pipeline.h"
+#include "pipeline_profiler.h"
+#include "frame_pool.h"
 #include "inference_engine.h"
 #include "fs_support.h"
 #include "gpio_ctrl/gpi_ctrl.h"
@@ -158,6 +160,21 @@ void startup_task(void *arg)
     rtos_printf("tile[%d] clock rate %d\n", THIS_XCORE_TILE, get_local_tile_processor_clock());
 #endif
 
+#if PIPELINE_PROFILER_ENABLED
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(5000));
+        rtos_printf("Tile[%d]:\n", THIS_XCORE_TILE);
+#if ON_TILE(AUDIO_PIPELINE_TILE_NO)
+        frame_pool_report();
+        pipeline_profiler_report();
+#endif
+#if appconfINFERENCE_ENABLED && ON_TILE(INFERENCE_TILE_NO)
+        inference_engine_report();
+        model_data_report();
+#endif
+    }
+#endif
+
     vTaskSuspend(NULL);
     while(1){;} /* Trap */
 }
@@ -0,0 +1,29 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef MODEL_PARTITION_H_
+#define MODEL_PARTITION_H_
+
+#include <stdint.h>
+
+/*
+ * Layout of the raw model partition written by
+ * tools/model_partition/model_partition_mkimage.py. The header is at the
+ * start of the partition, and the model data follows it at data_offset,
+ * which is a multiple of the flash sector size. Both CRCs are the CRC-32
+ * used by zlib, and all fields are little endian.
+ */
+#define MODEL_PARTITION_MAGIC       0x4C444F4D  /* "MODL" */
+#define MODEL_PARTITION_VERSION     1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;           /* Of this layout */
+    uint32_t data_offset;       /* From the start of the partition */
+    uint32_t data_size;
+    uint32_t data_crc;
+    uint32_t model_version;     /* As given to the tool, only reported */
+    uint32_t header_crc;        /* Of the fields above */
+} model_partition_header_t;
+
+#endif /* MODEL_PARTITION_H_ */
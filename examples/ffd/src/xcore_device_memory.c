@@ -1,34 +1,404 @@
 // Copyright 2021-2022 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
+/* STD headers */
+#include <stddef.h>
+#include <stdint.h>
+
 /* System headers */
 #include <xcore/assert.h>
+#include <xcore/hwtimer.h>
+
+/* FreeRTOS headers */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Library headers */
+#include "rtos_printf.h"
 
 /* App headers */
+#include "app_conf.h"
+#include "platform/driver_instances.h"
 #include "ff.h"
+#include "model_partition.h"
+#include "page_cache.h"
+#include "page_trace.h"
 #include "xcore_device_memory.h"
 
+/* Whether the model may be read with rtos_qspi_flash_read() */
+#define MODEL_FLASH_READ    (appconfMODEL_DIRECT_FLASH_READ || appconfMODEL_PARTITION_ENABLED)
+
 static FIL model_file;
 
-size_t model_file_init() 
+#if MODEL_FLASH_READ
+/* Flash address of the start of the model data, or 0 to read model.bin through FatFs */
+static unsigned model_flash_address;
+#endif
+
+/*
+ * Time spent by the inference task waiting on the backing store, and
+ * running inferences, in reference timer ticks.
+ */
+static uint64_t model_read_ticks;
+static uint64_t inference_ticks;
+static uint32_t inference_start;
+
+#if appconfMODEL_CACHE_PAGE_COUNT > 0
+PAGE_CACHE_STORAGE(model_cache, appconfMODEL_CACHE_PAGE_SIZE_LOG2, appconfMODEL_CACHE_PAGE_COUNT);
+static page_cache_t model_cache;
+#endif
+
+#if appconfMODEL_PREFETCH_ENABLED
+static page_trace_t model_trace;
+static uint16_t model_trace_pages[appconfMODEL_PREFETCH_TRACE_LENGTH];
+
+/*
+ * Held around every use of the cache and trace once the prefetch task has
+ * been started, as that task fills the cache alongside the inference task.
+ */
+static SemaphoreHandle_t model_lock;
+
+/* Pages for the prefetch task to read */
+static QueueHandle_t model_prefetch_queue;
+
+#define MODEL_LOCK()    do { if (model_lock != NULL) xSemaphoreTake(model_lock, portMAX_DELAY); } while (0)
+#define MODEL_UNLOCK()  do { if (model_lock != NULL) xSemaphoreGive(model_lock); } while (0)
+#else
+#define MODEL_LOCK()
+#define MODEL_UNLOCK()
+#endif
+
+#if appconfMODEL_DIRECT_FLASH_READ
+/*
+ * Returns the flash address of the start of the open model file, or 0 if
+ * its clusters are not contiguous. Seeking to each cluster in turn follows
+ * the FAT chain just once, since each seek continues from the last.
+ */
+static unsigned model_file_flash_address(void)
+{
+    FATFS *fs = model_file.obj.fs;
+    const DWORD first = model_file.obj.sclust;
+#if FF_MAX_SS == FF_MIN_SS
+    const size_t sector_size = FF_MAX_SS;
+#else
+    const size_t sector_size = fs->ssize;
+#endif
+    const size_t cluster_size = fs->csize * sector_size;
+    const FSIZE_t size = f_size(&model_file);
+    DWORD cluster = first;
+
+    if (first < 2) {
+        return 0;
+    }
+
+    for (FSIZE_t ofs = cluster_size; ofs < size; ofs += cluster_size) {
+        if (f_lseek(&model_file, ofs + 1) != FR_OK || model_file.clust != ++cluster) {
+            return 0;
+        }
+    }
+
+    return appconfMODEL_FS_FLASH_ADDRESS + (fs->database + (DWORD) fs->csize * (first - 2)) * sector_size;
+}
+#endif
+
+#if appconfMODEL_PARTITION_ENABLED
+/* Updates the zlib CRC-32 crc with size bytes of data, a nibble at a time */
+static uint32_t model_crc32(uint32_t crc, const void *data, size_t size)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    const uint8_t *p = data;
+
+    crc = ~crc;
+    while (size--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ table[crc & 0xF];
+        crc = (crc >> 4) ^ table[crc & 0xF];
+    }
+    return ~crc;
+}
+
+/*
+ * Returns the size of the model in the raw model partition, and sets
+ * model_flash_address to the start of its data, or returns 0 if the
+ * partition does not hold a valid model.
+ */
+static size_t model_partition_open(void)
+{
+    model_partition_header_t header;
+
+    rtos_qspi_flash_read(qspi_flash_ctx, (uint8_t *) &header, appconfMODEL_PARTITION_FLASH_ADDRESS, sizeof(header));
+
+    if (header.magic != MODEL_PARTITION_MAGIC ||
+        header.version != MODEL_PARTITION_VERSION ||
+        header.header_crc != model_crc32(0, &header, offsetof(model_partition_header_t, header_crc))) {
+        return 0;
+    }
+    if (header.data_offset < sizeof(header) || header.data_size == 0) {
+        return 0;
+    }
+
+#if appconfMODEL_PARTITION_VERIFY_CRC
+    {
+        static uint8_t chunk[512];
+        uint32_t crc = 0;
+
+        for (size_t ofs = 0; ofs < header.data_size; ofs += sizeof(chunk)) {
+            const size_t n = header.data_size - ofs < sizeof(chunk) ? header.data_size - ofs : sizeof(chunk);
+
+            rtos_qspi_flash_read(qspi_flash_ctx, chunk, appconfMODEL_PARTITION_FLASH_ADDRESS + header.data_offset + ofs, n);
+            crc = model_crc32(crc, chunk, n);
+        }
+        if (crc != header.data_crc) {
+            rtos_printf("model partition CRC mismatch\n");
+            return 0;
+        }
+    }
+#endif
+
+    model_flash_address = appconfMODEL_PARTITION_FLASH_ADDRESS + header.data_offset;
+    rtos_printf("model partition version %u, %u bytes\n", header.model_version, header.data_size);
+
+    return header.data_size;
+}
+#endif
+
+static size_t model_backing_read(void *read_ctx, void *dest, size_t offset, size_t size)
+{
+    (void) read_ctx;
+    size_t bytes_read = 0;
+    const uint32_t start = get_reference_time();
+
+#if MODEL_FLASH_READ
+    if (model_flash_address != 0) {
+        rtos_qspi_flash_read(qspi_flash_ctx, dest, model_flash_address + offset, size);
+        bytes_read = size;
+    } else
+#endif
+    {
+        UINT bytes_read_fs = 0;
+
+        if (f_lseek(&model_file, (FSIZE_t) offset) == FR_OK) {
+            f_read(&model_file, dest, size, &bytes_read_fs);
+        }
+        bytes_read = bytes_read_fs;
+    }
+
+    model_read_ticks += get_reference_time() - start;
+
+    return bytes_read;
+}
+
+#if appconfMODEL_PREFETCH_ENABLED
+/*
+ * Reads each page it is sent straight from flash into the cache, unless it
+ * is there already. The cache is only locked while it is looked at and
+ * filled, so the inference task keeps running during the flash read.
+ */
+static void model_prefetch_task(void *arg)
+{
+    (void) arg;
+    static uint8_t page_data[1 << appconfMODEL_CACHE_PAGE_SIZE_LOG2];
+
+    for (;;) {
+        uint32_t page;
+        int cached;
+
+        xQueueReceive(model_prefetch_queue, &page, portMAX_DELAY);
+
+        xSemaphoreTake(model_lock, portMAX_DELAY);
+        cached = page_cache_contains(&model_cache, page);
+        xSemaphoreGive(model_lock);
+
+        if (!cached) {
+            const size_t offset = (size_t) page << appconfMODEL_CACHE_PAGE_SIZE_LOG2;
+            size_t size = sizeof(page_data);
+            uint32_t start;
+
+            if (size > model_cache.backing_size - offset) {
+                size = model_cache.backing_size - offset;
+            }
+
+            start = get_reference_time();
+            rtos_qspi_flash_read(qspi_flash_ctx, page_data, model_flash_address + offset, size);
+
+            xSemaphoreTake(model_lock, portMAX_DELAY);
+            page_cache_insert(&model_cache, page, page_data, get_reference_time() - start);
+            xSemaphoreGive(model_lock);
+        }
+    }
+}
+
+/* Sends the prefetch task the pages due to be read next. Called locked. */
+static void model_prefetch_issue(void)
 {
-    FRESULT result;
-    
-    result = f_open(&model_file, "model.bin", FA_READ);
-    if (result == FR_OK) {
-        return f_size(&model_file);
+    uint32_t pages[appconfMODEL_PREFETCH_DEPTH];
+    size_t count;
+
+    if (model_prefetch_queue == NULL) {
+        return;
+    }
+
+    count = page_trace_prefetch(&model_trace, pages, appconfMODEL_PREFETCH_DEPTH);
+    for (size_t i = 0; i < count; i++) {
+        /* A page that does not fit is left to be read on demand */
+        (void) xQueueSend(model_prefetch_queue, &pages[i], 0);
+    }
+}
+
+static void model_prefetch_start(void)
+{
+    page_trace_init(&model_trace, model_trace_pages, appconfMODEL_PREFETCH_TRACE_LENGTH);
+
+    if (model_flash_address == 0) {
+        rtos_printf("model prefetch needs the model to be read directly from flash\n");
+        return;
+    }
+
+    model_lock = xSemaphoreCreateMutex();
+    model_prefetch_queue = xQueueCreate(2 * appconfMODEL_PREFETCH_DEPTH, sizeof(uint32_t));
+
+    xTaskCreate((TaskFunction_t) model_prefetch_task,
+                "model_prefetch",
+                RTOS_THREAD_STACK_SIZE(model_prefetch_task),
+                NULL,
+                uxTaskPriorityGet(NULL),
+                NULL);
+}
+#endif
+
+size_t model_file_init()
+{
+    size_t size = 0;
+
+#if appconfMODEL_PARTITION_ENABLED
+    size = model_partition_open();
+    if (size == 0) {
+        rtos_printf("no valid model partition, reading model.bin from the filesystem\n");
+    }
+#endif
+
+    if (size == 0) {
+        FRESULT result;
+
+        result = f_open(&model_file, "model.bin", FA_READ);
+        if (result != FR_OK) {
+            return 0;
+        }
+        size = f_size(&model_file);
+
+#if appconfMODEL_DIRECT_FLASH_READ
+        model_flash_address = model_file_flash_address();
+        if (model_flash_address == 0) {
+            rtos_printf("model.bin is fragmented, reading it through the filesystem\n");
+        }
+#endif
     }
-    return 0;
+
+#if appconfMODEL_CACHE_PAGE_COUNT > 0
+    PAGE_CACHE_INIT(&model_cache, model_cache, appconfMODEL_CACHE_PAGE_SIZE_LOG2, appconfMODEL_CACHE_PAGE_COUNT,
+                    size, model_backing_read, NULL);
+#endif
+
+#if appconfMODEL_PREFETCH_ENABLED
+    model_prefetch_start();
+#endif
+
+    return size;
 }
 
 size_t model_data_load(void *dest, const void *src, size_t size)
 {
     xassert(IS_SWMEM(src));
-    
+
+    const size_t offset = (uintptr_t) src - (uintptr_t) XS1_SWMEM_BASE;
+
+#if appconfMODEL_PREFETCH_ENABLED
     size_t bytes_read;
 
-    f_lseek(&model_file, (FSIZE_t)src - (FSIZE_t)XS1_SWMEM_BASE);
-    f_read(&model_file, dest, size, &bytes_read);
-    
+    MODEL_LOCK();
+    for (size_t ofs = offset; ofs < offset + size; ofs = (ofs | ((1 << appconfMODEL_CACHE_PAGE_SIZE_LOG2) - 1)) + 1) {
+        page_trace_access(&model_trace, ofs >> appconfMODEL_CACHE_PAGE_SIZE_LOG2);
+    }
+    bytes_read = page_cache_read(&model_cache, dest, offset, size);
+    model_prefetch_issue();
+    MODEL_UNLOCK();
+
     return bytes_read;
+#elif appconfMODEL_CACHE_PAGE_COUNT > 0
+    return page_cache_read(&model_cache, dest, offset, size);
+#else
+    return model_backing_read(NULL, dest, offset, size);
+#endif
+}
+
+void model_data_inference_start(void)
+{
+#if appconfMODEL_PREFETCH_ENABLED
+    MODEL_LOCK();
+    page_trace_start(&model_trace);
+    model_prefetch_issue();
+    MODEL_UNLOCK();
+#endif
+    inference_start = get_reference_time();
+}
+
+void model_data_inference_end(void)
+{
+    inference_ticks += get_reference_time() - inference_start;
+#if appconfMODEL_PREFETCH_ENABLED
+    MODEL_LOCK();
+    page_trace_end(&model_trace);
+    MODEL_UNLOCK();
+#endif
+}
+
+size_t model_data_ram_size(void)
+{
+    size_t size = sizeof(model_file);
+
+#if appconfMODEL_CACHE_PAGE_COUNT > 0
+    size += sizeof(model_cache) + sizeof(model_cache_storage) + sizeof(model_cache_entries);
+#endif
+#if appconfMODEL_PREFETCH_ENABLED
+    size += sizeof(model_trace) + sizeof(model_trace_pages);
+#endif
+    return size;
+}
+
+void model_data_report(void)
+{
+#if appconfMODEL_CACHE_PAGE_COUNT > 0
+    page_cache_stats_t stats;
+    uint32_t lookups;
+
+    MODEL_LOCK();
+    page_cache_stats_get(&model_cache, &stats, 1);
+    MODEL_UNLOCK();
+    lookups = stats.hits + stats.misses;
+
+    rtos_printf("model cache: %u hits, %u misses (%u%% hit), %u bypasses, %u read errors\n",
+                stats.hits, stats.misses, lookups ? (unsigned) (100ull * stats.hits / lookups) : 0,
+                stats.bypasses, stats.read_errors);
+#endif
+#if appconfMODEL_PREFETCH_ENABLED
+    page_trace_stats_t trace_stats;
+
+    MODEL_LOCK();
+    page_trace_stats_get(&model_trace, &trace_stats, 1);
+    MODEL_UNLOCK();
+
+    rtos_printf("model prefetch: %u pages, %u used, %u wasted, %u ms of flash reads hidden; trace %u followed, %u mispredicted, learnt %u times\n",
+                stats.prefetches, stats.prefetch_hits, stats.prefetch_wasted,
+                (unsigned) (stats.prefetch_saved / 100000),
+                trace_stats.followed, trace_stats.mispredicted, trace_stats.learnt);
+#endif
+    rtos_printf("model flash reads on demand: %u ms, inference: %u ms\n",
+                (unsigned) (model_read_ticks / 100000), (unsigned) (inference_ticks / 100000));
+    model_read_ticks = 0;
+    inference_ticks = 0;
 }
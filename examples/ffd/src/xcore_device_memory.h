@@ -29,4 +29,23 @@ size_t model_file_init();
  */
 size_t model_data_load(void *dest, const void *src, size_t size);
 
+/**
+ * Mark the start and end of an inference, which is timed and, with
+ * appconfMODEL_PREFETCH_ENABLED, is the span over which the order of the
+ * model reads is learnt and followed.
+ */
+void model_data_inference_start(void);
+void model_data_inference_end(void);
+
+/**
+ * Returns the RAM used to read the model, for its cache and prefetching.
+ */
+size_t model_data_ram_size(void);
+
+/**
+ * Print the model cache and prefetch statistics, and the time spent reading
+ * the model from flash and running inferences, since the last report.
+ */
+void model_data_report(void);
+
 #endif  // XCORE_DEVICE_MEMORY_H_
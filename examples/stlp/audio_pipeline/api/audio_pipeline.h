@@ -26,4 +26,21 @@ int audio_pipeline_output(
         size_t ch_count,
         size_t frame_count);
 
+/*
+ * Selects the main and shadow AEC filter lengths, in phases of
+ * appconfAUDIO_PIPELINE_FRAME_ADVANCE samples. The change takes effect at the
+ * next frame and resets the AEC filters. Returns 0 on success, or -1 if the
+ * filters exceed the memory sized by AEC_MAX_MAIN_FILTER_PHASES and
+ * AEC_MAX_SHADOW_FILTER_PHASES. Only available on the tile running the AEC,
+ * and only to the application, as it is not exposed over device control.
+ */
+int audio_pipeline_aec_phases_set(int main_phases, int shadow_phases);
+
+/*
+ * Prints the AEC processing time per frame and per filter phase, which is
+ * only measured when the pipeline profiler is enabled. Only available on the
+ * tile running the AEC.
+ */
+void audio_pipeline_aec_cost_report(void);
+
 #endif /* AUDIO_PIPELINE_H_ */
@@ -5,7 +5,7 @@ target_sources(sln_voice_app_stlp_audio_pipeline_adec_aec_2x_2y_no_comms
     INTERFACE
         ${CMAKE_CURRENT_LIST_DIR}/src/adec/audio_pipeline_t0.c
         ${CMAKE_CURRENT_LIST_DIR}/src/adec/audio_pipeline_t1.c
-        ${CMAKE_CURRENT_LIST_DIR}/src/adec/stage1/delay_buffer.c
+        ${CMAKE_CURRENT_LIST_DIR}/src/common/delay_buffer.c
         ${CMAKE_CURRENT_LIST_DIR}/src/adec/stage1/stage_1.c
         ${CMAKE_CURRENT_LIST_DIR}/src/adec/aec/aec_process_frame_1thread.c
 )
@@ -15,12 +15,17 @@ target_include_directories(sln_voice_app_stlp_audio_pipeline_adec_aec_2x_2y_no_c
         ${CMAKE_CURRENT_LIST_DIR}/src/adec
         ${CMAKE_CURRENT_LIST_DIR}/src/adec/aec
         ${CMAKE_CURRENT_LIST_DIR}/src/adec/stage1
+        ${CMAKE_CURRENT_LIST_DIR}/src/common
 )
 target_link_libraries(sln_voice_app_stlp_audio_pipeline_adec_aec_2x_2y_no_comms
     INTERFACE
         core::general
         rtos::freertos
         rtos::sw_services::generic_pipeline
+        sln_voice::pipeline_profiler
+        sln_voice::frame_pool
+        sln_voice::frame_codec
+        sln_voice::latency_probe
         fwk_voice::adec
         fwk_voice::aec
         fwk_voice::agc
@@ -35,6 +40,51 @@ add_library(sln_voice::app::stlp::ap::adec ALIAS sln_voice_app_stlp_audio_pipeli
 
 
 
+## Create custom stlp audiopipeline with the AEC split across 2 threads
+add_library(sln_voice_app_stlp_audio_pipeline_adec_aec_2x_2y_no_comms_2threads INTERFACE)
+target_sources(sln_voice_app_stlp_audio_pipeline_adec_aec_2x_2y_no_comms_2threads
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/src/adec/audio_pipeline_t0.c
+        ${CMAKE_CURRENT_LIST_DIR}/src/adec/audio_pipeline_t1.c
+        ${CMAKE_CURRENT_LIST_DIR}/src/common/delay_buffer.c
+        ${CMAKE_CURRENT_LIST_DIR}/src/adec/stage1/stage_1.c
+        ${CMAKE_CURRENT_LIST_DIR}/src/adec/aec/aec_process_frame_2threads.c
+)
+target_include_directories(sln_voice_app_stlp_audio_pipeline_adec_aec_2x_2y_no_comms_2threads
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/api
+        ${CMAKE_CURRENT_LIST_DIR}/src/adec
+        ${CMAKE_CURRENT_LIST_DIR}/src/adec/aec
+        ${CMAKE_CURRENT_LIST_DIR}/src/adec/stage1
+        ${CMAKE_CURRENT_LIST_DIR}/src/common
+)
+target_compile_definitions(sln_voice_app_stlp_audio_pipeline_adec_aec_2x_2y_no_comms_2threads
+    INTERFACE
+        NUM_AEC_THREADS=2
+)
+target_link_libraries(sln_voice_app_stlp_audio_pipeline_adec_aec_2x_2y_no_comms_2threads
+    INTERFACE
+        core::general
+        rtos::freertos
+        rtos::sw_services::generic_pipeline
+        sln_voice::pipeline_profiler
+        sln_voice::frame_pool
+        sln_voice::frame_codec
+        sln_voice::latency_probe
+        fwk_voice::adec
+        fwk_voice::aec
+        fwk_voice::agc
+        fwk_voice::ic
+        fwk_voice::ns
+        fwk_voice::vnr::features
+        fwk_voice::vnr::inference
+)
+
+## Create an alias
+add_library(sln_voice::app::stlp::ap::adec_2threads ALIAS sln_voice_app_stlp_audio_pipeline_adec_aec_2x_2y_no_comms_2threads)
+
+
+
 
 ## Create custom stlp audiopipeline
 add_library(sln_voice_app_stlp_audio_pipeline_adec_aec_2x_2y_no_comms_altarch INTERFACE)
@@ -42,7 +92,7 @@ target_sources(sln_voice_app_stlp_audio_pipeline_adec_aec_2x_2y_no_comms_altarch
     INTERFACE
         ${CMAKE_CURRENT_LIST_DIR}/src/adec_alt_arch/audio_pipeline_t0.c
         ${CMAKE_CURRENT_LIST_DIR}/src/adec_alt_arch/audio_pipeline_t1.c
-        ${CMAKE_CURRENT_LIST_DIR}/src/adec_alt_arch/stage1/delay_buffer.c
+        ${CMAKE_CURRENT_LIST_DIR}/src/common/delay_buffer.c
         ${CMAKE_CURRENT_LIST_DIR}/src/adec_alt_arch/stage1/stage_1.c
         ${CMAKE_CURRENT_LIST_DIR}/src/adec_alt_arch/aec/aec_process_frame_1thread.c
 )
@@ -52,12 +102,17 @@ target_include_directories(sln_voice_app_stlp_audio_pipeline_adec_aec_2x_2y_no_c
         ${CMAKE_CURRENT_LIST_DIR}/src/adec_alt_arch
         ${CMAKE_CURRENT_LIST_DIR}/src/adec_alt_arch/aec
         ${CMAKE_CURRENT_LIST_DIR}/src/adec_alt_arch/stage1
+        ${CMAKE_CURRENT_LIST_DIR}/src/common
 )
 target_link_libraries(sln_voice_app_stlp_audio_pipeline_adec_aec_2x_2y_no_comms_altarch
     INTERFACE
         core::general
         rtos::freertos
         rtos::sw_services::generic_pipeline
+        sln_voice::pipeline_profiler
+        sln_voice::frame_pool
+        sln_voice::frame_codec
+        sln_voice::latency_probe
         fwk_voice::adec
         fwk_voice::aec
         fwk_voice::agc
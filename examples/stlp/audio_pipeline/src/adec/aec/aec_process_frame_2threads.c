@@ -0,0 +1,200 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS headers */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "aec_defines.h"
+#include "aec_api.h"
+
+/* This processes one frame of data through the AEC pipeline stage, using the calling task and one worker task.
+ * The sequence of AEC calls is the same as aec_process_frame_1thread(). Work that only touches the main or the
+ * shadow filter state, and the per channel input FFTs, is split between the two tasks, which on an SMP tile run
+ * on separate hardware threads. Every split step operates on disjoint state, so the output is bit exact with the
+ * single threaded version.
+ */
+
+typedef enum {
+    AEC_STEP_INPUT_FFT,
+    AEC_STEP_X_ENERGY,
+    AEC_STEP_ERROR_AND_OUTPUT,
+    AEC_STEP_ADAPT,
+} aec_step_t;
+
+typedef struct {
+    aec_state_t *main_state;
+    aec_state_t *shadow_state;
+    int32_t (*output_main)[AEC_FRAME_ADVANCE];
+    int32_t (*output_shadow)[AEC_FRAME_ADVANCE];
+    unsigned X_energy_recalc_bin;
+    aec_step_t step;
+    TaskHandle_t caller;
+    TaskHandle_t worker;
+} aec_2threads_ctx_t;
+
+static aec_2threads_ctx_t aec_ctx;
+
+static void aec_step(aec_2threads_ctx_t *ctx, aec_step_t step, int thread)
+{
+    aec_state_t *main_state = ctx->main_state;
+    aec_state_t *state = (thread == 0) ? ctx->main_state : ctx->shadow_state;
+    int num_y_channels = main_state->shared_state->num_y_channels;
+    int num_x_channels = main_state->shared_state->num_x_channels;
+
+    switch (step) {
+    case AEC_STEP_INPUT_FFT:
+        // Channels are interleaved between the two threads
+        for(int ch=thread; ch<num_y_channels; ch+=2) {
+            aec_forward_fft(&main_state->shared_state->Y[ch], &main_state->shared_state->y[ch]);
+        }
+        for(int ch=thread; ch<num_x_channels; ch+=2) {
+            aec_forward_fft(&main_state->shared_state->X[ch], &main_state->shared_state->x[ch]);
+        }
+        break;
+
+    case AEC_STEP_X_ENERGY:
+        for(int ch=0; ch<num_x_channels; ch++) {
+            aec_calc_X_fifo_energy(state, ch, ctx->X_energy_recalc_bin);
+        }
+        break;
+
+    case AEC_STEP_ERROR_AND_OUTPUT:
+        aec_update_X_fifo_1d(state);
+
+        for(int ch=0; ch<num_y_channels; ch++) {
+            aec_calc_Error_and_Y_hat(state, ch);
+        }
+        for(int ch=0; ch<num_y_channels; ch++) {
+            aec_inverse_fft(&state->error[ch], &state->Error[ch]);
+            if (thread == 0) {
+                // y_hat is only needed by the coherence calculation, which uses the main filter
+                aec_inverse_fft(&state->y_hat[ch], &state->Y_hat[ch]);
+            }
+        }
+        if (thread == 0) {
+            for(int ch=0; ch<num_y_channels; ch++) {
+                aec_calc_coherence(state, ch);
+            }
+        }
+        for(int ch=0; ch<num_y_channels; ch++) {
+            int32_t (*output)[AEC_FRAME_ADVANCE] = (thread == 0) ? ctx->output_main : ctx->output_shadow;
+            aec_calc_output(state, (output != NULL) ? &output[ch] : NULL, ch);
+        }
+        if (thread == 0) {
+            for(int ch=0; ch<num_y_channels; ch++) {
+                bfp_s32_t temp;
+                bfp_s32_init(&temp, &ctx->output_main[ch][0], -31, AEC_FRAME_ADVANCE, 1);
+                aec_calc_time_domain_ema_energy(&state->error_ema_energy[ch], &temp, 0, AEC_FRAME_ADVANCE, &state->shared_state->config_params);
+            }
+        }
+        for(int ch=0; ch<num_y_channels; ch++) {
+            aec_forward_fft(&state->Error[ch], &state->error[ch]);
+        }
+        for(int ch=0; ch<num_y_channels; ch++) {
+            aec_calc_freq_domain_energy(&state->overall_Error[ch], &state->Error[ch]);
+            if (thread == 0) {
+                aec_calc_freq_domain_energy(&state->shared_state->overall_Y[ch], &state->shared_state->Y[ch]);
+            }
+        }
+        break;
+
+    case AEC_STEP_ADAPT:
+        for(int ch=0; ch<num_x_channels; ch++) {
+            aec_calc_normalisation_spectrum(state, ch, thread);
+        }
+        for(int ych=0; ych<num_y_channels; ych++) {
+            for(int xch=0; xch<num_x_channels; xch++) {
+                aec_calc_T(state, ych, xch);
+            }
+            aec_filter_adapt(state, ych);
+        }
+        break;
+    }
+}
+
+/* Runs step on both threads and returns once both halves are complete */
+static void aec_step_par(aec_2threads_ctx_t *ctx, aec_step_t step)
+{
+    ctx->step = step;
+    xTaskNotifyGive(ctx->worker);
+    aec_step(ctx, step, 0);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+static void aec_worker(aec_2threads_ctx_t *ctx)
+{
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        aec_step(ctx, ctx->step, 1);
+        xTaskNotifyGive(ctx->caller);
+    }
+}
+
+void aec_process_frame_2threads_init(unsigned priority)
+{
+    xTaskCreate((TaskFunction_t) aec_worker,
+                "aec_worker",
+                RTOS_THREAD_STACK_SIZE(aec_worker),
+                &aec_ctx,
+                priority,
+                &aec_ctx.worker);
+}
+
+void aec_process_frame_2threads(
+        aec_state_t *main_state,
+        aec_state_t *shadow_state,
+        int32_t (*output_main)[AEC_FRAME_ADVANCE],
+        int32_t (*output_shadow)[AEC_FRAME_ADVANCE],
+        const int32_t (*y_data)[AEC_FRAME_ADVANCE],
+        const int32_t (*x_data)[AEC_FRAME_ADVANCE])
+{
+    aec_2threads_ctx_t *ctx = &aec_ctx;
+    int num_y_channels = main_state->shared_state->num_y_channels;
+    int num_x_channels = main_state->shared_state->num_x_channels;
+
+    configASSERT(ctx->worker != NULL);
+
+    ctx->main_state = main_state;
+    ctx->shadow_state = shadow_state;
+    ctx->output_main = output_main;
+    ctx->output_shadow = output_shadow;
+    ctx->caller = xTaskGetCurrentTaskHandle();
+
+    aec_frame_init(main_state, shadow_state, y_data, x_data);
+
+    for(int ch=0; ch<num_y_channels; ch++) {
+        aec_calc_time_domain_ema_energy(&main_state->shared_state->y_ema_energy[ch], &main_state->shared_state->y[ch],
+                AEC_PROC_FRAME_LENGTH - AEC_FRAME_ADVANCE, AEC_FRAME_ADVANCE, &main_state->shared_state->config_params);
+    }
+    for(int ch=0; ch<num_x_channels; ch++) {
+        aec_calc_time_domain_ema_energy(&main_state->shared_state->x_ema_energy[ch], &main_state->shared_state->x[ch],
+                AEC_PROC_FRAME_LENGTH - AEC_FRAME_ADVANCE, AEC_FRAME_ADVANCE, &main_state->shared_state->config_params);
+    }
+
+    aec_step_par(ctx, AEC_STEP_INPUT_FFT);
+
+    aec_step_par(ctx, AEC_STEP_X_ENERGY);
+
+    ctx->X_energy_recalc_bin += 1;
+    if(ctx->X_energy_recalc_bin == (AEC_PROC_FRAME_LENGTH/2) + 1) {
+        ctx->X_energy_recalc_bin = 0;
+    }
+
+    // The X FIFO is shared by both filters, so it is updated before either uses it
+    for(int ch=0; ch<num_x_channels; ch++) {
+        aec_update_X_fifo_and_calc_sigmaXX(main_state, ch);
+    }
+
+    aec_step_par(ctx, AEC_STEP_ERROR_AND_OUTPUT);
+
+    // Filter comparison reads and may update both filters
+    aec_compare_filters_and_calc_mu(
+            main_state,
+            shadow_state);
+
+    aec_step_par(ctx, AEC_STEP_ADAPT);
+}
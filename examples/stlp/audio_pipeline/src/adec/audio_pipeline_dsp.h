@@ -5,7 +5,10 @@
 #define AUDIO_PIPELINE_DSP_H_
 
 #include <stdint.h>
+#include <stddef.h>
+#include <string.h>
 #include "app_conf.h"
+#include "frame_codec.h"
 
 /* Pipeline config */
 #define AP_MAX_Y_CHANNELS (2)
@@ -15,8 +18,32 @@
 /* AEC config */
 #define AEC_MAX_Y_CHANNELS   (AP_MAX_Y_CHANNELS)
 #define AEC_MAX_X_CHANNELS   (AP_MAX_X_CHANNELS)
+#ifndef AEC_MAIN_FILTER_PHASES
 #define AEC_MAIN_FILTER_PHASES    (10)
+#endif
+#ifndef AEC_SHADOW_FILTER_PHASES
 #define AEC_SHADOW_FILTER_PHASES    (5)
+#endif
+
+/* Largest filter the AEC memory pools are sized for. At run time any phase
+ * count whose filters fit in the same pool memory may be selected. */
+#ifndef AEC_MAX_MAIN_FILTER_PHASES
+#define AEC_MAX_MAIN_FILTER_PHASES    (AEC_MAIN_FILTER_PHASES)
+#endif
+#ifndef AEC_MAX_SHADOW_FILTER_PHASES
+#define AEC_MAX_SHADOW_FILTER_PHASES    (AEC_SHADOW_FILTER_PHASES)
+#endif
+
+/* Number of hardware threads the AEC stage runs on. With 2, the main and
+ * shadow filters are processed in parallel by the stage task and a worker task. */
+#ifndef NUM_AEC_THREADS
+#define NUM_AEC_THREADS (1)
+#endif
+
+/* Priority of the AEC worker task used when NUM_AEC_THREADS > 1 */
+#ifndef AEC_WORKER_TASK_PRIORITY
+#define AEC_WORKER_TASK_PRIORITY (appconfAUDIO_PIPELINE_TASK_PRIORITY)
+#endif
 
 /* Delay buffer config */
 #define MAX_DELAY_BUF_CHANNELS (2)
@@ -43,10 +70,116 @@ typedef struct {
     /* Below is additional context needed by other stages on a per frame basis */
     int32_t vnr_pred_flag;
     float_s32_t max_ref_energy;
-    float_s32_t aec_corr_factor;
+    float_s32_t aec_corr_factor[AP_MAX_Y_CHANNELS];
     int32_t ref_active_flag;
+
+    /*
+     * Reference time at which the mic array delivered the frame to the
+     * pipeline input, used to measure the pipeline latency. It is carried
+     * across the intertile link as an age and rebased onto the receiving
+     * tile's timer.
+     */
+    uint32_t capture_time;
+
+    /* Selects, per channel, whether the current samples are in samples or samples_alt */
+    int32_t sample_plane[appconfAUDIO_PIPELINE_CHANNELS];
+
+    /*
+     * Second sample plane. Stages read a channel from its current plane and
+     * write their result straight into the other one rather than copying it
+     * back. This is last so that it is not sent between tiles.
+     */
+    int32_t DWORD_ALIGNED samples_alt[appconfAUDIO_PIPELINE_CHANNELS][appconfAUDIO_PIPELINE_FRAME_ADVANCE];
 } frame_data_t;
 
+/* Number of bytes of a frame sent between tiles */
+#define FRAME_DATA_TX_SIZE offsetof(frame_data_t, samples_alt)
+
+/*
+ * With a compact appconfAUDIO_PIPELINE_WIRE_FORMAT, a frame is sent between
+ * tiles as its per frame context followed by each channel of samples,
+ * aec_reference_audio_samples and mic_samples_passthrough, encoded with
+ * frame_codec. Tile 0 consumes all three planes, samples_alt is never sent.
+ */
+#define FRAME_DATA_WIRE_PLANES 3
+#define FRAME_DATA_META_OFFSET offsetof(frame_data_t, vnr_pred_flag)
+#define FRAME_DATA_META_SIZE (offsetof(frame_data_t, sample_plane) - FRAME_DATA_META_OFFSET)
+#define FRAME_DATA_WIRE_SIZE (FRAME_DATA_META_SIZE + \
+        FRAME_DATA_WIRE_PLANES * appconfAUDIO_PIPELINE_CHANNELS * \
+        FRAME_CODEC_ENCODED_SIZE(appconfAUDIO_PIPELINE_WIRE_FORMAT, appconfAUDIO_PIPELINE_FRAME_ADVANCE))
+
+/* Returns the current samples of channel ch */
+static inline int32_t *frame_samples_in(frame_data_t *frame_data, int ch)
+{
+    return frame_data->sample_plane[ch] ? frame_data->samples_alt[ch] : frame_data->samples[ch];
+}
+
+/* Returns the plane a stage should write its output for channel ch to */
+static inline int32_t *frame_samples_out(frame_data_t *frame_data, int ch)
+{
+    return frame_data->sample_plane[ch] ? frame_data->samples[ch] : frame_data->samples_alt[ch];
+}
+
+/* Makes the output plane written by a stage the current plane of channel ch */
+static inline void frame_samples_swap(frame_data_t *frame_data, int ch)
+{
+    frame_data->sample_plane[ch] ^= 1;
+}
+
+/*
+ * Moves every channel back into samples, which the output functions and the
+ * intertile link expect to be contiguous with the reference and passthrough
+ * microphone channels. At most one copy per channel, once per frame.
+ */
+static inline void frame_samples_resolve(frame_data_t *frame_data)
+{
+    for (int ch = 0; ch < appconfAUDIO_PIPELINE_CHANNELS; ch++) {
+        if (frame_data->sample_plane[ch]) {
+            memcpy(frame_data->samples[ch], frame_data->samples_alt[ch], sizeof(frame_data->samples[ch]));
+            frame_data->sample_plane[ch] = 0;
+        }
+    }
+}
+
+/* Encodes frame_data for the intertile link into wire, returning its length */
+static inline size_t frame_data_encode(const frame_data_t *frame_data, uint8_t *wire)
+{
+    const int32_t (*planes[FRAME_DATA_WIRE_PLANES])[appconfAUDIO_PIPELINE_FRAME_ADVANCE] = {
+        frame_data->samples,
+        frame_data->aec_reference_audio_samples,
+        frame_data->mic_samples_passthrough,
+    };
+    size_t len = FRAME_DATA_META_SIZE;
+
+    memcpy(wire, (const uint8_t *)frame_data + FRAME_DATA_META_OFFSET, FRAME_DATA_META_SIZE);
+    for (int p = 0; p < FRAME_DATA_WIRE_PLANES; p++) {
+        for (int ch = 0; ch < appconfAUDIO_PIPELINE_CHANNELS; ch++) {
+            len += frame_codec_encode(appconfAUDIO_PIPELINE_WIRE_FORMAT, &wire[len],
+                                      planes[p][ch], appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+        }
+    }
+    return len;
+}
+
+/* Decodes a frame encoded by frame_data_encode(). The sample planes are left at 0. */
+static inline void frame_data_decode(frame_data_t *frame_data, const uint8_t *wire)
+{
+    int32_t (*planes[FRAME_DATA_WIRE_PLANES])[appconfAUDIO_PIPELINE_FRAME_ADVANCE] = {
+        frame_data->samples,
+        frame_data->aec_reference_audio_samples,
+        frame_data->mic_samples_passthrough,
+    };
+    size_t len = FRAME_DATA_META_SIZE;
+
+    memcpy((uint8_t *)frame_data + FRAME_DATA_META_OFFSET, wire, FRAME_DATA_META_SIZE);
+    for (int p = 0; p < FRAME_DATA_WIRE_PLANES; p++) {
+        for (int ch = 0; ch < appconfAUDIO_PIPELINE_CHANNELS; ch++) {
+            len += frame_codec_decode(appconfAUDIO_PIPELINE_WIRE_FORMAT, planes[p][ch],
+                                      &wire[len], appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+        }
+    }
+}
+
 typedef struct aec_ctx {
     aec_state_t DWORD_ALIGNED aec_main_state;
     aec_state_t DWORD_ALIGNED aec_shadow_state;
@@ -15,6 +15,8 @@
 
 /* Library headers */
 #include "generic_pipeline.h"
+#include "pipeline_profiler.h"
+#include "frame_pool.h"
 #include "adec_api.h"
 
 /* App headers */
@@ -34,21 +36,37 @@ static aec_conf_t aec_de_mode_conf;
 static aec_conf_t aec_non_de_mode_conf;
 static adec_config_t adec_conf;
 
+#define AUDIO_PIPELINE_STAGE_COUNT      1
+
+/*
+ * The input, stage and output all run in the one stage task, so it only
+ * ever holds one frame
+ */
+#define AUDIO_PIPELINE_FRAME_POOL_SIZE  FRAME_POOL_PIPELINE_FRAMES(AUDIO_PIPELINE_STAGE_COUNT)
+
+FRAME_POOL_STORAGE(audio_pipeline_frames, frame_data_t, AUDIO_PIPELINE_FRAME_POOL_SIZE);
+static frame_pool_t frame_pool;
+
 static void *audio_pipeline_input_i(void *input_app_data)
 {
     frame_data_t *frame_data;
 
-    frame_data = pvPortMalloc(sizeof(frame_data_t));
-    memset(frame_data, 0x00, sizeof(frame_data_t));
+    frame_data = frame_pool_acquire(&frame_pool);
+    memset(frame_data, 0x00, FRAME_DATA_TX_SIZE);
 
     audio_pipeline_input(input_app_data,
                        (int32_t **)frame_data->aec_reference_audio_samples,
                        4,
                        appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+    frame_data->capture_time = get_reference_time();
 
     frame_data->vnr_pred_flag = 0;
 
-    memcpy(frame_data->samples, frame_data->mic_samples_passthrough, sizeof(frame_data->samples));
+    /* The AEC delays its input in place, so it gets its own copy of the mics */
+    memcpy(frame_data->samples_alt, frame_data->mic_samples_passthrough, sizeof(frame_data->samples_alt));
+    for (int ch = 0; ch < appconfAUDIO_PIPELINE_CHANNELS; ch++) {
+        frame_data->sample_plane[ch] = 1;
+    }
 
     return frame_data;
 }
@@ -56,31 +74,52 @@ static void *audio_pipeline_input_i(void *input_app_data)
 static int audio_pipeline_output_i(frame_data_t *frame_data,
                                    void *output_app_data)
 {
+    frame_samples_resolve(frame_data);
+
+    /* Send the age of the frame, tile 0 adds its own time on receipt */
+    frame_data->capture_time -= get_reference_time();
+
+#if appconfAUDIO_PIPELINE_WIRE_FORMAT == FRAME_CODEC_INT32
     rtos_intertile_tx(intertile_ctx,
                       appconfAUDIOPIPELINE_PORT,
                       frame_data,
-                      sizeof(frame_data_t));
-    return AUDIO_PIPELINE_FREE_FRAME;
+                      FRAME_DATA_TX_SIZE);
+#else
+    static uint32_t wire[(FRAME_DATA_WIRE_SIZE + sizeof(uint32_t) - 1) / sizeof(uint32_t)];
+    size_t len = frame_data_encode(frame_data, (uint8_t *)wire);
+
+    rtos_intertile_tx(intertile_ctx,
+                      appconfAUDIOPIPELINE_PORT,
+                      wire,
+                      len);
+#endif
+    frame_pool_release(&frame_pool, frame_data);
+    return AUDIO_PIPELINE_DONT_FREE_FRAME;
 }
 
 static void stage_aec(frame_data_t *frame_data)
 {
 #if appconfAUDIO_PIPELINE_SKIP_AEC
 #else
-    int32_t DWORD_ALIGNED stage_1_out[AEC_MAX_Y_CHANNELS][appconfAUDIO_PIPELINE_FRAME_ADVANCE];
-
+    /* The input function leaves every mic channel in samples_alt */
     stage_1_process_frame(&stage_1_state,
-                          &stage_1_out[0],
+                          frame_data->samples,
                           &frame_data->max_ref_energy,
-                          &frame_data->aec_corr_factor,
+                          frame_data->aec_corr_factor,
                           &frame_data->ref_active_flag,
-                          frame_data->samples,
+                          frame_data->samples_alt,
                           frame_data->aec_reference_audio_samples);
 
-    memcpy(frame_data->samples, stage_1_out, AEC_MAX_Y_CHANNELS * appconfAUDIO_PIPELINE_FRAME_ADVANCE * sizeof(int32_t));
+    for (int ch = 0; ch < AEC_MAX_Y_CHANNELS; ch++) {
+        frame_samples_swap(frame_data, ch);
+    }
 #endif
 }
 
+PIPELINE_PROFILER_DEFINE_INPUT(audio_pipeline_input_i)
+PIPELINE_PROFILER_DEFINE_OUTPUT(audio_pipeline_output_i)
+PIPELINE_PROFILER_DEFINE_STAGE(stage_aec)
+
 static void initialize_pipeline_stages(void)
 {
     aec_non_de_mode_conf.num_y_channels = 2;
@@ -99,25 +138,40 @@ static void initialize_pipeline_stages(void)
     stage_1_init(&stage_1_state, &aec_de_mode_conf, &aec_non_de_mode_conf, &adec_conf);
 }
 
+int audio_pipeline_aec_phases_set(int main_phases, int shadow_phases)
+{
+    return stage_1_set_aec_phases(&stage_1_state, main_phases, shadow_phases);
+}
+
+void audio_pipeline_aec_cost_report(void)
+{
+    stage_1_aec_cost_report(&stage_1_state);
+}
+
 void audio_pipeline_init(
     void *input_app_data,
     void *output_app_data)
 {
-    const int stage_count = 1;
+    const int stage_count = AUDIO_PIPELINE_STAGE_COUNT;
 
     const pipeline_stage_t stages[] = {
-        (pipeline_stage_t)stage_aec,
+        (pipeline_stage_t)PIPELINE_PROFILED(stage_aec),
     };
 
     const configSTACK_DEPTH_TYPE stage_stack_sizes[] = {
-        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_aec) + RTOS_THREAD_STACK_SIZE(audio_pipeline_output_i) + RTOS_THREAD_STACK_SIZE(audio_pipeline_input_i),
+        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_aec) + RTOS_THREAD_STACK_SIZE(audio_pipeline_output_i) + RTOS_THREAD_STACK_SIZE(audio_pipeline_input_i) + PIPELINE_PROFILER_STACK_SIZE,
 
     };
 
     initialize_pipeline_stages();
+    FRAME_POOL_INIT(&frame_pool, audio_pipeline_frames, frame_data_t, AUDIO_PIPELINE_FRAME_POOL_SIZE);
+
+    PIPELINE_PROFILER_REGISTER(audio_pipeline_input_i);
+    PIPELINE_PROFILER_REGISTER(stage_aec);
+    PIPELINE_PROFILER_REGISTER(audio_pipeline_output_i);
 
-    generic_pipeline_init((pipeline_input_t)audio_pipeline_input_i,
-                        (pipeline_output_t)audio_pipeline_output_i,
+    generic_pipeline_init((pipeline_input_t)PIPELINE_PROFILED(audio_pipeline_input_i),
+                        (pipeline_output_t)PIPELINE_PROFILED(audio_pipeline_output_i),
                         input_app_data,
                         output_app_data,
                         stages,
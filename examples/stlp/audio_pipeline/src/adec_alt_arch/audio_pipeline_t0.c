@@ -15,6 +15,9 @@
 
 /* Library headers */
 #include "generic_pipeline.h"
+#include "pipeline_profiler.h"
+#include "latency_probe.h"
+#include "frame_pool.h"
 #include "aec_api.h"
 #include "agc_api.h"
 #include "ic_api.h"
@@ -40,12 +43,20 @@ static vnr_pred_stage_ctx_t DWORD_ALIGNED vnr_pred_stage_state = {};
 static ns_stage_ctx_t DWORD_ALIGNED ns_stage_state = {};
 static agc_stage_ctx_t DWORD_ALIGNED agc_stage_state = {};
 
+#define AUDIO_PIPELINE_STAGE_COUNT      3
+
+/* One frame in each stage task plus a full queue between each pair of stages */
+#define AUDIO_PIPELINE_FRAME_POOL_SIZE  FRAME_POOL_PIPELINE_FRAMES(AUDIO_PIPELINE_STAGE_COUNT)
+
+FRAME_POOL_STORAGE(audio_pipeline_frames, frame_data_t, AUDIO_PIPELINE_FRAME_POOL_SIZE);
+static frame_pool_t frame_pool;
+
 static void *audio_pipeline_input_i(void *input_app_data)
 {
     frame_data_t *frame_data;
 
-    frame_data = pvPortMalloc(sizeof(frame_data_t));
-    memset(frame_data, 0x00, sizeof(frame_data_t));
+    frame_data = frame_pool_acquire(&frame_pool);
+    memset(frame_data, 0x00, FRAME_DATA_TX_SIZE);
 
     size_t bytes_received = 0;
     bytes_received = rtos_intertile_rx_len(
@@ -53,12 +64,28 @@ static void *audio_pipeline_input_i(void *input_app_data)
             appconfAUDIOPIPELINE_PORT,
             portMAX_DELAY);
 
-    xassert(bytes_received == sizeof(frame_data_t));
+#if appconfAUDIO_PIPELINE_WIRE_FORMAT == FRAME_CODEC_INT32
+    xassert(bytes_received == FRAME_DATA_TX_SIZE);
 
     rtos_intertile_rx_data(
             intertile_ctx,
             frame_data,
             bytes_received);
+#else
+    static uint32_t wire[(FRAME_DATA_WIRE_SIZE + sizeof(uint32_t) - 1) / sizeof(uint32_t)];
+
+    xassert(bytes_received == FRAME_DATA_WIRE_SIZE);
+
+    rtos_intertile_rx_data(
+            intertile_ctx,
+            wire,
+            bytes_received);
+
+    frame_data_decode(frame_data, (const uint8_t *)wire);
+#endif
+
+    /* Rebase the age sent by tile 1 onto this tile's timer */
+    frame_data->capture_time += get_reference_time();
 
     return frame_data;
 }
@@ -66,10 +93,21 @@ static void *audio_pipeline_input_i(void *input_app_data)
 static int audio_pipeline_output_i(frame_data_t *frame_data,
                                    void *output_app_data)
 {
-    return audio_pipeline_output(output_app_data,
-                               (int32_t **)frame_data->samples,
-                               6,
-                               appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+    frame_samples_resolve(frame_data);
+
+#if LATENCY_PROBE_ENABLED
+    latency_probe_frame_begin(frame_data->capture_time);
+#endif
+
+    int ret = audio_pipeline_output(output_app_data,
+                                    (int32_t **)frame_data->samples,
+                                    6,
+                                    appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+
+    if (ret == AUDIO_PIPELINE_FREE_FRAME) {
+        frame_pool_release(&frame_pool, frame_data);
+    }
+    return AUDIO_PIPELINE_DONT_FREE_FRAME;
 }
 
 static void stage_vnr_and_ic(frame_data_t *frame_data)
@@ -84,11 +122,10 @@ static void stage_vnr_and_ic(frame_data_t *frame_data)
         ic_stage_state.state.config_params.bypass = 0;
     }
 
-    int32_t DWORD_ALIGNED ic_output[appconfAUDIO_PIPELINE_FRAME_ADVANCE];
     ic_filter(&ic_stage_state.state,
-              frame_data->samples[0],
-              frame_data->samples[1],
-              ic_output);
+              frame_samples_in(frame_data, 0),
+              frame_samples_in(frame_data, 1),
+              frame_samples_out(frame_data, 0));
 
     // VNR
     bfp_s32_t feature_patch;
@@ -112,7 +149,7 @@ static void stage_vnr_and_ic(frame_data_t *frame_data)
     ic_adapt(&ic_stage_state.state, vnr_pred_stage_state.vnr_pred_state.input_vnr_pred);
 
     /* Intentionally ignoring comms ch from here on out */
-    memcpy(frame_data->samples, ic_output, appconfAUDIO_PIPELINE_FRAME_ADVANCE * sizeof(int32_t));
+    frame_samples_swap(frame_data, 0);
 #endif
 }
 
@@ -120,13 +157,12 @@ static void stage_ns(frame_data_t *frame_data)
 {
 #if appconfAUDIO_PIPELINE_SKIP_NS
 #else
-    int32_t DWORD_ALIGNED ns_output[appconfAUDIO_PIPELINE_FRAME_ADVANCE];
     configASSERT(NS_FRAME_ADVANCE == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
     ns_process_frame(
                 &ns_stage_state.state,
-                ns_output,
-                frame_data->samples[0]);
-    memcpy(frame_data->samples, ns_output, appconfAUDIO_PIPELINE_FRAME_ADVANCE * sizeof(int32_t));
+                frame_samples_out(frame_data, 0),
+                frame_samples_in(frame_data, 0));
+    frame_samples_swap(frame_data, 0);
 #endif
 }
 
@@ -134,22 +170,27 @@ static void stage_agc(frame_data_t *frame_data)
 {
 #if appconfAUDIO_PIPELINE_SKIP_AGC
 #else
-    int32_t DWORD_ALIGNED agc_output[appconfAUDIO_PIPELINE_FRAME_ADVANCE];
     configASSERT(AGC_FRAME_ADVANCE == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
 
     agc_stage_state.md.vnr_flag = frame_data->vnr_pred_flag;
     agc_stage_state.md.aec_ref_power = frame_data->max_ref_energy;
-    agc_stage_state.md.aec_corr_factor = frame_data->aec_corr_factor;
+    agc_stage_state.md.aec_corr_factor = frame_data->aec_corr_factor[0];
 
     agc_process_frame(
             &agc_stage_state.state,
-            agc_output,
-            frame_data->samples[0],
+            frame_samples_out(frame_data, 0),
+            frame_samples_in(frame_data, 0),
             &agc_stage_state.md);
-    memcpy(frame_data->samples, agc_output, appconfAUDIO_PIPELINE_FRAME_ADVANCE * sizeof(int32_t));
+    frame_samples_swap(frame_data, 0);
 #endif
 }
 
+PIPELINE_PROFILER_DEFINE_INPUT(audio_pipeline_input_i)
+PIPELINE_PROFILER_DEFINE_OUTPUT(audio_pipeline_output_i)
+PIPELINE_PROFILER_DEFINE_STAGE(stage_vnr_and_ic)
+PIPELINE_PROFILER_DEFINE_STAGE(stage_ns)
+PIPELINE_PROFILER_DEFINE_STAGE(stage_agc)
+
 static void initialize_pipeline_stages(void)
 {
     ic_init(&ic_stage_state.state);
@@ -174,24 +215,31 @@ void audio_pipeline_init(
     void *input_app_data,
     void *output_app_data)
 {
-    const int stage_count = 3;
+    const int stage_count = AUDIO_PIPELINE_STAGE_COUNT;
 
     const pipeline_stage_t stages[] = {
-        (pipeline_stage_t)stage_vnr_and_ic,
-        (pipeline_stage_t)stage_ns,
-        (pipeline_stage_t)stage_agc,
+        (pipeline_stage_t)PIPELINE_PROFILED(stage_vnr_and_ic),
+        (pipeline_stage_t)PIPELINE_PROFILED(stage_ns),
+        (pipeline_stage_t)PIPELINE_PROFILED(stage_agc),
     };
 
     const configSTACK_DEPTH_TYPE stage_stack_sizes[] = {
-        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_vnr_and_ic) + RTOS_THREAD_STACK_SIZE(audio_pipeline_input_i),
-        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_ns),
-        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_agc) + RTOS_THREAD_STACK_SIZE(audio_pipeline_output_i),
+        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_vnr_and_ic) + RTOS_THREAD_STACK_SIZE(audio_pipeline_input_i) + PIPELINE_PROFILER_STACK_SIZE,
+        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_ns) + PIPELINE_PROFILER_STACK_SIZE,
+        configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_agc) + RTOS_THREAD_STACK_SIZE(audio_pipeline_output_i) + PIPELINE_PROFILER_STACK_SIZE,
     };
 
     initialize_pipeline_stages();
+    FRAME_POOL_INIT(&frame_pool, audio_pipeline_frames, frame_data_t, AUDIO_PIPELINE_FRAME_POOL_SIZE);
+
+    PIPELINE_PROFILER_REGISTER(audio_pipeline_input_i);
+    PIPELINE_PROFILER_REGISTER(stage_vnr_and_ic);
+    PIPELINE_PROFILER_REGISTER(stage_ns);
+    PIPELINE_PROFILER_REGISTER(stage_agc);
+    PIPELINE_PROFILER_REGISTER(audio_pipeline_output_i);
 
-    generic_pipeline_init((pipeline_input_t)audio_pipeline_input_i,
-                        (pipeline_output_t)audio_pipeline_output_i,
+    generic_pipeline_init((pipeline_input_t)PIPELINE_PROFILED(audio_pipeline_input_i),
+                        (pipeline_output_t)PIPELINE_PROFILED(audio_pipeline_output_i),
                         input_app_data,
                         output_app_data,
                         stages,
@@ -1,9 +1,25 @@
 // Copyright 2022 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
+#include <xcore/hwtimer.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if defined(__XS3A__)
+#include "rtos_printf.h"
+#else
+#include <stdio.h>
+#define rtos_printf printf
+#endif
+
+#include "pipeline_profiler.h"
 #include "audio_pipeline_dsp.h"
 #include "stage_1.h"
 
+/* Reference timer ticks available to process one frame */
+#define STAGE_1_FRAME_TICKS ((uint64_t)AP_FRAME_ADVANCE * 100000000 / appconfAUDIO_PIPELINE_SAMPLE_RATE)
+
 extern void aec_process_frame_2threads(
         aec_state_t *main_state,
         aec_state_t *shadow_state,
@@ -20,35 +36,106 @@ extern void aec_process_frame_1thread(
         const int32_t (*y_data)[AEC_FRAME_ADVANCE],
         const int32_t (*x_data)[AEC_FRAME_ADVANCE]);
 
+/** Check that the filters for conf fit in the memory pools in stage_1_state_t*/
+static int aec_conf_fits_memory_pool(const aec_conf_t *conf)
+{
+    const int main_pool_phases = (AEC_MAX_Y_CHANNELS * AEC_MAX_X_CHANNELS * AEC_MAX_MAIN_FILTER_PHASES) + (AEC_MAX_X_CHANNELS * AEC_MAX_MAIN_FILTER_PHASES);
+    const int shadow_pool_phases = AEC_MAX_Y_CHANNELS * AEC_MAX_X_CHANNELS * AEC_MAX_SHADOW_FILTER_PHASES;
+    int main_phases = (conf->num_y_channels * conf->num_x_channels * conf->num_main_filt_phases) + (conf->num_x_channels * conf->num_main_filt_phases);
+    int shadow_phases = conf->num_y_channels * conf->num_x_channels * conf->num_shadow_filt_phases;
+
+    if ((conf->num_y_channels == 0) || (conf->num_y_channels > AEC_MAX_Y_CHANNELS) ||
+        (conf->num_x_channels == 0) || (conf->num_x_channels > AEC_MAX_X_CHANNELS)) {
+        return 0;
+    }
+    // The shadow filter works on the most recent frames of the X FIFO, which is sized by the main filter
+    if ((conf->num_main_filt_phases == 0) || (conf->num_shadow_filt_phases > conf->num_main_filt_phases)) {
+        return 0;
+    }
+    return (main_phases <= main_pool_phases) && (shadow_phases <= shadow_pool_phases);
+}
+
+/** aec_init() lays the filters out from the start of the memory pools, so any configuration that fits
+ * re-partitions the same memory*/
 static void aec_switch_configuration(stage_1_state_t *state, aec_conf_t *conf)
 {
+    configASSERT(aec_conf_fits_memory_pool(conf));
+#if PIPELINE_PROFILER_ENABLED
+    taskENTER_CRITICAL();
+    state->aec_ticks = 0;
+    state->aec_frames = 0;
+    taskEXIT_CRITICAL();
+#endif
+
     aec_init(&state->aec_main_state, &state->aec_shadow_state, &state->aec_shared_state,
             &state->aec_main_memory_pool[0], &state->aec_shadow_memory_pool[0],
             conf->num_y_channels, conf->num_x_channels,
             conf->num_main_filt_phases, conf->num_shadow_filt_phases);
 }
 
-static inline void get_delayed_frame(
-        int32_t (*input_y_data)[AP_FRAME_ADVANCE],
-        int32_t (*input_x_data)[AP_FRAME_ADVANCE],
-        delay_buf_state_t *delay_state)
+static void aec_apply_pending_configuration(stage_1_state_t *state)
 {
-    int num_channels = (delay_state->delay_samples) > 0 ? AP_MAX_Y_CHANNELS : AP_MAX_X_CHANNELS;
-    if (delay_state->delay_samples >= 0) {/** Requested Mic delay +ve => delay mic*/
-        for(int ch=0; ch<num_channels; ch++) {
-            for(int i=0; i<AP_FRAME_ADVANCE; i++) {
-                get_delayed_sample(delay_state, &input_y_data[ch][i], ch);
-            }
-        }
+    taskENTER_CRITICAL();
+    state->aec_non_de_mode_conf = state->aec_pending_conf;
+    state->aec_conf_pending = 0;
+    taskEXIT_CRITICAL();
+
+    // During delay estimation the new configuration is picked up when the AEC switches back
+    if (!state->delay_estimator_enabled) {
+        aec_switch_configuration(state, &state->aec_non_de_mode_conf);
     }
-    else if (delay_state->delay_samples < 0) {/* Requested Mic delay negative => advance mic which can't be done, so delay reference*/
-        for(int ch=0; ch<num_channels; ch++) {
-            for(int i=0; i<AP_FRAME_ADVANCE; i++) {
-                get_delayed_sample(delay_state, &input_x_data[ch][i], ch);
-            }
-        }
+}
+
+int stage_1_set_aec_phases(stage_1_state_t *state, int main_phases, int shadow_phases)
+{
+    aec_conf_t conf = state->aec_non_de_mode_conf;
+
+    if ((main_phases < 0) || (main_phases > UINT8_MAX) || (shadow_phases < 0) || (shadow_phases > UINT8_MAX)) {
+        return -1;
+    }
+    conf.num_main_filt_phases = main_phases;
+    conf.num_shadow_filt_phases = shadow_phases;
+    if (!aec_conf_fits_memory_pool(&conf)) {
+        return -1;
     }
-    return;
+
+    taskENTER_CRITICAL();
+    state->aec_pending_conf = conf;
+    state->aec_conf_pending = 1;
+    taskEXIT_CRITICAL();
+
+    return 0;
+}
+
+void stage_1_aec_cost_report(stage_1_state_t *state)
+{
+#if PIPELINE_PROFILER_ENABLED
+    const aec_conf_t *conf = state->delay_estimator_enabled ? &state->aec_de_mode_conf : &state->aec_non_de_mode_conf;
+    int filter_phases = conf->num_y_channels * conf->num_x_channels * (conf->num_main_filt_phases + conf->num_shadow_filt_phases);
+    uint64_t ticks;
+    uint32_t frames;
+
+    // The 64 bit count is updated by the stage task, possibly on another core, so is copied in one go
+    taskENTER_CRITICAL();
+    ticks = state->aec_ticks;
+    frames = state->aec_frames;
+    taskEXIT_CRITICAL();
+
+    if (frames == 0) {
+        rtos_printf("AEC: %d main + %d shadow phases, no frames\n", conf->num_main_filt_phases, conf->num_shadow_filt_phases);
+        return;
+    }
+
+    // Fixed costs such as the FFTs are included, so this is an upper bound on the cost of one extra phase
+    uint32_t ticks_per_frame = ticks / frames;
+    rtos_printf("AEC: %d main + %d shadow phases, %u ticks/frame (%u%% of frame), %u ticks/phase\n",
+                conf->num_main_filt_phases, conf->num_shadow_filt_phases,
+                (unsigned)ticks_per_frame,
+                (unsigned)((100 * (uint64_t)ticks_per_frame) / STAGE_1_FRAME_TICKS),
+                (unsigned)(ticks_per_frame / filter_phases));
+#else
+    (void) state;
+#endif
 }
 
 void stage_1_init(stage_1_state_t *state, aec_conf_t *de_conf, aec_conf_t *non_de_conf, adec_config_t *adec_config) {
@@ -60,6 +147,7 @@ void stage_1_init(stage_1_state_t *state, aec_conf_t *de_conf, aec_conf_t *non_d
     delay_buffer_init(&state->delay_state, 0/*Initialise with 0 delay_samples*/);
     memcpy(&state->aec_de_mode_conf, de_conf, sizeof(aec_conf_t));
     memcpy(&state->aec_non_de_mode_conf, non_de_conf, sizeof(aec_conf_t));
+    state->aec_conf_pending = 0;
 
     adec_init(&state->adec_state, adec_config);
     aec_switch_configuration(state, &state->aec_non_de_mode_conf);
@@ -125,12 +213,12 @@ void stage_1_process_frame(stage_1_state_t *state, int32_t (*output_frame)[AP_FR
     //printf("frame %d\n",framenum);
     framenum++;
 
-    delay_buf_state_t *delay_state_ptr = &state->delay_state;
-    get_delayed_frame(
-            input_y,
-            input_x,
-            delay_state_ptr
-            );
+    /** Apply a filter length change requested since the last frame*/
+    if (state->aec_conf_pending) {
+        aec_apply_pending_configuration(state);
+    }
+
+    delay_buffer_process_frame(&state->delay_state, input_y, input_x);
 
     /** Detect if there's activity on the reference channels*/
     *ref_active_flag = aec_detect_input_activity(input_x, state->ref_active_threshold, state->aec_main_state.shared_state->num_x_channels);
@@ -139,11 +227,21 @@ void stage_1_process_frame(stage_1_state_t *state, int32_t (*output_frame)[AP_FR
     alt_arch_controller(state, ref_active_flag);
 
     /** AEC*/
+#if PIPELINE_PROFILER_ENABLED
+    uint32_t aec_start = get_reference_time();
+#endif
 #if (NUM_AEC_THREADS > 1)
     aec_process_frame_2threads(&state->aec_main_state, &state->aec_shadow_state, output_frame, NULL, input_y, input_x);
 #else
     aec_process_frame_1thread(&state->aec_main_state, &state->aec_shadow_state, output_frame, NULL, input_y, input_x);
 #endif
+#if PIPELINE_PROFILER_ENABLED
+    uint32_t aec_end = get_reference_time();
+    taskENTER_CRITICAL();
+    state->aec_ticks += aec_end - aec_start;
+    state->aec_frames++;
+    taskEXIT_CRITICAL();
+#endif
 
     /** Update metadata*/
     *max_ref_energy = aec_calc_max_input_energy(input_x, state->aec_main_state.shared_state->num_x_channels);
@@ -183,11 +281,8 @@ void stage_1_process_frame(stage_1_state_t *state, int32_t (*output_frame)[AP_FR
     /** Update delay buffer if there's a delay change requested by ADEC*/
     if(adec_output.delay_change_request_flag == 1){
         //printf("Frame %d: Set delay to %ld\n", framenum, adec_output.requested_mic_delay_samples);
-        // Update delay_buffer delay_samples with mic delay requested by adec
-        update_delay_samples(&state->delay_state, adec_output.requested_mic_delay_samples);
-        for(int ch=0; ch<AP_MAX_Y_CHANNELS; ch++) {
-            reset_partial_delay_buffer(&state->delay_state, ch);
-        }
+        // Update delay_buffer with mic delay requested by adec. The next frame crossfades to the new delay
+        delay_buffer_set_delay(&state->delay_state, DELAY_BUF_SAMPLES_TO_Q(adec_output.requested_mic_delay_samples));
     }
 
     alt_arch_rewrite_output(output_frame, input_y, state->aec_main_state.shared_state->num_y_channels, state->aec_main_state.shared_state->config_params.aec_core_conf.bypass);
@@ -37,12 +37,18 @@ typedef struct {
     //Top level
     aec_conf_t aec_de_mode_conf;
     aec_conf_t aec_non_de_mode_conf;
+    aec_conf_t aec_pending_conf; // Applied to aec_non_de_mode_conf at the next frame boundary
+    volatile int32_t aec_conf_pending;
     int32_t delay_estimator_enabled;
     float_s32_t ref_active_threshold; //-60dB
 
     //alt-arch
     int32_t hold_aec_count;
     int32_t hold_aec_limit;
+
+    //AEC cost, accumulated since the last configuration change when the pipeline profiler is enabled
+    uint64_t aec_ticks;
+    uint32_t aec_frames;
 } stage_1_state_t;
 
 void stage_1_init(stage_1_state_t *state, aec_conf_t *de_conf, aec_conf_t *non_de_conf, adec_config_t *adec_config);
@@ -50,4 +56,13 @@ void stage_1_init(stage_1_state_t *state, aec_conf_t *de_conf, aec_conf_t *non_d
 void stage_1_process_frame(stage_1_state_t *state, int32_t (*output_frame)[AP_FRAME_ADVANCE],
     float_s32_t *max_ref_energy, float_s32_t *aec_corr_factor, int32_t *ref_active_flag,
     int32_t (*input_y)[AP_FRAME_ADVANCE], int32_t (*input_x)[AP_FRAME_ADVANCE]);
+
+/** Request new main and shadow filter phase counts for the normal (non delay estimation) AEC configuration.
+ * May be called from any task on the tile. The AEC is reinitialised with the new filter length at the start
+ * of the next frame. Returns 0 on success, or -1 if the filters would not fit in the AEC memory pools.*/
+int stage_1_set_aec_phases(stage_1_state_t *state, int main_phases, int shadow_phases);
+
+/** Print the AEC processing time per frame and per filter phase for the current configuration.
+ * Prints nothing unless the pipeline profiler is enabled.*/
+void stage_1_aec_cost_report(stage_1_state_t *state);
 #endif
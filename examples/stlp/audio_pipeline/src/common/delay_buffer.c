@@ -0,0 +1,146 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+#include <string.h>
+#include "delay_buffer.h"
+
+#define DELAY_BUF_MAX_DELAY_Q (DELAY_BUF_SAMPLES_TO_Q(DELAY_BUF_MAX_DELAY_SAMPLES - 2))
+
+static inline int32_t wrap_idx(int32_t idx) {
+    if (idx < 0) {
+        idx += DELAY_BUF_MAX_DELAY_SAMPLES;
+    } else if (idx >= DELAY_BUF_MAX_DELAY_SAMPLES) {
+        idx -= DELAY_BUF_MAX_DELAY_SAMPLES;
+    }
+    return idx;
+}
+
+static void ring_read(const int32_t *ring, int32_t start, int32_t *dst, int32_t count) {
+    start = wrap_idx(start);
+    int32_t first = DELAY_BUF_MAX_DELAY_SAMPLES - start;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(dst, &ring[start], first * sizeof(int32_t));
+    memcpy(&dst[first], &ring[0], (count - first) * sizeof(int32_t));
+}
+
+static void ring_write(int32_t *ring, int32_t start, const int32_t *src, int32_t count) {
+    int32_t first = DELAY_BUF_MAX_DELAY_SAMPLES - start;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(&ring[start], src, first * sizeof(int32_t));
+    memcpy(&ring[0], &src[first], (count - first) * sizeof(int32_t));
+}
+
+/* Fills tap[0..num_samples] with the signal delayed by delay_samples + 1 down to delay_samples, i.e. the two
+ * neighbouring integer taps needed to interpolate every output sample of the block*/
+static void gather_tap(const int32_t *ring, int32_t curr_idx, const int32_t *samples, int32_t delay_samples,
+        int32_t *tap, int32_t num_samples) {
+    int32_t from_history = delay_samples + 1;
+    if (from_history > num_samples + 1) {
+        from_history = num_samples + 1;
+    }
+    ring_read(ring, curr_idx - delay_samples - 1, tap, from_history);
+    memcpy(&tap[from_history], samples, (num_samples + 1 - from_history) * sizeof(int32_t));
+}
+
+static inline int32_t interpolate(const int32_t *tap, int32_t i, int32_t frac) {
+    int64_t a = tap[i + 1];
+    int64_t b = tap[i];
+    return (int32_t)(a + (((b - a) * frac) >> DELAY_BUF_FRAC_BITS));
+}
+
+void delay_buffer_init(delay_buf_state_t *state, int default_delay_samples) {
+    memset(state->delay_buffer, 0, sizeof(state->delay_buffer));
+    memset(&state->curr_idx[0], 0, sizeof(state->curr_idx));
+    state->delay_q = DELAY_BUF_SAMPLES_TO_Q(default_delay_samples);
+    state->prev_delay_q = state->delay_q;
+    state->crossfade = 0;
+}
+
+void delay_buffer_process_block(delay_buf_state_t *state, int32_t *samples, int32_t ch, int32_t delay_samples, int32_t num_samples) {
+    int32_t *ring = state->delay_buffer[ch];
+    int32_t curr_idx = state->curr_idx[ch];
+    int32_t from_history = (delay_samples < num_samples) ? delay_samples : num_samples;
+    int32_t history[AP_FRAME_ADVANCE];
+
+    // Read the delayed history before the new block can overwrite it, then store the new block
+    ring_read(ring, curr_idx - delay_samples, history, from_history);
+    ring_write(ring, curr_idx, samples, num_samples);
+
+    memmove(&samples[from_history], &samples[0], (num_samples - from_history) * sizeof(int32_t));
+    memcpy(&samples[0], history, from_history * sizeof(int32_t));
+
+    state->curr_idx[ch] = wrap_idx(curr_idx + num_samples);
+}
+
+static void process_channel(delay_buf_state_t *state, int32_t *samples, int32_t ch) {
+    int32_t delay_q = (state->delay_q < 0) ? -state->delay_q : state->delay_q;
+    int32_t frac = delay_q & ((1 << DELAY_BUF_FRAC_BITS) - 1);
+
+    if (!state->crossfade && (frac == 0)) {
+        delay_buffer_process_block(state, samples, ch, delay_q >> DELAY_BUF_FRAC_BITS, AP_FRAME_ADVANCE);
+        return;
+    }
+
+    int32_t *ring = state->delay_buffer[ch];
+    int32_t curr_idx = state->curr_idx[ch];
+    int32_t tap[AP_FRAME_ADVANCE + 1];
+    int32_t prev_tap[AP_FRAME_ADVANCE + 1];
+
+    gather_tap(ring, curr_idx, samples, delay_q >> DELAY_BUF_FRAC_BITS, tap, AP_FRAME_ADVANCE);
+    if (state->crossfade) {
+        int32_t prev_delay_q = (state->prev_delay_q < 0) ? -state->prev_delay_q : state->prev_delay_q;
+        gather_tap(ring, curr_idx, samples, prev_delay_q >> DELAY_BUF_FRAC_BITS, prev_tap, AP_FRAME_ADVANCE);
+        int32_t prev_frac = prev_delay_q & ((1 << DELAY_BUF_FRAC_BITS) - 1);
+        ring_write(ring, curr_idx, samples, AP_FRAME_ADVANCE);
+
+        // Linear crossfade over the frame, reaching the new delay on the last sample
+        for (int i = 0; i < AP_FRAME_ADVANCE; i++) {
+            int64_t from = interpolate(prev_tap, i, prev_frac);
+            int64_t to = interpolate(tap, i, frac);
+            samples[i] = (int32_t)(from + ((to - from) * (i + 1)) / AP_FRAME_ADVANCE);
+        }
+    } else {
+        ring_write(ring, curr_idx, samples, AP_FRAME_ADVANCE);
+        for (int i = 0; i < AP_FRAME_ADVANCE; i++) {
+            samples[i] = interpolate(tap, i, frac);
+        }
+    }
+
+    state->curr_idx[ch] = wrap_idx(curr_idx + AP_FRAME_ADVANCE);
+}
+
+void delay_buffer_process_frame(delay_buf_state_t *state,
+        int32_t (*input_y_data)[AP_FRAME_ADVANCE],
+        int32_t (*input_x_data)[AP_FRAME_ADVANCE]) {
+    int32_t (*input)[AP_FRAME_ADVANCE] = (state->delay_q >= 0) ? input_y_data : input_x_data;
+
+    for (int ch = 0; ch < MAX_DELAY_BUF_CHANNELS; ch++) {
+        process_channel(state, input[ch], ch);
+    }
+    state->crossfade = 0;
+}
+
+void delay_buffer_set_delay(delay_buf_state_t *state, int32_t delay_q) {
+    if (delay_q > DELAY_BUF_MAX_DELAY_Q) {
+        delay_q = DELAY_BUF_MAX_DELAY_Q;
+    } else if (delay_q < -DELAY_BUF_MAX_DELAY_Q) {
+        delay_q = -DELAY_BUF_MAX_DELAY_Q;
+    }
+
+    if ((delay_q >= 0) == (state->delay_q >= 0)) {
+        // If a crossfade is still pending, this one starts where that one would have started
+        if (!state->crossfade) {
+            state->prev_delay_q = state->delay_q;
+        }
+        state->crossfade = (delay_q != state->prev_delay_q);
+    } else {
+        memset(state->delay_buffer, 0, sizeof(state->delay_buffer));
+        state->crossfade = 0;
+    }
+    state->delay_q = delay_q;
+}
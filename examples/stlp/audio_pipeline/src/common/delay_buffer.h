@@ -0,0 +1,46 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef DELAY_BUFFER_H_
+#define DELAY_BUFFER_H_
+
+/* Shared by the adec and adec_alt_arch pipelines, each of which provides the buffer sizes in its own header */
+#include "audio_pipeline_dsp.h"
+
+/* Number of fractional bits in a delay. Delays with a fractional part are linearly interpolated */
+#define DELAY_BUF_FRAC_BITS (8)
+
+#define DELAY_BUF_SAMPLES_TO_Q(samples) ((int32_t)(samples) * (1 << DELAY_BUF_FRAC_BITS))
+
+typedef struct {
+    // Circular buffer to store the samples
+    int32_t delay_buffer[MAX_DELAY_BUF_CHANNELS][DELAY_BUF_MAX_DELAY_SAMPLES];
+    // index of the value for the samples to be stored in the buffer
+    int32_t curr_idx[MAX_DELAY_BUF_CHANNELS];
+    // Mic delay in samples, in Q(DELAY_BUF_FRAC_BITS). A negative delay delays the reference instead
+    int32_t delay_q;
+    // Delay that the next frame crossfades from, when crossfade is set
+    int32_t prev_delay_q;
+    int32_t crossfade;
+} delay_buf_state_t;
+
+void delay_buffer_init(delay_buf_state_t *state, int default_delay_samples);
+
+/** Delay one block of num_samples samples of channel ch in place by delay_samples, which must be less than
+ * DELAY_BUF_MAX_DELAY_SAMPLES. num_samples must be at most AP_FRAME_ADVANCE. The ring buffer is accessed with at
+ * most two contiguous copies each way.*/
+void delay_buffer_process_block(delay_buf_state_t *state, int32_t *samples, int32_t ch, int32_t delay_samples, int32_t num_samples);
+
+/** Delay a frame in place by the current delay. A positive delay delays the mic (y) channels. The mics can't be
+ * advanced, so a negative delay delays the reference (x) channels instead.*/
+void delay_buffer_process_frame(delay_buf_state_t *state,
+        int32_t (*input_y_data)[AP_FRAME_ADVANCE],
+        int32_t (*input_x_data)[AP_FRAME_ADVANCE]);
+
+/** Set a new delay, in Q(DELAY_BUF_FRAC_BITS) samples. If the same channels stay delayed, the next frame crossfades
+ * from the old delay to the new one. If the sign flips, the buffer holds the history of the wrong channels, so the
+ * whole buffer of every channel is cleared and the newly delayed channels output silence for the first delay samples.
+ * The per sample delay this replaced only cleared the last delay samples of the channel being reset.*/
+void delay_buffer_set_delay(delay_buf_state_t *state, int32_t delay_q);
+
+#endif /* DELAY_BUFFER_H_ */
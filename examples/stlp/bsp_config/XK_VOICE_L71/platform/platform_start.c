@@ -102,7 +102,7 @@ static void mics_start(void)
 {
     rtos_mic_array_rpc_config(mic_array_ctx, appconfMIC_ARRAY_RPC_PORT, appconfMIC_ARRAY_RPC_PRIORITY);
 
-#if ON_TILE(MICARRAY_TILE_NO)
+#if ON_TILE(MICARRAY_TILE_NO) && !appconfPDM_MICS_PARKED
     rtos_mic_array_start(
             mic_array_ctx,
             2 * MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME,
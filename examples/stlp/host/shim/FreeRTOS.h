@@ -0,0 +1,40 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef HOST_SHIM_FREERTOS_H_
+#define HOST_SHIM_FREERTOS_H_
+
+/*
+ * Minimal subset of the FreeRTOS API used by the STLP audio pipeline
+ * sources, mapped onto the C library so that they can be compiled and
+ * run natively on the build host.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+typedef size_t configSTACK_DEPTH_TYPE;
+
+#define pdFALSE                   ((BaseType_t) 0)
+#define pdTRUE                    ((BaseType_t) 1)
+#define pdPASS                    pdTRUE
+#define pdFAIL                    pdFALSE
+#define portMAX_DELAY             ((TickType_t) 0xffffffffUL)
+#define pdMS_TO_TICKS(ms)         ((TickType_t) (ms))
+
+#define configMAX_PRIORITIES      32
+#define configMINIMAL_STACK_SIZE  0
+
+#define configASSERT(x)           assert(x)
+#define RTOS_THREAD_STACK_SIZE(x) 0
+#define RTOS_MEMORY_BARRIER()     __sync_synchronize()
+
+#define pvPortMalloc(size)        malloc(size)
+#define vPortFree(ptr)            free(ptr)
+
+#endif /* HOST_SHIM_FREERTOS_H_ */
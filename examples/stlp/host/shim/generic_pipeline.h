@@ -0,0 +1,37 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef HOST_SHIM_GENERIC_PIPELINE_H_
+#define HOST_SHIM_GENERIC_PIPELINE_H_
+
+#include <stddef.h>
+
+typedef void * (*pipeline_input_t)(void *input_data);
+typedef int (*pipeline_output_t)(void *data, void *output_data);
+typedef void (*pipeline_stage_t)(void *data);
+
+/*
+ * Same signature as the RTOS generic pipeline. On the host no tasks are
+ * created; the pipeline is registered and then stepped one frame at a time
+ * with host_pipeline_process_frame().
+ */
+void generic_pipeline_init(
+        const pipeline_input_t input,
+        const pipeline_output_t output,
+        void * const input_data,
+        void * const output_data,
+        const pipeline_stage_t * const stage_functions,
+        const size_t * const stage_stack_sizes,
+        const int pipeline_priority,
+        const int stage_count);
+
+/* Returns the number of pipelines registered with generic_pipeline_init() */
+int host_pipeline_count(void);
+
+/*
+ * Runs one frame through the input function, every stage and the output
+ * function of the given pipeline, in registration order.
+ */
+void host_pipeline_process_frame(int pipeline);
+
+#endif /* HOST_SHIM_GENERIC_PIPELINE_H_ */
@@ -0,0 +1,46 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef HOST_SHIM_DRIVER_INSTANCES_H_
+#define HOST_SHIM_DRIVER_INSTANCES_H_
+
+#include <stddef.h>
+#include "xcore/assert.h"
+
+/*
+ * The host build compiles each tile's pipeline source separately with
+ * THIS_XCORE_TILE set, exactly as the xcore build does.
+ */
+#ifndef ON_TILE
+#define ON_TILE(t) (!defined(THIS_XCORE_TILE) || THIS_XCORE_TILE == (t))
+#endif
+
+#define FLASH_TILE_NO      0
+#define I2C_TILE_NO        0
+#define USB_TILE_NO        0
+#define MICARRAY_TILE_NO   1
+#define I2S_TILE_NO        1
+
+typedef struct rtos_intertile_struct rtos_intertile_t;
+
+extern rtos_intertile_t *intertile_ctx;
+
+/*
+ * In-memory replacement for the intertile link. Each port holds at most one
+ * message, which is enough because the host runner steps the tile 1 and
+ * tile 0 pipelines alternately.
+ */
+void rtos_intertile_tx(rtos_intertile_t *ctx,
+                       unsigned port,
+                       void *msg,
+                       size_t len);
+
+size_t rtos_intertile_rx_len(rtos_intertile_t *ctx,
+                             unsigned port,
+                             unsigned timeout);
+
+size_t rtos_intertile_rx_data(rtos_intertile_t *ctx,
+                              void *data,
+                              size_t len);
+
+#endif /* HOST_SHIM_DRIVER_INSTANCES_H_ */
@@ -0,0 +1,10 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef HOST_SHIM_QUEUE_H_
+#define HOST_SHIM_QUEUE_H_
+
+/* Nothing from this header is needed by the host build of the pipeline */
+#include "FreeRTOS.h"
+
+#endif /* HOST_SHIM_QUEUE_H_ */
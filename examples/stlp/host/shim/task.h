@@ -0,0 +1,18 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef HOST_SHIM_TASK_H_
+#define HOST_SHIM_TASK_H_
+
+#include "FreeRTOS.h"
+
+/* The host runner is single threaded, so there is never anything to wait for */
+static inline void vTaskDelay(const TickType_t ticks)
+{
+    (void) ticks;
+}
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+#endif /* HOST_SHIM_TASK_H_ */
@@ -0,0 +1,11 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef HOST_SHIM_XCORE_ASSERT_H_
+#define HOST_SHIM_XCORE_ASSERT_H_
+
+#include <assert.h>
+
+#define xassert(e) assert(e)
+
+#endif /* HOST_SHIM_XCORE_ASSERT_H_ */
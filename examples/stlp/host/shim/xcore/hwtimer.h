@@ -0,0 +1,18 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef HOST_SHIM_XCORE_HWTIMER_H_
+#define HOST_SHIM_XCORE_HWTIMER_H_
+
+#include <stdint.h>
+#include <time.h>
+
+/* Emulates the 100 MHz xcore reference clock using the host monotonic clock */
+static inline uint32_t get_reference_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 100000000 + (uint64_t)ts.tv_nsec / 10);
+}
+
+#endif /* HOST_SHIM_XCORE_HWTIMER_H_ */
@@ -0,0 +1,142 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+/* STD headers */
+#include <string.h>
+#include <stdint.h>
+
+/* Shim headers */
+#include "FreeRTOS.h"
+#include "generic_pipeline.h"
+#include "platform/driver_instances.h"
+
+/* App headers */
+#include "audio_pipeline.h"
+
+#define HOST_PIPELINE_MAX_COUNT     2
+#define HOST_PIPELINE_MAX_STAGES    8
+#define HOST_INTERTILE_PORT_COUNT   16
+
+typedef struct {
+    pipeline_input_t input;
+    pipeline_output_t output;
+    void *input_data;
+    void *output_data;
+    pipeline_stage_t stages[HOST_PIPELINE_MAX_STAGES];
+    int stage_count;
+} host_pipeline_t;
+
+typedef struct {
+    void *msg;
+    size_t len;
+} host_intertile_msg_t;
+
+static host_pipeline_t pipelines[HOST_PIPELINE_MAX_COUNT];
+static int pipeline_count;
+
+static host_intertile_msg_t intertile_msgs[HOST_INTERTILE_PORT_COUNT];
+static host_intertile_msg_t *intertile_rx_pending;
+
+rtos_intertile_t *intertile_ctx = NULL;
+
+void generic_pipeline_init(
+        const pipeline_input_t input,
+        const pipeline_output_t output,
+        void * const input_data,
+        void * const output_data,
+        const pipeline_stage_t * const stage_functions,
+        const size_t * const stage_stack_sizes,
+        const int pipeline_priority,
+        const int stage_count)
+{
+    (void) stage_stack_sizes;
+    (void) pipeline_priority;
+
+    configASSERT(pipeline_count < HOST_PIPELINE_MAX_COUNT);
+    configASSERT(stage_count <= HOST_PIPELINE_MAX_STAGES);
+
+    host_pipeline_t *p = &pipelines[pipeline_count++];
+
+    p->input = input;
+    p->output = output;
+    p->input_data = input_data;
+    p->output_data = output_data;
+    p->stage_count = stage_count;
+    memcpy(p->stages, stage_functions, stage_count * sizeof(pipeline_stage_t));
+}
+
+int host_pipeline_count(void)
+{
+    return pipeline_count;
+}
+
+void host_pipeline_process_frame(int pipeline)
+{
+    configASSERT(pipeline < pipeline_count);
+
+    host_pipeline_t *p = &pipelines[pipeline];
+    void *data = p->input(p->input_data);
+
+    for (int i = 0; i < p->stage_count; i++) {
+        p->stages[i](data);
+    }
+
+    if (p->output(data, p->output_data) == AUDIO_PIPELINE_FREE_FRAME) {
+        vPortFree(data);
+    }
+}
+
+void rtos_intertile_tx(rtos_intertile_t *ctx,
+                       unsigned port,
+                       void *msg,
+                       size_t len)
+{
+    (void) ctx;
+    configASSERT(port < HOST_INTERTILE_PORT_COUNT);
+
+    host_intertile_msg_t *m = &intertile_msgs[port];
+
+    /* Nothing on the host drains a port concurrently, so it must be empty */
+    configASSERT(m->msg == NULL);
+
+    m->msg = pvPortMalloc(len);
+    m->len = len;
+    memcpy(m->msg, msg, len);
+}
+
+size_t rtos_intertile_rx_len(rtos_intertile_t *ctx,
+                             unsigned port,
+                             unsigned timeout)
+{
+    (void) ctx;
+    (void) timeout;
+    configASSERT(port < HOST_INTERTILE_PORT_COUNT);
+
+    host_intertile_msg_t *m = &intertile_msgs[port];
+
+    /* A receive that would block forever on the device is a runner bug */
+    configASSERT(m->msg != NULL);
+
+    intertile_rx_pending = m;
+    return m->len;
+}
+
+size_t rtos_intertile_rx_data(rtos_intertile_t *ctx,
+                              void *data,
+                              size_t len)
+{
+    (void) ctx;
+    configASSERT(intertile_rx_pending != NULL);
+
+    host_intertile_msg_t *m = intertile_rx_pending;
+
+    configASSERT(len <= m->len);
+    memcpy(data, m->msg, len);
+
+    vPortFree(m->msg);
+    m->msg = NULL;
+    m->len = 0;
+    intertile_rx_pending = NULL;
+
+    return len;
+}
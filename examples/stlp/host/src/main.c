@@ -0,0 +1,154 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+/*
+ * Host runner for the STLP audio pipeline.
+ *
+ * Reads a standard 4 channel test vector (Mic 1, Mic 0, Ref L, Ref R), the
+ * same file that tools/audio/process_wav.sh -c4 -a plays to the device,
+ * pushes it through the tile 1 and tile 0 pipeline stages one frame at a
+ * time and writes a wav file in the XCORE-VOICE output channel order
+ * (ASR, Comms, Ref L, Ref R, Mic 0, Mic 1).
+ */
+
+/* STD headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Shim headers */
+#include "FreeRTOS.h"
+#include "generic_pipeline.h"
+
+/* App headers */
+#include "app_conf.h"
+#include "audio_pipeline.h"
+#include "pipeline_profiler.h"
+#include "wav_file.h"
+
+#define HOST_INPUT_CHANNELS     4
+#define HOST_OUTPUT_CHANNELS    6
+
+/*
+ * The test vector channel for each pipeline input channel, in the
+ * XCORE-VOICE input order Ref L, Ref R, Mic 0, Mic 1, as remixed by
+ * process_wav.sh.
+ */
+static const int host_input_remix[HOST_INPUT_CHANNELS] = {2, 3, 1, 0};
+
+static int32_t host_input[HOST_INPUT_CHANNELS][appconfAUDIO_PIPELINE_FRAME_ADVANCE];
+static size_t host_frames_read;
+
+/* Each tile's pipeline source is compiled with its init function renamed */
+void audio_pipeline_init_tile0(void *input_app_data, void *output_app_data);
+void audio_pipeline_init_tile1(void *input_app_data, void *output_app_data);
+
+void audio_pipeline_input(void *input_app_data,
+                          int32_t **input_audio_frames,
+                          size_t ch_count,
+                          size_t frame_count)
+{
+    wav_file_t *wav = input_app_data;
+    int32_t *frames = (int32_t *)input_audio_frames;
+
+    configASSERT(ch_count == HOST_INPUT_CHANNELS);
+    configASSERT(frame_count == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+
+    /* A short read is zero filled, and a read error is reported once the pipeline has run */
+    host_frames_read += wav_file_read(wav, &host_input[0][0], frame_count);
+
+    /* input_audio_frames is really a flat int32_t[ch_count][frame_count] */
+    for (size_t ch = 0; ch < ch_count; ch++) {
+        memcpy(&frames[ch * frame_count], host_input[host_input_remix[ch]], frame_count * sizeof(int32_t));
+    }
+}
+
+int audio_pipeline_output(void *output_app_data,
+                          int32_t **output_audio_frames,
+                          size_t ch_count,
+                          size_t frame_count)
+{
+    wav_file_t *wav = output_app_data;
+
+    configASSERT(ch_count == HOST_OUTPUT_CHANNELS);
+
+    wav_file_write(wav, (const int32_t *)output_audio_frames, frame_count);
+
+    return AUDIO_PIPELINE_FREE_FRAME;
+}
+
+int main(int argc, char **argv)
+{
+    wav_file_t input_wav;
+    wav_file_t output_wav;
+    int status = EXIT_SUCCESS;
+
+    if (argc != 3 && argc != 5) {
+        fprintf(stderr, "Usage: %s input.wav output.wav [main_phases shadow_phases]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (wav_file_open_read(&input_wav, argv[1]) != 0) {
+        fprintf(stderr, "Unable to read %s as a 16 or 32 bit PCM wav file\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    if (input_wav.channels != HOST_INPUT_CHANNELS ||
+        input_wav.sample_rate != appconfAUDIO_PIPELINE_SAMPLE_RATE) {
+        fprintf(stderr, "%s must have %d channels at %d Hz\n",
+                argv[1], HOST_INPUT_CHANNELS, appconfAUDIO_PIPELINE_SAMPLE_RATE);
+        wav_file_close(&input_wav);
+        return EXIT_FAILURE;
+    }
+
+    if (wav_file_open_write(&output_wav, argv[2],
+                            HOST_OUTPUT_CHANNELS,
+                            appconfAUDIO_PIPELINE_SAMPLE_RATE,
+                            input_wav.bits_per_sample) != 0) {
+        fprintf(stderr, "Unable to create %s\n", argv[2]);
+        wav_file_close(&input_wav);
+        return EXIT_FAILURE;
+    }
+
+    /* Tile 1 is registered first so that it runs ahead of tile 0 */
+    audio_pipeline_init_tile1(&input_wav, NULL);
+    audio_pipeline_init_tile0(NULL, &output_wav);
+    configASSERT(host_pipeline_count() == 2);
+
+    if (argc == 5 && audio_pipeline_aec_phases_set(atoi(argv[3]), atoi(argv[4])) != 0) {
+        fprintf(stderr, "AEC filter of %s main and %s shadow phases does not fit in the AEC memory pools\n",
+                argv[3], argv[4]);
+        wav_file_close(&output_wav);
+        wav_file_close(&input_wav);
+        return EXIT_FAILURE;
+    }
+
+    /* The final partial frame is zero padded */
+    while (input_wav.frames_remaining > 0) {
+        host_pipeline_process_frame(0);
+        host_pipeline_process_frame(1);
+    }
+
+    if (input_wav.error) {
+        fprintf(stderr, "Error reading %s after %u frames\n", argv[1], (unsigned)host_frames_read);
+        status = EXIT_FAILURE;
+    }
+
+    printf("Processed %u frames of %d samples\n",
+           (unsigned)(output_wav.frames_written / appconfAUDIO_PIPELINE_FRAME_ADVANCE),
+           appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+
+#if PIPELINE_PROFILER_ENABLED
+    pipeline_profiler_report();
+    audio_pipeline_aec_cost_report();
+#endif
+
+    if (wav_file_close(&output_wav) != 0) {
+        fprintf(stderr, "Error writing %s\n", argv[2]);
+        status = EXIT_FAILURE;
+    }
+    wav_file_close(&input_wav);
+
+    return status;
+}
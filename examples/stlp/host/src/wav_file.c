@@ -0,0 +1,193 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+/* STD headers */
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "wav_file.h"
+
+#define WAV_FORMAT_PCM          1
+#define WAV_FORMAT_EXTENSIBLE   0xFFFE
+#define WAV_HEADER_BYTES        44
+
+static uint32_t read_le(const uint8_t *p, int bytes)
+{
+    uint32_t v = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static void write_le(uint8_t *p, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        p[i] = v & 0xFF;
+        v >>= 8;
+    }
+}
+
+int wav_file_open_read(wav_file_t *wav, const char *path)
+{
+    uint8_t hdr[12];
+    uint8_t chunk[8];
+    int have_fmt = 0;
+
+    memset(wav, 0, sizeof(wav_file_t));
+
+    wav->fp = fopen(path, "rb");
+    if (wav->fp == NULL) {
+        return -1;
+    }
+
+    if (fread(hdr, 1, sizeof(hdr), wav->fp) != sizeof(hdr) ||
+        memcmp(hdr, "RIFF", 4) != 0 ||
+        memcmp(&hdr[8], "WAVE", 4) != 0) {
+        goto fail;
+    }
+
+    while (fread(chunk, 1, sizeof(chunk), wav->fp) == sizeof(chunk)) {
+        uint32_t len = read_le(&chunk[4], 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[16];
+            if (len < sizeof(fmt) || fread(fmt, 1, sizeof(fmt), wav->fp) != sizeof(fmt)) {
+                goto fail;
+            }
+            uint32_t format = read_le(&fmt[0], 2);
+            if (format != WAV_FORMAT_PCM && format != WAV_FORMAT_EXTENSIBLE) {
+                goto fail;
+            }
+            wav->channels = read_le(&fmt[2], 2);
+            wav->sample_rate = read_le(&fmt[4], 4);
+            wav->bits_per_sample = read_le(&fmt[14], 2);
+            if (wav->bits_per_sample != 16 && wav->bits_per_sample != 32) {
+                goto fail;
+            }
+            if (fseek(wav->fp, (len - sizeof(fmt)) + (len & 1), SEEK_CUR) != 0) {
+                goto fail;
+            }
+            have_fmt = 1;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!have_fmt) {
+                goto fail;
+            }
+            wav->frames_remaining = len / (wav->channels * wav->bits_per_sample / 8);
+            return 0;
+        } else if (fseek(wav->fp, len + (len & 1), SEEK_CUR) != 0) {
+            goto fail;
+        }
+    }
+
+fail:
+    fclose(wav->fp);
+    wav->fp = NULL;
+    return -1;
+}
+
+int wav_file_open_write(wav_file_t *wav,
+                        const char *path,
+                        unsigned channels,
+                        unsigned sample_rate,
+                        unsigned bits_per_sample)
+{
+    uint8_t hdr[WAV_HEADER_BYTES] = {0};
+
+    memset(wav, 0, sizeof(wav_file_t));
+
+    wav->fp = fopen(path, "wb");
+    if (wav->fp == NULL) {
+        return -1;
+    }
+    wav->channels = channels;
+    wav->sample_rate = sample_rate;
+    wav->bits_per_sample = bits_per_sample;
+    wav->write_mode = 1;
+
+    /* Written again with the final sizes on close */
+    return fwrite(hdr, 1, sizeof(hdr), wav->fp) == sizeof(hdr) ? 0 : -1;
+}
+
+size_t wav_file_read(wav_file_t *wav, int32_t *samples, size_t frame_count)
+{
+    const unsigned bytes_per_sample = wav->bits_per_sample / 8;
+    size_t frames_read = 0;
+    uint8_t buf[8 * sizeof(int32_t)];
+
+    memset(samples, 0, frame_count * wav->channels * sizeof(int32_t));
+
+    while (frames_read < frame_count && wav->frames_remaining > 0) {
+        const size_t len = wav->channels * bytes_per_sample;
+
+        if (len > sizeof(buf) || fread(buf, 1, len, wav->fp) != len) {
+            wav->frames_remaining = 0;
+            wav->error = 1;
+            break;
+        }
+        for (unsigned ch = 0; ch < wav->channels; ch++) {
+            uint32_t v = read_le(&buf[ch * bytes_per_sample], bytes_per_sample);
+            samples[ch * frame_count + frames_read] = (int32_t)(v << (32 - wav->bits_per_sample));
+        }
+        frames_read++;
+        wav->frames_remaining--;
+    }
+
+    return frames_read;
+}
+
+void wav_file_write(wav_file_t *wav, const int32_t *samples, size_t frame_count)
+{
+    const unsigned bytes_per_sample = wav->bits_per_sample / 8;
+    uint8_t buf[8 * sizeof(int32_t)];
+
+    for (size_t i = 0; i < frame_count; i++) {
+        for (unsigned ch = 0; ch < wav->channels; ch++) {
+            uint32_t v = (uint32_t)samples[ch * frame_count + i] >> (32 - wav->bits_per_sample);
+            write_le(&buf[ch * bytes_per_sample], v, bytes_per_sample);
+        }
+        if (fwrite(buf, 1, wav->channels * bytes_per_sample, wav->fp) != wav->channels * bytes_per_sample) {
+            wav->error = 1;
+        }
+    }
+    wav->frames_written += frame_count;
+}
+
+int wav_file_close(wav_file_t *wav)
+{
+    if (wav->fp == NULL) {
+        return -1;
+    }
+
+    if (wav->write_mode) {
+        uint8_t hdr[WAV_HEADER_BYTES];
+        const uint32_t block_align = wav->channels * wav->bits_per_sample / 8;
+        const uint32_t data_len = wav->frames_written * block_align;
+
+        memcpy(&hdr[0], "RIFF", 4);
+        write_le(&hdr[4], 36 + data_len, 4);
+        memcpy(&hdr[8], "WAVE", 4);
+        memcpy(&hdr[12], "fmt ", 4);
+        write_le(&hdr[16], 16, 4);
+        write_le(&hdr[20], WAV_FORMAT_PCM, 2);
+        write_le(&hdr[22], wav->channels, 2);
+        write_le(&hdr[24], wav->sample_rate, 4);
+        write_le(&hdr[28], wav->sample_rate * block_align, 4);
+        write_le(&hdr[32], block_align, 2);
+        write_le(&hdr[34], wav->bits_per_sample, 2);
+        memcpy(&hdr[36], "data", 4);
+        write_le(&hdr[40], data_len, 4);
+
+        if (fseek(wav->fp, 0, SEEK_SET) != 0 || fwrite(hdr, 1, sizeof(hdr), wav->fp) != sizeof(hdr)) {
+            wav->error = 1;
+        }
+    }
+
+    if (fclose(wav->fp) != 0 && wav->write_mode) {
+        wav->error = 1;
+    }
+    wav->fp = NULL;
+
+    return wav->write_mode && wav->error ? -1 : 0;
+}
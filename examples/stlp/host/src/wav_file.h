@@ -0,0 +1,60 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef WAV_FILE_H_
+#define WAV_FILE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+typedef struct {
+    FILE *fp;
+    unsigned channels;
+    unsigned sample_rate;
+    unsigned bits_per_sample;
+    uint32_t frames_remaining;
+    uint32_t frames_written;
+    int write_mode;
+    int error;          /* Set when a read or write fails */
+} wav_file_t;
+
+/*
+ * Opens a 16 or 32 bit PCM wav file for reading.
+ * Returns 0 on success.
+ */
+int wav_file_open_read(wav_file_t *wav, const char *path);
+
+/*
+ * Opens a PCM wav file for writing. The header is finalised by
+ * wav_file_close().
+ * Returns 0 on success.
+ */
+int wav_file_open_write(wav_file_t *wav,
+                        const char *path,
+                        unsigned channels,
+                        unsigned sample_rate,
+                        unsigned bits_per_sample);
+
+/*
+ * Reads up to frame_count frames into the channel-major buffer
+ * samples[ch][frame_count] as left justified Q31 values. Frames past the end
+ * of the file, or after a read error, are zero filled. A file that ends
+ * before the length given in its header sets error.
+ * Returns the number of frames read from the file.
+ */
+size_t wav_file_read(wav_file_t *wav, int32_t *samples, size_t frame_count);
+
+/*
+ * Writes frame_count frames from the channel-major buffer
+ * samples[ch][frame_count], truncating to the file's sample width. A write
+ * that fails sets error.
+ */
+void wav_file_write(wav_file_t *wav, const int32_t *samples, size_t frame_count);
+
+/*
+ * Closes the file, first finalising the header of a file opened for writing.
+ * Returns 0 on success, or -1 if any write to the file failed.
+ */
+int wav_file_close(wav_file_t *wav);
+
+#endif /* WAV_FILE_H_ */
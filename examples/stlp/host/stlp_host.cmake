@@ -0,0 +1,70 @@
+#**********************
+# Host (x86) build of the STLP adec audio pipeline
+#**********************
+set(STLP_HOST_AP_DIR ${CMAKE_CURRENT_LIST_DIR}/../audio_pipeline)
+
+set(STLP_HOST_INCLUDES
+    ${CMAKE_CURRENT_LIST_DIR}/shim
+    ${CMAKE_CURRENT_LIST_DIR}/src
+    ${CMAKE_CURRENT_LIST_DIR}/../src
+    ${STLP_HOST_AP_DIR}/api
+    ${STLP_HOST_AP_DIR}/src/adec
+    ${STLP_HOST_AP_DIR}/src/adec/aec
+    ${STLP_HOST_AP_DIR}/src/adec/stage1
+    ${STLP_HOST_AP_DIR}/src/common
+)
+
+set(STLP_HOST_COMPILE_DEFINITIONS
+    MIC_ARRAY_CONFIG_MIC_COUNT=2
+    MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME=240
+    MIC_ARRAY_CONFIG_MCLK_FREQ=24576000
+    MIC_ARRAY_CONFIG_PDM_FREQ=3072000
+)
+
+set(STLP_HOST_LINK_LIBRARIES
+    sln_voice::pipeline_profiler
+    sln_voice::frame_pool
+    sln_voice::frame_codec
+    fwk_voice::adec
+    fwk_voice::aec
+    fwk_voice::agc
+    fwk_voice::ic
+    fwk_voice::ns
+    fwk_voice::vnr::features
+    fwk_voice::vnr::inference
+)
+
+## Each tile's pipeline source is built on its own so that ON_TILE() selects
+## the right half and the two audio_pipeline_init() definitions do not clash.
+foreach(TILE 0 1)
+    add_library(example_stlp_adec_host_tile${TILE} OBJECT EXCLUDE_FROM_ALL)
+    target_sources(example_stlp_adec_host_tile${TILE}
+        PRIVATE
+            ${STLP_HOST_AP_DIR}/src/adec/audio_pipeline_t${TILE}.c
+    )
+    target_include_directories(example_stlp_adec_host_tile${TILE} PRIVATE ${STLP_HOST_INCLUDES})
+    target_compile_definitions(example_stlp_adec_host_tile${TILE}
+        PRIVATE
+            ${STLP_HOST_COMPILE_DEFINITIONS}
+            THIS_XCORE_TILE=${TILE}
+            audio_pipeline_init=audio_pipeline_init_tile${TILE}
+    )
+    target_link_libraries(example_stlp_adec_host_tile${TILE} PRIVATE ${STLP_HOST_LINK_LIBRARIES})
+endforeach()
+
+add_executable(example_stlp_adec_host EXCLUDE_FROM_ALL)
+target_sources(example_stlp_adec_host
+    PRIVATE
+        ${CMAKE_CURRENT_LIST_DIR}/src/main.c
+        ${CMAKE_CURRENT_LIST_DIR}/src/host_pipeline.c
+        ${CMAKE_CURRENT_LIST_DIR}/src/wav_file.c
+        ${STLP_HOST_AP_DIR}/src/common/delay_buffer.c
+        ${STLP_HOST_AP_DIR}/src/adec/stage1/stage_1.c
+        ${STLP_HOST_AP_DIR}/src/adec/aec/aec_process_frame_1thread.c
+        $<TARGET_OBJECTS:example_stlp_adec_host_tile0>
+        $<TARGET_OBJECTS:example_stlp_adec_host_tile1>
+)
+target_include_directories(example_stlp_adec_host PRIVATE ${STLP_HOST_INCLUDES})
+target_compile_definitions(example_stlp_adec_host PRIVATE ${STLP_HOST_COMPILE_DEFINITIONS})
+target_compile_options(example_stlp_adec_host PRIVATE -O2 -g)
+target_link_libraries(example_stlp_adec_host PRIVATE ${STLP_HOST_LINK_LIBRARIES} m)
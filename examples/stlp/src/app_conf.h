@@ -84,6 +84,16 @@
 #define appconfEXTERNAL_MCLK       0
 #endif
 
+/*
+ * When enabled the USB audio streams are resampled to follow the host's
+ * clock, and the app PLL is left at its nominal rate. This lets USB run with
+ * an external MCLK, such as one shared with an I2S master, at the cost of
+ * the resampler's processing and three quarters of a millisecond of latency each way.
+ */
+#ifndef appconfUSB_AUDIO_ASRC
+#define appconfUSB_AUDIO_ASRC      0
+#endif
+
 /*
  * This option sends all 6 16 KHz channels (two channels of processed audio,
  * stereo reference audio, and stereo microphone audio) out over a single
@@ -111,12 +121,46 @@
 #define appconfMIC_SRC_DEFAULT     appconfMIC_SRC_MICS
 #endif
 
+/*
+ * When enabled, while the mics are taken from USB the audio pipeline input
+ * waits for each frame from the host rather than for one from the PDM mics,
+ * so the pipeline runs at whatever pace the host sends audio and no frame is
+ * ever filled with zeros. appconfPDM_MICS_PARKED additionally never starts
+ * the PDM mics, which then always come from USB.
+ */
+#ifndef appconfUSB_MIC_CLOCKED
+#define appconfUSB_MIC_CLOCKED     0
+#endif
+
+#ifndef appconfPDM_MICS_PARKED
+#define appconfPDM_MICS_PARKED     0
+#endif
+
+#if appconfPDM_MICS_PARKED && !(appconfUSB_ENABLED && appconfUSB_MIC_CLOCKED)
+#error appconfPDM_MICS_PARKED requires appconfUSB_ENABLED and appconfUSB_MIC_CLOCKED
+#endif
+
 #define appconfUSB_AUDIO_RELEASE   0
 #define appconfUSB_AUDIO_TESTING   1
 #ifndef appconfUSB_AUDIO_MODE
 #define appconfUSB_AUDIO_MODE      appconfUSB_AUDIO_RELEASE
 #endif
 
+/*
+ * Format of the audio sent from the tile 1 to the tile 0 audio pipeline,
+ * one of the FRAME_CODEC_* formats in frame_codec.h. The compact formats
+ * reduce the intertile link bandwidth and transfer time, at the cost of
+ * encoding and decoding each frame.
+ */
+#ifndef appconfAUDIO_PIPELINE_WIRE_FORMAT
+#define appconfAUDIO_PIPELINE_WIRE_FORMAT   FRAME_CODEC_INT32
+#endif
+
+/* Output paths measured when the latency probe is enabled */
+#define appconfLATENCY_PROBE_PATH_I2S   0
+#define appconfLATENCY_PROBE_PATH_USB   1
+#define appconfLATENCY_PROBE_PATH_WW    2
+
 #define appconfSPI_AUDIO_RELEASE   0
 #define appconfSPI_AUDIO_TESTING   1
 #ifndef appconfSPI_AUDIO_MODE
@@ -8,8 +8,8 @@
 #error Cannot use both USB and SPI interfaces
 #endif
 
-#if appconfUSB_ENABLED && appconfEXTERNAL_MCLK
-#error Cannot use USB with an external mclk source
+#if appconfUSB_ENABLED && appconfEXTERNAL_MCLK && !appconfUSB_AUDIO_ASRC
+#error Cannot use USB with an external mclk source unless appconfUSB_AUDIO_ASRC is enabled
 #endif
 
 #if appconfI2S_TDM_ENABLED && appconfI2S_AUDIO_SAMPLE_RATE != 3*appconfAUDIO_PIPELINE_SAMPLE_RATE
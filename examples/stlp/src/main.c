@@ -4,6 +4,7 @@
 #include <platform.h>
 #include <xs1.h>
 #include <xcore/channel.h>
+#include <xscope.h>
 
 /* FreeRTOS headers */
 #include "FreeRTOS.h"
@@ -22,6 +23,9 @@
 #include "usb_support.h"
 #include "usb_audio.h"
 #include "audio_pipeline.h"
+#include "pipeline_profiler.h"
+#include "latency_probe.h"
+#include "frame_pool.h"
 #include "ww_model_runner/ww_model_runner.h"
 #include "fs_support.h"
 
@@ -67,8 +71,23 @@ void audio_pipeline_input(void *input_app_data,
     (void) input_app_data;
     int32_t **mic_ptr = (int32_t **)(input_audio_frames + (2 * frame_count));
 
+#if appconfUSB_ENABLED && appconfUSB_MIC_CLOCKED
+    /*
+     * The USB stream sets the pace while it is the mic source. The PDM mics
+     * are left unread, so their backlog is flushed again on switching back.
+     */
+    const int usb_clocked = appconfPDM_MICS_PARKED || mic_from_usb;
+#else
+    const int usb_clocked = 0;
+#endif
+
     static int flushed;
-    while (!flushed) {
+
+    if (usb_clocked) {
+        flushed = 0;
+    }
+
+    while (!usb_clocked && !flushed) {
         size_t received;
         received = rtos_mic_array_rx(mic_array_ctx,
                                      mic_ptr,
@@ -84,36 +103,45 @@ void audio_pipeline_input(void *input_app_data,
     }
 
     /*
-     * NOTE: ALWAYS receive the next frame from the PDM mics,
-     * even if USB is the current mic source. The controls the
+     * NOTE: Unless clocked by USB, ALWAYS receive the next frame from the
+     * PDM mics, even if USB is the current mic source. The controls the
      * timing since usb_audio_recv() does not block and will
      * receive all zeros if no frame is available yet.
      */
-    rtos_mic_array_rx(mic_array_ctx,
-                      mic_ptr,
-                      frame_count,
-                      portMAX_DELAY);
+    if (!usb_clocked) {
+        rtos_mic_array_rx(mic_array_ctx,
+                          mic_ptr,
+                          frame_count,
+                          portMAX_DELAY);
+    }
 
 #if appconfUSB_ENABLED
     int32_t **usb_mic_audio_frame = NULL;
-    size_t ch_cnt = 2;  /* ref frames */
 
-    if (aec_ref_source == appconfAEC_REF_USB) {
+    if (aec_ref_source == appconfAEC_REF_USB || usb_clocked) {
         usb_mic_audio_frame = input_audio_frames;
     }
 
-    if (mic_from_usb) {
-        ch_count += 2;  /* mic frames */
-    }
+    if (usb_clocked) {
+        /* ref L, ref R, mic 0, mic 1. Any I2S reference replaces the first two below. */
+        usb_audio_recv_blocking(intertile_ctx,
+                                frame_count,
+                                usb_mic_audio_frame,
+                                ch_count + 2);
+    } else {
+        if (mic_from_usb) {
+            ch_count += 2;  /* mic frames */
+        }
 
-    /*
-     * As noted above, this does not block.
-     * and expects ref L, ref R, mic 0, mic 1
-     */
-    usb_audio_recv(intertile_ctx,
-                   frame_count,
-                   usb_mic_audio_frame,
-                   ch_count);
+        /*
+         * As noted above, this does not block.
+         * and expects ref L, ref R, mic 0, mic 1
+         */
+        usb_audio_recv(intertile_ctx,
+                       frame_count,
+                       usb_mic_audio_frame,
+                       ch_count);
+    }
 #endif
 
 #if appconfI2S_ENABLED
@@ -165,6 +193,9 @@ int audio_pipeline_output(void *output_app_data,
                 (int32_t*) tmp,
                 frame_count,
                 portMAX_DELAY);
+#if LATENCY_PROBE_ENABLED
+    latency_probe_record(appconfLATENCY_PROBE_PATH_I2S);
+#endif
 #else
     int32_t *tmpptr = (int32_t *)output_audio_frames;
     for (int i = 0; i < frame_count; i++) {
@@ -186,6 +217,11 @@ int audio_pipeline_output(void *output_app_data,
                     tdm_output,
                     appconfI2S_AUDIO_SAMPLE_RATE / appconfAUDIO_PIPELINE_SAMPLE_RATE,
                     portMAX_DELAY);
+#if LATENCY_PROBE_ENABLED
+        if (i == 0) {
+            latency_probe_record(appconfLATENCY_PROBE_PATH_I2S);
+        }
+#endif
     }
 #endif
 #elif appconfI2S_MODE == appconfI2S_MODE_SLAVE
@@ -313,6 +349,19 @@ static void mem_analysis(void)
 {
 	for (;;) {
 		rtos_printf("Tile[%d]:\n\tMinimum heap free: %d\n\tCurrent heap free: %d\n", THIS_XCORE_TILE, xPortGetMinimumEverFreeHeapSize(), xPortGetFreeHeapSize());
+		frame_pool_report();
+#if PIPELINE_PROFILER_ENABLED
+		pipeline_profiler_report();
+#if ON_TILE(1)
+		audio_pipeline_aec_cost_report();
+#endif
+#endif
+#if LATENCY_PROBE_ENABLED && ON_TILE(0)
+		latency_probe_report(LATENCY_HIST);
+#endif
+#if appconfUSB_ENABLED
+		usb_audio_stats_report(USB_AUDIO_STATS);
+#endif
 		vTaskDelay(pdMS_TO_TICKS(5000));
 	}
 }
@@ -336,6 +385,18 @@ void startup_task(void *arg)
     gpio_test(gpio_ctx_t0);
 #endif
 
+#if LATENCY_PROBE_ENABLED && ON_TILE(0)
+#if appconfI2S_ENABLED && (appconfI2S_MODE == appconfI2S_MODE_MASTER)
+    latency_probe_init(appconfLATENCY_PROBE_PATH_I2S, "i2s");
+#endif
+#if appconfUSB_ENABLED
+    latency_probe_init(appconfLATENCY_PROBE_PATH_USB, "usb");
+#endif
+#if appconfWW_ENABLED
+    latency_probe_init(appconfLATENCY_PROBE_PATH_WW, "ww");
+#endif
+#endif
+
     audio_pipeline_init(NULL, NULL);
 
 #if ON_TILE(FS_TILE_NO)
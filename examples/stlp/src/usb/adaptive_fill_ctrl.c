@@ -0,0 +1,150 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "adaptive_fill_ctrl.h"
+
+#if __xcore__
+#include "app_conf.h"
+/*
+ * The pipeline writes a frame at a time and USB reads a millisecond at a
+ * time, so the fill level is a sawtooth with a period of one frame. Once
+ * the output is primed with two frames it falls to about one frame before
+ * the next frame arrives, so aim for a mean of one and a half frames.
+ */
+#define FILL_PACKETS_PER_FRAME (appconfAUDIO_PIPELINE_FRAME_ADVANCE / (appconfAUDIO_PIPELINE_SAMPLE_RATE / 1000))
+#define FILL_TARGET            (appconfAUDIO_PIPELINE_FRAME_ADVANCE + appconfAUDIO_PIPELINE_FRAME_ADVANCE / 2)
+/*
+ * Samples from the host are taken a frame at a time as soon as a frame is
+ * buffered, so their fill level is a sawtooth that peaks a little over one
+ * frame. Aim for a mean of one frame, which leaves about half a frame either
+ * side of it.
+ */
+#define FILL_FROM_HOST_TARGET  appconfAUDIO_PIPELINE_FRAME_ADVANCE
+#else //__xcore__
+// If we're compiling this for x86 we're probably testing it - just assume some values
+#define FILL_PACKETS_PER_FRAME 15  // 240 sample frames at 16kHz
+#define FILL_TARGET            360
+#define FILL_FROM_HOST_TARGET  240
+#endif //__xcore__
+
+#ifndef FILL_AVERAGE_FRAMES
+#define FILL_AVERAGE_FRAMES    4
+#endif
+#define FILL_AVERAGE_PACKETS   (FILL_AVERAGE_FRAMES * FILL_PACKETS_PER_FRAME)
+
+#define PPM(x) ((int32_t)((x) * 2147.483648))
+
+/*
+ * Proportional and integral gains, as rate trim per sample of mean fill
+ * error. The fill is averaged over FILL_AVERAGE_FRAMES so that the time a
+ * frame lands within a millisecond adds little noise, and the integral
+ * gain applies once per average. With 16 samples per millisecond and the
+ * app PLL's steps of about 10 ppm these give a damping ratio of about 0.5
+ * and settle within two minutes.
+ */
+#ifndef FILL_KP
+#define FILL_KP                PPM(2)
+#endif
+#ifndef FILL_KI
+#define FILL_KI                PPM(0.004)
+#endif
+
+/*
+ * The rate estimate corrects for most of the drift when the host is
+ * streaming out, so the trim only needs to cover the crystal tolerances
+ * when it is not.
+ */
+#ifndef FILL_TRIM_LIMIT
+#define FILL_TRIM_LIMIT        PPM(500)
+#endif
+
+#define FILL_INTEGRAL_LIMIT    (((int64_t)FILL_TRIM_LIMIT * FILL_AVERAGE_PACKETS) / FILL_KI)
+
+static bool running = false;
+static uint32_t packet_count;
+static int64_t error_sum;
+static int64_t integral;
+static int32_t trim;
+
+void reset_fill_level_trim()
+{
+    running = false;
+}
+
+int32_t determine_fill_level_trim(int32_t fill_level)
+{
+    if (fill_level < 0)
+    {
+        running = false;
+        return 0;
+    }
+
+    if (!running)
+    {
+        running = true;
+        packet_count = 0;
+        error_sum = 0;
+        integral = 0;
+        trim = 0;
+    }
+
+    // Averaging over one whole period of the sawtooth removes it
+    error_sum += fill_level - FILL_TARGET;
+
+    if (++packet_count < FILL_AVERAGE_PACKETS)
+    {
+        return trim;
+    }
+
+    integral += error_sum;
+    if (integral > FILL_INTEGRAL_LIMIT)
+    {
+        integral = FILL_INTEGRAL_LIMIT;
+    }
+    else if (integral < -FILL_INTEGRAL_LIMIT)
+    {
+        integral = -FILL_INTEGRAL_LIMIT;
+    }
+
+    // A buffer filling up means the device is producing samples too quickly, so slow it down
+    int64_t output = -((int64_t)FILL_KP * error_sum + (int64_t)FILL_KI * integral) / FILL_AVERAGE_PACKETS;
+
+    if (output > FILL_TRIM_LIMIT)
+    {
+        output = FILL_TRIM_LIMIT;
+    }
+    else if (output < -FILL_TRIM_LIMIT)
+    {
+        output = -FILL_TRIM_LIMIT;
+    }
+
+    trim = (int32_t)output;
+    packet_count = 0;
+    error_sum = 0;
+
+    return trim;
+}
+
+int32_t determine_fill_level_trim_from_host(int32_t fill_level)
+{
+    if (fill_level < 0)
+    {
+        return determine_fill_level_trim(-1);
+    }
+
+    /*
+     * Samples from the host back up when the device is too slow rather than
+     * too fast, so reflect the level about the target before using the same
+     * controller.
+     */
+    int32_t reflected = FILL_TARGET - (fill_level - FILL_FROM_HOST_TARGET);
+    if (reflected < 0)
+    {
+        reflected = 0;
+    }
+
+    return determine_fill_level_trim(reflected);
+}
@@ -0,0 +1,27 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+// This file intentionally only includes pure generic C constructs to allow compilation and testing by an x86 processor.
+
+#include <stdint.h>
+
+/*
+ * Returns the trim, in the same UQ31 units as the result of
+ * determine_USB_audio_rate(), to add to the USB audio rate so that the
+ * samples buffered for the host settle at their target level.
+ *
+ * Called once per IN transfer with the number of samples per channel left
+ * in the buffer, or with a negative fill_level while the buffer is not being
+ * drained, which resets the controller and returns 0.
+ */
+int32_t determine_fill_level_trim(int32_t fill_level);
+
+/*
+ * As determine_fill_level_trim(), but for the samples buffered from the
+ * host, which are drained at the device's rate rather than the host's. Used
+ * when the USB audio is resampled and the host is not streaming in, so that
+ * its OUT stream alone steers the ratio. fill_level is negative while the
+ * host is not streaming out.
+ */
+int32_t determine_fill_level_trim_from_host(int32_t fill_level);
+void reset_fill_level_trim();
@@ -12,6 +12,10 @@
 
 #include "adaptive_rate_adjust.h"
 #include "adaptive_rate_callback.h"
+#include "adaptive_fill_ctrl.h"
+#include "rtos_intertile.h"
+#include "usb_audio.h"
+#include "app_conf.h"
 
 #include <stdbool.h>
 #include <xcore/port.h>
@@ -28,7 +32,8 @@
 #define USB_ADAPTIVE_TASK_PRIORITY (configMAX_PRIORITIES-1)
 #endif /* USB_ADAPTIVE_TASK_PRIORITY */
 
-#define DATA_EVENT_QUEUE_SIZE 1
+/* One OUT and one IN transfer may complete before the task runs */
+#define DATA_EVENT_QUEUE_SIZE 2
 
 typedef struct usb_audio_rate_packet_desc {
     uint32_t cur_time;
@@ -43,15 +48,48 @@ static void usb_adaptive_clk_manager(void *args) {
     (void) args;
 
     usb_audio_rate_packet_desc_t pkt_data;
-    static uint64_t prev_s;
-    uint32_t data_rate = 0;
-    uint64_t s = 0;
+    static int64_t prev_s;
+    uint32_t data_rate = 1u << 31;
+    int32_t fill_trim = 0;
+    int64_t s = 0;
 
     while(1) {
         xQueueReceive(data_event_queue, (void *)&pkt_data, portMAX_DELAY);
 
-        data_rate = determine_USB_audio_rate(pkt_data.cur_time, pkt_data.xfer_len, pkt_data.ep_dir, true);
-        s = (uint64_t)data_rate;
+        /*
+         * OUT transfers measure the host's rate. IN transfers drain the
+         * samples buffered for the host, whose fill level then trims that
+         * rate so that any drift left over, or all of it when the host is
+         * not streaming out, cannot overrun or underrun the buffer.
+         */
+        if (pkt_data.ep_dir == USB_DIR_OUT) {
+            data_rate = determine_USB_audio_rate(pkt_data.cur_time, pkt_data.xfer_len, pkt_data.ep_dir, true);
+#if appconfUSB_AUDIO_ASRC
+            /*
+             * Without a stream to the host only the samples buffered from it
+             * are left to trim the resampling ratio. The rate estimate is
+             * against the reference clock, which an external MCLK need not
+             * follow, so there is always some drift left for the trim.
+             */
+            if (usb_audio_to_host_fill_level() < 0) {
+                fill_trim = determine_fill_level_trim_from_host(usb_audio_from_host_fill_level());
+            }
+#endif
+        } else {
+            const int32_t fill_level = usb_audio_to_host_fill_level();
+
+            if (!appconfUSB_AUDIO_ASRC || fill_level >= 0) {
+                fill_trim = determine_fill_level_trim(fill_level);
+            }
+        }
+        s = (int64_t)data_rate + fill_trim;
+
+#if appconfUSB_AUDIO_ASRC
+        /* The app PLL is left alone and the USB audio resampled by s instead */
+        usb_audio_asrc_set_ratio((uint32_t)s);
+        continue;
+#endif
+
         /* The below manipulations calculate the required f value to scale the nominal app PLL (24.576MHz) by the data rate.
          * The relevant equations are from the XU316 datasheet, and are:
          *
@@ -86,13 +124,14 @@ static void usb_adaptive_clk_manager(void *args) {
          */
 
         s *= 102400;
-        s -= ((uint64_t)102251 << 31);
+        s -= ((int64_t)102251 << 31);
         s >>= 30;
         s = (s % 2) ? (s >> 1) + 1 : s >> 1;
 
         if (s != prev_s)
         {
             app_pll_set_numerator((int)s);
+            usb_audio_stats_rate_ctrl((uint32_t)s);
             //rtos_printf("New App PLL numerator: %d, data rate: %u\n", (int)s, data_rate);
         }
 
@@ -102,8 +141,7 @@ static void usb_adaptive_clk_manager(void *args) {
 
 bool tud_xcore_data_cb(uint32_t cur_time, uint32_t ep_num, uint32_t ep_dir, size_t xfer_len)
 {
-    if (ep_num == USB_AUDIO_EP &&
-        ep_dir == USB_DIR_OUT)
+    if (ep_num == USB_AUDIO_EP)
     {
         if(data_event_queue != NULL) {
             BaseType_t xHigherPriorityTaskWoken;
@@ -12,4 +12,11 @@ uint32_t determine_USB_audio_rate(uint32_t timestamp,
                                     uint32_t direction,
                                     bool update);
 void reset_state();
+
+/*
+ * Sets the number of bytes a transfer in direction is expected to carry at
+ * the nominal rate, for when the host changes the sample rate or format,
+ * and restarts the rate estimate in that direction.
+ */
+void set_expected_USB_audio_bytes(uint32_t direction, uint32_t bytes_per_transaction);
 void sof_toggle();
\ No newline at end of file
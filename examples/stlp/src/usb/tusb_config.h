@@ -77,9 +77,14 @@ extern const uint16_t tud_audio_desc_lengths[CFG_TUD_AUDIO];
 #define CFG_TUD_AUDIO_FUNC_1_N_AS_INT                       1
 #define CFG_TUD_AUDIO_FUNC_1_CTRL_BUF_SZ                    64
 
-/* TODO make these configurable in app_conf? */
+/*
+ * TODO make these configurable in app_conf?
+ * The TX values are those of the first microphone alternate setting. The
+ * others, in usb_descriptors.h, stream fewer channels or wider samples.
+ */
 #define CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX          2
 #define CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_RX          2
+#define CFG_TUD_AUDIO_FUNC_1_MAX_BYTES_PER_SAMPLE_TX        4
 
 #if appconfUSB_AUDIO_MODE == appconfUSB_AUDIO_RELEASE
 #define CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX                  2
@@ -106,9 +111,10 @@ extern const uint16_t tud_audio_desc_lengths[CFG_TUD_AUDIO];
 // To support USB Adaptive/Asynchronous, maximum packet size must be large enough to accommodate an extra set of samples per frame.
 // Adding 1 to AUDIO_SAMPLES_PER_USB_FRAME allows this.
 #define CFG_TUD_AUDIO_ENABLE_EP_IN                  1
-#define CFG_TUD_AUDIO_FUNC_1_EP_IN_SZ               ((AUDIO_FRAMES_PER_USB_FRAME + 1) * CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX)
-#define CFG_TUD_AUDIO_FUNC_1_EP_IN_SZ_MAX           (CFG_TUD_AUDIO_FUNC_1_EP_IN_SZ)    // Maximum EP IN size for all AS alternate settings used
-#define CFG_TUD_AUDIO_FUNC_1_EP_IN_SW_BUF_SZ        CFG_TUD_AUDIO_FUNC_1_EP_IN_SZ
+#define CFG_TUD_AUDIO_EP_IN_SZ(_channels, _bytes)   ((AUDIO_FRAMES_PER_USB_FRAME + 1) * (_bytes) * (_channels))
+#define CFG_TUD_AUDIO_FUNC_1_EP_IN_SZ               CFG_TUD_AUDIO_EP_IN_SZ(CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX, CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX)
+#define CFG_TUD_AUDIO_FUNC_1_EP_IN_SZ_MAX           CFG_TUD_AUDIO_EP_IN_SZ(CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX, CFG_TUD_AUDIO_FUNC_1_MAX_BYTES_PER_SAMPLE_TX)    // Maximum EP IN size for all AS alternate settings used
+#define CFG_TUD_AUDIO_FUNC_1_EP_IN_SW_BUF_SZ        CFG_TUD_AUDIO_FUNC_1_EP_IN_SZ_MAX
 
 #define CFG_TUD_AUDIO_ENABLE_EP_OUT                 1
 #define CFG_TUD_AUDIO_FUNC_1_EP_OUT_SZ              ((AUDIO_FRAMES_PER_USB_FRAME + 1) * CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_RX * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX)
@@ -30,20 +30,45 @@
 #include <stdio.h>
 #include <string.h>
 #include <xcore/hwtimer.h>
+#include <xscope.h>
 #include <src.h>
 
 #include "FreeRTOS.h"
-#include "stream_buffer.h"
 
 #include "usb_descriptors.h"
 #include "tusb.h"
 
 #include "rtos_intertile.h"
 
+#include "usb_audio.h"
+#include "adaptive_rate_adjust.h"
+#include "adaptive_rate_callback.h"
+#include "audio_ring.h"
+#include "src_block.h"
+#include "drift_src.h"
 #include "audio_pipeline.h"
+#include "latency_probe.h"
 
 #include "app_conf.h"
 
+/*
+ * The host may choose the pipeline's own rate, which needs no conversion, or
+ * three times it, but nothing above appconfUSB_AUDIO_SAMPLE_RATE, which the
+ * endpoints are sized for and which is used until the host chooses.
+ */
+#if appconfUSB_AUDIO_SAMPLE_RATE == 3 * appconfAUDIO_PIPELINE_SAMPLE_RATE
+#define USB_AUDIO_RATE_COUNT 2
+#else
+#define USB_AUDIO_RATE_COUNT 1
+#endif
+
+static const uint32_t usb_audio_rates[USB_AUDIO_RATE_COUNT] = {
+    appconfAUDIO_PIPELINE_SAMPLE_RATE,
+#if USB_AUDIO_RATE_COUNT > 1
+    3 * appconfAUDIO_PIPELINE_SAMPLE_RATE,
+#endif
+};
+
 // Audio controls
 // Current states
 bool mute[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX + 1]; 						// +1 for master channel 0
@@ -53,7 +78,7 @@ uint8_t clkValid;
 
 // Range states
 audio_control_range_2_n_t(1) volumeRng[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX+1]; 			// Volume range state
-audio_control_range_4_n_t(1) sampleFreqRng; 						// Sample frequency range state
+audio_control_range_4_n_t(USB_AUDIO_RATE_COUNT) sampleFreqRng; 		// Sample frequency range state
 
 static volatile bool mic_interface_open = false;
 static volatile bool spkr_interface_open = false;
@@ -61,12 +86,43 @@ static volatile bool spkr_interface_open = false;
 static uint32_t prev_n_bytes_received = 0;
 static bool host_streaming_out = false;
 
-static StreamBufferHandle_t samples_to_host_stream_buf;
-static StreamBufferHandle_t samples_from_host_stream_buf;
-static StreamBufferHandle_t rx_buffer;
+static audio_ring_t samples_to_host_ring;
+static volatile bool samples_to_host_ready = false;
+static audio_ring_t samples_from_host_ring;
+static audio_ring_t rx_ring;
 static TaskHandle_t usb_audio_out_task_handle;
 
-#define RATE_MULTIPLIER (appconfUSB_AUDIO_SAMPLE_RATE / appconfAUDIO_PIPELINE_SAMPLE_RATE)
+#define RATE_MULTIPLIER_MAX (appconfUSB_AUDIO_SAMPLE_RATE / appconfAUDIO_PIPELINE_SAMPLE_RATE)
+
+/*
+ * Ratio of the sample rate the host has chosen to the pipeline's, and the
+ * number of samples per channel in a nominal USB transfer at that rate.
+ * Only changed by usb_audio_set_rate(), which runs in the USB task along
+ * with everything else that uses them.
+ */
+static unsigned rate_multiplier = RATE_MULTIPLIER_MAX;
+static size_t usb_frames_per_ms = AUDIO_FRAMES_PER_USB_FRAME;
+
+/*
+ * Each count and fill range has a single writer, either the USB task or
+ * whichever task runs usb_audio_send() or usb_audio_recv(), so none needs a
+ * lock. A fill measured while a report restarts the ranges may be lost.
+ */
+static usb_audio_stats_t stats = {
+    .to_host = {.min_fill = -1, .max_fill = -1},
+    .from_host = {.min_fill = -1, .max_fill = -1},
+    .rate_ctrl_min = UINT32_MAX,
+};
+
+static void usb_audio_stats_fill(usb_audio_dir_stats_t *dir, int32_t fill)
+{
+    if (dir->min_fill < 0 || fill < dir->min_fill) {
+        dir->min_fill = fill;
+    }
+    if (fill > dir->max_fill) {
+        dir->max_fill = fill;
+    }
+}
 
 #define USB_FRAMES_PER_VFE_FRAME (appconfAUDIO_PIPELINE_FRAME_ADVANCE / (appconfAUDIO_PIPELINE_SAMPLE_RATE / 1000))
 
@@ -105,56 +161,283 @@ void tud_resume_cb(void)
 // AUDIO Task
 //--------------------------------------------------------------------+
 
-#if CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 2
+/* Samples from the host. Those to it are in the layout of to_host_format. */
+#if CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_RX == 2
 typedef int16_t samp_t;
-#elif CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 4
+#define src_block_ds3_samp src_block_ds3_s16
+#elif CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_RX == 4
 typedef int32_t samp_t;
+#define src_block_ds3_samp src_block_ds3_s32
+#else
+#error CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_RX must be either 2 or 4
+#endif
+
+/*
+ * rx_ring holds USB transactions as received, at the USB rate, until they
+ * make up whole samples at the pipeline rate. It is sized to hold a whole
+ * number of RATE_MULTIPLIER_MAX sample groups, so that each contiguous region
+ * read from it holds a whole number of the groups at either rate.
+ */
+#define RX_RING_FRAMES (2 * CFG_TUD_AUDIO_FUNC_1_EP_OUT_SW_BUF_SZ / (sizeof(samp_t) * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX))
+
+static samp_t rx_ring_storage[RX_RING_FRAMES][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
+static samp_t samples_from_host_storage[2 * appconfAUDIO_PIPELINE_FRAME_ADVANCE][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
+static int32_t samples_to_host_storage[3 * appconfAUDIO_PIPELINE_FRAME_ADVANCE][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
+
+static src_block_ds3_t from_host_src_state[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
+static src_block_us3_t to_host_src_state[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
+
+/*
+ * The channels and sample width of the samples in samples_to_host_ring, and
+ * the bytes of one sample of every channel in it. Only these channels are
+ * converted and put in the ring, in this layout.
+ */
+static usb_audio_mic_format_t to_host_format;
+static size_t to_host_frame_bytes;
+
+/*
+ * The microphone alternate setting the host last chose, which only the USB
+ * task writes. It posts a request for usb_audio_send() to switch the ring to
+ * it between two frames, and while the request is outstanding leaves the
+ * ring and the format above alone, as usb_audio_send() may be resetting them.
+ */
+static usb_audio_mic_format_t to_host_format_next;
+static volatile unsigned to_host_format_req;
+static volatile unsigned to_host_format_ack;
+
+#define TO_HOST_FORMAT_PENDING() (to_host_format_req != to_host_format_ack)
+
+/*
+ * Switches the SRC path to the sample rate the host has chosen, which it
+ * does before setting a streaming interface, and the rate estimate to the
+ * transfer sizes that go with it.
+ */
+static void usb_audio_set_rate(uint32_t rate)
+{
+    const unsigned multiplier = rate / appconfAUDIO_PIPELINE_SAMPLE_RATE;
+
+    if (multiplier == rate_multiplier) {
+        return;
+    }
+
+    rate_multiplier = multiplier;
+    usb_frames_per_ms = rate / 1000;
+
+    src_block_ds3_init(from_host_src_state, CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX);
+    src_block_us3_init(to_host_src_state, CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX);
+
+    set_expected_USB_audio_bytes(USB_DIR_OUT, sizeof(samp_t) * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX * usb_frames_per_ms);
+    set_expected_USB_audio_bytes(USB_DIR_IN, to_host_format_next.channels * to_host_format_next.bytes_per_sample * usb_frames_per_ms);
+
+    rtos_printf("USB audio sample rate %u\n", rate);
+}
+
+/*
+ * Switches samples_to_host_ring to to_host_format_next, starting it again at
+ * a size that holds exactly three pipeline frames so that it keeps holding a
+ * whole number of them. Called by usb_audio_send() between frames, when the
+ * USB task has asked for it and so is not using the ring.
+ */
+static void usb_audio_apply_to_host_format(void)
+{
+    const unsigned req = to_host_format_req;
+
+    RTOS_MEMORY_BARRIER();
+
+    to_host_format = to_host_format_next;
+    to_host_frame_bytes = (size_t) to_host_format.channels * to_host_format.bytes_per_sample;
+
+    audio_ring_init(&samples_to_host_ring, samples_to_host_storage, 3 * appconfAUDIO_PIPELINE_FRAME_ADVANCE * to_host_frame_bytes);
+
+    /* The ring and format must be set before the USB task may use them */
+    RTOS_MEMORY_BARRIER();
+    to_host_format_ack = req;
+}
+
+/*
+ * Called by the USB task to switch the samples sent to the host to format.
+ * Until usb_audio_send() has applied it, silence is sent.
+ */
+static void usb_audio_set_to_host_format(const usb_audio_mic_format_t *format)
+{
+    to_host_format_next = *format;
+    src_block_us3_init(to_host_src_state, CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX);
+
+    set_expected_USB_audio_bytes(USB_DIR_IN, (size_t) format->channels * format->bytes_per_sample * usb_frames_per_ms);
+
+    RTOS_MEMORY_BARRIER();
+    to_host_format_req++;
+}
+
+/*
+ * Converts frames samples of each channel at src, where channel ch starts at
+ * src + ch * stride, to the layout sent to the host at dst. Only the channels
+ * in to_host_format are touched, and any of those from src_chans on are sent
+ * as silence.
+ */
+static void usb_audio_pack_to_host(void *dst, const int32_t *src, size_t stride, size_t src_chans, size_t frames)
+{
+    const size_t channels = to_host_format.channels;
+
+    for (size_t ch = 0; ch < channels; ch++) {
+        if (to_host_format.bytes_per_sample == 2) {
+            int16_t *y = (int16_t *) dst + ch;
+            for (size_t i = 0; i < frames; i++) {
+                y[i * channels] = ch < src_chans ? src[ch * stride + i] >> 16 : 0;
+            }
+        } else {
+            int32_t *y = (int32_t *) dst + ch;
+            for (size_t i = 0; i < frames; i++) {
+                y[i * channels] = ch < src_chans ? src[ch * stride + i] : 0;
+            }
+        }
+    }
+}
+
+/* Upsamples frames samples in to_host_format from in to three times as many at out */
+static void usb_audio_us3_to_host(void *out, const void *in, size_t frames)
+{
+    if (to_host_format.bytes_per_sample == 2) {
+        src_block_us3_s16(to_host_src_state, to_host_format.channels, out, in, frames);
+    } else {
+        src_block_us3_s32(to_host_src_state, to_host_format.channels, out, in, frames);
+    }
+}
+
+#if appconfUSB_AUDIO_ASRC
+/*
+ * Ratio of the host's sample rate to the pipeline's, in UQ31. It is kept
+ * within 1/256 of one, which bounds the number of samples either resampler
+ * makes or needs per pipeline frame to ASRC_MAX_FRAMES.
+ */
+#define ASRC_RATIO_ONE      (1u << 31)
+#define ASRC_RATIO_LIMIT    (ASRC_RATIO_ONE >> 8)
+#define ASRC_MAX_FRAMES     (appconfAUDIO_PIPELINE_FRAME_ADVANCE + appconfAUDIO_PIPELINE_FRAME_ADVANCE / 64)
+
+static volatile uint32_t asrc_ratio = ASRC_RATIO_ONE;
+static drift_src_t to_host_src;
+
+/* The pipeline's samples are resampled to the host's rate on the way to it */
+static uint32_t asrc_to_host_step(void)
+{
+    return (uint32_t) ((1ull << 61) / asrc_ratio);
+}
+
+/* And the host's to the pipeline's on the way from it */
+static uint32_t asrc_from_host_step(void)
+{
+    return asrc_ratio >> 1;
+}
+#endif
+
+void usb_audio_asrc_set_ratio(uint32_t ratio)
+{
+#if appconfUSB_AUDIO_ASRC
+    if (ratio > ASRC_RATIO_ONE + ASRC_RATIO_LIMIT) {
+        ratio = ASRC_RATIO_ONE + ASRC_RATIO_LIMIT;
+    } else if (ratio < ASRC_RATIO_ONE - ASRC_RATIO_LIMIT) {
+        ratio = ASRC_RATIO_ONE - ASRC_RATIO_LIMIT;
+    }
+    asrc_ratio = ratio;
+    usb_audio_stats_rate_ctrl(ratio);
 #else
-#error CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX must be either 2 or 4
+    (void) ratio;
 #endif
+}
 
 void usb_audio_send(rtos_intertile_t *intertile_ctx,
                     size_t frame_count,
                     int32_t **frame_buffers,
                     size_t num_chans)
 {
-    samp_t usb_audio_in_frame[appconfAUDIO_PIPELINE_FRAME_ADVANCE][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
+    uint8_t *usb_audio_in_frames;
+    size_t space;
     int32_t *frame_buf_ptr = (int32_t *) frame_buffers;
 
-#if CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 2
-    const int src_32_shift = 16;
-#elif CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 4
-    const int src_32_shift = 0;
-#endif
+    xassert(frame_count == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
 
-    memset(usb_audio_in_frame, 0, sizeof(samp_t) * appconfAUDIO_PIPELINE_FRAME_ADVANCE * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX);
+    if (TO_HOST_FORMAT_PENDING()) {
+        usb_audio_apply_to_host_format();
+    }
 
-    xassert(frame_count == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+    if (!mic_interface_open) {
+        return;
+    }
 
-    for(int ch=0; ch<CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX; ch++) {
-        for (int i=0; i<appconfAUDIO_PIPELINE_FRAME_ADVANCE; i++) {
-            if (ch < num_chans) {
-                usb_audio_in_frame[i][ch] = frame_buf_ptr[i+(appconfAUDIO_PIPELINE_FRAME_ADVANCE*ch)] >> src_32_shift;
-            }
-        }
+#if appconfUSB_AUDIO_ASRC
+    static int32_t resampled[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX][ASRC_MAX_FRAMES];
+    const size_t src_chans = num_chans < to_host_format.channels ? num_chans : to_host_format.channels;
+    size_t frames_out;
+    size_t frames_written = 0;
+
+    if (to_host_src.channels != src_chans) {
+        drift_src_init(&to_host_src, src_chans);
     }
+    drift_src_set_step(&to_host_src, asrc_to_host_step());
 
-    if (mic_interface_open) {
-        if (xStreamBufferSpacesAvailable(samples_to_host_stream_buf) >= sizeof(usb_audio_in_frame)) {
-            xStreamBufferSend(samples_to_host_stream_buf, usb_audio_in_frame, sizeof(usb_audio_in_frame), 0);
-        } else {
-            rtos_printf("lost VFE output samples\n");
+    frames_out = drift_src_output_count(&to_host_src, appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+    xassert(frames_out <= ASRC_MAX_FRAMES);
+
+    if (audio_ring_space(&samples_to_host_ring) < frames_out * to_host_frame_bytes) {
+        stats.to_host.overruns++;
+        rtos_printf("lost VFE output samples\n");
+        return;
+    }
+
+    drift_src_push(&to_host_src,
+                   &resampled[0][0], ASRC_MAX_FRAMES,
+                   frame_buf_ptr, appconfAUDIO_PIPELINE_FRAME_ADVANCE,
+                   appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+
+    /* The number of frames varies, so they may wrap around the end of the ring */
+    while (frames_written < frames_out) {
+        size_t n;
+
+        usb_audio_in_frames = audio_ring_write_reserve(&samples_to_host_ring, &space);
+        n = space / to_host_frame_bytes;
+        if (n > frames_out - frames_written) {
+            n = frames_out - frames_written;
         }
 
+        usb_audio_pack_to_host(usb_audio_in_frames, &resampled[0][frames_written], ASRC_MAX_FRAMES, src_chans, n);
+
+        audio_ring_write_commit(&samples_to_host_ring, n * to_host_frame_bytes);
+        frames_written += n;
+    }
+#if LATENCY_PROBE_ENABLED
+    latency_probe_queue(appconfLATENCY_PROBE_PATH_USB, frames_out);
+#endif
+#else
+    const size_t frame_bytes = appconfAUDIO_PIPELINE_FRAME_ADVANCE * to_host_frame_bytes;
+
+    /*
+     * Only whole frames are written to the ring, and it holds a whole number
+     * of them, so the free space always starts with a contiguous frame.
+     */
+    usb_audio_in_frames = audio_ring_write_reserve(&samples_to_host_ring, &space);
+    if (space < frame_bytes) {
+        stats.to_host.overruns++;
+        rtos_printf("lost VFE output samples\n");
+        return;
     }
+
+    usb_audio_pack_to_host(usb_audio_in_frames, frame_buf_ptr, appconfAUDIO_PIPELINE_FRAME_ADVANCE, num_chans, appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+
+    audio_ring_write_commit(&samples_to_host_ring, frame_bytes);
+#if LATENCY_PROBE_ENABLED
+    latency_probe_queue(appconfLATENCY_PROBE_PATH_USB, appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+#endif
+#endif
 }
 
-void usb_audio_recv(rtos_intertile_t *intertile_ctx,
-                    size_t frame_count,
-                    int32_t **frame_buffers,
-                    size_t num_chans)
+static void usb_audio_recv_frame(rtos_intertile_t *intertile_ctx,
+                                 size_t frame_count,
+                                 int32_t **frame_buffers,
+                                 size_t num_chans,
+                                 TickType_t timeout)
 {
     static samp_t usb_audio_out_frame[appconfAUDIO_PIPELINE_FRAME_ADVANCE][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
+    static bool receiving = false;
     size_t bytes_received;
     int32_t *frame_buf_ptr = (int32_t *) frame_buffers;
 
@@ -168,7 +451,7 @@ void usb_audio_recv(rtos_intertile_t *intertile_ctx,
     bytes_received = rtos_intertile_rx_len(
             intertile_ctx,
             appconfUSB_AUDIO_PORT,
-            USB_AUDIO_RECV_DELAY);
+            timeout);
 
     if (bytes_received > 0) {
         xassert(bytes_received == sizeof(usb_audio_out_frame));
@@ -177,8 +460,18 @@ void usb_audio_recv(rtos_intertile_t *intertile_ctx,
                 intertile_ctx,
                 usb_audio_out_frame,
                 bytes_received);
+        receiving = true;
     } else {
         memset(usb_audio_out_frame, 0, sizeof(usb_audio_out_frame));
+
+        /*
+         * Only the first missing frame of a gap counts, so that a host that
+         * has stopped streaming does not count one every frame.
+         */
+        if (receiving) {
+            stats.from_host.underruns++;
+            receiving = false;
+        }
     }
 
     if (frame_buf_ptr != NULL) {
@@ -192,6 +485,90 @@ void usb_audio_recv(rtos_intertile_t *intertile_ctx,
     }
 }
 
+void usb_audio_recv(rtos_intertile_t *intertile_ctx,
+                    size_t frame_count,
+                    int32_t **frame_buffers,
+                    size_t num_chans)
+{
+    usb_audio_recv_frame(intertile_ctx, frame_count, frame_buffers, num_chans, USB_AUDIO_RECV_DELAY);
+}
+
+void usb_audio_recv_blocking(rtos_intertile_t *intertile_ctx,
+                             size_t frame_count,
+                             int32_t **frame_buffers,
+                             size_t num_chans)
+{
+    usb_audio_recv_frame(intertile_ctx, frame_count, frame_buffers, num_chans, portMAX_DELAY);
+}
+
+#if appconfUSB_AUDIO_ASRC
+void usb_audio_out_task(void *arg)
+{
+    rtos_intertile_t *intertile_ctx = (rtos_intertile_t*) arg;
+    static drift_src_t from_host_src;
+    static samp_t usb_audio_in_frames[ASRC_MAX_FRAMES][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
+    static int32_t src_in[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX][ASRC_MAX_FRAMES];
+    static int32_t src_out[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX][appconfAUDIO_PIPELINE_FRAME_ADVANCE];
+    static samp_t usb_audio_out_frame[appconfAUDIO_PIPELINE_FRAME_ADVANCE][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
+
+#if CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_RX == 2
+    const int src_32_shift = 16;
+#elif CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_RX == 4
+    const int src_32_shift = 0;
+#endif
+
+    drift_src_init(&from_host_src, CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX);
+
+    for (;;) {
+        (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        /*
+         * The number of samples each pipeline frame is resampled from
+         * varies, so rather than one frame per notification, make frames for
+         * as long as there are enough samples. rtos_intertile_tx() paces
+         * this to the pipeline, and the fill level left behind is what the
+         * rate adjustment trims the ratio by.
+         */
+        for (;;) {
+            size_t frames_in;
+            size_t bytes_in;
+
+            drift_src_set_step(&from_host_src, asrc_from_host_step());
+            frames_in = drift_src_input_count(&from_host_src, appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+            xassert(frames_in <= ASRC_MAX_FRAMES);
+            bytes_in = frames_in * sizeof(usb_audio_in_frames[0]);
+
+            /* Either not enough yet, or the ring was discarded */
+            if (audio_ring_read(&samples_from_host_ring, usb_audio_in_frames, bytes_in) != bytes_in) {
+                break;
+            }
+
+            for (int ch=0; ch<CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX; ch++) {
+                for (size_t i=0; i<frames_in; i++) {
+                    src_in[ch][i] = (int32_t) usb_audio_in_frames[i][ch] << src_32_shift;
+                }
+            }
+
+            drift_src_pull(&from_host_src,
+                           &src_out[0][0], appconfAUDIO_PIPELINE_FRAME_ADVANCE,
+                           &src_in[0][0], ASRC_MAX_FRAMES,
+                           appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+
+            for (int ch=0; ch<CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX; ch++) {
+                for (int i=0; i<appconfAUDIO_PIPELINE_FRAME_ADVANCE; i++) {
+                    usb_audio_out_frame[i][ch] = src_out[ch][i] >> src_32_shift;
+                }
+            }
+
+            rtos_intertile_tx(
+                    intertile_ctx,
+                    appconfUSB_AUDIO_PORT,
+                    usb_audio_out_frame,
+                    sizeof(usb_audio_out_frame));
+        }
+    }
+}
+#else
 void usb_audio_out_task(void *arg)
 {
     rtos_intertile_t *intertile_ctx = (rtos_intertile_t*) arg;
@@ -202,20 +579,23 @@ void usb_audio_out_task(void *arg)
         size_t bytes_received = 0;
 
         /*
-         * Only wake up when the stream buffer contains a whole audio
+         * Only wake up when the ring contains a whole audio
          * pipeline frame.
          */
         (void) ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
 
-        bytes_received = xStreamBufferReceive(samples_from_host_stream_buf, usb_audio_out_frame, sizeof(usb_audio_out_frame), 0);
+        /*
+         * The frame is copied out of the ring, rather than sent from it in
+         * place, so that its space is free again before rtos_intertile_tx()
+         * waits for the other tile to pick it up.
+         */
+        bytes_received = audio_ring_read(&samples_from_host_ring, usb_audio_out_frame, sizeof(usb_audio_out_frame));
 
         /*
          * This shouldn't normally be zero, but it could be possible that
-         * the stream buffer is reset after this task has been notified.
+         * the ring is discarded after this task has been notified.
          */
         if (bytes_received > 0) {
-            xassert(bytes_received == sizeof(usb_audio_out_frame));
-
             rtos_intertile_tx(
                     intertile_ctx,
                     appconfUSB_AUDIO_PORT,
@@ -224,6 +604,7 @@ void usb_audio_out_task(void *arg)
         }
     }
 }
+#endif
 
 //--------------------------------------------------------------------+
 // Application Callback API Implementations
@@ -322,6 +703,30 @@ bool tud_audio_set_req_entity_cb(uint8_t rhport,
             return false;
         }
     }
+
+    // Clock Source unit
+    if (entityID == UAC2_ENTITY_CLOCK) {
+        switch (ctrlSel) {
+        case AUDIO_CS_CTRL_SAM_FREQ:
+            // Request uses format layout 3
+            TU_VERIFY(p_request->wLength == sizeof(audio_control_cur_4_t));
+
+            /* Takes effect when the host next sets a streaming interface */
+            for (int i = 0; i < USB_AUDIO_RATE_COUNT; i++) {
+                if ((uint32_t) ((audio_control_cur_4_t*) pBuff)->bCur == usb_audio_rates[i]) {
+                    sampFreq = usb_audio_rates[i];
+                    TU_LOG2("    Set Sample Freq: %u\r\n", (unsigned) sampFreq);
+                    return true;
+                }
+            }
+            return false;
+
+            // Unknown/Unsupported control
+        default:
+            TU_BREAKPOINT();
+            return false;
+        }
+    }
     return false;    // Yet not implemented
 }
 
@@ -495,6 +900,45 @@ bool tud_audio_rx_done_pre_read_cb(uint8_t rhport,
     return true;
 }
 
+/*
+ * Moves groups groups of rate_multiplier samples of each channel out of
+ * rx_ring and into samples_from_host_ring, converting them to the pipeline
+ * sample rate on the way. Every read from rx_ring is a whole number of
+ * groups, so its contiguous regions always are too, while those of
+ * samples_from_host_ring hold whole samples of every channel. Either may end
+ * before the other, so the groups are moved as many at a time as both allow.
+ */
+static void rx_ring_to_samples_from_host(size_t groups)
+{
+    const size_t out_frame_bytes = sizeof(samp_t) * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX;
+    const size_t in_group_bytes = rate_multiplier * out_frame_bytes;
+
+    while (groups > 0) {
+        size_t in_len;
+        size_t out_len;
+        samp_t *in = audio_ring_read_reserve(&rx_ring, &in_len);
+        samp_t *out = audio_ring_write_reserve(&samples_from_host_ring, &out_len);
+        size_t n = groups;
+
+        if (n > in_len / in_group_bytes) {
+            n = in_len / in_group_bytes;
+        }
+        if (n > out_len / out_frame_bytes) {
+            n = out_len / out_frame_bytes;
+        }
+
+        if (rate_multiplier == 3) {
+            src_block_ds3_samp(from_host_src_state, CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX, out, in, n);
+        } else {
+            memcpy(out, in, n * out_frame_bytes);
+        }
+
+        audio_ring_read_commit(&rx_ring, n * in_group_bytes);
+        audio_ring_write_commit(&samples_from_host_ring, n * out_frame_bytes);
+        groups -= n;
+    }
+}
+
 bool tud_audio_rx_done_post_read_cb(uint8_t rhport,
                                     uint16_t n_bytes_received,
                                     uint8_t func_id,
@@ -502,10 +946,13 @@ bool tud_audio_rx_done_post_read_cb(uint8_t rhport,
                                     uint8_t cur_alt_setting)
 {
     (void)rhport;
-  
-    uint8_t rx_data[CFG_TUD_AUDIO_FUNC_1_EP_OUT_SW_BUF_SZ];
-    samp_t usb_audio_frames[AUDIO_FRAMES_PER_USB_FRAME][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
-    const size_t stream_buffer_send_byte_count = sizeof(usb_audio_frames) / RATE_MULTIPLIER;
+
+    const size_t out_frame_bytes = sizeof(samp_t) * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX;
+    const size_t stream_buffer_send_byte_count = out_frame_bytes * (appconfAUDIO_PIPELINE_SAMPLE_RATE / 1000);
+    size_t groups;
+    size_t fill;
+    void *ring_ptr;
+    size_t len;
 
     host_streaming_out = true;
     prev_n_bytes_received = n_bytes_received;
@@ -515,91 +962,62 @@ bool tud_audio_rx_done_post_read_cb(uint8_t rhport,
     }
 
     /* 
-     * rx_data is a holding space to recieve the latest USB transaction.
-     * If it fits, we then push into rx_buffer. This could be a nominal-size transaction, or it could not be.
-     * We then only push nominal size transactions into the stream buffer.
-     * Hopefully this doesn't cause timing issues in the pipeline.
+     * The latest USB transaction is read straight out of the endpoint FIFO
+     * into rx_ring, whatever its size. An adaptive host may send a sample
+     * more or less than nominal in any one transaction.
      */
-
-    if (sizeof(rx_data) >= n_bytes_received)
+    if (audio_ring_space(&rx_ring) < n_bytes_received)
     {
-        tud_audio_read(rx_data, n_bytes_received);
-    }
-    else
-    {
-        /* 
-         * I don't believe we ever get here because I think the EP FIFO will complain before this, 
-         * but better safe than sorry
-         */
-        rtos_printf("Rx'd too much USB data in one transaction, cannot read\n");
+        stats.from_host.overruns++;
+        rtos_printf("Rx'd too much total USB data, cannot buffer\n");
         return false;
     }
 
-    if (xStreamBufferSpacesAvailable(rx_buffer) >= n_bytes_received)
-    {
-        xStreamBufferSend(rx_buffer, rx_data, n_bytes_received, 0);
-    }
-    else
-    {
-        rtos_printf("Rx'd too much total USB data, cannot buffer\n");
-        return false;
+    for (size_t n = n_bytes_received; n > 0; n -= len) {
+        ring_ptr = audio_ring_write_reserve(&rx_ring, &len);
+        if (len > n) {
+            len = n;
+        }
+        tud_audio_read(ring_ptr, len);
+        audio_ring_write_commit(&rx_ring, len);
     }
 
-    if (xStreamBufferBytesAvailable(rx_buffer) >= sizeof(usb_audio_frames))
-    {
-        size_t num_rx_total = 0;
-        while(num_rx_total < sizeof(usb_audio_frames)){
-            size_t num_rx = xStreamBufferReceive(rx_buffer, &usb_audio_frames[num_rx_total], sizeof(usb_audio_frames)-num_rx_total, 0);
-            num_rx_total += num_rx;
-        }        
+    /*
+     * Everything received so far is passed on, apart from any samples at
+     * the USB rate that do not yet make up a whole sample at the pipeline
+     * rate. Those wait in rx_ring for the next transaction.
+     */
+    groups = audio_ring_fill(&rx_ring) / (rate_multiplier * out_frame_bytes);
+    if (groups == 0) {
+        return true;
     }
-    else
-    {
-        rtos_printf("Not enough data to send to stream buffer, cycling again\n");
+
+    if (audio_ring_space(&samples_from_host_ring) < groups * out_frame_bytes) {
+        audio_ring_read_commit(&rx_ring, groups * rate_multiplier * out_frame_bytes);
+        stats.from_host.overruns++;
+        rtos_printf("lost USB output samples\n");
         return true;
     }
 
-    if (xStreamBufferSpacesAvailable(samples_from_host_stream_buf) >= stream_buffer_send_byte_count)
-    {
-        if (RATE_MULTIPLIER == 3) {
+    rx_ring_to_samples_from_host(groups);
 
-            static int32_t __attribute__((aligned (8))) src_data[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX][SRC_FF3V_FIR_NUM_PHASES][SRC_FF3V_FIR_TAPS_PER_PHASE];
-            samp_t src_audio_frames[AUDIO_FRAMES_PER_USB_FRAME / RATE_MULTIPLIER][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX];
-  
-            for (int i = 0; i < AUDIO_FRAMES_PER_USB_FRAME / RATE_MULTIPLIER; i++) {
-                for (int j = 0; j < CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX; j++) {
-                    int64_t sum = 0;
-                    sum = src_ds3_voice_add_sample(sum, src_data[j][0], src_ff3v_fir_coefs[0], usb_audio_frames[3*i + 0][j]);
-                    sum = src_ds3_voice_add_sample(sum, src_data[j][1], src_ff3v_fir_coefs[1], usb_audio_frames[3*i + 1][j]);
-                    src_audio_frames[i][j] = src_ds3_voice_add_final_sample(sum, src_data[j][2], src_ff3v_fir_coefs[2], usb_audio_frames[3*i + 2][j]);
-                }
-            }
-            xStreamBufferSend(samples_from_host_stream_buf, src_audio_frames, stream_buffer_send_byte_count, 0);
-        } else {
-            xStreamBufferSend(samples_from_host_stream_buf, usb_audio_frames, stream_buffer_send_byte_count, 0);
-        }
-  
-        /*
-         * Wake up the task waiting on this buffer whenever there is one more
-         * USB frame worth of audio data than the amount of data required to
-         * be input into the pipeline.
-         *
-         * This way the task will not wake up each time this task puts another
-         * milliseconds of audio into the stream buffer, but rather once every
-         * pipeline frame time.
-         */
-        const size_t buffer_notify_level = stream_buffer_send_byte_count * (1 + USB_FRAMES_PER_VFE_FRAME);
-  
-        /*
-         * TODO: If the above is modified such that not exactly AUDIO_FRAMES_PER_USB_FRAME / RATE_MULTIPLIER
-         * frames are written to the stream buffer at a time, then this will need to change to >=.
-         */
+    /*
+     * Wake up the task waiting on this buffer whenever there is one more
+     * USB frame worth of audio data than the amount of data required to
+     * be input into the pipeline.
+     *
+     * This way the task will not wake up each time this task puts another
+     * milliseconds of audio into the ring, but rather once every
+     * pipeline frame time. The level is tested for being crossed, rather
+     * than reached exactly, so that it does not matter how much was
+     * written or, with the resampler, how much the task takes at a time.
+     */
+    const size_t buffer_notify_level = stream_buffer_send_byte_count * (1 + USB_FRAMES_PER_VFE_FRAME);
 
-        if (xStreamBufferBytesAvailable(samples_from_host_stream_buf) == buffer_notify_level) {
-            xTaskNotifyGive(usb_audio_out_task_handle);
-        }
-    } else {
-        rtos_printf("lost USB output samples\n");
+    fill = audio_ring_fill(&samples_from_host_ring);
+    usb_audio_stats_fill(&stats.from_host, fill / out_frame_bytes);
+    if (fill >= buffer_notify_level && fill - groups * out_frame_bytes < buffer_notify_level) {
+        xTaskNotifyGive(usb_audio_out_task_handle);
     }
   
     return true;
@@ -610,18 +1028,15 @@ bool tud_audio_tx_done_pre_load_cb(uint8_t rhport,
                                    uint8_t ep_in,
                                    uint8_t cur_alt_setting)
 {
-    static int ready = 0;
     size_t bytes_available;
     size_t tx_size_bytes;
     size_t tx_size_frames;
+
     /*
-     * This buffer needs to be large enough to hold any size of transaction,
-     * but if it's any bigger than twice nominal then we have bigger issues
+     * This buffer has to be large enough to contain any size transaction in
+     * any format, which at 32 bits is too much for the stack.
      */
-    samp_t stream_buffer_audio_frames[2 * AUDIO_FRAMES_PER_USB_FRAME / RATE_MULTIPLIER][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
-
-    /* This buffer has to be large enough to contain any size transaction */
-    samp_t usb_audio_frames[RATE_MULTIPLIER*AUDIO_FRAMES_PER_USB_FRAME][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
+    static int32_t usb_audio_frames[RATE_MULTIPLIER_MAX*AUDIO_FRAMES_PER_USB_FRAME][CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX];
 
     /*
      * Copying XUA_lite logic basically verbatim - if the host is streaming out, 
@@ -630,17 +1045,17 @@ bool tud_audio_tx_done_pre_load_cb(uint8_t rhport,
      * This assumes (as with XUA_lite) that the host sends the same number of samples for each channel.
      * This also assumes that TX and RX rates are the same, which is an assumption made elsewhere.
      * This finally assumes that at nominal rate, 
-     *     AUDIO_FRAMES_PER_USB_FRAME / RATE_MULTIPLIER == prev_n_bytes_received / CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX
+     *     usb_frames_per_ms == prev_n_bytes_received / (sizeof(samp_t) * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX)
      */
     if (host_streaming_out && (0 != prev_n_bytes_received))
     {
-        tx_size_bytes = (prev_n_bytes_received / CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX) * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX;
+        tx_size_frames = prev_n_bytes_received / (sizeof(samp_t) * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX);
     }
     else
     {
-        tx_size_bytes = sizeof(samp_t) * (AUDIO_FRAMES_PER_USB_FRAME / RATE_MULTIPLIER) * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX;
+        tx_size_frames = usb_frames_per_ms;
     }
-    tx_size_frames = tx_size_bytes / (sizeof(samp_t) * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX);
+    tx_size_bytes = tx_size_frames * to_host_format_next.channels * to_host_format_next.bytes_per_sample;
 
     (void) rhport;
     (void) itf;
@@ -648,31 +1063,48 @@ bool tud_audio_tx_done_pre_load_cb(uint8_t rhport,
     (void) cur_alt_setting;
 
     if (!mic_interface_open) {
-        ready = 0;
+        samples_to_host_ready = false;
         mic_interface_open = true;
     }
 
+    /*
+     * Send silence until usb_audio_send() has switched the ring to the
+     * format the host chose, and only then look at the ring.
+     */
+    if (TO_HOST_FORMAT_PENDING()) {
+        samples_to_host_ready = false;
+        memset(usb_audio_frames, 0, tx_size_bytes);
+        tud_audio_write(usb_audio_frames, tx_size_bytes);
+        return true;
+    }
+    RTOS_MEMORY_BARRIER();
+
     /*
      * If the buffer becomes full, reset it in an attempt to
      * maintain a good fill level again.
      */
 
 
-    if (xStreamBufferIsFull(samples_to_host_stream_buf)) {
-        xStreamBufferReset(samples_to_host_stream_buf);
-        ready = 0;
+    if (audio_ring_space(&samples_to_host_ring) == 0) {
+        audio_ring_flush(&samples_to_host_ring);
+#if LATENCY_PROBE_ENABLED
+        latency_probe_flush(appconfLATENCY_PROBE_PATH_USB);
+#endif
+        samples_to_host_ready = false;
+        stats.to_host.resets++;
         rtos_printf("Oops buffer is full\n");
         return true;
     }
 
-    bytes_available = xStreamBufferBytesAvailable(samples_to_host_stream_buf);
+    bytes_available = audio_ring_fill(&samples_to_host_ring);
+    usb_audio_stats_fill(&stats.to_host, bytes_available / to_host_frame_bytes);
 
-    if (bytes_available >= 2 * sizeof(samp_t) * appconfAUDIO_PIPELINE_FRAME_ADVANCE * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX) {
+    if (bytes_available >= 2 * appconfAUDIO_PIPELINE_FRAME_ADVANCE * to_host_frame_bytes) {
         /* wait until we have 2 full audio pipeline output frames in the buffer */
-        ready = 1;
+        samples_to_host_ready = true;
     }
     
-    if (!ready) {
+    if (!samples_to_host_ready) {
         // we need to send something despite not being fully ready
         //  so, send all zeros
         memset(usb_audio_frames, 0, tx_size_bytes);
@@ -680,32 +1112,44 @@ bool tud_audio_tx_done_pre_load_cb(uint8_t rhport,
         return true;
     }
 
-    size_t tx_size_bytes_rate_adjusted = tx_size_bytes / RATE_MULTIPLIER;
-    size_t tx_size_frames_rate_adjusted = tx_size_frames / RATE_MULTIPLIER;
+    size_t tx_size_bytes_rate_adjusted = tx_size_bytes / rate_multiplier;
+    size_t tx_size_frames_rate_adjusted = tx_size_frames / rate_multiplier;
 
     if (bytes_available >= tx_size_bytes_rate_adjusted) {
-
         size_t num_rx_total = 0;
-        while(num_rx_total < tx_size_bytes_rate_adjusted){
-            size_t num_rx =  xStreamBufferReceive(samples_to_host_stream_buf, &stream_buffer_audio_frames[num_rx_total], tx_size_bytes_rate_adjusted-num_rx_total, 0);
-            num_rx_total += num_rx;
-        }        
 
-        if (RATE_MULTIPLIER == 3) {
-            static int32_t __attribute__((aligned (8))) src_data[CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX][SRC_FF3V_FIR_TAPS_PER_PHASE];
+        /*
+         * The samples are taken from the ring in place, in two parts when
+         * they wrap around its end.
+         */
+        while (num_rx_total < tx_size_frames_rate_adjusted) {
+            size_t len;
+            uint8_t *stream_buffer_audio_frames = audio_ring_read_reserve(&samples_to_host_ring, &len);
+            size_t num_rx = len / to_host_frame_bytes;
 
-            for (int i = 0; i < tx_size_frames_rate_adjusted ; i++) {
-                for (int j = 0; j < CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX; j++) {
-                    usb_audio_frames[3*i + 0][j] = src_us3_voice_input_sample(src_data[j], src_ff3v_fir_coefs[2], (int32_t)stream_buffer_audio_frames[i][j]);
-                    usb_audio_frames[3*i + 1][j] = src_us3_voice_get_next_sample(src_data[j], src_ff3v_fir_coefs[1]);
-                    usb_audio_frames[3*i + 2][j] = src_us3_voice_get_next_sample(src_data[j], src_ff3v_fir_coefs[0]);
-                }
+            if (num_rx > tx_size_frames_rate_adjusted - num_rx_total) {
+                num_rx = tx_size_frames_rate_adjusted - num_rx_total;
             }
+
+            if (rate_multiplier == 3) {
+                usb_audio_us3_to_host((uint8_t *) usb_audio_frames + 3 * num_rx_total * to_host_frame_bytes,
+                                      stream_buffer_audio_frames, num_rx);
+            } else {
+                tud_audio_write(stream_buffer_audio_frames, num_rx * to_host_frame_bytes);
+            }
+
+            audio_ring_read_commit(&samples_to_host_ring, num_rx * to_host_frame_bytes);
+            num_rx_total += num_rx;
+        }
+#if LATENCY_PROBE_ENABLED
+        latency_probe_dequeue(appconfLATENCY_PROBE_PATH_USB, tx_size_frames_rate_adjusted);
+#endif
+
+        if (rate_multiplier == 3) {
             tud_audio_write(usb_audio_frames, tx_size_bytes);
-        } else {
-            tud_audio_write(stream_buffer_audio_frames, tx_size_bytes);
         }
     } else {
+        stats.to_host.underruns++;
         rtos_printf("Oops buffer is empty!\n");
     }
 
@@ -734,13 +1178,17 @@ bool tud_audio_set_itf_cb(uint8_t rhport,
     uint8_t const itf = tu_u16_low(tu_le16toh(p_request->wIndex));
     uint8_t const alt = tu_u16_low(tu_le16toh(p_request->wValue));
 
+    usb_audio_set_rate(sampFreq);
+
 #if AUDIO_OUTPUT_ENABLED
     if (itf == ITF_NUM_AUDIO_STREAMING_SPK) {
         /* In case the interface is reset without
          * closing it first */
         spkr_interface_open = false;
-        xStreamBufferReset(samples_from_host_stream_buf);
-        xStreamBufferReset(rx_buffer);
+        audio_ring_discard(&samples_from_host_ring);
+        /* Wake the task to drop the discarded bytes and so free their space */
+        xTaskNotifyGive(usb_audio_out_task_handle);
+        audio_ring_init(&rx_ring, rx_ring_storage, sizeof(rx_ring_storage));
     }
 #endif
 #if AUDIO_INPUT_ENABLED
@@ -748,7 +1196,14 @@ bool tud_audio_set_itf_cb(uint8_t rhport,
         /* In case the interface is reset without
          * closing it first */
         mic_interface_open = false;
-        xStreamBufferReset(samples_to_host_stream_buf);
+        if (alt > 0 && alt <= USB_AUDIO_MIC_ALT_COUNT) {
+            usb_audio_set_to_host_format(&usb_audio_mic_formats[alt - 1]);
+        } else if (!TO_HOST_FORMAT_PENDING()) {
+            audio_ring_flush(&samples_to_host_ring);
+        }
+#if LATENCY_PROBE_ENABLED
+        latency_probe_flush(appconfLATENCY_PROBE_PATH_USB);
+#endif
     }
 #endif
 
@@ -780,6 +1235,61 @@ bool tud_audio_set_itf_close_EP_cb(uint8_t rhport,
     return true;
 }
 
+int32_t usb_audio_to_host_fill_level(void)
+{
+    if (!mic_interface_open || !samples_to_host_ready || TO_HOST_FORMAT_PENDING()) {
+        return -1;
+    }
+
+    return audio_ring_fill(&samples_to_host_ring) / to_host_frame_bytes;
+}
+
+int32_t usb_audio_from_host_fill_level(void)
+{
+    if (!spkr_interface_open) {
+        return -1;
+    }
+
+    return audio_ring_fill(&samples_from_host_ring) / (sizeof(samp_t) * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX);
+}
+
+void usb_audio_stats_rate_ctrl(uint32_t value)
+{
+    if (value < stats.rate_ctrl_min) {
+        stats.rate_ctrl_min = value;
+    }
+    if (value > stats.rate_ctrl_max) {
+        stats.rate_ctrl_max = value;
+    }
+}
+
+void usb_audio_stats_get(usb_audio_stats_t *stats_out)
+{
+    stats.report++;
+    *stats_out = stats;
+    stats_out->magic = USB_AUDIO_STATS_MAGIC;
+    stats_out->version = USB_AUDIO_STATS_VERSION;
+    stats_out->tile = THIS_XCORE_TILE;
+    if (stats.rate_ctrl_min > stats.rate_ctrl_max) {
+        stats_out->rate_ctrl_min = 0;
+    }
+
+    stats.to_host.min_fill = -1;
+    stats.to_host.max_fill = -1;
+    stats.from_host.min_fill = -1;
+    stats.from_host.max_fill = -1;
+    stats.rate_ctrl_min = UINT32_MAX;
+    stats.rate_ctrl_max = 0;
+}
+
+void usb_audio_stats_report(unsigned char xscope_probe)
+{
+    usb_audio_stats_t record;
+
+    usb_audio_stats_get(&record);
+    xscope_bytes(xscope_probe, sizeof(record), (const unsigned char *) &record);
+}
+
 void usb_audio_init(rtos_intertile_t *intertile_ctx,
                     unsigned priority)
 {
@@ -787,27 +1297,29 @@ void usb_audio_init(rtos_intertile_t *intertile_ctx,
     sampFreq = appconfUSB_AUDIO_SAMPLE_RATE;
     clkValid = 1;
 
-    sampleFreqRng.wNumSubRanges = 1;
-    sampleFreqRng.subrange[0].bMin = appconfUSB_AUDIO_SAMPLE_RATE;
-    sampleFreqRng.subrange[0].bMax = appconfUSB_AUDIO_SAMPLE_RATE;
-    sampleFreqRng.subrange[0].bRes = 0;
+    sampleFreqRng.wNumSubRanges = USB_AUDIO_RATE_COUNT;
+    for (int i = 0; i < USB_AUDIO_RATE_COUNT; i++) {
+        sampleFreqRng.subrange[i].bMin = usb_audio_rates[i];
+        sampleFreqRng.subrange[i].bMax = usb_audio_rates[i];
+        sampleFreqRng.subrange[i].bRes = 0;
+    }
 
-    rx_buffer = xStreamBufferCreate(2 * CFG_TUD_AUDIO_FUNC_1_EP_OUT_SW_BUF_SZ, 0);
+    xassert(RX_RING_FRAMES % RATE_MULTIPLIER_MAX == 0);
+    audio_ring_init(&rx_ring, rx_ring_storage, sizeof(rx_ring_storage));
 
     /*
      * Note: Given the way that the USB callback notifies usb_audio_out_task,
      * the size of this buffer MUST NOT be greater than 2 VFE frames.
      */
-    samples_from_host_stream_buf = xStreamBufferCreate(2 * sizeof(samp_t) * appconfAUDIO_PIPELINE_FRAME_ADVANCE * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_RX,
-                                            0);
+    audio_ring_init(&samples_from_host_ring, samples_from_host_storage, sizeof(samples_from_host_storage));
 
     /*
      * Note: The USB callback waits until there are at least 2 VFE frames
      * in this buffer before starting to send to the host, so the size of
      * this buffer MUST be AT LEAST 2 VFE frames.
      */
-    samples_to_host_stream_buf = xStreamBufferCreate(3 * sizeof(samp_t) * appconfAUDIO_PIPELINE_FRAME_ADVANCE * CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX,
-                                            0);
+    usb_audio_set_to_host_format(&usb_audio_mic_formats[0]);
+    usb_audio_apply_to_host_format();
 
     xTaskCreate((TaskFunction_t) usb_audio_out_task, "usb_audio_out_task", portTASK_STACK_DEPTH(usb_audio_out_task), intertile_ctx, priority, &usb_audio_out_task_handle);
 }
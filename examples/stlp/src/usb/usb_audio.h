@@ -25,7 +25,84 @@ void usb_audio_recv(rtos_intertile_t *intertile_ctx,
                     int32_t **frame_buffers,
                     size_t num_chans);
 
+/*
+ * As usb_audio_recv(), but always waits for the next frame from the host, so
+ * that the caller is paced by the USB stream.
+ */
+void usb_audio_recv_blocking(rtos_intertile_t *intertile_ctx,
+                             size_t frame_count,
+                             int32_t **frame_buffers,
+                             size_t num_chans);
+
 void usb_audio_init(rtos_intertile_t *intertile_ctx, unsigned priority);
 
+/*
+ * Returns the number of samples per channel waiting to be sent to the host,
+ * or -1 if they are not currently being sent.
+ */
+int32_t usb_audio_to_host_fill_level(void);
+
+/*
+ * Returns the number of samples per channel received from the host and not
+ * yet sent to the pipeline, or -1 if the host is not currently sending them.
+ */
+int32_t usb_audio_from_host_fill_level(void);
+
+/*
+ * Sets the ratio of the host's sample rate to the pipeline's, in UQ31, that
+ * the USB audio is resampled by when appconfUSB_AUDIO_ASRC is enabled. It
+ * takes effect from the next frame in each direction.
+ */
+void usb_audio_asrc_set_ratio(uint32_t ratio);
+
+/* First word of every statistics record, "USBA" in little endian */
+#define USB_AUDIO_STATS_MAGIC       0x41425355
+#define USB_AUDIO_STATS_VERSION     1
+
+/*
+ * Health of the audio in one direction. The counts run from boot, while the
+ * fill range, in samples per channel, covers only the time since the last
+ * report and is -1 when nothing was measured.
+ */
+typedef struct {
+    uint32_t underruns;     /* Transfers or frames that found too few samples */
+    uint32_t overruns;      /* Transfers or frames dropped for lack of space */
+    uint32_t resets;        /* Times the buffer was emptied to recover */
+    int32_t min_fill;
+    int32_t max_fill;
+} usb_audio_dir_stats_t;
+
+/*
+ * Statistics record, sent over xscope as little endian 32-bit words by
+ * usb_audio_stats_report(). Each tile only fills in what it measures: the
+ * tile running the pipeline input counts from_host underruns and the USB
+ * tile everything else.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t tile;
+    uint32_t report;        /* Increments with every report from this tile */
+    usb_audio_dir_stats_t to_host;
+    usb_audio_dir_stats_t from_host;
+
+    /*
+     * Range of the app PLL numerator set since the last report, or of the
+     * resampling ratio in UQ31 with appconfUSB_AUDIO_ASRC. Both are zero
+     * when it was not changed.
+     */
+    uint32_t rate_ctrl_min;
+    uint32_t rate_ctrl_max;
+} usb_audio_stats_t;
+
+/* Records a value the rate control has just applied, for its range */
+void usb_audio_stats_rate_ctrl(uint32_t value);
+
+/* Copies this tile's statistics into stats and starts new ranges */
+void usb_audio_stats_get(usb_audio_stats_t *stats);
+
+/* Sends this tile's statistics over the given xscope probe and starts new ranges */
+void usb_audio_stats_report(unsigned char xscope_probe);
+
 
 #endif /* USB_AUDIO_H_ */
@@ -102,11 +102,11 @@ const size_t uac2_total_descriptors_length =
 #endif
 #if AUDIO_INPUT_ENABLED
         + TUD_AUDIO_DESC_STD_AS_INT_LEN
-        + TUD_AUDIO_DESC_STD_AS_INT_LEN
-        + TUD_AUDIO_DESC_CS_AS_INT_LEN
-        + TUD_AUDIO_DESC_TYPE_I_FORMAT_LEN
-        + TUD_AUDIO_DESC_STD_AS_ISO_EP_LEN
-        + TUD_AUDIO_DESC_CS_AS_ISO_EP_LEN
+        + USB_AUDIO_MIC_ALT_COUNT * (TUD_AUDIO_DESC_STD_AS_INT_LEN
+                                     + TUD_AUDIO_DESC_CS_AS_INT_LEN
+                                     + TUD_AUDIO_DESC_TYPE_I_FORMAT_LEN
+                                     + TUD_AUDIO_DESC_STD_AS_ISO_EP_LEN
+                                     + TUD_AUDIO_DESC_CS_AS_ISO_EP_LEN)
 #endif
         ;
 
@@ -121,6 +121,27 @@ const uint16_t tud_audio_desc_lengths[CFG_TUD_AUDIO] = {
 
 #define AUDIO_INTERFACE_STRING_INDEX 4
 
+#if AUDIO_INPUT_ENABLED
+#define USB_AUDIO_MIC_FORMAT(_alt, _channels, _bytes) {_channels, _bytes},
+
+const usb_audio_mic_format_t usb_audio_mic_formats[USB_AUDIO_MIC_ALT_COUNT] = {
+    USB_AUDIO_MIC_ALTS(USB_AUDIO_MIC_FORMAT)
+};
+
+/* Alternate _alt - alternate interface for data streaming in the given format */
+#define USB_AUDIO_MIC_ALT_DESC(_alt, _channels, _bytes) \
+    /* Standard AS Interface Descriptor(4.9.1) */ \
+    TUD_AUDIO_DESC_STD_AS_INT(/*_itfnum*/ ITF_NUM_AUDIO_STREAMING_MIC, /*_altset*/ _alt, /*_nEPs*/ 0x01, /*_stridx*/ 0x00), \
+    /* Class-Specific AS Interface Descriptor(4.9.2) */ \
+    TUD_AUDIO_DESC_CS_AS_INT(/*_termid*/ UAC2_ENTITY_MIC_OUTPUT_TERMINAL, /*_ctrl*/ AUDIO_CTRL_NONE, /*_formattype*/ AUDIO_FORMAT_TYPE_I, /*_formats*/ AUDIO_DATA_FORMAT_TYPE_I_PCM, /*_nchannelsphysical*/ _channels, /*_channelcfg*/ AUDIO_CHANNEL_CONFIG_NON_PREDEFINED, /*_stridx*/ 0x00), \
+    /* Type I Format Type Descriptor(2.3.1.6 - Audio Formats) */ \
+    TUD_AUDIO_DESC_TYPE_I_FORMAT(_bytes, (_bytes)*8), \
+    /* Standard AS Isochronous Audio Data Endpoint Descriptor(4.10.1.1) */ \
+    TUD_AUDIO_DESC_STD_AS_ISO_EP(/*_ep*/ 0x80 | EPNUM_AUDIO, /*_attr*/ (TUSB_XFER_ISOCHRONOUS | TUSB_ISO_EP_ATT_ADAPTIVE /*| TUSB_ISO_EP_ATT_IMPLICIT_FB */ | TUSB_ISO_EP_ATT_DATA), /*_maxEPsize*/ CFG_TUD_AUDIO_EP_IN_SZ(_channels, _bytes), /*_interval*/ (CFG_TUSB_RHPORT0_MODE & OPT_MODE_HIGH_SPEED) ? 0x04 : 0x01), \
+    /* Class-Specific AS Isochronous Audio Data Endpoint Descriptor(4.10.1.2) */ \
+    TUD_AUDIO_DESC_CS_AS_ISO_EP(/*_attr*/ AUDIO_CS_AS_ISO_DATA_EP_ATT_NON_MAX_PACKETS_OK, /*_ctrl*/ AUDIO_CTRL_NONE, /*_lockdelayunit*/ AUDIO_CS_AS_ISO_DATA_EP_LOCK_DELAY_UNIT_MILLISEC, /*_lockdelay*/ 0x0003),
+#endif
+
 uint8_t const desc_configuration[] = {
     // Interface count, string index, total length, attribute, power in mA
     TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP, 400),
@@ -132,7 +153,7 @@ uint8_t const desc_configuration[] = {
     /* Class-Specific AC Interface Header Descriptor(4.7.2) */
     TUD_AUDIO_DESC_CS_AC(/*_bcdADC*/ 0x0200, /*_category*/ AUDIO_FUNC_OTHER, /*_totallen*/ uac2_interface_descriptors_length, /*_ctrl*/ AUDIO_CS_AS_INTERFACE_CTRL_LATENCY_POS),
     /* Clock Source Descriptor(4.7.2.1) */
-    TUD_AUDIO_DESC_CLK_SRC(/*_clkid*/ UAC2_ENTITY_CLOCK, /*_attr*/ AUDIO_CLOCK_SOURCE_ATT_INT_PRO_CLK, /*_ctrl*/ (AUDIO_CTRL_R << AUDIO_CLOCK_SOURCE_CTRL_CLK_VAL_POS) | (AUDIO_CTRL_R << AUDIO_CLOCK_SOURCE_CTRL_CLK_FRQ_POS), /*_assocTerm*/ 0x00,  /*_stridx*/ 0x00),
+    TUD_AUDIO_DESC_CLK_SRC(/*_clkid*/ UAC2_ENTITY_CLOCK, /*_attr*/ AUDIO_CLOCK_SOURCE_ATT_INT_PRO_CLK, /*_ctrl*/ (AUDIO_CTRL_R << AUDIO_CLOCK_SOURCE_CTRL_CLK_VAL_POS) | (AUDIO_CTRL_RW << AUDIO_CLOCK_SOURCE_CTRL_CLK_FRQ_POS), /*_assocTerm*/ 0x00,  /*_stridx*/ 0x00),
 
 
 #if AUDIO_OUTPUT_ENABLED
@@ -183,17 +204,7 @@ uint8_t const desc_configuration[] = {
     /* Standard AS Interface Descriptor(4.9.1) */
     /* Interface 1, Alternate 0 - default alternate setting with 0 bandwidth */
     TUD_AUDIO_DESC_STD_AS_INT(/*_itfnum*/ ITF_NUM_AUDIO_STREAMING_MIC, /*_altset*/ 0x00, /*_nEPs*/ 0x00, /*_stridx*/ 0x00),
-    /* Standard AS Interface Descriptor(4.9.1) */
-    /* Interface 1, Alternate 1 - alternate interface for data streaming */
-    TUD_AUDIO_DESC_STD_AS_INT(/*_itfnum*/ ITF_NUM_AUDIO_STREAMING_MIC, /*_altset*/ 0x01, /*_nEPs*/ 0x01, /*_stridx*/ 0x00),
-    /* Class-Specific AS Interface Descriptor(4.9.2) */
-    TUD_AUDIO_DESC_CS_AS_INT(/*_termid*/ UAC2_ENTITY_MIC_OUTPUT_TERMINAL, /*_ctrl*/ AUDIO_CTRL_NONE, /*_formattype*/ AUDIO_FORMAT_TYPE_I, /*_formats*/ AUDIO_DATA_FORMAT_TYPE_I_PCM, /*_nchannelsphysical*/ CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX, /*_channelcfg*/ AUDIO_CHANNEL_CONFIG_NON_PREDEFINED, /*_stridx*/ 0x00),
-    /* Type I Format Type Descriptor(2.3.1.6 - Audio Formats) */
-    TUD_AUDIO_DESC_TYPE_I_FORMAT(CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX, CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX*8),
-    /* Standard AS Isochronous Audio Data Endpoint Descriptor(4.10.1.1) */
-    TUD_AUDIO_DESC_STD_AS_ISO_EP(/*_ep*/ 0x80 | EPNUM_AUDIO, /*_attr*/ (TUSB_XFER_ISOCHRONOUS | TUSB_ISO_EP_ATT_ADAPTIVE /*| TUSB_ISO_EP_ATT_IMPLICIT_FB */ | TUSB_ISO_EP_ATT_DATA), /*_maxEPsize*/ CFG_TUD_AUDIO_FUNC_1_EP_IN_SZ, /*_interval*/ (CFG_TUSB_RHPORT0_MODE & OPT_MODE_HIGH_SPEED) ? 0x04 : 0x01),
-    /* Class-Specific AS Isochronous Audio Data Endpoint Descriptor(4.10.1.2) */
-    TUD_AUDIO_DESC_CS_AS_ISO_EP(/*_attr*/ AUDIO_CS_AS_ISO_DATA_EP_ATT_NON_MAX_PACKETS_OK, /*_ctrl*/ AUDIO_CTRL_NONE, /*_lockdelayunit*/ AUDIO_CS_AS_ISO_DATA_EP_LOCK_DELAY_UNIT_MILLISEC, /*_lockdelay*/ 0x0003),
+    USB_AUDIO_MIC_ALTS(USB_AUDIO_MIC_ALT_DESC)
 #endif
 
     }; // desc_configuration
@@ -4,6 +4,8 @@
 #ifndef USB_DESCRIPTORS_H_
 #define USB_DESCRIPTORS_H_
 
+#include <stdint.h>
+
 #include "tusb_config.h"
 
 #if CFG_TUD_AUDIO_ENABLE_EP_IN && CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX > 0
@@ -40,4 +42,43 @@ enum {
 #define UAC2_ENTITY_MIC_FEATURE_UNIT    0x22
 #define UAC2_ENTITY_MIC_OUTPUT_TERMINAL 0x23
 
+/*
+ * Microphone alternate settings, from 1 up, as X(alt, channels, bytes per
+ * sample). Each channel count is offered at 16 and at 32 bits, and fewer
+ * channels are always the first ones the pipeline outputs, so a host that
+ * only records the ASR output can ask for just that.
+ */
+#define USB_AUDIO_MIC_OTHER_BYTES_PER_SAMPLE (CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX == 2 ? 4 : 2)
+
+#if CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX > 2
+#define USB_AUDIO_MIC_ALT_COUNT 6
+#define USB_AUDIO_MIC_ALTS(X) \
+    X(1, CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX, CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX) \
+    X(2, CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX, USB_AUDIO_MIC_OTHER_BYTES_PER_SAMPLE) \
+    X(3, 2, CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX) \
+    X(4, 2, USB_AUDIO_MIC_OTHER_BYTES_PER_SAMPLE) \
+    X(5, 1, CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX) \
+    X(6, 1, USB_AUDIO_MIC_OTHER_BYTES_PER_SAMPLE)
+#elif CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX == 2
+#define USB_AUDIO_MIC_ALT_COUNT 4
+#define USB_AUDIO_MIC_ALTS(X) \
+    X(1, 2, CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX) \
+    X(2, 2, USB_AUDIO_MIC_OTHER_BYTES_PER_SAMPLE) \
+    X(3, 1, CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX) \
+    X(4, 1, USB_AUDIO_MIC_OTHER_BYTES_PER_SAMPLE)
+#else
+#define USB_AUDIO_MIC_ALT_COUNT 2
+#define USB_AUDIO_MIC_ALTS(X) \
+    X(1, 1, CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX) \
+    X(2, 1, USB_AUDIO_MIC_OTHER_BYTES_PER_SAMPLE)
+#endif
+
+typedef struct {
+    uint8_t channels;
+    uint8_t bytes_per_sample;
+} usb_audio_mic_format_t;
+
+/* Indexed by alternate setting minus one */
+extern const usb_audio_mic_format_t usb_audio_mic_formats[USB_AUDIO_MIC_ALT_COUNT];
+
 #endif /* USB_DESCRIPTORS_H_ */
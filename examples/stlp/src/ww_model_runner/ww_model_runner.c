@@ -10,6 +10,7 @@
 #include "stream_buffer.h"
 
 #include "app_conf.h"
+#include "latency_probe.h"
 #include "platform/driver_instances.h"
 #include "ww_model_runner/ww_model_runner.h"
 
@@ -36,6 +37,10 @@ void ww_audio_send(rtos_intertile_t *intertile_ctx,
     if(audio_stream != NULL) {
         if (xStreamBufferSend(audio_stream, ww_samples, sizeof(ww_samples), 0) != sizeof(ww_samples)) {
             rtos_printf("lost output samples for ww\n");
+        } else {
+#if LATENCY_PROBE_ENABLED
+            latency_probe_record(appconfLATENCY_PROBE_PATH_WW);
+#endif
         }
     }
 }
@@ -8,6 +8,8 @@ set(APP_INCLUDES
     ${CMAKE_CURRENT_LIST_DIR}/src/ww_model_runner
 )
 
+option(STLP_USB_AUDIO_ASRC "Resample the USB audio to the host's clock instead of steering the app PLL" OFF)
+
 include(${CMAKE_CURRENT_LIST_DIR}/bsp_config/bsp_config.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/audio_pipeline/audio_pipeline.cmake)
 
@@ -34,6 +36,10 @@ set(APP_COMPILE_DEFINITIONS
     CFG_TUSB_DEBUG=0
 )
 
+if(STLP_USB_AUDIO_ASRC)
+    list(APPEND APP_COMPILE_DEFINITIONS appconfUSB_AUDIO_ASRC=1)
+endif()
+
 set(APP_LINK_OPTIONS
     -lquadspi
     -report
@@ -44,10 +50,14 @@ set(APP_COMMON_LINK_LIBRARIES
     core::lib_tflite_micro
     rtos::freertos_usb
     sdk::lib_src
+    sln_voice::audio_ring
+    sln_voice::src_block
+    sln_voice::drift_src
 )
 
 set(STLP_PIPELINES
     adec
+    adec_2threads
     adec_altarch
 )
 
@@ -5,6 +5,8 @@ set(STLP_DEV_PIPELINES
 )
 
 option(DEBUG_STLP_USB_MIC_INPUT     "Enable stlp usb mic input"  OFF)
+option(DEBUG_STLP_USB_MIC_INPUT_CLOCKED  "Enable stlp usb mic input, paced by the host rather than the PDM mics"  OFF)
+option(DEBUG_STLP_PDM_MICS_PARKED  "Leave the PDM mics stopped in a DEBUG_STLP_USB_MIC_INPUT_CLOCKED build"  OFF)
 
 set(STLP_UA_COMPILE_DEFINITIONS
     ${APP_COMPILE_DEFINITIONS}
@@ -25,6 +27,16 @@ if(DEBUG_STLP_USB_MIC_INPUT)
     list(APPEND STLP_UA_COMPILE_DEFINITIONS appconfUSB_AUDIO_TESTING=appconfUSB_AUDIO_TESTING)
 endif()
 
+# a usb mic enabled build with the pipeline input waiting on the host's audio
+if(DEBUG_STLP_USB_MIC_INPUT_CLOCKED)
+    list(APPEND STLP_UA_COMPILE_DEFINITIONS appconfMIC_SRC_DEFAULT=appconfMIC_SRC_USB)
+    list(APPEND STLP_UA_COMPILE_DEFINITIONS appconfUSB_AUDIO_TESTING=appconfUSB_AUDIO_TESTING)
+    list(APPEND STLP_UA_COMPILE_DEFINITIONS appconfUSB_MIC_CLOCKED=1)
+    if(DEBUG_STLP_PDM_MICS_PARKED)
+        list(APPEND STLP_UA_COMPILE_DEFINITIONS appconfPDM_MICS_PARKED=1)
+    endif()
+endif()
+
 foreach(STLP_AP ${STLP_PIPELINES})
     #**********************
     # Tile Targets
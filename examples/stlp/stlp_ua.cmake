@@ -1,6 +1,9 @@
 
 option(DEBUG_STLP_USB_MIC_INPUT        "Enable stlp usb mic input"  OFF)
 option(DEBUG_STLP_USB_MIC_INPUT_PIPELINE_BYPASS  "Enable stlp usb mic input and audio pipeline bypass"  OFF)
+option(DEBUG_STLP_USB_MIC_INPUT_CLOCKED  "Enable stlp usb mic input, paced by the host rather than the PDM mics"  OFF)
+option(DEBUG_STLP_PDM_MICS_PARKED  "Leave the PDM mics stopped in a DEBUG_STLP_USB_MIC_INPUT_CLOCKED build"  OFF)
+set(STLP_USB_AUDIO_SAMPLE_RATE 48000 CACHE STRING "Highest USB audio sample rate offered to the host, 16000 or 48000")
 
 set(STLP_UA_COMPILE_DEFINITIONS
     ${APP_COMPILE_DEFINITIONS}
@@ -8,6 +11,7 @@ set(STLP_UA_COMPILE_DEFINITIONS
     appconfUSB_ENABLED=1
     appconfAEC_REF_DEFAULT=appconfAEC_REF_USB
     appconfI2S_MODE=appconfI2S_MODE_MASTER
+    appconfUSB_AUDIO_SAMPLE_RATE=${STLP_USB_AUDIO_SAMPLE_RATE}
 
     MIC_ARRAY_CONFIG_MCLK_FREQ=24576000
 )
@@ -22,7 +26,16 @@ if(DEBUG_STLP_USB_MIC_INPUT_PIPELINE_BYPASS)
     list(APPEND STLP_UA_COMPILE_DEFINITIONS appconfMIC_SRC_DEFAULT=appconfMIC_SRC_USB)
     list(APPEND STLP_UA_COMPILE_DEFINITIONS appconfUSB_AUDIO_MODE=appconfUSB_AUDIO_TESTING)
     list(APPEND STLP_UA_COMPILE_DEFINITIONS appconfPIPELINE_BYPASS=1)
-    list(APPEND STLP_UA_COMPILE_DEFINITIONS appconfUSB_AUDIO_SAMPLE_RATE=48000)
+endif()
+
+# a usb mic enabled build with the pipeline input waiting on the host's audio
+if(DEBUG_STLP_USB_MIC_INPUT_CLOCKED)
+    list(APPEND STLP_UA_COMPILE_DEFINITIONS appconfMIC_SRC_DEFAULT=appconfMIC_SRC_USB)
+    list(APPEND STLP_UA_COMPILE_DEFINITIONS appconfUSB_AUDIO_MODE=appconfUSB_AUDIO_TESTING)
+    list(APPEND STLP_UA_COMPILE_DEFINITIONS appconfUSB_MIC_CLOCKED=1)
+    if(DEBUG_STLP_PDM_MICS_PARKED)
+        list(APPEND STLP_UA_COMPILE_DEFINITIONS appconfPDM_MICS_PARKED=1)
+    endif()
 endif()
 
 foreach(STLP_AP ${STLP_PIPELINES})
@@ -0,0 +1,103 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef AUDIO_RING_H_
+#define AUDIO_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Single producer, single consumer byte ring for handing audio between a USB
+ * callback and a task, used in place of a FreeRTOS stream buffer.
+ *
+ * Rather than copying through the ring, each side may ask for a pointer to
+ * the next contiguous region it owns, fill or drain it in place, and then
+ * commit what it used:
+ *
+ *     p = audio_ring_write_reserve(ring, &len);   ... write up to len bytes at p
+ *     audio_ring_write_commit(ring, n);
+ *
+ *     p = audio_ring_read_reserve(ring, &len);    ... read up to len bytes at p
+ *     audio_ring_read_commit(ring, n);
+ *
+ * A reserved region never crosses the end of the buffer, so it may be
+ * shorter than the total space or fill. When every write and read is a whole
+ * number of some chunk size that divides the ring size, every region starts
+ * on a chunk boundary and at least one chunk is always contiguous.
+ *
+ * No lock is needed provided that all writes happen in one task or callback
+ * and all reads happen in one (possibly different) task or callback.
+ */
+
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+
+    volatile uint32_t head;         /* Bytes ever written, only written by the producer */
+    volatile uint32_t tail;         /* Bytes ever read, only written by the consumer */
+    size_t head_offset;             /* Index in buf of head, only used by the producer */
+    size_t tail_offset;             /* Index in buf of tail, only used by the consumer */
+
+    /* Discard requested by the producer, applied by the consumer */
+    volatile uint32_t discard_pos;  /* Only written by audio_ring_discard() */
+    volatile unsigned discard_req;  /* Only written by audio_ring_discard() */
+    volatile unsigned discard_ack;  /* Only written by the consumer */
+} audio_ring_t;
+
+/* Initialises ring, empty, over the size bytes at buf */
+void audio_ring_init(audio_ring_t *ring, void *buf, size_t size);
+
+/* Number of bytes that may currently be read. May be called from either side. */
+size_t audio_ring_fill(const audio_ring_t *ring);
+
+/* Number of bytes that may currently be written. May be called from either side. */
+size_t audio_ring_space(const audio_ring_t *ring);
+
+/*
+ * Producer side. Returns a pointer to the next free byte and sets len to the
+ * number of contiguous free bytes from there, which is zero when full.
+ */
+void *audio_ring_write_reserve(audio_ring_t *ring, size_t *len);
+
+/* Producer side. Publishes the first len bytes of the reserved region. */
+void audio_ring_write_commit(audio_ring_t *ring, size_t len);
+
+/*
+ * Consumer side. Returns a pointer to the oldest unread byte and sets len to
+ * the number of contiguous bytes that may be read from there, which is zero
+ * when empty.
+ */
+void *audio_ring_read_reserve(audio_ring_t *ring, size_t *len);
+
+/* Consumer side. Releases the first len bytes of the reserved region. */
+void audio_ring_read_commit(audio_ring_t *ring, size_t len);
+
+/*
+ * Producer side. Copies len bytes from data into the ring, across the end of
+ * the buffer if necessary. Returns len, or 0 without writing anything if
+ * there is not space for all of it.
+ */
+size_t audio_ring_write(audio_ring_t *ring, const void *data, size_t len);
+
+/*
+ * Consumer side. Copies len bytes out of the ring into data, across the end
+ * of the buffer if necessary. Returns len, or 0 without reading anything if
+ * fewer than len bytes are available.
+ */
+size_t audio_ring_read(audio_ring_t *ring, void *data, size_t len);
+
+/* Consumer side. Discards everything written so far. */
+void audio_ring_flush(audio_ring_t *ring);
+
+/*
+ * Producer side. Discards everything written so far. The discarded bytes stop
+ * counting towards the fill at once, but their space is only reused after
+ * the consumer drops them, which it does the next time it reserves or reads.
+ * A consumer that only runs when woken by the producer must therefore be
+ * woken after a discard, or a ring discarded while nearly full may never
+ * again fill enough to wake it.
+ */
+void audio_ring_discard(audio_ring_t *ring);
+
+#endif /* AUDIO_RING_H_ */
@@ -0,0 +1,13 @@
+## Create audio ring library
+add_library(sln_voice_audio_ring INTERFACE)
+target_sources(sln_voice_audio_ring
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/src/audio_ring.c
+)
+target_include_directories(sln_voice_audio_ring
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/api
+)
+
+## Create an alias
+add_library(sln_voice::audio_ring ALIAS sln_voice_audio_ring)
@@ -0,0 +1,211 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+/* STD headers */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/* FreeRTOS headers */
+#include "FreeRTOS.h"
+
+#include "audio_ring.h"
+
+/*
+ * All cores on a tile share one memory and execute in order, so only the
+ * compiler needs to be stopped from moving buffer accesses across the
+ * head and tail updates.
+ */
+#define AUDIO_RING_BARRIER()    __asm__ volatile("" ::: "memory")
+
+/*
+ * The read position, taking into account a discard that the consumer has not
+ * yet applied. head and tail are free running, so positions are compared by
+ * their signed difference.
+ */
+static uint32_t audio_ring_live_tail(const audio_ring_t *ring)
+{
+    const unsigned pending = ring->discard_req != ring->discard_ack;
+
+    AUDIO_RING_BARRIER();
+    const uint32_t tail = ring->tail;
+
+    if (pending) {
+        const uint32_t pos = ring->discard_pos;
+        if ((int32_t) (pos - tail) > 0) {
+            return pos;
+        }
+    }
+
+    return tail;
+}
+
+/*
+ * Returns offset moved on by len bytes. The free running counters wrap at
+ * 2^32, which the size need not divide, so offsets are only ever advanced
+ * by the distance between two counters rather than derived from one.
+ */
+static size_t audio_ring_offset_advance(const audio_ring_t *ring, size_t offset, uint32_t len)
+{
+    return (offset + len % ring->size) % ring->size;
+}
+
+static void audio_ring_apply_discard(audio_ring_t *ring)
+{
+    const unsigned req = ring->discard_req;
+
+    if (req != ring->discard_ack) {
+        AUDIO_RING_BARRIER();
+        const uint32_t pos = ring->discard_pos;
+
+        /* A later discard may already have been applied along with this one */
+        if ((int32_t) (pos - ring->tail) > 0) {
+            ring->tail_offset = audio_ring_offset_advance(ring, ring->tail_offset, pos - ring->tail);
+            ring->tail = pos;
+        }
+
+        AUDIO_RING_BARRIER();
+        ring->discard_ack = req;
+    }
+}
+
+void audio_ring_init(audio_ring_t *ring, void *buf, size_t size)
+{
+    configASSERT(buf != NULL);
+    configASSERT(size > 0 && size <= INT32_MAX);
+
+    ring->buf = buf;
+    ring->size = size;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->head_offset = 0;
+    ring->tail_offset = 0;
+    ring->discard_pos = 0;
+    ring->discard_req = 0;
+    ring->discard_ack = 0;
+}
+
+size_t audio_ring_fill(const audio_ring_t *ring)
+{
+    const uint32_t tail = audio_ring_live_tail(ring);
+
+    return ring->head - tail;
+}
+
+size_t audio_ring_space(const audio_ring_t *ring)
+{
+    /*
+     * Discarded bytes are not free until the consumer has dropped them, as
+     * it may still be reading from a region it reserved before the discard.
+     */
+    const uint32_t tail = ring->tail;
+
+    return ring->size - (ring->head - tail);
+}
+
+void *audio_ring_write_reserve(audio_ring_t *ring, size_t *len)
+{
+    const size_t space = audio_ring_space(ring);
+    const size_t to_end = ring->size - ring->head_offset;
+
+    *len = space < to_end ? space : to_end;
+
+    return ring->buf + ring->head_offset;
+}
+
+void audio_ring_write_commit(audio_ring_t *ring, size_t len)
+{
+    configASSERT(len <= audio_ring_space(ring));
+
+    /* The data must be in the buffer before the consumer can see it */
+    AUDIO_RING_BARRIER();
+
+    ring->head_offset += len;
+    if (ring->head_offset >= ring->size) {
+        ring->head_offset -= ring->size;
+    }
+    ring->head += len;
+}
+
+void *audio_ring_read_reserve(audio_ring_t *ring, size_t *len)
+{
+    audio_ring_apply_discard(ring);
+
+    const size_t fill = ring->head - ring->tail;
+    const size_t to_end = ring->size - ring->tail_offset;
+
+    AUDIO_RING_BARRIER();
+
+    *len = fill < to_end ? fill : to_end;
+
+    return ring->buf + ring->tail_offset;
+}
+
+void audio_ring_read_commit(audio_ring_t *ring, size_t len)
+{
+    configASSERT(len <= ring->head - ring->tail);
+
+    /* The data must have been read before the producer may overwrite it */
+    AUDIO_RING_BARRIER();
+
+    ring->tail_offset += len;
+    if (ring->tail_offset >= ring->size) {
+        ring->tail_offset -= ring->size;
+    }
+    ring->tail += len;
+}
+
+size_t audio_ring_write(audio_ring_t *ring, const void *data, size_t len)
+{
+    if (len > audio_ring_space(ring)) {
+        return 0;
+    }
+
+    const size_t to_end = ring->size - ring->head_offset;
+    const size_t first = len < to_end ? len : to_end;
+
+    memcpy(ring->buf + ring->head_offset, data, first);
+    memcpy(ring->buf, (const uint8_t *) data + first, len - first);
+    audio_ring_write_commit(ring, len);
+
+    return len;
+}
+
+size_t audio_ring_read(audio_ring_t *ring, void *data, size_t len)
+{
+    audio_ring_apply_discard(ring);
+
+    if (len > ring->head - ring->tail) {
+        return 0;
+    }
+
+    AUDIO_RING_BARRIER();
+
+    const size_t to_end = ring->size - ring->tail_offset;
+    const size_t first = len < to_end ? len : to_end;
+
+    memcpy(data, ring->buf + ring->tail_offset, first);
+    memcpy((uint8_t *) data + first, ring->buf, len - first);
+    audio_ring_read_commit(ring, len);
+
+    return len;
+}
+
+void audio_ring_flush(audio_ring_t *ring)
+{
+    const uint32_t head = ring->head;
+
+    AUDIO_RING_BARRIER();
+
+    ring->tail_offset = audio_ring_offset_advance(ring, ring->tail_offset, head - ring->tail);
+    ring->tail = head;
+}
+
+void audio_ring_discard(audio_ring_t *ring)
+{
+    ring->discard_pos = ring->head;
+
+    AUDIO_RING_BARRIER();
+
+    ring->discard_req++;
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef DRIFT_SRC_H_
+#define DRIFT_SRC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Fractional resampler for a ratio close to one, used to move audio between
+ * two clock domains that run at the same nominal rate, such as USB and an
+ * I2S master clock, without either one following the other.
+ *
+ * Each output is the input filtered to a position that advances by the step,
+ * in input samples, for every output. The filter is a DRIFT_SRC_TAPS tap
+ * windowed sinc, chosen from DRIFT_SRC_PHASES + 1 fractional delays and
+ * interpolated linearly between the two nearest. At a 16 kHz rate it is
+ * accurate to 90 dB up to 3 kHz and to 75 dB up to 6 kHz. The step may be
+ * changed between calls as the drift is tracked. At a step of one the output
+ * is the input delayed by exactly DRIFT_SRC_TAPS / 2 samples.
+ *
+ * drift_src_push() suits a producer that is handed a fixed number of inputs
+ * and drift_src_pull() a consumer that must make a fixed number of outputs.
+ * The two may be mixed on one instance.
+ *
+ * Samples are held one channel after another, with the same number of
+ * samples of every channel per call, and all channels share one position.
+ */
+
+#ifndef DRIFT_SRC_MAX_CHANNELS
+#define DRIFT_SRC_MAX_CHANNELS  8
+#endif
+
+/* The step is the number of input samples per output sample, in UQ2.30 */
+#define DRIFT_SRC_STEP_ONE      (1u << 30)
+
+/* Filter length, and the number of fractional delays it is tabulated at */
+#define DRIFT_SRC_TAPS          24
+#define DRIFT_SRC_PHASES_LOG2   6
+#define DRIFT_SRC_PHASES        (1 << DRIFT_SRC_PHASES_LOG2)
+
+/* Input samples kept between calls to filter across blocks */
+#define DRIFT_SRC_HISTORY       DRIFT_SRC_TAPS
+
+typedef struct {
+    size_t channels;
+    uint32_t step;
+
+    /*
+     * Position of the next output, in UQ32.32 input samples, counted from
+     * the oldest sample of history.
+     */
+    uint64_t pos;
+
+    int32_t history[DRIFT_SRC_MAX_CHANNELS][DRIFT_SRC_HISTORY];
+} drift_src_t;
+
+/* Initialises ctx for channels channels, with silent history and a step of one */
+void drift_src_init(drift_src_t *ctx, size_t channels);
+
+/* Sets the number of input samples per output sample, in UQ2.30 */
+void drift_src_set_step(drift_src_t *ctx, uint32_t step);
+
+/* Number of outputs drift_src_push() would make from n_in inputs */
+size_t drift_src_output_count(const drift_src_t *ctx, size_t n_in);
+
+/* Number of inputs drift_src_pull() needs to make n_out outputs */
+size_t drift_src_input_count(const drift_src_t *ctx, size_t n_out);
+
+/*
+ * Resamples all n_in samples of each channel from in to out. Channel ch
+ * starts at in + ch * in_stride and at out + ch * out_stride. Returns the
+ * number of samples made for each channel, which is
+ * drift_src_output_count(ctx, n_in) and must not exceed out_stride.
+ */
+size_t drift_src_push(drift_src_t *ctx,
+                      int32_t *out, size_t out_stride,
+                      const int32_t *in, size_t in_stride,
+                      size_t n_in);
+
+/*
+ * Makes exactly n_out samples of each channel at out, laid out as for
+ * drift_src_push(), from the drift_src_input_count(ctx, n_out) samples of
+ * each channel at in. Returns that number of inputs used.
+ */
+size_t drift_src_pull(drift_src_t *ctx,
+                      int32_t *out, size_t out_stride,
+                      const int32_t *in, size_t in_stride,
+                      size_t n_out);
+
+#endif /* DRIFT_SRC_H_ */
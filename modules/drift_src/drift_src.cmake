@@ -0,0 +1,14 @@
+## Create drift SRC library
+add_library(sln_voice_drift_src INTERFACE)
+target_sources(sln_voice_drift_src
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/src/drift_src.c
+        ${CMAKE_CURRENT_LIST_DIR}/src/drift_src_coefs.c
+)
+target_include_directories(sln_voice_drift_src
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/api
+)
+
+## Create an alias
+add_library(sln_voice::drift_src ALIAS sln_voice_drift_src)
@@ -0,0 +1,79 @@
+#!/usr/bin/env python
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+"""
+Generates src/drift_src_coefs.c, the fractional delay filters used by
+drift_src: a Kaiser windowed sinc for each of PHASES + 1 evenly spaced
+delays from 0 to 1 sample, in Q30, each summing to exactly 1.
+"""
+
+import argparse
+import math
+
+TAPS = 24
+PHASES = 64
+BETA = 9.0
+Q = 30
+
+
+def bessel_i0(x):
+    term = 1.0
+    total = 1.0
+    k = 1
+    while term > 1e-12 * total:
+        term *= (x / (2 * k)) ** 2
+        total += term
+        k += 1
+    return total
+
+
+def kaiser(t, half_width, beta):
+    r = t / half_width
+    if abs(r) >= 1:
+        return 0.0
+    return bessel_i0(beta * math.sqrt(1 - r * r)) / bessel_i0(beta)
+
+
+def sinc(t):
+    return 1.0 if t == 0 else math.sin(math.pi * t) / (math.pi * t)
+
+
+def phase_coefs(delay):
+    # Tap j weights the input TAPS / 2 - 1 - j samples before the one the output follows
+    centre = TAPS // 2 - 1
+    h = [sinc(j - centre - delay) * kaiser(j - centre - delay, TAPS / 2, BETA) for j in range(TAPS)]
+    total = sum(h)
+    q = [int(round((1 << Q) * c / total)) for c in h]
+    # Put the rounding error on the largest tap so that the DC gain is exact
+    q[max(range(TAPS), key=lambda j: abs(q[j]))] += (1 << Q) - sum(q)
+    return q
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("output", help="C file to write")
+    args = parser.parse_args()
+
+    with open(args.output, "w") as f:
+        f.write("// Copyright 2022 XMOS LIMITED.\n")
+        f.write("// This Software is subject to the terms of the XMOS Public Licence: Version 1.\n\n")
+        f.write("/* Generated by script/gen_drift_src_coefs.py, do not edit */\n\n")
+        f.write("#include <stdint.h>\n\n")
+        f.write("#include \"drift_src_coefs.h\"\n\n")
+        f.write("#if DRIFT_SRC_TAPS != %d || DRIFT_SRC_PHASES != %d\n" % (TAPS, PHASES))
+        f.write("#error drift_src_coefs.c must be regenerated\n")
+        f.write("#endif\n\n")
+        f.write("const int32_t drift_src_coefs[DRIFT_SRC_PHASES + 1][DRIFT_SRC_TAPS] = {\n")
+        for p in range(PHASES + 1):
+            q = phase_coefs(p / PHASES)
+            f.write("    {")
+            for j, c in enumerate(q):
+                if j % 8 == 0:
+                    f.write("\n        ")
+                f.write("%11d," % c)
+            f.write("\n    },\n")
+        f.write("};\n")
+
+
+if __name__ == "__main__":
+    main()
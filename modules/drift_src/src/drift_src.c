@@ -0,0 +1,185 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+/* STD headers */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "drift_src.h"
+#include "drift_src_coefs.h"
+
+#define HALF    (DRIFT_SRC_TAPS / 2)
+
+/*
+ * Within a call the inputs are indexed after the history, so sample j is
+ * history[j] for j < DRIFT_SRC_HISTORY and the new input after that. The
+ * output at position pos lies between samples k and k + 1, where k is the
+ * whole part of pos, and is filtered from samples k - HALF + 1 to k + HALF.
+ * So with n_in new inputs there are outputs up to a position of
+ * n_in + DRIFT_SRC_HISTORY - HALF, and the position must end no earlier than
+ * HALF - 1 samples into the last DRIFT_SRC_HISTORY samples so that they are
+ * enough for the next call.
+ */
+#define POS_LIMIT(n_in)     ((uint64_t) ((n_in) + DRIFT_SRC_HISTORY - HALF) << 32)
+#define POS_REBASE(n_in)    ((uint64_t) (n_in) << 32)
+
+/* At a step of one this makes one output per input from the start */
+#define POS_INITIAL         POS_LIMIT(0)
+
+static inline uint64_t drift_src_step_q32(const drift_src_t *ctx)
+{
+    return (uint64_t) ctx->step << 2;
+}
+
+static inline int32_t drift_src_sample(const int32_t *history, const int32_t *in, size_t j)
+{
+    return j < DRIFT_SRC_HISTORY ? history[j] : in[j - DRIFT_SRC_HISTORY];
+}
+
+static inline int64_t drift_src_dot(const int32_t *coefs, const int32_t *x)
+{
+    int64_t acc = 0;
+
+    for (int j = 0; j < DRIFT_SRC_TAPS; j++) {
+        acc += (int64_t) coefs[j] * x[j];
+    }
+    return acc;
+}
+
+/*
+ * Filters the DRIFT_SRC_TAPS samples at x to the point frac, in UQ0.32, of
+ * the way between the middle two. The filters either side of frac are both
+ * applied and their outputs interpolated linearly, with 14 bits below the
+ * sample kept until the end. The magnitudes of the taps of any one filter
+ * add up to less than three, so the sums fit in 64 bits.
+ */
+static inline int32_t drift_src_filter(const int32_t *x, uint32_t frac)
+{
+    const uint32_t p = frac >> (32 - DRIFT_SRC_PHASES_LOG2);
+    const int64_t r = (frac >> (17 - DRIFT_SRC_PHASES_LOG2)) & 0x7FFF;
+    const int64_t y0 = drift_src_dot(drift_src_coefs[p], x) >> 16;
+    const int64_t y1 = drift_src_dot(drift_src_coefs[p + 1], x) >> 16;
+    int64_t y;
+
+    y = y0 + (((y1 - y0) * r) >> 15);
+    y = (y + (1 << 13)) >> 14;
+
+    if (y > INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (y < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t) y;
+}
+
+/*
+ * Makes n_out outputs of every channel from n_in inputs, then moves the
+ * position and history on past the inputs.
+ */
+static void drift_src_run(drift_src_t *ctx,
+                          int32_t *out, size_t out_stride,
+                          const int32_t *in, size_t in_stride,
+                          size_t n_in, size_t n_out)
+{
+    const uint64_t step = drift_src_step_q32(ctx);
+
+    for (size_t ch = 0; ch < ctx->channels; ch++) {
+        const int32_t *history = ctx->history[ch];
+        const int32_t *x = in + ch * in_stride;
+        int32_t *y = out + ch * out_stride;
+        uint64_t pos = ctx->pos;
+
+        for (size_t i = 0; i < n_out; i++) {
+            const size_t first = (size_t) (pos >> 32) - (HALF - 1);
+            int32_t window[DRIFT_SRC_TAPS];
+            const int32_t *w;
+
+            /* Only the first few outputs of a call reach back into the history */
+            if (first >= DRIFT_SRC_HISTORY) {
+                w = &x[first - DRIFT_SRC_HISTORY];
+            } else {
+                for (size_t j = 0; j < DRIFT_SRC_TAPS; j++) {
+                    window[j] = drift_src_sample(history, x, first + j);
+                }
+                w = window;
+            }
+
+            y[i] = drift_src_filter(w, (uint32_t) pos);
+            pos += step;
+        }
+    }
+
+    for (size_t ch = 0; ch < ctx->channels; ch++) {
+        int32_t *history = ctx->history[ch];
+        const int32_t *x = in + ch * in_stride;
+
+        /* Each sample moves to a lower index, so none is overwritten before it is read */
+        for (size_t j = 0; j < DRIFT_SRC_HISTORY; j++) {
+            history[j] = drift_src_sample(history, x, n_in + j);
+        }
+    }
+
+    ctx->pos += n_out * step;
+    ctx->pos -= POS_REBASE(n_in);
+}
+
+void drift_src_init(drift_src_t *ctx, size_t channels)
+{
+    memset(ctx, 0, sizeof(drift_src_t));
+    ctx->channels = channels <= DRIFT_SRC_MAX_CHANNELS ? channels : DRIFT_SRC_MAX_CHANNELS;
+    ctx->step = DRIFT_SRC_STEP_ONE;
+    ctx->pos = POS_INITIAL;
+}
+
+void drift_src_set_step(drift_src_t *ctx, uint32_t step)
+{
+    ctx->step = step != 0 ? step : 1;
+}
+
+size_t drift_src_output_count(const drift_src_t *ctx, size_t n_in)
+{
+    const uint64_t limit = POS_LIMIT(n_in);
+    const uint64_t step = drift_src_step_q32(ctx);
+
+    if (ctx->pos >= limit) {
+        return 0;
+    }
+    return (size_t) ((limit - ctx->pos + step - 1) / step);
+}
+
+size_t drift_src_input_count(const drift_src_t *ctx, size_t n_out)
+{
+    if (n_out == 0) {
+        return 0;
+    }
+
+    /* Just enough inputs to reach the last output */
+    const uint64_t last = ctx->pos + (n_out - 1) * drift_src_step_q32(ctx);
+    return (size_t) (last >> 32) + HALF + 1 - DRIFT_SRC_HISTORY;
+}
+
+size_t drift_src_push(drift_src_t *ctx,
+                      int32_t *out, size_t out_stride,
+                      const int32_t *in, size_t in_stride,
+                      size_t n_in)
+{
+    const size_t n_out = drift_src_output_count(ctx, n_in);
+
+    drift_src_run(ctx, out, out_stride, in, in_stride, n_in, n_out);
+
+    return n_out;
+}
+
+size_t drift_src_pull(drift_src_t *ctx,
+                      int32_t *out, size_t out_stride,
+                      const int32_t *in, size_t in_stride,
+                      size_t n_out)
+{
+    const size_t n_in = drift_src_input_count(ctx, n_out);
+
+    drift_src_run(ctx, out, out_stride, in, in_stride, n_in, n_out);
+
+    return n_in;
+}
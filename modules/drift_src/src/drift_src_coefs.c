@@ -0,0 +1,340 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* Generated by script/gen_drift_src_coefs.py, do not edit */
+
+#include <stdint.h>
+
+#include "drift_src_coefs.h"
+
+#if DRIFT_SRC_TAPS != 24 || DRIFT_SRC_PHASES != 64
+#error drift_src_coefs.c must be regenerated
+#endif
+
+const int32_t drift_src_coefs[DRIFT_SRC_PHASES + 1][DRIFT_SRC_TAPS] = {
+    {
+                  0,          0,          0,          0,          0,          0,          0,          0,
+                  0,          0,          0, 1073741824,          0,          0,          0,          0,
+                  0,          0,          0,          0,          0,          0,          0,          0,
+    },
+    {
+             -10895,      40145,    -108238,     243959,    -487458,     893648,   -1541600,    2563103,
+           -4236876,    7375808,  -16017455, 1073304168,   16556501,   -7519969,    4305683,   -2603385,
+            1566954,    -909733,     497355,    -249694,     111278,     -41561,      11434,      -1348,
+    },
+    {
+             -21238,      78807,    -213227,     481680,    -963976,    1769253,   -3054432,    5080256,
+           -8395795,   14592946,  -31481786, 1071989307,   33636909,  -15168993,    8670713,   -5241199,
+            3155730,   -1833518,    1003516,    -504594,     225373,     -84465,      23393,      -2836,
+    },
+    {
+             -31021,     115925,    -314775,     712689,   -1428558,    2624936,   -4535205,    7545986,
+          -12467930,   21637508,  -46379953, 1069799224,   51225003,  -22931369,   13085323,   -7907403,
+            4762677,   -2769248,    1517347,    -764144,     342050,    -128632,      35861,      -4467,
+    },
+    {
+             -40237,     151445,    -412702,     936539,   -1880258,    3458900,   -5980761,    9955030,
+          -16444795,   28496227,  -60700009, 1066737217,   69303536,  -30790844,   17539470,  -10595798,
+            6384042,   -3714747,    2037670,   -1027765,     461060,    -173976,      48820,      -6240,
+    },
+    {
+             -48880,     185318,    -506843,    1152812,   -2318181,    4269436,   -7388079,   12302343,
+          -20318269,   35156496,  -74431111, 1062807894,   87854261,  -38730638,   22022857,  -13300030,
+            8015973,   -4667776,    2563266,   -1294849,     582138,    -220403,      62246,      -8157,
+    },
+    {
+             -56948,     217505,    -597048,    1361119,   -2741488,    5054922,   -8754284,   14583111,
+          -24080604,   41606379,  -87563530, 1058017175,  106857953,  -46733471,   26524949,  -16013610,
+            9654531,   -5626039,    3092878,   -1564771,     705010,    -267815,      76117,     -10217,
+    },
+    {
+             -64440,     247969,    -683182,    1561103,   -3149390,    5813830,  -10076647,   16792753,
+          -27724438,   47834634, -100088656, 1052372261,  126294433,  -54781591,   31034998,  -18729925,
+           11295694,   -6587184,    3625214,   -1836880,     829388,    -316107,      90407,     -12420,
+    },
+    {
+             -71357,     276683,    -765125,    1752435,   -3541156,    6544725,  -11352594,   18926938,
+          -31242810,   53830717, -111999006, 1045881632,  146142604,  -62856808,   35542066,  -21442253,
+           12935373,   -7548812,    4158950,   -2110505,     954971,    -365167,     105086,     -14763,
+    },
+    {
+             -77703,     303621,    -842770,    1934817,   -3916111,    7246268,  -12579709,   20981582,
+          -34629167,   59584799, -123288226, 1038555050,  166380471,  -70940517,   40035044,  -24143778,
+           14569413,   -8508480,    4692733,   -2384959,    1081448,    -414879,     120122,     -17245,
+    },
+    {
+             -83483,     328770,    -916028,    2107981,   -4273636,    7917220,  -13755736,   22952864,
+          -37877376,   65087776, -133951088, 1030403493,  186985182,  -79013741,   44502681,  -26827605,
+           16193608,   -9463707,    5225181,   -2659533,    1208499,    -465120,     135483,     -19861,
+    },
+    {
+             -88702,     352116,    -984822,    2271690,   -4613169,    8556440,  -14878584,   24837222,
+          -40981731,   70331275, -143983495, 1021439189,  207933056,  -87057153,   48933605,  -29486778,
+           17803712,  -10411983,    5754891,   -2933505,    1335790,    -515762,     151131,     -22609,
+    },
+    {
+             -93371,     373655,   -1049089,    2425738,   -4934208,    9162887,  -15946326,   26631366,
+          -43936959,   75307658, -153382471, 1011675553,  229199624,  -95051120,   53316350,  -32114294,
+           19395443,  -11350769,    6280439,   -3206138,    1462982,    -566672,     167028,     -25482,
+    },
+    {
+             -97498,     393387,   -1108782,    2569948,   -5236305,    9735622,  -16957208,   28332276,
+          -46738231,   80010035, -162146159, 1001127189,  250759662, -102975733,   57639380,  -34703121,
+           20964499,  -12277508,    6800385,   -3476682,    1589724,    -617712,     183132,     -28476,
+    },
+    {
+            -101096,     411317,   -1163867,    2704175,   -5519074,   10273811,  -17909643,   29937210,
+          -49381160,   84432259, -170273812,  989809843,  272587229, -110810848,   61891118,  -37246214,
+           22506566,  -13189630,    7313275,   -3744374,    1715660,    -668738,     199401,     -31584,
+    },
+    {
+            -104176,     427457,   -1214323,    2828301,   -5782183,   10776719,  -18802218,   31443703,
+          -51861809,   88568930, -177765782,  977740389,  294655715, -118536119,   66059971,  -39736535,
+           24017331,  -14084556,    7817646,   -4008446,    1840423,    -719604,     215788,     -34798,
+    },
+    {
+            -106753,     441823,   -1260143,    2942241,   -6025361,   11243715,  -19633693,   32849572,
+          -54176695,   92415398, -184623510,  964936792,  316937874, -126131038,   70134357,  -42167064,
+           25492489,  -14959710,    8312028,   -4268119,    1963645,    -770157,     232244,     -38111,
+    },
+    {
+            -108842,     454433,   -1301334,    3045937,   -6248391,   11674271,  -20403000,   34152913,
+          -56322785,   95967756, -190849508,  951418074,  339405876, -133574978,   74102734,  -44530826,
+           26927757,  -15812519,    8794950,   -4522610,    2084949,    -820242,     248721,     -41512,
+    },
+    {
+            -110460,     465315,   -1337914,    3139359,   -6451115,   12067961,  -21109244,   35352107,
+          -58297503,   99222840, -196447349,  937204289,  362031344, -140847227,   77953626,  -46820901,
+           28318886,  -16640426,    9264942,   -4771134,    2203955,    -869700,     265166,     -44993,
+    },
+    {
+            -111624,     474497,   -1369914,    3222507,   -6633428,   12424460,  -21751703,   36445815,
+          -60098724,  102178226, -201421644,  922316467,  384785405, -147927031,   81675654,  -49030446,
+           29661670,  -17440891,    9720541,   -5012903,    2320278,    -918371,     281524,     -48541,
+    },
+    {
+            -112352,     482012,   -1397378,    3295406,   -6795284,   12743544,  -22329828,   37432979,
+          -61724777,  104832218, -205778024,  906776599,  407638738, -154793637,   85257562,  -51152711,
+           30951959,  -18211404,   10160292,   -5247131,    2433535,    -966088,     297740,     -52146,
+    },
+    {
+            -112662,     487899,   -1420358,    3358111,   -6936687,   13025087,  -22843238,   38312822,
+          -63174438,  107183844, -209523117,  890607576,  430561619, -161426332,   88688245,  -53181060,
+           32185667,  -18949486,   10582753,   -5473033,    2543336,   -1012685,     313756,     -55795,
+    },
+    {
+            -112574,     492197,   -1438921,    3410700,   -7057696,   13269063,  -23291721,   39084841,
+          -64446929,  109232846, -212664529,  873833171,  453523970, -167804486,   91956779,  -55108985,
+           33358789,  -19652700,   10986502,   -5689832,    2649295,   -1057994,     329512,     -59474,
+    },
+    {
+            -112109,     494952,   -1453143,    3453276,   -7158422,   13475539,  -23675232,   39748809,
+          -65541912,  110979670, -215210813,  856477970,  476495415, -173907591,   95052451,  -56930127,
+           34467408,  -20318658,   11370138,   -5896757,    2751025,   -1101845,     344949,     -63169,
+    },
+    {
+            -111287,     496211,   -1463109,    3485968,   -7239026,   13644680,  -23993889,   40304769,
+          -66459483,  112425451, -217171446,  838567345,  499445325, -179715311,   97964784,  -58638294,
+           35507709,  -20945024,   11732285,   -6093047,    2848141,   -1144067,     360004,     -66865,
+    },
+    {
+            -110129,     496024,   -1468914,    3508929,   -7299718,   13776741,  -24247972,   40753030,
+          -67200167,  113572002, -218556801,  820127406,  522342871, -185207515,  100683566,  -60227477,
+           36475987,  -21529525,   12071597,   -6277953,    2940262,   -1184488,     374613,     -70545,
+    },
+    {
+            -108656,     494445,   -1470662,    3522331,   -7340754,   13872066,  -24437917,   41094163,
+          -67764908,  114421800, -219378115,  801184953,  545157078, -190364328,  103198880,  -61691869,
+           37368660,  -22069957,   12386763,   -6450739,    3027009,   -1222938,     388714,     -74195,
+    },
+    {
+            -106890,     491529,   -1468467,    3526371,   -7362438,   13931089,  -24564315,   41328995,
+          -68155063,  114977966, -219647459,  781767417,  567856879, -195166168,  105501132,  -63025880,
+           38182283,  -22564191,   12676510,   -6610688,    3108011,   -1259245,     402241,     -77795,
+    },
+    {
+            -104852,     487333,   -1462447,    3521264,   -7365118,   13954327,  -24627905,   41458601,
+          -68372390,  115244251, -219377707,  761902837,  590411163, -199593788,  107581075,  -64224159,
+           38913552,  -23010180,   12939607,   -6757100,    3182902,   -1293241,     415128,     -81329,
+    },
+    {
+            -102564,     481917,   -1452732,    3507246,   -7349182,   13942379,  -24629574,   41484304,
+          -68419040,  115225019, -218582500,  741619778,  612788834, -203628325,  109429841,  -65281605,
+           39559320,  -23405967,   13174869,   -6889296,    3251325,   -1324757,     427311,     -84777,
+    },
+    {
+            -100048,     475343,   -1439456,    3484569,   -7315060,   13895923,  -24570349,   41407659,
+          -68297544,  114925221, -217276211,  720947308,  634958863, -207251333,  111038962,  -66193387,
+           40116606,  -23749687,   13381162,   -7006621,    3312930,   -1353628,     438722,     -88120,
+    },
+    {
+             -97324,     467672,   -1422758,    3453506,   -7263222,   13815713,  -24451391,   41230454,
+          -68010803,  114350382, -215473912,  699914929,  656890341, -210444829,  112400401,  -66954959,
+           40582604,  -24039581,   13557404,   -7108447,    3367378,   -1379691,     449297,     -91340,
+    },
+    {
+             -94414,     458968,   -1402786,    3414341,   -7194171,   13702575,  -24273996,   40954695,
+          -67562074,  113506576, -213191334,  678552532,  678552532, -213191334,  113506576,  -67562074,
+           40954695,  -24273996,   13702575,   -7194171,    3414341,   -1402786,     458968,     -94414,
+    },
+    {
+             -91340,     449297,   -1379691,    3367378,   -7108447,   13557404,  -24039581,   40582604,
+          -66954959,  112400401, -210444829,  656890341,  699914929, -215473912,  114350382,  -68010803,
+           41230454,  -24451391,   13815713,   -7263222,    3453506,   -1422758,     467672,     -97324,
+    },
+    {
+             -88120,     438722,   -1353628,    3312930,   -7006621,   13381162,  -23749687,   40116606,
+          -66193387,  111038962, -207251333,  634958863,  720947308, -217276211,  114925221,  -68297544,
+           41407659,  -24570349,   13895923,   -7315060,    3484569,   -1439456,     475343,    -100048,
+    },
+    {
+             -84777,     427311,   -1324757,    3251325,   -6889296,   13174869,  -23405967,   39559320,
+          -65281605,  109429841, -203628325,  612788834,  741619778, -218582500,  115225019,  -68419040,
+           41484304,  -24629574,   13942379,   -7349182,    3507246,   -1452732,     481917,    -102564,
+    },
+    {
+             -81329,     415128,   -1293241,    3182902,   -6757100,   12939607,  -23010180,   38913552,
+          -64224159,  107581075, -199593788,  590411163,  761902837, -219377707,  115244251,  -68372390,
+           41458601,  -24627905,   13954327,   -7365118,    3521264,   -1462447,     487333,    -104852,
+    },
+    {
+             -77795,     402241,   -1259245,    3108011,   -6610688,   12676510,  -22564191,   38182283,
+          -63025880,  105501132, -195166168,  567856879,  781767417, -219647459,  114977966,  -68155063,
+           41328995,  -24564315,   13931089,   -7362438,    3526371,   -1468467,     491529,    -106890,
+    },
+    {
+             -74195,     388714,   -1222938,    3027009,   -6450739,   12386763,  -22069957,   37368660,
+          -61691869,  103198880, -190364328,  545157078,  801184953, -219378115,  114421800,  -67764908,
+           41094163,  -24437917,   13872066,   -7340754,    3522331,   -1470662,     494445,    -108656,
+    },
+    {
+             -70545,     374613,   -1184488,    2940262,   -6277953,   12071597,  -21529525,   36475987,
+          -60227477,  100683566, -185207515,  522342871,  820127406, -218556801,  113572002,  -67200167,
+           40753030,  -24247972,   13776741,   -7299718,    3508929,   -1468914,     496024,    -110129,
+    },
+    {
+             -66865,     360004,   -1144067,    2848141,   -6093047,   11732285,  -20945024,   35507709,
+          -58638294,   97964784, -179715311,  499445325,  838567345, -217171446,  112425451,  -66459483,
+           40304769,  -23993889,   13644680,   -7239026,    3485968,   -1463109,     496211,    -111287,
+    },
+    {
+             -63169,     344949,   -1101845,    2751025,   -5896757,   11370138,  -20318658,   34467408,
+          -56930127,   95052451, -173907591,  476495415,  856477970, -215210813,  110979670,  -65541912,
+           39748809,  -23675232,   13475539,   -7158422,    3453276,   -1453143,     494952,    -112109,
+    },
+    {
+             -59474,     329512,   -1057994,    2649295,   -5689832,   10986502,  -19652700,   33358789,
+          -55108985,   91956779, -167804486,  453523970,  873833171, -212664529,  109232846,  -64446929,
+           39084841,  -23291721,   13269063,   -7057696,    3410700,   -1438921,     492197,    -112574,
+    },
+    {
+             -55795,     313756,   -1012685,    2543336,   -5473033,   10582753,  -18949486,   32185667,
+          -53181060,   88688245, -161426332,  430561619,  890607576, -209523117,  107183844,  -63174438,
+           38312822,  -22843238,   13025087,   -6936687,    3358111,   -1420358,     487899,    -112662,
+    },
+    {
+             -52146,     297740,    -966088,    2433535,   -5247131,   10160292,  -18211404,   30951959,
+          -51152711,   85257562, -154793637,  407638738,  906776599, -205778024,  104832218,  -61724777,
+           37432979,  -22329828,   12743544,   -6795284,    3295406,   -1397378,     482012,    -112352,
+    },
+    {
+             -48541,     281524,    -918371,    2320278,   -5012903,    9720541,  -17440891,   29661670,
+          -49030446,   81675654, -147927031,  384785405,  922316467, -201421644,  102178226,  -60098724,
+           36445815,  -21751703,   12424460,   -6633428,    3222507,   -1369914,     474497,    -111624,
+    },
+    {
+             -44993,     265166,    -869700,    2203955,   -4771134,    9264942,  -16640426,   28318886,
+          -46820901,   77953626, -140847227,  362031344,  937204289, -196447349,   99222840,  -58297503,
+           35352107,  -21109244,   12067961,   -6451115,    3139359,   -1337914,     465315,    -110460,
+    },
+    {
+             -41512,     248721,    -820242,    2084949,   -4522610,    8794950,  -15812519,   26927757,
+          -44530826,   74102734, -133574978,  339405876,  951418074, -190849508,   95967756,  -56322785,
+           34152913,  -20403000,   11674271,   -6248391,    3045937,   -1301334,     454433,    -108842,
+    },
+    {
+             -38111,     232244,    -770157,    1963645,   -4268119,    8312028,  -14959710,   25492489,
+          -42167064,   70134357, -126131038,  316937874,  964936792, -184623510,   92415398,  -54176695,
+           32849572,  -19633693,   11243715,   -6025361,    2942241,   -1260143,     441823,    -106753,
+    },
+    {
+             -34798,     215788,    -719604,    1840423,   -4008446,    7817646,  -14084556,   24017331,
+          -39736535,   66059971, -118536119,  294655715,  977740389, -177765782,   88568930,  -51861809,
+           31443703,  -18802218,   10776719,   -5782183,    2828301,   -1214323,     427457,    -104176,
+    },
+    {
+             -31584,     199401,    -668738,    1715660,   -3744374,    7313275,  -13189630,   22506566,
+          -37246214,   61891118, -110810848,  272587229,  989809843, -170273812,   84432259,  -49381160,
+           29937210,  -17909643,   10273811,   -5519074,    2704175,   -1163867,     411317,    -101096,
+    },
+    {
+             -28476,     183132,    -617712,    1589724,   -3476682,    6800385,  -12277508,   20964499,
+          -34703121,   57639380, -102975733,  250759662, 1001127189, -162146159,   80010035,  -46738231,
+           28332276,  -16957208,    9735622,   -5236305,    2569948,   -1108782,     393387,     -97498,
+    },
+    {
+             -25482,     167028,    -566672,    1462982,   -3206138,    6280439,  -11350769,   19395443,
+          -32114294,   53316350,  -95051120,  229199624, 1011675553, -153382471,   75307658,  -43936959,
+           26631366,  -15946326,    9162887,   -4934208,    2425738,   -1049089,     373655,     -93371,
+    },
+    {
+             -22609,     151131,    -515762,    1335790,   -2933505,    5754891,  -10411983,   17803712,
+          -29486778,   48933605,  -87057153,  207933056, 1021439189, -143983495,   70331275,  -40981731,
+           24837222,  -14878584,    8556440,   -4613169,    2271690,    -984822,     352116,     -88702,
+    },
+    {
+             -19861,     135483,    -465120,    1208499,   -2659533,    5225181,   -9463707,   16193608,
+          -26827605,   44502681,  -79013741,  186985182, 1030403493, -133951088,   65087776,  -37877376,
+           22952864,  -13755736,    7917220,   -4273636,    2107981,    -916028,     328770,     -83483,
+    },
+    {
+             -17245,     120122,    -414879,    1081448,   -2384959,    4692733,   -8508480,   14569413,
+          -24143778,   40035044,  -70940517,  166380471, 1038555050, -123288226,   59584799,  -34629167,
+           20981582,  -12579709,    7246268,   -3916111,    1934817,    -842770,     303621,     -77703,
+    },
+    {
+             -14763,     105086,    -365167,     954971,   -2110505,    4158950,   -7548812,   12935373,
+          -21442253,   35542066,  -62856808,  146142604, 1045881632, -111999006,   53830717,  -31242810,
+           18926938,  -11352594,    6544725,   -3541156,    1752435,    -765125,     276683,     -71357,
+    },
+    {
+             -12420,      90407,    -316107,     829388,   -1836880,    3625214,   -6587184,   11295694,
+          -18729925,   31034998,  -54781591,  126294433, 1052372261, -100088656,   47834634,  -27724438,
+           16792753,  -10076647,    5813830,   -3149390,    1561103,    -683182,     247969,     -64440,
+    },
+    {
+             -10217,      76117,    -267815,     705010,   -1564771,    3092878,   -5626039,    9654531,
+          -16013610,   26524949,  -46733471,  106857953, 1058017175,  -87563530,   41606379,  -24080604,
+           14583111,   -8754284,    5054922,   -2741488,    1361119,    -597048,     217505,     -56948,
+    },
+    {
+              -8157,      62246,    -220403,     582138,   -1294849,    2563266,   -4667776,    8015973,
+          -13300030,   22022857,  -38730638,   87854261, 1062807894,  -74431111,   35156496,  -20318269,
+           12302343,   -7388079,    4269436,   -2318181,    1152812,    -506843,     185318,     -48880,
+    },
+    {
+              -6240,      48820,    -173976,     461060,   -1027765,    2037670,   -3714747,    6384042,
+          -10595798,   17539470,  -30790844,   69303536, 1066737217,  -60700009,   28496227,  -16444795,
+            9955030,   -5980761,    3458900,   -1880258,     936539,    -412702,     151445,     -40237,
+    },
+    {
+              -4467,      35861,    -128632,     342050,    -764144,    1517347,   -2769248,    4762677,
+           -7907403,   13085323,  -22931369,   51225003, 1069799224,  -46379953,   21637508,  -12467930,
+            7545986,   -4535205,    2624936,   -1428558,     712689,    -314775,     115925,     -31021,
+    },
+    {
+              -2836,      23393,     -84465,     225373,    -504594,    1003516,   -1833518,    3155730,
+           -5241199,    8670713,  -15168993,   33636909, 1071989307,  -31481786,   14592946,   -8395795,
+            5080256,   -3054432,    1769253,    -963976,     481680,    -213227,      78807,     -21238,
+    },
+    {
+              -1348,      11434,     -41561,     111278,    -249694,     497355,    -909733,    1566954,
+           -2603385,    4305683,   -7519969,   16556501, 1073304168,  -16017455,    7375808,   -4236876,
+            2563103,   -1541600,     893648,    -487458,     243959,    -108238,      40145,     -10895,
+    },
+    {
+                  0,          0,          0,          0,          0,          0,          0,          0,
+                  0,          0,          0,          0, 1073741824,          0,          0,          0,
+                  0,          0,          0,          0,          0,          0,          0,          0,
+    },
+};
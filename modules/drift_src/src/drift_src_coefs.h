@@ -0,0 +1,18 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef DRIFT_SRC_COEFS_H_
+#define DRIFT_SRC_COEFS_H_
+
+#include <stdint.h>
+
+#include "drift_src.h"
+
+/*
+ * Fractional delay filters in Q30. Row p delays by p / DRIFT_SRC_PHASES of a
+ * sample, and tap j weights the input DRIFT_SRC_TAPS / 2 - 1 - j samples
+ * before the one the output follows, so row 0 is a unit impulse.
+ */
+extern const int32_t drift_src_coefs[DRIFT_SRC_PHASES + 1][DRIFT_SRC_TAPS];
+
+#endif /* DRIFT_SRC_COEFS_H_ */
@@ -0,0 +1,48 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef FRAME_CODEC_H_
+#define FRAME_CODEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Compact wire formats for blocks of Q31 audio samples sent between tiles.
+ *
+ * FRAME_CODEC_INT32 is the samples as they are.
+ * FRAME_CODEC_INT24 keeps the top 24 bits of each sample, packed in 3 bytes.
+ * FRAME_CODEC_INT16 keeps the top 16 bits of each sample.
+ * FRAME_CODEC_BFP16 stores 16 bit mantissas with one shared exponent per
+ * block, so quiet signals keep their low order bits. It is lossless for
+ * blocks whose samples all fit in 16 bits.
+ *
+ * The 24 and 16 bit formats truncate. Every encoded block is a multiple of
+ * 4 bytes long when the block length is a multiple of 4 samples, so that
+ * blocks can be packed back to back.
+ */
+#define FRAME_CODEC_INT32   0
+#define FRAME_CODEC_INT24   1
+#define FRAME_CODEC_INT16   2
+#define FRAME_CODEC_BFP16   3
+
+/* Number of bytes that num_samples samples encode to in format */
+#define FRAME_CODEC_ENCODED_SIZE(format, num_samples)                          \
+    ((format) == FRAME_CODEC_INT24 ? 3 * (num_samples) :                       \
+     (format) == FRAME_CODEC_INT16 ? 2 * (num_samples) :                       \
+     (format) == FRAME_CODEC_BFP16 ? sizeof(int32_t) + 2 * (num_samples) :     \
+                                     sizeof(int32_t) * (num_samples))
+
+/*
+ * Encodes num_samples samples from src into dst in format, and returns the
+ * number of bytes written. dst must be 4 byte aligned.
+ */
+size_t frame_codec_encode(int format, uint8_t *dst, const int32_t *src, size_t num_samples);
+
+/*
+ * Decodes num_samples samples in format from src into dst, and returns the
+ * number of bytes read. src must be 4 byte aligned.
+ */
+size_t frame_codec_decode(int format, int32_t *dst, const uint8_t *src, size_t num_samples);
+
+#endif /* FRAME_CODEC_H_ */
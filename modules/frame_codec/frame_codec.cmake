@@ -0,0 +1,13 @@
+## Create frame codec library
+add_library(sln_voice_frame_codec INTERFACE)
+target_sources(sln_voice_frame_codec
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/src/frame_codec.c
+)
+target_include_directories(sln_voice_frame_codec
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/api
+)
+
+## Create an alias
+add_library(sln_voice::frame_codec ALIAS sln_voice_frame_codec)
@@ -0,0 +1,101 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+/* STD headers */
+#include <string.h>
+#include <stdint.h>
+
+#include "frame_codec.h"
+
+static size_t encode_int24(uint8_t *dst, const int32_t *src, size_t num_samples)
+{
+    for (size_t i = 0; i < num_samples; i++) {
+        uint32_t s = (uint32_t) src[i];
+        dst[3 * i + 0] = (uint8_t)(s >> 8);
+        dst[3 * i + 1] = (uint8_t)(s >> 16);
+        dst[3 * i + 2] = (uint8_t)(s >> 24);
+    }
+    return 3 * num_samples;
+}
+
+static size_t decode_int24(int32_t *dst, const uint8_t *src, size_t num_samples)
+{
+    for (size_t i = 0; i < num_samples; i++) {
+        dst[i] = (int32_t)(((uint32_t) src[3 * i + 0] << 8) |
+                           ((uint32_t) src[3 * i + 1] << 16) |
+                           ((uint32_t) src[3 * i + 2] << 24));
+    }
+    return 3 * num_samples;
+}
+
+static size_t encode_shifted16(int16_t *dst, const int32_t *src, size_t num_samples, int shift)
+{
+    for (size_t i = 0; i < num_samples; i++) {
+        dst[i] = (int16_t)(src[i] >> shift);
+    }
+    return 2 * num_samples;
+}
+
+static size_t decode_shifted16(int32_t *dst, const int16_t *src, size_t num_samples, int shift)
+{
+    for (size_t i = 0; i < num_samples; i++) {
+        dst[i] = (int32_t)((uint32_t)(int32_t) src[i] << shift);
+    }
+    return 2 * num_samples;
+}
+
+static size_t encode_bfp16(uint8_t *dst, const int32_t *src, size_t num_samples)
+{
+    int32_t headroom = 31;
+
+    /* Redundant sign bits common to every sample in the block */
+    for (size_t i = 0; i < num_samples && headroom > 0; i++) {
+        int32_t hr = __builtin_clrsb(src[i]);
+        if (hr < headroom) {
+            headroom = hr;
+        }
+    }
+
+    int32_t shift = (headroom >= 16) ? 0 : 16 - headroom;
+    memcpy(dst, &shift, sizeof(shift));
+
+    return sizeof(shift) + encode_shifted16((int16_t *)(dst + sizeof(shift)), src, num_samples, shift);
+}
+
+static size_t decode_bfp16(int32_t *dst, const uint8_t *src, size_t num_samples)
+{
+    int32_t shift;
+    memcpy(&shift, src, sizeof(shift));
+
+    return sizeof(shift) + decode_shifted16(dst, (const int16_t *)(src + sizeof(shift)), num_samples, shift);
+}
+
+size_t frame_codec_encode(int format, uint8_t *dst, const int32_t *src, size_t num_samples)
+{
+    switch (format) {
+    case FRAME_CODEC_INT24:
+        return encode_int24(dst, src, num_samples);
+    case FRAME_CODEC_INT16:
+        return encode_shifted16((int16_t *) dst, src, num_samples, 16);
+    case FRAME_CODEC_BFP16:
+        return encode_bfp16(dst, src, num_samples);
+    default:
+        memcpy(dst, src, num_samples * sizeof(int32_t));
+        return num_samples * sizeof(int32_t);
+    }
+}
+
+size_t frame_codec_decode(int format, int32_t *dst, const uint8_t *src, size_t num_samples)
+{
+    switch (format) {
+    case FRAME_CODEC_INT24:
+        return decode_int24(dst, src, num_samples);
+    case FRAME_CODEC_INT16:
+        return decode_shifted16(dst, (const int16_t *) src, num_samples, 16);
+    case FRAME_CODEC_BFP16:
+        return decode_bfp16(dst, src, num_samples);
+    default:
+        memcpy(dst, src, num_samples * sizeof(int32_t));
+        return num_samples * sizeof(int32_t);
+    }
+}
@@ -0,0 +1,103 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef FRAME_POOL_H_
+#define FRAME_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Fixed capacity pool of equally sized, 8 byte aligned blocks, used in place
+ * of pvPortMalloc() for audio pipeline frames.
+ *
+ * Free blocks are held in a single producer, single consumer ring of
+ * pointers, so acquire and release are O(1) and need no lock provided that
+ * all acquires happen in one task and all releases happen in one (possibly
+ * different) task. This matches generic_pipeline, where frames are created
+ * by the input function in the first stage task and retired by the output
+ * function in the last stage task.
+ */
+
+/* Maximum number of pools that frame_pool_report() keeps track of */
+#ifndef FRAME_POOL_MAX_POOLS
+#define FRAME_POOL_MAX_POOLS    4
+#endif
+
+/* Length of the queue generic_pipeline creates between each pair of stages */
+#ifndef FRAME_POOL_PIPELINE_QUEUE_DEPTH
+#define FRAME_POOL_PIPELINE_QUEUE_DEPTH    2
+#endif
+
+/*
+ * Most frames a generic_pipeline of stage_count stages can hold at once:
+ * one in each stage task, counting the frame being filled by the input
+ * function in the first and the one being retired by the output function
+ * in the last, plus a full queue between each pair of stages. A pool of
+ * this size never stalls the input while a frame is still in flight.
+ */
+#define FRAME_POOL_PIPELINE_FRAMES(stage_count) \
+    ((stage_count) + ((stage_count) - 1) * FRAME_POOL_PIPELINE_QUEUE_DEPTH)
+
+typedef struct {
+    const char *name;
+    uint8_t *storage;
+    size_t block_size;
+    unsigned capacity;
+
+    /* Ring of capacity + 1 free block pointers */
+    void **ring;
+    volatile unsigned head; /* Only written by frame_pool_release() */
+    volatile unsigned tail; /* Only written by frame_pool_acquire() */
+
+    volatile unsigned acquired;
+    volatile unsigned released;
+    unsigned high_water;
+    unsigned stalls;
+} frame_pool_t;
+
+/*
+ * Statically allocates the storage for a pool called name holding count
+ * objects of type.
+ */
+#define FRAME_POOL_STORAGE(name, type, count)                                          \
+    static uint64_t name##_storage[(count) * ((sizeof(type) + 7) / 8)];               \
+    static void *name##_ring[(count) + 1]
+
+/* Initialises a pool from storage declared with FRAME_POOL_STORAGE() */
+#define FRAME_POOL_INIT(pool, name, type, count)                                      \
+    frame_pool_init((pool), #name, name##_storage, ((sizeof(type) + 7) / 8) * 8,       \
+                    (count), name##_ring)
+
+/*
+ * Initialises pool over storage, which must be 8 byte aligned and hold
+ * capacity blocks of block_size bytes, and ring, which must hold
+ * capacity + 1 pointers. block_size must be a multiple of 8.
+ * The pool is also registered for frame_pool_report().
+ */
+void frame_pool_init(frame_pool_t *pool,
+                     const char *name,
+                     void *storage,
+                     size_t block_size,
+                     unsigned capacity,
+                     void **ring);
+
+/* Returns a free block, or NULL if every block is in use */
+void *frame_pool_try_acquire(frame_pool_t *pool);
+
+/*
+ * Returns a free block, yielding to the scheduler until one is released if
+ * the pool is exhausted. Each time this has to wait is counted as a stall.
+ */
+void *frame_pool_acquire(frame_pool_t *pool);
+
+/* Returns block, previously acquired from pool, to the pool */
+void frame_pool_release(frame_pool_t *pool, void *block);
+
+/* Number of blocks currently acquired and not yet released */
+unsigned frame_pool_in_use(const frame_pool_t *pool);
+
+/* Prints capacity, usage, high-water mark and stalls for every pool */
+void frame_pool_report(void);
+
+#endif /* FRAME_POOL_H_ */
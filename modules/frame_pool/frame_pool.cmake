@@ -0,0 +1,13 @@
+## Create frame pool library
+add_library(sln_voice_frame_pool INTERFACE)
+target_sources(sln_voice_frame_pool
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/src/frame_pool.c
+)
+target_include_directories(sln_voice_frame_pool
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/api
+)
+
+## Create an alias
+add_library(sln_voice::frame_pool ALIAS sln_voice_frame_pool)
@@ -0,0 +1,132 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+/* STD headers */
+#include <stdint.h>
+#include <stddef.h>
+
+/* FreeRTOS headers */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if defined(__XS3A__)
+#include "rtos_printf.h"
+#else
+#include <stdio.h>
+#define rtos_printf printf
+#endif
+
+#include "frame_pool.h"
+
+/*
+ * All cores on a tile share one memory and execute in order, so only the
+ * compiler needs to be stopped from reordering ring and index accesses.
+ */
+#define FRAME_POOL_BARRIER()    __asm__ volatile("" ::: "memory")
+
+static frame_pool_t *pools[FRAME_POOL_MAX_POOLS];
+static unsigned pool_count;
+
+void frame_pool_init(frame_pool_t *pool,
+                     const char *name,
+                     void *storage,
+                     size_t block_size,
+                     unsigned capacity,
+                     void **ring)
+{
+    configASSERT(((uintptr_t) storage & 7) == 0);
+    configASSERT((block_size & 7) == 0);
+    configASSERT(capacity > 0);
+
+    pool->name = name;
+    pool->storage = storage;
+    pool->block_size = block_size;
+    pool->capacity = capacity;
+    pool->ring = ring;
+    pool->acquired = 0;
+    pool->released = 0;
+    pool->high_water = 0;
+    pool->stalls = 0;
+
+    for (unsigned i = 0; i < capacity; i++) {
+        ring[i] = pool->storage + i * block_size;
+    }
+    pool->tail = 0;
+    pool->head = capacity;
+
+    if (pool_count < FRAME_POOL_MAX_POOLS) {
+        pools[pool_count++] = pool;
+    }
+}
+
+void *frame_pool_try_acquire(frame_pool_t *pool)
+{
+    const unsigned tail = pool->tail;
+
+    if (tail == pool->head) {
+        return NULL;
+    }
+
+    FRAME_POOL_BARRIER();
+    void *block = pool->ring[tail];
+    FRAME_POOL_BARRIER();
+
+    pool->tail = (tail == pool->capacity) ? 0 : tail + 1;
+    pool->acquired++;
+
+    const unsigned in_use = pool->acquired - pool->released;
+    if (in_use > pool->high_water) {
+        pool->high_water = in_use;
+    }
+
+    return block;
+}
+
+void *frame_pool_acquire(frame_pool_t *pool)
+{
+    void *block = frame_pool_try_acquire(pool);
+
+    if (block == NULL) {
+        pool->stalls++;
+        do {
+            vTaskDelay(1);
+            block = frame_pool_try_acquire(pool);
+        } while (block == NULL);
+    }
+
+    return block;
+}
+
+void frame_pool_release(frame_pool_t *pool, void *block)
+{
+    const unsigned head = pool->head;
+
+    configASSERT((uint8_t *) block >= pool->storage &&
+                 (uint8_t *) block < pool->storage + pool->capacity * pool->block_size);
+
+    pool->ring[head] = block;
+    FRAME_POOL_BARRIER();
+
+    pool->head = (head == pool->capacity) ? 0 : head + 1;
+    pool->released++;
+}
+
+unsigned frame_pool_in_use(const frame_pool_t *pool)
+{
+    return pool->acquired - pool->released;
+}
+
+void frame_pool_report(void)
+{
+    for (unsigned i = 0; i < pool_count; i++) {
+        const frame_pool_t *pool = pools[i];
+
+        rtos_printf("%s: %u x %u bytes, in use %u, high water %u, stalls %u\n",
+                    pool->name,
+                    pool->capacity,
+                    (unsigned) pool->block_size,
+                    frame_pool_in_use(pool),
+                    pool->high_water,
+                    pool->stalls);
+    }
+}
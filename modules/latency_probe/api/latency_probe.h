@@ -0,0 +1,154 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef LATENCY_PROBE_H_
+#define LATENCY_PROBE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * End to end latency probe for the audio output paths.
+ *
+ * Every pipeline frame carries the reference time at which the mic array
+ * delivered it to the pipeline input. The pipeline output passes that time to
+ * latency_probe_frame_begin() before handing the frame to its sinks, and each
+ * sink records the latency of the frame on its own path when the frame
+ * leaves the device:
+ *
+ *  - A sink that sends a frame straight out calls latency_probe_record()
+ *    once the send returns.
+ *  - A sink that writes into a buffer drained elsewhere calls
+ *    latency_probe_queue() when the frame is written and
+ *    latency_probe_dequeue() as samples are drained, so the time the frame
+ *    spends in the buffer is included.
+ *
+ * Latencies, in 100 MHz reference timer ticks, are accumulated into a
+ * histogram per path. latency_probe_report() sends the histograms over
+ * xscope, where tools/latency/latency_probe_decode.py decodes them, and
+ * clears them.
+ *
+ * All functions are compiled out unless LATENCY_PROBE_ENABLED is 1.
+ */
+
+#ifndef LATENCY_PROBE_ENABLED
+#define LATENCY_PROBE_ENABLED       0
+#endif
+
+/* Maximum number of output paths on one tile */
+#ifndef LATENCY_PROBE_MAX_PATHS
+#define LATENCY_PROBE_MAX_PATHS     4
+#endif
+
+/* Histogram layout. The default covers 0-128 ms in 0.5 ms bins */
+#ifndef LATENCY_PROBE_HIST_BINS
+#define LATENCY_PROBE_HIST_BINS     256
+#endif
+
+#ifndef LATENCY_PROBE_HIST_BIN_TICKS
+#define LATENCY_PROBE_HIST_BIN_TICKS 50000
+#endif
+
+/* Maximum number of queued frames waiting in a path's buffer */
+#ifndef LATENCY_PROBE_MAX_QUEUED
+#define LATENCY_PROBE_MAX_QUEUED    8
+#endif
+
+/* Histogram bins sent in each xscope record */
+#define LATENCY_PROBE_RECORD_BINS   32
+
+/* First word of every xscope record, "LATP" in little endian */
+#define LATENCY_PROBE_RECORD_MAGIC  0x5054414C
+#define LATENCY_PROBE_RECORD_VERSION 1
+
+/* Length of the path name carried in each record, including the terminator */
+#define LATENCY_PROBE_NAME_LEN      12
+
+/*
+ * One xscope record, sent as little endian 32-bit words. A report sends
+ * LATENCY_PROBE_HIST_BINS / LATENCY_PROBE_RECORD_BINS records per path, each
+ * carrying the summary and a slice of the histogram.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t tile;
+    uint32_t path;
+    char name[LATENCY_PROBE_NAME_LEN];
+    uint32_t report;        /* Increments with every report from this tile */
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t mean;
+    uint32_t dropped;       /* Queued frames discarded by latency_probe_flush() */
+    uint32_t bin_ticks;
+    uint32_t total_bins;
+    uint32_t first_bin;
+    uint32_t bins;
+    uint32_t hist[LATENCY_PROBE_RECORD_BINS];
+} latency_probe_record_t;
+
+typedef struct {
+    uint32_t position;      /* Sample count written before the frame */
+    uint32_t capture_time;
+} latency_probe_marker_t;
+
+typedef struct {
+    const char *name;
+
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t dropped;
+    uint32_t hist[LATENCY_PROBE_HIST_BINS];
+
+    /* Single producer, single consumer ring of frames in the path's buffer */
+    latency_probe_marker_t queue[LATENCY_PROBE_MAX_QUEUED + 1];
+    volatile unsigned head;     /* Only written by latency_probe_queue() */
+    volatile unsigned tail;     /* Only written by the consumer */
+    volatile uint32_t written;  /* Only written by latency_probe_queue() */
+    uint32_t read;              /* Only used by the consumer */
+} latency_probe_path_t;
+
+#if LATENCY_PROBE_ENABLED
+
+/* Names path, which must be less than LATENCY_PROBE_MAX_PATHS, and clears it */
+void latency_probe_init(int path, const char *name);
+
+/*
+ * Sets the capture time of the frame being passed to the sinks. Must be
+ * called from the task that calls latency_probe_record() and
+ * latency_probe_queue().
+ */
+void latency_probe_frame_begin(uint32_t capture_time);
+
+/* Records the latency of the current frame on path as of now */
+void latency_probe_record(int path);
+
+/*
+ * Notes that the current frame, of samples samples, has been written to the
+ * buffer drained by path. Frames beyond LATENCY_PROBE_MAX_QUEUED in flight
+ * are not measured.
+ */
+void latency_probe_queue(int path, size_t samples);
+
+/*
+ * Notes that samples samples have been drained from the buffer of path,
+ * recording the latency of every queued frame whose first sample has now
+ * left. Must only be called from one task or interrupt per path.
+ */
+void latency_probe_dequeue(int path, size_t samples);
+
+/*
+ * Discards the frames queued on path, for use when its buffer is reset.
+ * Called from the same context as latency_probe_dequeue().
+ */
+void latency_probe_flush(int path);
+
+/* Sends every named path's histogram to xscope_probe and clears it */
+void latency_probe_report(unsigned char xscope_probe);
+
+#endif /* LATENCY_PROBE_ENABLED */
+
+#endif /* LATENCY_PROBE_H_ */
@@ -0,0 +1,18 @@
+option(ENABLE_LATENCY_PROBE "Measure the latency of each audio output path and report it over xscope" OFF)
+
+## Create latency probe library
+add_library(sln_voice_latency_probe INTERFACE)
+target_sources(sln_voice_latency_probe
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/src/latency_probe.c
+)
+target_include_directories(sln_voice_latency_probe
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/api
+)
+if(ENABLE_LATENCY_PROBE)
+    target_compile_definitions(sln_voice_latency_probe INTERFACE LATENCY_PROBE_ENABLED=1)
+endif()
+
+## Create an alias
+add_library(sln_voice::latency_probe ALIAS sln_voice_latency_probe)
@@ -0,0 +1,155 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+/* STD headers */
+#include <string.h>
+#include <stdint.h>
+#include <xcore/hwtimer.h>
+
+#include "latency_probe.h"
+
+#if LATENCY_PROBE_ENABLED
+
+#include <xscope.h>
+
+#ifndef THIS_XCORE_TILE
+#define THIS_XCORE_TILE 0
+#endif
+
+#if (LATENCY_PROBE_HIST_BINS % LATENCY_PROBE_RECORD_BINS) != 0
+#error LATENCY_PROBE_HIST_BINS must be a multiple of LATENCY_PROBE_RECORD_BINS
+#endif
+
+static latency_probe_path_t latency_probe_paths[LATENCY_PROBE_MAX_PATHS];
+static uint32_t frame_capture_time;
+static uint32_t report_count;
+
+static void latency_probe_clear(latency_probe_path_t *p)
+{
+    p->count = 0;
+    p->total = 0;
+    p->max = 0;
+    p->min = UINT32_MAX;
+    p->dropped = 0;
+    memset(p->hist, 0, sizeof(p->hist));
+}
+
+static void latency_probe_add(latency_probe_path_t *p, uint32_t ticks)
+{
+    uint32_t bin = ticks / LATENCY_PROBE_HIST_BIN_TICKS;
+    if (bin >= LATENCY_PROBE_HIST_BINS) {
+        bin = LATENCY_PROBE_HIST_BINS - 1;
+    }
+
+    p->count++;
+    p->total += ticks;
+    p->hist[bin]++;
+    if (ticks < p->min) {
+        p->min = ticks;
+    }
+    if (ticks > p->max) {
+        p->max = ticks;
+    }
+}
+
+void latency_probe_init(int path, const char *name)
+{
+    latency_probe_path_t *p = &latency_probe_paths[path];
+
+    memset(p, 0, sizeof(latency_probe_path_t));
+    p->name = name;
+    latency_probe_clear(p);
+}
+
+void latency_probe_frame_begin(uint32_t capture_time)
+{
+    frame_capture_time = capture_time;
+}
+
+void latency_probe_record(int path)
+{
+    latency_probe_add(&latency_probe_paths[path], get_reference_time() - frame_capture_time);
+}
+
+void latency_probe_queue(int path, size_t samples)
+{
+    latency_probe_path_t *p = &latency_probe_paths[path];
+    const unsigned next = (p->head + 1) % (LATENCY_PROBE_MAX_QUEUED + 1);
+
+    if (next != p->tail) {
+        p->queue[p->head].position = p->written;
+        p->queue[p->head].capture_time = frame_capture_time;
+        p->head = next;
+    }
+    p->written += samples;
+}
+
+void latency_probe_dequeue(int path, size_t samples)
+{
+    latency_probe_path_t *p = &latency_probe_paths[path];
+    const uint32_t now = get_reference_time();
+
+    p->read += samples;
+
+    /* A frame has left once the sample count read passes its first sample */
+    while (p->tail != p->head && (int32_t) (p->read - p->queue[p->tail].position) > 0) {
+        latency_probe_add(p, now - p->queue[p->tail].capture_time);
+        p->tail = (p->tail + 1) % (LATENCY_PROBE_MAX_QUEUED + 1);
+    }
+}
+
+void latency_probe_flush(int path)
+{
+    latency_probe_path_t *p = &latency_probe_paths[path];
+
+    /*
+     * Everything written so far has been discarded. A frame queued while this
+     * runs may be counted as dropped, or kept, but is never mismeasured.
+     */
+    p->read = p->written;
+    while (p->tail != p->head && (int32_t) (p->read - p->queue[p->tail].position) > 0) {
+        p->dropped++;
+        p->tail = (p->tail + 1) % (LATENCY_PROBE_MAX_QUEUED + 1);
+    }
+}
+
+void latency_probe_report(unsigned char xscope_probe)
+{
+    latency_probe_record_t record;
+
+    report_count++;
+
+    for (int i = 0; i < LATENCY_PROBE_MAX_PATHS; i++) {
+        latency_probe_path_t *p = &latency_probe_paths[i];
+
+        if (p->name == NULL) {
+            continue;
+        }
+
+        memset(&record, 0, sizeof(record));
+        record.magic = LATENCY_PROBE_RECORD_MAGIC;
+        record.version = LATENCY_PROBE_RECORD_VERSION;
+        record.tile = THIS_XCORE_TILE;
+        record.path = i;
+        strncpy(record.name, p->name, LATENCY_PROBE_NAME_LEN - 1);
+        record.report = report_count;
+        record.count = p->count;
+        record.min = p->count ? p->min : 0;
+        record.max = p->max;
+        record.mean = p->count ? (uint32_t) (p->total / p->count) : 0;
+        record.dropped = p->dropped;
+        record.bin_ticks = LATENCY_PROBE_HIST_BIN_TICKS;
+        record.total_bins = LATENCY_PROBE_HIST_BINS;
+        record.bins = LATENCY_PROBE_RECORD_BINS;
+
+        for (int first = 0; first < LATENCY_PROBE_HIST_BINS; first += LATENCY_PROBE_RECORD_BINS) {
+            record.first_bin = first;
+            memcpy(record.hist, &p->hist[first], sizeof(record.hist));
+            xscope_bytes(xscope_probe, sizeof(record), (const unsigned char *) &record);
+        }
+
+        latency_probe_clear(p);
+    }
+}
+
+#endif /* LATENCY_PROBE_ENABLED */
@@ -0,0 +1,9 @@
+include(${CMAKE_CURRENT_LIST_DIR}/pipeline_profiler/pipeline_profiler.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/frame_pool/frame_pool.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/frame_codec/frame_codec.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/latency_probe/latency_probe.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/audio_ring/audio_ring.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/src_block/src_block.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/drift_src/drift_src.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/page_cache/page_cache.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/page_trace/page_trace.cmake)
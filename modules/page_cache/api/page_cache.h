@@ -0,0 +1,134 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef PAGE_CACHE_H_
+#define PAGE_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Read-only, least recently used cache of fixed size pages in front of a
+ * slow backing store, such as a model held in flash.
+ *
+ * Reads are split at page boundaries and each page is looked up among the
+ * cached ones, so repeated reads of the same data only go to the backing
+ * store once for as long as the page stays cached. On a miss the page that
+ * has gone longest without a read is replaced. A read larger than the whole
+ * cache would only evict pages it goes on to replace itself, so it goes
+ * straight to the backing store.
+ *
+ * Pages may also be put in the cache ahead of being read, by a prefetcher
+ * that reads them from the backing store itself. The cost the prefetcher
+ * gives each such page, typically the time its read took, is added up over
+ * the pages that are then read from the cache before being replaced, as a
+ * measure of the backing store reads the prefetcher took off the reader.
+ *
+ * A cache is not thread safe. A prefetcher on another task must hold the
+ * same lock as the reader around each call.
+ */
+
+/* Tag of a cache entry that holds no page */
+#define PAGE_CACHE_NO_PAGE      UINT32_MAX
+
+/*
+ * Reads size bytes at offset in the backing store into dest and returns
+ * the number of bytes read.
+ */
+typedef size_t (*page_cache_read_t)(void *read_ctx, void *dest, size_t offset, size_t size);
+
+typedef struct {
+    uint32_t page;
+    uint32_t last_use;
+
+    /* Cost of a prefetched page that has not been read yet, otherwise 0 */
+    uint32_t prefetch_cost;
+} page_cache_entry_t;
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t bypasses;
+    uint32_t read_errors;
+
+    /* Pages prefetched, then read from the cache or replaced unread */
+    uint32_t prefetches;
+    uint32_t prefetch_hits;
+    uint32_t prefetch_wasted;
+
+    /* Total cost of the prefetched pages that were read */
+    uint64_t prefetch_saved;
+} page_cache_stats_t;
+
+typedef struct {
+    uint8_t *storage;
+    page_cache_entry_t *entries;
+    unsigned page_count;
+    unsigned page_size_log2;
+    size_t backing_size;
+
+    page_cache_read_t read;
+    void *read_ctx;
+
+    /* Counts page lookups, and is the time of each entry's last use */
+    uint32_t clock;
+
+    /* Entry of the most recent hit or fill, checked first */
+    unsigned mru;
+
+    page_cache_stats_t stats;
+} page_cache_t;
+
+/*
+ * Statically allocates the storage for a cache called name of count pages
+ * of 1 << page_size_log2 bytes.
+ */
+#define PAGE_CACHE_STORAGE(name, page_size_log2, count)                                 \
+    static uint64_t name##_storage[(count) * ((((size_t) 1 << (page_size_log2)) + 7) / 8)]; \
+    static page_cache_entry_t name##_entries[(count)]
+
+/* Initialises a cache from storage declared with PAGE_CACHE_STORAGE() */
+#define PAGE_CACHE_INIT(cache, name, page_size_log2, count, backing_size, read, read_ctx) \
+    page_cache_init((cache), name##_storage, name##_entries, (page_size_log2), (count),   \
+                    (backing_size), (read), (read_ctx))
+
+/*
+ * Initialises cache, empty, over storage of page_count pages of
+ * 1 << page_size_log2 bytes and entries of page_count entries, in front of
+ * backing_size bytes read by read.
+ */
+void page_cache_init(page_cache_t *cache,
+                     void *storage,
+                     page_cache_entry_t *entries,
+                     unsigned page_size_log2,
+                     unsigned page_count,
+                     size_t backing_size,
+                     page_cache_read_t read,
+                     void *read_ctx);
+
+/* Forgets every cached page, keeping the statistics */
+void page_cache_invalidate(page_cache_t *cache);
+
+/*
+ * Copies size bytes at offset in the backing store to dest, from the cache
+ * where the pages are held. Returns the number of bytes copied, which is
+ * less than size only if the read goes past the end of the backing store
+ * or the backing store fails to read.
+ */
+size_t page_cache_read(page_cache_t *cache, void *dest, size_t offset, size_t size);
+
+/* Returns nonzero if page, of 1 << page_size_log2 bytes, is in the cache */
+int page_cache_contains(const page_cache_t *cache, uint32_t page);
+
+/*
+ * Puts the data of page, read by a prefetcher at a cost of cost, in the
+ * cache as its most recently used page, unless it is there already. The
+ * data is the whole page, or as much of it as comes before the end of the
+ * backing store. Returns nonzero if the page was put in the cache.
+ */
+int page_cache_insert(page_cache_t *cache, uint32_t page, const void *data, uint32_t cost);
+
+/* Copies the statistics to stats and, if reset is set, clears them */
+void page_cache_stats_get(page_cache_t *cache, page_cache_stats_t *stats, int reset);
+
+#endif /* PAGE_CACHE_H_ */
@@ -0,0 +1,13 @@
+## Create page cache library
+add_library(sln_voice_page_cache INTERFACE)
+target_sources(sln_voice_page_cache
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/src/page_cache.c
+)
+target_include_directories(sln_voice_page_cache
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/api
+)
+
+## Create an alias
+add_library(sln_voice::page_cache ALIAS sln_voice_page_cache)
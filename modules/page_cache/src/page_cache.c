@@ -0,0 +1,223 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+/* STD headers */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "page_cache.h"
+
+static inline size_t page_cache_page_size(const page_cache_t *cache)
+{
+    return (size_t) 1 << cache->page_size_log2;
+}
+
+static inline uint8_t *page_cache_data(const page_cache_t *cache, unsigned entry)
+{
+    return cache->storage + ((size_t) entry << cache->page_size_log2);
+}
+
+/*
+ * Returns the entry to replace, which is an empty one if there is any and
+ * otherwise the one that has gone unused the longest. Ages are taken
+ * relative to the clock so that they stay in order when it wraps.
+ */
+static unsigned page_cache_victim(const page_cache_t *cache)
+{
+    unsigned victim = 0;
+    uint32_t oldest = 0;
+
+    for (unsigned i = 0; i < cache->page_count; i++) {
+        const uint32_t age = cache->clock - cache->entries[i].last_use;
+
+        if (cache->entries[i].page == PAGE_CACHE_NO_PAGE) {
+            return i;
+        }
+        if (age >= oldest) {
+            oldest = age;
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+/* Returns the entry holding page, or page_count if it is not cached */
+static unsigned page_cache_find(const page_cache_t *cache, uint32_t page)
+{
+    unsigned entry = cache->mru;
+
+    if (cache->entries[entry].page != page) {
+        for (entry = 0; entry < cache->page_count; entry++) {
+            if (cache->entries[entry].page == page) {
+                break;
+            }
+        }
+    }
+    return entry;
+}
+
+/* Empties entry for a new page, counting any prefetched page in it as wasted */
+static void page_cache_evict(page_cache_t *cache, unsigned entry)
+{
+    if (cache->entries[entry].prefetch_cost != 0) {
+        cache->stats.prefetch_wasted++;
+    }
+    cache->entries[entry].page = PAGE_CACHE_NO_PAGE;
+    cache->entries[entry].prefetch_cost = 0;
+}
+
+/* Size of page, which is the page size unless the backing store ends in it */
+static size_t page_cache_page_bytes(const page_cache_t *cache, uint32_t page)
+{
+    const size_t start = (size_t) page << cache->page_size_log2;
+    const size_t size = page_cache_page_size(cache);
+
+    return size < cache->backing_size - start ? size : cache->backing_size - start;
+}
+
+/*
+ * Returns the cached data of page, reading it from the backing store into
+ * the least recently used entry if it is not cached, or NULL if it cannot
+ * be read.
+ */
+static const uint8_t *page_cache_page(page_cache_t *cache, uint32_t page)
+{
+    unsigned entry = page_cache_find(cache, page);
+
+    cache->clock++;
+
+    if (entry < cache->page_count) {
+        page_cache_entry_t *e = &cache->entries[entry];
+
+        cache->stats.hits++;
+        if (e->prefetch_cost != 0) {
+            cache->stats.prefetch_hits++;
+            cache->stats.prefetch_saved += e->prefetch_cost;
+            e->prefetch_cost = 0;
+        }
+    } else {
+        const size_t size = page_cache_page_bytes(cache, page);
+
+        entry = page_cache_victim(cache);
+        page_cache_evict(cache, entry);
+        cache->stats.misses++;
+
+        if (cache->read(cache->read_ctx, page_cache_data(cache, entry),
+                        (size_t) page << cache->page_size_log2, size) != size) {
+            cache->stats.read_errors++;
+            return NULL;
+        }
+        cache->entries[entry].page = page;
+    }
+
+    cache->entries[entry].last_use = cache->clock;
+    cache->mru = entry;
+
+    return page_cache_data(cache, entry);
+}
+
+void page_cache_init(page_cache_t *cache,
+                     void *storage,
+                     page_cache_entry_t *entries,
+                     unsigned page_size_log2,
+                     unsigned page_count,
+                     size_t backing_size,
+                     page_cache_read_t read,
+                     void *read_ctx)
+{
+    memset(cache, 0, sizeof(page_cache_t));
+    cache->storage = storage;
+    cache->entries = entries;
+    cache->page_count = page_count;
+    cache->page_size_log2 = page_size_log2;
+    cache->backing_size = backing_size;
+    cache->read = read;
+    cache->read_ctx = read_ctx;
+
+    page_cache_invalidate(cache);
+}
+
+void page_cache_invalidate(page_cache_t *cache)
+{
+    for (unsigned i = 0; i < cache->page_count; i++) {
+        cache->entries[i].page = PAGE_CACHE_NO_PAGE;
+        cache->entries[i].last_use = 0;
+        cache->entries[i].prefetch_cost = 0;
+    }
+    cache->clock = 0;
+    cache->mru = 0;
+}
+
+size_t page_cache_read(page_cache_t *cache, void *dest, size_t offset, size_t size)
+{
+    uint8_t *out = dest;
+    size_t copied = 0;
+
+    if (offset >= cache->backing_size) {
+        return 0;
+    }
+    if (size > cache->backing_size - offset) {
+        size = cache->backing_size - offset;
+    }
+
+    if (size > (size_t) cache->page_count << cache->page_size_log2) {
+        cache->stats.bypasses++;
+        return cache->read(cache->read_ctx, dest, offset, size);
+    }
+
+    while (copied < size) {
+        const size_t in_page = offset & (page_cache_page_size(cache) - 1);
+        const uint8_t *data = page_cache_page(cache, offset >> cache->page_size_log2);
+        size_t n = page_cache_page_size(cache) - in_page;
+
+        if (data == NULL) {
+            break;
+        }
+        if (n > size - copied) {
+            n = size - copied;
+        }
+
+        memcpy(out + copied, data + in_page, n);
+        copied += n;
+        offset += n;
+    }
+
+    return copied;
+}
+
+int page_cache_contains(const page_cache_t *cache, uint32_t page)
+{
+    return page_cache_find(cache, page) < cache->page_count;
+}
+
+int page_cache_insert(page_cache_t *cache, uint32_t page, const void *data, uint32_t cost)
+{
+    unsigned entry;
+
+    if (((size_t) page << cache->page_size_log2) >= cache->backing_size || page_cache_contains(cache, page)) {
+        return 0;
+    }
+
+    entry = page_cache_victim(cache);
+    page_cache_evict(cache, entry);
+    memcpy(page_cache_data(cache, entry), data, page_cache_page_bytes(cache, page));
+
+    cache->clock++;
+    cache->entries[entry].page = page;
+    cache->entries[entry].last_use = cache->clock;
+    /* A cost of 0 would not mark the page as prefetched */
+    cache->entries[entry].prefetch_cost = cost != 0 ? cost : 1;
+    cache->stats.prefetches++;
+
+    return 1;
+}
+
+void page_cache_stats_get(page_cache_t *cache, page_cache_stats_t *stats, int reset)
+{
+    *stats = cache->stats;
+
+    if (reset) {
+        memset(&cache->stats, 0, sizeof(page_cache_stats_t));
+    }
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef PAGE_TRACE_H_
+#define PAGE_TRACE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Learns the order in which pages of a backing store are read on each pass
+ * of a repeated computation, such as the layers of a model read on every
+ * inference, and predicts the pages about to be read so that they can be
+ * prefetched.
+ *
+ * A pass runs from page_trace_start() to page_trace_end(). The first pass
+ * records the order of the pages read, each time the page read differs from
+ * the last one, and later passes follow that recording. A page read that is
+ * not the next one recorded is looked for a little further on, so that an
+ * occasional extra or missing read does not lose the place. When more than
+ * one in PAGE_TRACE_RELEARN_RATIO reads in a pass could not be followed,
+ * the order is learnt again on the next pass. A pass with more page changes
+ * than the recording holds stops the trace from predicting at all.
+ *
+ * A trace is not thread safe and is expected to be used from a single task,
+ * or under the same lock as the reads it follows.
+ */
+
+/* Number of recorded pages past the expected one that a read is looked for in */
+#ifndef PAGE_TRACE_RESYNC_WINDOW
+#define PAGE_TRACE_RESYNC_WINDOW    16
+#endif
+
+#ifndef PAGE_TRACE_RELEARN_RATIO
+#define PAGE_TRACE_RELEARN_RATIO    4
+#endif
+
+typedef enum {
+    PAGE_TRACE_LEARN,       /* The next pass will be recorded */
+    PAGE_TRACE_RECORDING,
+    PAGE_TRACE_FOLLOWING,
+    PAGE_TRACE_OVERFLOWED,  /* A pass did not fit, and nothing is predicted */
+} page_trace_state_t;
+
+typedef struct {
+    uint32_t passes;
+    uint32_t learnt;
+    uint32_t followed;
+    uint32_t mispredicted;
+} page_trace_stats_t;
+
+typedef struct {
+    uint16_t *pages;
+    unsigned capacity;
+    unsigned length;
+    page_trace_state_t state;
+    int in_pass;
+
+    /* Last page read, and the index of the one expected next */
+    uint32_t last_page;
+    unsigned next;
+
+    /* Index past the last page returned by page_trace_prefetch() */
+    unsigned issued;
+
+    /* Reads and mispredictions in the current pass */
+    unsigned pass_reads;
+    unsigned pass_mispredicted;
+
+    page_trace_stats_t stats;
+} page_trace_t;
+
+/*
+ * Initialises trace to learn the pages of a pass in pages, which holds
+ * capacity page numbers. Page numbers from UINT16_MAX up cannot be
+ * recorded.
+ */
+void page_trace_init(page_trace_t *trace, uint16_t *pages, unsigned capacity);
+
+/* Starts a pass */
+void page_trace_start(page_trace_t *trace);
+
+/* Ends a pass */
+void page_trace_end(page_trace_t *trace);
+
+/* Records a read of page, which is ignored outside of a pass */
+void page_trace_access(page_trace_t *trace, uint32_t page);
+
+/*
+ * Copies to pages, which holds depth page numbers, those of the next depth
+ * pages expected to be read that have not already been returned in this
+ * pass, and returns how many there are. Nothing is returned unless a pass is
+ * being followed.
+ */
+size_t page_trace_prefetch(page_trace_t *trace, uint32_t *pages, size_t depth);
+
+/* Copies the statistics to stats and, if reset is set, clears them */
+void page_trace_stats_get(page_trace_t *trace, page_trace_stats_t *stats, int reset);
+
+#endif /* PAGE_TRACE_H_ */
@@ -0,0 +1,13 @@
+## Create page trace library
+add_library(sln_voice_page_trace INTERFACE)
+target_sources(sln_voice_page_trace
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/src/page_trace.c
+)
+target_include_directories(sln_voice_page_trace
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/api
+)
+
+## Create an alias
+add_library(sln_voice::page_trace ALIAS sln_voice_page_trace)
@@ -0,0 +1,130 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+/* STD headers */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "page_trace.h"
+
+#define NO_PAGE     UINT32_MAX
+
+static void page_trace_record(page_trace_t *trace, uint32_t page)
+{
+    if (trace->length < trace->capacity && page < UINT16_MAX) {
+        trace->pages[trace->length++] = (uint16_t) page;
+    } else {
+        trace->state = PAGE_TRACE_OVERFLOWED;
+    }
+}
+
+static void page_trace_follow(page_trace_t *trace, uint32_t page)
+{
+    unsigned end = trace->next + 1 + PAGE_TRACE_RESYNC_WINDOW;
+
+    if (trace->next < trace->length && trace->pages[trace->next] == page) {
+        trace->next++;
+        trace->stats.followed++;
+        return;
+    }
+
+    trace->stats.mispredicted++;
+    trace->pass_mispredicted++;
+
+    if (end > trace->length) {
+        end = trace->length;
+    }
+    for (unsigned i = trace->next + 1; i < end; i++) {
+        if (trace->pages[i] == page) {
+            trace->next = i + 1;
+            if (trace->issued < trace->next) {
+                trace->issued = trace->next;
+            }
+            return;
+        }
+    }
+}
+
+void page_trace_init(page_trace_t *trace, uint16_t *pages, unsigned capacity)
+{
+    memset(trace, 0, sizeof(page_trace_t));
+    trace->pages = pages;
+    trace->capacity = capacity;
+    trace->state = PAGE_TRACE_LEARN;
+    trace->last_page = NO_PAGE;
+}
+
+void page_trace_start(page_trace_t *trace)
+{
+    if (trace->state == PAGE_TRACE_LEARN) {
+        trace->state = PAGE_TRACE_RECORDING;
+        trace->length = 0;
+    }
+
+    trace->in_pass = 1;
+    trace->last_page = NO_PAGE;
+    trace->next = 0;
+    trace->issued = 0;
+    trace->pass_reads = 0;
+    trace->pass_mispredicted = 0;
+    trace->stats.passes++;
+}
+
+void page_trace_end(page_trace_t *trace)
+{
+    if (!trace->in_pass) {
+        return;
+    }
+    trace->in_pass = 0;
+
+    if (trace->state == PAGE_TRACE_RECORDING) {
+        trace->state = PAGE_TRACE_FOLLOWING;
+        trace->stats.learnt++;
+    } else if (trace->state == PAGE_TRACE_FOLLOWING &&
+               trace->pass_mispredicted * PAGE_TRACE_RELEARN_RATIO > trace->pass_reads) {
+        trace->state = PAGE_TRACE_LEARN;
+    }
+}
+
+void page_trace_access(page_trace_t *trace, uint32_t page)
+{
+    if (!trace->in_pass || page == trace->last_page) {
+        return;
+    }
+    trace->last_page = page;
+    trace->pass_reads++;
+
+    if (trace->state == PAGE_TRACE_RECORDING) {
+        page_trace_record(trace, page);
+    } else if (trace->state == PAGE_TRACE_FOLLOWING) {
+        page_trace_follow(trace, page);
+    }
+}
+
+size_t page_trace_prefetch(page_trace_t *trace, uint32_t *pages, size_t depth)
+{
+    size_t end = trace->next + depth;
+    size_t count = 0;
+
+    if (!trace->in_pass || trace->state != PAGE_TRACE_FOLLOWING) {
+        return 0;
+    }
+
+    if (end > trace->length) {
+        end = trace->length;
+    }
+    while (trace->issued < end) {
+        pages[count++] = trace->pages[trace->issued++];
+    }
+    return count;
+}
+
+void page_trace_stats_get(page_trace_t *trace, page_trace_stats_t *stats, int reset)
+{
+    *stats = trace->stats;
+
+    if (reset) {
+        memset(&trace->stats, 0, sizeof(page_trace_stats_t));
+    }
+}
@@ -0,0 +1,130 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef PIPELINE_PROFILER_H_
+#define PIPELINE_PROFILER_H_
+
+#include <stdint.h>
+#include <xcore/hwtimer.h>
+
+/*
+ * Execution time profiler for generic_pipeline stages and I/O hooks.
+ *
+ * Each profiled function is wrapped so that its duration, measured in
+ * 100 MHz reference timer ticks, is accumulated into a
+ * pipeline_profiler_stat_t. The statistics live in the global
+ * pipeline_profiler structure so they can be inspected from xgdb, and
+ * pipeline_profiler_report() prints them.
+ *
+ * When PIPELINE_PROFILER_ENABLED is 0 every macro below expands to the
+ * unwrapped function and nothing is compiled in.
+ */
+
+#ifndef PIPELINE_PROFILER_ENABLED
+#define PIPELINE_PROFILER_ENABLED       0
+#endif
+
+/* Maximum number of functions that may be registered on one tile */
+#ifndef PIPELINE_PROFILER_MAX_STATS
+#define PIPELINE_PROFILER_MAX_STATS     16
+#endif
+
+/* Histogram used for the percentile estimate. The default covers 0-32 ms */
+#ifndef PIPELINE_PROFILER_HIST_BINS
+#define PIPELINE_PROFILER_HIST_BINS     128
+#endif
+
+#ifndef PIPELINE_PROFILER_HIST_BIN_TICKS
+#define PIPELINE_PROFILER_HIST_BIN_TICKS 25000
+#endif
+
+typedef struct {
+    const char *name;
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t hist[PIPELINE_PROFILER_HIST_BINS];
+} pipeline_profiler_stat_t;
+
+typedef struct {
+    uint32_t stat_count;
+    pipeline_profiler_stat_t stats[PIPELINE_PROFILER_MAX_STATS];
+} pipeline_profiler_t;
+
+extern pipeline_profiler_t pipeline_profiler;
+
+/*
+ * Returns a new, zeroed statistic named name, or NULL if all
+ * PIPELINE_PROFILER_MAX_STATS have been used. Registration is not thread
+ * safe and is expected to happen from the pipeline init functions.
+ */
+pipeline_profiler_stat_t *pipeline_profiler_register(const char *name);
+
+/*
+ * Adds one measurement of ticks to stat. A stat must only be updated from
+ * a single task; stat may be NULL, in which case nothing is recorded.
+ */
+void pipeline_profiler_record(pipeline_profiler_stat_t *stat, uint32_t ticks);
+
+/*
+ * Returns the upper bound of the histogram bin that contains the given
+ * percentile (0-100) of the recorded measurements.
+ */
+uint32_t pipeline_profiler_percentile(const pipeline_profiler_stat_t *stat, unsigned percentile);
+
+/* Clears all recorded measurements, keeping the registrations */
+void pipeline_profiler_reset(void);
+
+/* Prints count, min, mean, max and p99 in ticks for every registered stat */
+void pipeline_profiler_report(void);
+
+#if PIPELINE_PROFILER_ENABLED
+
+#define PIPELINE_PROFILER_DEFINE_STAGE(fn)                                  \
+    static pipeline_profiler_stat_t *fn##_stat;                             \
+    static void fn##_profiled(void *frame_data)                             \
+    {                                                                       \
+        const uint32_t start = get_reference_time();                        \
+        fn(frame_data);                                                     \
+        pipeline_profiler_record(fn##_stat, get_reference_time() - start);  \
+    }
+
+#define PIPELINE_PROFILER_DEFINE_INPUT(fn)                                  \
+    static pipeline_profiler_stat_t *fn##_stat;                             \
+    static void *fn##_profiled(void *input_app_data)                        \
+    {                                                                       \
+        const uint32_t start = get_reference_time();                        \
+        void *frame_data = fn(input_app_data);                              \
+        pipeline_profiler_record(fn##_stat, get_reference_time() - start);  \
+        return frame_data;                                                  \
+    }
+
+#define PIPELINE_PROFILER_DEFINE_OUTPUT(fn)                                 \
+    static pipeline_profiler_stat_t *fn##_stat;                             \
+    static int fn##_profiled(void *frame_data, void *output_app_data)       \
+    {                                                                       \
+        const uint32_t start = get_reference_time();                        \
+        int ret = fn(frame_data, output_app_data);                          \
+        pipeline_profiler_record(fn##_stat, get_reference_time() - start);  \
+        return ret;                                                         \
+    }
+
+#define PIPELINE_PROFILER_REGISTER(fn)  (fn##_stat = pipeline_profiler_register(#fn))
+#define PIPELINE_PROFILED(fn)           fn##_profiled
+
+/* Extra stack words for a task that runs up to three wrappers */
+#define PIPELINE_PROFILER_STACK_SIZE    32
+
+#else
+
+#define PIPELINE_PROFILER_DEFINE_STAGE(fn)
+#define PIPELINE_PROFILER_DEFINE_INPUT(fn)
+#define PIPELINE_PROFILER_DEFINE_OUTPUT(fn)
+#define PIPELINE_PROFILER_REGISTER(fn)  ((void) 0)
+#define PIPELINE_PROFILED(fn)           fn
+#define PIPELINE_PROFILER_STACK_SIZE    0
+
+#endif /* PIPELINE_PROFILER_ENABLED */
+
+#endif /* PIPELINE_PROFILER_H_ */
@@ -0,0 +1,18 @@
+option(ENABLE_PIPELINE_PROFILER "Record per-stage execution time statistics in the audio pipelines" OFF)
+
+## Create pipeline profiler library
+add_library(sln_voice_pipeline_profiler INTERFACE)
+target_sources(sln_voice_pipeline_profiler
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/src/pipeline_profiler.c
+)
+target_include_directories(sln_voice_pipeline_profiler
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/api
+)
+if(ENABLE_PIPELINE_PROFILER)
+    target_compile_definitions(sln_voice_pipeline_profiler INTERFACE PIPELINE_PROFILER_ENABLED=1)
+endif()
+
+## Create an alias
+add_library(sln_voice::pipeline_profiler ALIAS sln_voice_pipeline_profiler)
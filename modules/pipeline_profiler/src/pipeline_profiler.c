@@ -0,0 +1,110 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+/* STD headers */
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__XS3A__)
+#include "rtos_printf.h"
+#else
+#include <stdio.h>
+#define rtos_printf printf
+#endif
+
+#include "pipeline_profiler.h"
+
+#if PIPELINE_PROFILER_ENABLED
+
+pipeline_profiler_t pipeline_profiler;
+
+pipeline_profiler_stat_t *pipeline_profiler_register(const char *name)
+{
+    if (pipeline_profiler.stat_count >= PIPELINE_PROFILER_MAX_STATS) {
+        return NULL;
+    }
+
+    pipeline_profiler_stat_t *stat = &pipeline_profiler.stats[pipeline_profiler.stat_count++];
+
+    memset(stat, 0, sizeof(pipeline_profiler_stat_t));
+    stat->name = name;
+    stat->min = UINT32_MAX;
+
+    return stat;
+}
+
+void pipeline_profiler_record(pipeline_profiler_stat_t *stat, uint32_t ticks)
+{
+    if (stat == NULL) {
+        return;
+    }
+
+    uint32_t bin = ticks / PIPELINE_PROFILER_HIST_BIN_TICKS;
+    if (bin >= PIPELINE_PROFILER_HIST_BINS) {
+        bin = PIPELINE_PROFILER_HIST_BINS - 1;
+    }
+
+    stat->count++;
+    stat->total += ticks;
+    stat->hist[bin]++;
+    if (ticks < stat->min) {
+        stat->min = ticks;
+    }
+    if (ticks > stat->max) {
+        stat->max = ticks;
+    }
+}
+
+uint32_t pipeline_profiler_percentile(const pipeline_profiler_stat_t *stat, unsigned percentile)
+{
+    /* Number of measurements at or below the percentile, rounded up */
+    const uint64_t target = ((uint64_t) stat->count * percentile + 99) / 100;
+    uint64_t seen = 0;
+
+    for (int i = 0; i < PIPELINE_PROFILER_HIST_BINS; i++) {
+        seen += stat->hist[i];
+        if (seen >= target && seen > 0) {
+            /* The last bin also holds everything that overflowed */
+            if (i == PIPELINE_PROFILER_HIST_BINS - 1) {
+                return stat->max;
+            }
+            const uint32_t upper = (i + 1) * PIPELINE_PROFILER_HIST_BIN_TICKS;
+            return upper < stat->max ? upper : stat->max;
+        }
+    }
+    return 0;
+}
+
+void pipeline_profiler_reset(void)
+{
+    for (uint32_t i = 0; i < pipeline_profiler.stat_count; i++) {
+        pipeline_profiler_stat_t *stat = &pipeline_profiler.stats[i];
+
+        stat->count = 0;
+        stat->total = 0;
+        stat->max = 0;
+        stat->min = UINT32_MAX;
+        memset(stat->hist, 0, sizeof(stat->hist));
+    }
+}
+
+void pipeline_profiler_report(void)
+{
+    for (uint32_t i = 0; i < pipeline_profiler.stat_count; i++) {
+        const pipeline_profiler_stat_t *stat = &pipeline_profiler.stats[i];
+
+        if (stat->count == 0) {
+            rtos_printf("%s: no samples\n", stat->name);
+            continue;
+        }
+        rtos_printf("%s: n=%u min=%u mean=%u max=%u p99=%u ticks\n",
+                    stat->name,
+                    (unsigned) stat->count,
+                    (unsigned) stat->min,
+                    (unsigned) (stat->total / stat->count),
+                    (unsigned) stat->max,
+                    (unsigned) pipeline_profiler_percentile(stat, 99));
+    }
+}
+
+#endif /* PIPELINE_PROFILER_ENABLED */
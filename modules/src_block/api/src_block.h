@@ -0,0 +1,86 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+#ifndef SRC_BLOCK_H_
+#define SRC_BLOCK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <src.h>
+
+/*
+ * Block versions of the lib_src fixed factor of 3 voice filters, for
+ * converting whole USB frames between 48 kHz and 16 kHz.
+ *
+ * lib_src works one sample of one channel per call, and each call shifts
+ * that phase's delay line along by one. Here each channel keeps its recent
+ * input in a flat history buffer instead, a block of new input is appended
+ * to it, and every output of the block is computed directly from it, so the
+ * history is only moved once per block. The filter taps are
+ * src_ff3v_fir_coefs and the output is bit exact with the equivalent
+ * sequence of src_ds3_voice_* or src_us3_voice_* calls.
+ *
+ * Samples are interleaved, frame by frame, and each function takes one state
+ * per channel. Each channel is filtered independently. out must not overlap
+ * in.
+ */
+
+/* Input frames a downsampler consumes per pass over its history */
+#ifndef SRC_BLOCK_DS3_CHUNK
+#define SRC_BLOCK_DS3_CHUNK     (SRC_FF3V_FIR_NUM_PHASES * 16)
+#endif
+
+/* Input frames an upsampler consumes per pass over its history */
+#ifndef SRC_BLOCK_US3_CHUNK
+#define SRC_BLOCK_US3_CHUNK     16
+#endif
+
+#if (SRC_BLOCK_DS3_CHUNK % SRC_FF3V_FIR_NUM_PHASES) != 0
+#error SRC_BLOCK_DS3_CHUNK must be a multiple of SRC_FF3V_FIR_NUM_PHASES
+#endif
+
+#define SRC_BLOCK_DS3_HISTORY   (SRC_FF3V_FIR_NUM_PHASES * (SRC_FF3V_FIR_TAPS_PER_PHASE - 1))
+#define SRC_BLOCK_US3_HISTORY   (SRC_FF3V_FIR_TAPS_PER_PHASE - 1)
+
+typedef struct {
+    /* The last SRC_BLOCK_DS3_HISTORY input samples, oldest first, then room for a chunk */
+    int32_t buf[SRC_BLOCK_DS3_HISTORY + SRC_BLOCK_DS3_CHUNK];
+} src_block_ds3_t;
+
+typedef struct {
+    /* The last SRC_BLOCK_US3_HISTORY input samples, oldest first, then room for a chunk */
+    int32_t buf[SRC_BLOCK_US3_HISTORY + SRC_BLOCK_US3_CHUNK];
+} src_block_us3_t;
+
+/* Clears the history of each of the channels states in state */
+void src_block_ds3_init(src_block_ds3_t *state, size_t channels);
+void src_block_us3_init(src_block_us3_t *state, size_t channels);
+
+/*
+ * Downsamples 3 * frames interleaved frames of channels samples from in into
+ * frames interleaved frames at out. state holds one entry per channel.
+ *
+ * Equivalent, for each output frame i and channel j, to
+ *
+ *     sum = src_ds3_voice_add_sample(0, data[j][0], src_ff3v_fir_coefs[0], in[3*i + 0][j]);
+ *     sum = src_ds3_voice_add_sample(sum, data[j][1], src_ff3v_fir_coefs[1], in[3*i + 1][j]);
+ *     out[i][j] = src_ds3_voice_add_final_sample(sum, data[j][2], src_ff3v_fir_coefs[2], in[3*i + 2][j]);
+ */
+void src_block_ds3_s16(src_block_ds3_t *state, size_t channels, int16_t *out, const int16_t *in, size_t frames);
+void src_block_ds3_s32(src_block_ds3_t *state, size_t channels, int32_t *out, const int32_t *in, size_t frames);
+
+/*
+ * Upsamples frames interleaved frames of channels samples from in into
+ * 3 * frames interleaved frames at out. state holds one entry per channel.
+ *
+ * Equivalent, for each input frame i and channel j, to
+ *
+ *     out[3*i + 0][j] = src_us3_voice_input_sample(data[j], src_ff3v_fir_coefs[2], in[i][j]);
+ *     out[3*i + 1][j] = src_us3_voice_get_next_sample(data[j], src_ff3v_fir_coefs[1]);
+ *     out[3*i + 2][j] = src_us3_voice_get_next_sample(data[j], src_ff3v_fir_coefs[0]);
+ */
+void src_block_us3_s16(src_block_us3_t *state, size_t channels, int16_t *out, const int16_t *in, size_t frames);
+void src_block_us3_s32(src_block_us3_t *state, size_t channels, int32_t *out, const int32_t *in, size_t frames);
+
+#endif /* SRC_BLOCK_H_ */
@@ -0,0 +1,199 @@
+// Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+// XMOS Public License: Version 1
+
+/* STD headers */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "src_block.h"
+
+#define TAPS    SRC_FF3V_FIR_TAPS_PER_PHASE
+#define PHASES  SRC_FF3V_FIR_NUM_PHASES
+
+/*
+ * Arithmetic shift right of a 64-bit accumulator, saturated to 32 bits. This
+ * is the lsats/lextract pair that lib_src ends each filter with.
+ */
+static inline int32_t src_block_extract(int64_t acc, unsigned shift)
+{
+    acc >>= shift;
+    if (acc > INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (acc < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t) acc;
+}
+
+static inline int32_t src_block_ds3_result(int64_t acc)
+{
+    const int32_t y = src_block_extract(acc, 31);
+    return src_block_extract((int64_t) y * src_ff3v_fir_comp_ds, src_ff3v_fir_comp_q_ds);
+}
+
+static inline int32_t src_block_us3_result(int64_t acc)
+{
+    const int32_t y = src_block_extract(acc, 31);
+    return src_block_extract((int64_t) y * src_ff3v_fir_comp_us, src_ff3v_fir_comp_q_us);
+}
+
+/*
+ * The taps of all three phases as one filter, in the order that lines them
+ * up with the input history, oldest sample first, so that every output is a
+ * plain dot product over consecutive samples.
+ *
+ * Downsampling, phase p sees every third input starting at p, newest first,
+ * so the output completed by input n sums coefs[p][k] * x[n - 3k - 2 + p].
+ */
+static void src_block_ds3_taps(int32_t taps[PHASES * TAPS])
+{
+    for (int k = 0; k < TAPS; k++) {
+        for (int p = 0; p < PHASES; p++) {
+            taps[PHASES * (TAPS - 1 - k) + p] = src_ff3v_fir_coefs[p][k];
+        }
+    }
+}
+
+/*
+ * Upsampling, output q of each input uses coefs[2 - q] over the newest TAPS
+ * inputs, newest first.
+ */
+static void src_block_us3_taps(int32_t taps[PHASES][TAPS])
+{
+    for (int q = 0; q < PHASES; q++) {
+        for (int k = 0; k < TAPS; k++) {
+            taps[q][TAPS - 1 - k] = src_ff3v_fir_coefs[PHASES - 1 - q][k];
+        }
+    }
+}
+
+/*
+ * Filters the chunk of n_in samples that follows the history in buf into
+ * n_in / 3 outputs, then keeps the end of it as the new history.
+ */
+static void src_block_ds3_chunk(src_block_ds3_t *state, const int32_t *taps, int32_t *y, size_t n_in)
+{
+    int32_t *buf = state->buf;
+
+    for (size_t i = 0; i < n_in / PHASES; i++) {
+        const int32_t *x = &buf[PHASES * i];
+        int64_t acc = 0;
+
+        for (int j = 0; j < PHASES * TAPS; j++) {
+            acc += (int64_t) taps[j] * x[j];
+        }
+        y[i] = src_block_ds3_result(acc);
+    }
+
+    memmove(buf, &buf[n_in], SRC_BLOCK_DS3_HISTORY * sizeof(buf[0]));
+}
+
+/*
+ * Filters the chunk of n_in samples that follows the history in buf into
+ * 3 * n_in outputs, then keeps the end of it as the new history.
+ */
+static void src_block_us3_chunk(src_block_us3_t *state, const int32_t taps[PHASES][TAPS], int32_t *y, size_t n_in)
+{
+    int32_t *buf = state->buf;
+
+    for (size_t i = 0; i < n_in; i++) {
+        const int32_t *x = &buf[i];
+
+        for (int q = 0; q < PHASES; q++) {
+            int64_t acc = 0;
+
+            for (int j = 0; j < TAPS; j++) {
+                acc += (int64_t) taps[q][j] * x[j];
+            }
+            y[PHASES * i + q] = src_block_us3_result(acc);
+        }
+    }
+
+    memmove(buf, &buf[n_in], SRC_BLOCK_US3_HISTORY * sizeof(buf[0]));
+}
+
+void src_block_ds3_init(src_block_ds3_t *state, size_t channels)
+{
+    memset(state, 0, channels * sizeof(src_block_ds3_t));
+}
+
+void src_block_us3_init(src_block_us3_t *state, size_t channels)
+{
+    memset(state, 0, channels * sizeof(src_block_us3_t));
+}
+
+/*
+ * The sample width only affects how each chunk is gathered into the history
+ * and scattered back out, so the 16 and 32-bit versions share these bodies.
+ */
+#define SRC_BLOCK_DS3_BODY()                                                        \
+    size_t n_total = PHASES * frames;                                               \
+    int32_t taps[PHASES * TAPS];                                                    \
+    int32_t y[SRC_BLOCK_DS3_CHUNK / PHASES];                                        \
+                                                                                    \
+    src_block_ds3_taps(taps);                                                       \
+    while (n_total > 0) {                                                           \
+        const size_t n_in = n_total < SRC_BLOCK_DS3_CHUNK ? n_total : SRC_BLOCK_DS3_CHUNK; \
+        const size_t n_out = n_in / PHASES;                                         \
+                                                                                    \
+        for (size_t j = 0; j < channels; j++) {                                     \
+            int32_t *chunk = &state[j].buf[SRC_BLOCK_DS3_HISTORY];                  \
+            for (size_t i = 0; i < n_in; i++) {                                     \
+                chunk[i] = in[i * channels + j];                                    \
+            }                                                                       \
+            src_block_ds3_chunk(&state[j], taps, y, n_in);                          \
+            for (size_t i = 0; i < n_out; i++) {                                    \
+                out[i * channels + j] = y[i];                                       \
+            }                                                                       \
+        }                                                                           \
+        in += n_in * channels;                                                      \
+        out += n_out * channels;                                                    \
+        n_total -= n_in;                                                            \
+    }
+
+#define SRC_BLOCK_US3_BODY()                                                        \
+    size_t n_total = frames;                                                        \
+    int32_t taps[PHASES][TAPS];                                                     \
+    int32_t y[PHASES * SRC_BLOCK_US3_CHUNK];                                        \
+                                                                                    \
+    src_block_us3_taps(taps);                                                       \
+    while (n_total > 0) {                                                           \
+        const size_t n_in = n_total < SRC_BLOCK_US3_CHUNK ? n_total : SRC_BLOCK_US3_CHUNK; \
+        const size_t n_out = PHASES * n_in;                                         \
+                                                                                    \
+        for (size_t j = 0; j < channels; j++) {                                     \
+            int32_t *chunk = &state[j].buf[SRC_BLOCK_US3_HISTORY];                  \
+            for (size_t i = 0; i < n_in; i++) {                                     \
+                chunk[i] = in[i * channels + j];                                    \
+            }                                                                       \
+            src_block_us3_chunk(&state[j], taps, y, n_in);                          \
+            for (size_t i = 0; i < n_out; i++) {                                    \
+                out[i * channels + j] = y[i];                                       \
+            }                                                                       \
+        }                                                                           \
+        in += n_in * channels;                                                      \
+        out += n_out * channels;                                                    \
+        n_total -= n_in;                                                            \
+    }
+
+void src_block_ds3_s16(src_block_ds3_t *state, size_t channels, int16_t *out, const int16_t *in, size_t frames)
+{
+    SRC_BLOCK_DS3_BODY()
+}
+
+void src_block_ds3_s32(src_block_ds3_t *state, size_t channels, int32_t *out, const int32_t *in, size_t frames)
+{
+    SRC_BLOCK_DS3_BODY()
+}
+
+void src_block_us3_s16(src_block_us3_t *state, size_t channels, int16_t *out, const int16_t *in, size_t frames)
+{
+    SRC_BLOCK_US3_BODY()
+}
+
+void src_block_us3_s32(src_block_us3_t *state, size_t channels, int32_t *out, const int32_t *in, size_t frames)
+{
+    SRC_BLOCK_US3_BODY()
+}
@@ -0,0 +1,13 @@
+## Create block SRC library
+add_library(sln_voice_src_block INTERFACE)
+target_sources(sln_voice_src_block
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/src/src_block.c
+)
+target_include_directories(sln_voice_src_block
+    INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/api
+)
+
+## Create an alias
+add_library(sln_voice::src_block ALIAS sln_voice_src_block)
@@ -0,0 +1,69 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+from cffi import FFI
+from shutil import rmtree
+
+def build_ffi():
+    # One more ../ than necessary - builds in the 'build' subdirectory in this folder
+    MODULE_ROOT = "../../../../examples/ffd/inference"
+    TEST_ROOT = "../kws"
+
+    FLAGS = [
+        '-std=c99',
+        '-fPIC',
+        '-O2'
+        ]
+
+    # Source file
+    SRCS = [f"{MODULE_ROOT}/kws/kws_features.c",
+            f"{MODULE_ROOT}/kws/kws_inf_eng.c",
+            f"{TEST_ROOT}/kws_wrapper.c"]
+    INCLUDES = [f"{MODULE_ROOT}/api/",
+                f"{MODULE_ROOT}/kws/",
+                TEST_ROOT]
+
+    # Units under test
+    ffibuilder = FFI()
+    ffibuilder.cdef(
+        """
+        void set_model(int32_t input_size, float input_scale, int32_t input_zero_point, int32_t output_size, int32_t init_ret);
+        void set_probabilities(const float *probabilities, int32_t count);
+        int32_t backend_block_size(void);
+        int32_t backend_init(void);
+        int32_t backend_reset(void);
+        int32_t backend_process_block(const int16_t *samples);
+        int32_t backend_results(int32_t *ids, int32_t max_count);
+        int32_t backend_invokes(void);
+        void backend_model_input(int8_t *dest);
+        void features_compute(const int16_t *samples, int32_t slices, float *out);
+        """
+    )
+
+    ffibuilder.set_source("kws_api",
+    """
+        #include <stdint.h>
+        void set_model(int32_t input_size, float input_scale, int32_t input_zero_point, int32_t output_size, int32_t init_ret);
+        void set_probabilities(const float *probabilities, int32_t count);
+        int32_t backend_block_size(void);
+        int32_t backend_init(void);
+        int32_t backend_reset(void);
+        int32_t backend_process_block(const int16_t *samples);
+        int32_t backend_results(int32_t *ids, int32_t max_count);
+        int32_t backend_invokes(void);
+        void backend_model_input(int8_t *dest);
+        void features_compute(const int16_t *samples, int32_t slices, float *out);
+    """,
+        sources=SRCS,
+        include_dirs=INCLUDES,
+        libraries=["m"],
+        extra_compile_args=FLAGS)
+
+    ffibuilder.compile(tmpdir="build", target="kws_api.*", verbose=True)
+
+def clean_ffi():
+    rmtree("./build")
+
+
+if __name__ == "__main__":
+    build_ffi()
@@ -0,0 +1,59 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+from cffi import FFI
+from shutil import rmtree
+
+def build_ffi():
+    # One more ../ than necessary - builds in the 'build' subdirectory in this folder
+    MODULE_ROOT = "../../../../modules/page_cache"
+    TEST_ROOT = "../page_cache"
+
+    FLAGS = [
+        '-std=c99',
+        '-fPIC',
+        '-O2'
+        ]
+
+    # Source file
+    SRCS = [f"{MODULE_ROOT}/src/page_cache.c",
+            f"{TEST_ROOT}/page_cache_wrapper.c"]
+    INCLUDES = [f"{MODULE_ROOT}/api/"]
+
+    # Units under test
+    ffibuilder = FFI()
+    ffibuilder.cdef(
+        """
+        void init(int32_t page_size_log2, int32_t page_count, const uint8_t *data, int32_t size);
+        void set_fail_at(int32_t offset);
+        void invalidate(void);
+        int32_t cache_read(uint8_t *dest, int32_t offset, int32_t size);
+        int32_t contains(uint32_t page);
+        int32_t insert(uint32_t page, uint32_t cost);
+        void stats(uint32_t *out);
+        """
+    )
+
+    ffibuilder.set_source("page_cache_api",
+    """
+        #include <stdint.h>
+        void init(int32_t page_size_log2, int32_t page_count, const uint8_t *data, int32_t size);
+        void set_fail_at(int32_t offset);
+        void invalidate(void);
+        int32_t cache_read(uint8_t *dest, int32_t offset, int32_t size);
+        int32_t contains(uint32_t page);
+        int32_t insert(uint32_t page, uint32_t cost);
+        void stats(uint32_t *out);
+    """,
+        sources=SRCS,
+        include_dirs=INCLUDES,
+        extra_compile_args=FLAGS)
+
+    ffibuilder.compile(tmpdir="build", target="page_cache_api.*", verbose=True)
+
+def clean_ffi():
+    rmtree("./build")
+
+
+if __name__ == "__main__":
+    build_ffi()
@@ -0,0 +1,59 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+from cffi import FFI
+from shutil import rmtree
+
+def build_ffi():
+    # One more ../ than necessary - builds in the 'build' subdirectory in this folder
+    MODULE_ROOT = "../../../../modules/page_trace"
+    TEST_ROOT = "../page_trace"
+
+    FLAGS = [
+        '-std=c99',
+        '-fPIC',
+        '-O2'
+        ]
+
+    # Source file
+    SRCS = [f"{MODULE_ROOT}/src/page_trace.c",
+            f"{TEST_ROOT}/page_trace_wrapper.c"]
+    INCLUDES = [f"{MODULE_ROOT}/api/"]
+
+    # Units under test
+    ffibuilder = FFI()
+    ffibuilder.cdef(
+        """
+        void init(int32_t capacity);
+        void pass_start(void);
+        void pass_end(void);
+        void page_access(uint32_t page);
+        int32_t prefetch(uint32_t *out, int32_t depth);
+        int32_t state(void);
+        void stats(uint32_t *out);
+        """
+    )
+
+    ffibuilder.set_source("page_trace_api",
+    """
+        #include <stdint.h>
+        void init(int32_t capacity);
+        void pass_start(void);
+        void pass_end(void);
+        void page_access(uint32_t page);
+        int32_t prefetch(uint32_t *out, int32_t depth);
+        int32_t state(void);
+        void stats(uint32_t *out);
+    """,
+        sources=SRCS,
+        include_dirs=INCLUDES,
+        extra_compile_args=FLAGS)
+
+    ffibuilder.compile(tmpdir="build", target="page_trace_api.*", verbose=True)
+
+def clean_ffi():
+    rmtree("./build")
+
+
+if __name__ == "__main__":
+    build_ffi()
@@ -0,0 +1,18 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef APP_CONF_H_
+#define APP_CONF_H_
+
+/* The settings of the KWS backend under test */
+#define appconfAUDIO_PIPELINE_SAMPLE_RATE   16000
+#define appconfKWS_MODEL_FILE               "kws.tflite"
+#define appconfKWS_INPUT_MAX_SLICES         8
+#define appconfKWS_BLOCK_SIZE               320
+#define appconfKWS_CLASS_IDS                {0, 0, 1, 3}
+#define appconfKWS_CLASS_NAMES              {"silence", "unknown", "wake word", "command"}
+#define appconfKWS_AVERAGE_BLOCKS           4
+#define appconfKWS_THRESHOLD_PERCENT        80
+#define appconfKWS_SUPPRESS_BLOCKS          6
+
+#endif /* APP_CONF_H_ */
@@ -0,0 +1,118 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "inference_engine.h"
+#include "kws_features.h"
+#include "kws_model.h"
+
+#define MAX_INPUT_SIZE      1024
+#define MAX_OUTPUT_SIZE     8
+#define MAX_RESULTS         64
+
+/* Stands in for the TFLite Micro model, giving the probabilities set by the test */
+static int8_t model_input[MAX_INPUT_SIZE];
+static kws_model_info_t model_info;
+static int32_t model_init_ret;
+static float model_probabilities[MAX_OUTPUT_SIZE];
+static int32_t model_invokes;
+
+static int32_t result_ids[MAX_RESULTS];
+static int32_t result_count;
+
+int32_t kws_model_init(kws_model_info_t *info)
+{
+    *info = model_info;
+    return model_init_ret;
+}
+
+int32_t kws_model_invoke(float *probabilities)
+{
+    memcpy(probabilities, model_probabilities, model_info.output_size * sizeof(float));
+    model_invokes++;
+    return 0;
+}
+
+size_t kws_model_memory_footprint(void)
+{
+    return 0;
+}
+
+static void result_record(void *ctx, int id, const char *text)
+{
+    (void) ctx;
+    (void) text;
+
+    if (result_count < MAX_RESULTS) {
+        result_ids[result_count] = id;
+    }
+    result_count++;
+}
+
+void set_model(int32_t input_size, float input_scale, int32_t input_zero_point, int32_t output_size, int32_t init_ret)
+{
+    model_info.input = model_input;
+    model_info.input_size = input_size;
+    model_info.input_scale = input_scale;
+    model_info.input_zero_point = input_zero_point;
+    model_info.output_size = output_size;
+    model_init_ret = init_ret;
+}
+
+void set_probabilities(const float *probabilities, int32_t count)
+{
+    memcpy(model_probabilities, probabilities, count * sizeof(float));
+}
+
+int32_t backend_block_size(void)
+{
+    return inference_engine_backend_kws.block_size;
+}
+
+int32_t backend_init(void)
+{
+    result_count = 0;
+    model_invokes = 0;
+    return inference_engine_backend_kws.init(result_record, NULL);
+}
+
+int32_t backend_reset(void)
+{
+    return inference_engine_backend_kws.reset();
+}
+
+int32_t backend_process_block(const int16_t *samples)
+{
+    return inference_engine_backend_kws.process_block(samples);
+}
+
+int32_t backend_results(int32_t *ids, int32_t max_count)
+{
+    const int32_t n = result_count < max_count ? result_count : max_count;
+
+    memcpy(ids, result_ids, n * sizeof(int32_t));
+    return result_count;
+}
+
+int32_t backend_invokes(void)
+{
+    return model_invokes;
+}
+
+void backend_model_input(int8_t *dest)
+{
+    memcpy(dest, model_input, model_info.input_size);
+}
+
+/* Runs the front end on its own, from silence, one slice per KWS_FEATURES_STEP_SIZE samples */
+void features_compute(const int16_t *samples, int32_t slices, float *out)
+{
+    static kws_features_t ctx;
+
+    kws_features_init(&ctx);
+    for (int32_t s = 0; s < slices; s++) {
+        kws_features_compute(&ctx, &samples[s * KWS_FEATURES_STEP_SIZE], &out[s * KWS_FEATURES_CHANNELS]);
+    }
+}
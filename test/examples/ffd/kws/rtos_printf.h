@@ -0,0 +1,9 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef RTOS_PRINTF_H_
+#define RTOS_PRINTF_H_
+
+#define rtos_printf(...)
+
+#endif /* RTOS_PRINTF_H_ */
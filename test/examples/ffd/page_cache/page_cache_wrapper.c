@@ -0,0 +1,85 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "page_cache.h"
+
+#define MAX_PAGE_SIZE_LOG2  8
+#define MAX_PAGE_COUNT      16
+#define MAX_BACKING_SIZE    65536
+
+PAGE_CACHE_STORAGE(cache, MAX_PAGE_SIZE_LOG2, MAX_PAGE_COUNT);
+static page_cache_t ctx;
+
+static uint8_t backing[MAX_BACKING_SIZE];
+static int32_t backing_reads;
+static int32_t backing_bytes;
+static int32_t fail_at = -1;
+
+/* Reads from the backing array, failing any read that reaches fail_at */
+static size_t backing_read(void *read_ctx, void *dest, size_t offset, size_t size)
+{
+    (void) read_ctx;
+
+    backing_reads++;
+    if (fail_at >= 0 && offset + size > (size_t) fail_at) {
+        return 0;
+    }
+    memcpy(dest, &backing[offset], size);
+    backing_bytes += size;
+    return size;
+}
+
+void init(int32_t page_size_log2, int32_t page_count, const uint8_t *data, int32_t size)
+{
+    memcpy(backing, data, size);
+    backing_reads = 0;
+    backing_bytes = 0;
+    fail_at = -1;
+    page_cache_init(&ctx, cache_storage, cache_entries, page_size_log2, page_count, size, backing_read, NULL);
+}
+
+void set_fail_at(int32_t offset)
+{
+    fail_at = offset;
+}
+
+void invalidate(void)
+{
+    page_cache_invalidate(&ctx);
+}
+
+int32_t cache_read(uint8_t *dest, int32_t offset, int32_t size)
+{
+    return page_cache_read(&ctx, dest, offset, size);
+}
+
+int32_t contains(uint32_t page)
+{
+    return page_cache_contains(&ctx, page);
+}
+
+/* Prefetches page from the backing array */
+int32_t insert(uint32_t page, uint32_t cost)
+{
+    return page_cache_insert(&ctx, page, &backing[page << ctx.page_size_log2], cost);
+}
+
+void stats(uint32_t *out)
+{
+    page_cache_stats_t s;
+
+    page_cache_stats_get(&ctx, &s, 0);
+    out[0] = s.hits;
+    out[1] = s.misses;
+    out[2] = s.bypasses;
+    out[3] = s.read_errors;
+    out[4] = backing_reads;
+    out[5] = backing_bytes;
+    out[6] = s.prefetches;
+    out[7] = s.prefetch_hits;
+    out[8] = s.prefetch_wasted;
+    out[9] = (uint32_t) s.prefetch_saved;
+}
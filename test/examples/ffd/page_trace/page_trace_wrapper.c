@@ -0,0 +1,52 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+
+#include "page_trace.h"
+
+#define TRACE_LENGTH    64
+
+static page_trace_t ctx;
+static uint16_t pages[TRACE_LENGTH];
+
+void init(int32_t capacity)
+{
+    page_trace_init(&ctx, pages, capacity <= TRACE_LENGTH ? capacity : TRACE_LENGTH);
+}
+
+void pass_start(void)
+{
+    page_trace_start(&ctx);
+}
+
+void pass_end(void)
+{
+    page_trace_end(&ctx);
+}
+
+void page_access(uint32_t page)
+{
+    page_trace_access(&ctx, page);
+}
+
+int32_t prefetch(uint32_t *out, int32_t depth)
+{
+    return page_trace_prefetch(&ctx, out, depth);
+}
+
+int32_t state(void)
+{
+    return ctx.state;
+}
+
+void stats(uint32_t *out)
+{
+    page_trace_stats_t s;
+
+    page_trace_stats_get(&ctx, &s, 0);
+    out[0] = s.passes;
+    out[1] = s.learnt;
+    out[2] = s.followed;
+    out[3] = s.mispredicted;
+}
@@ -0,0 +1,165 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import os
+import sys
+import numpy as np
+import pytest
+
+from build_kws import build_ffi, clean_ffi
+
+sys.path.append(os.path.join(os.path.dirname(__file__), "../../../tools/kws"))
+import kws_features
+
+CHANNELS = kws_features.CHANNELS
+STEP_SIZE = kws_features.STEP_SIZE
+MAX_SLICES = 8
+CLASS_COUNT = 4
+SCALE = 0.15
+ZERO_POINT = 20
+
+def audio(slices, seed=1):
+    rng = np.random.default_rng(seed)
+    t = np.arange(slices * STEP_SIZE) / kws_features.SAMPLE_RATE
+    tone = 8000 * np.sin(2 * np.pi * 440 * t) + 3000 * np.sin(2 * np.pi * 2500 * t)
+    return np.clip(tone + rng.normal(0, 500, len(t)), -32768, 32767).astype(np.int16)
+
+def setup(slices=MAX_SLICES, output_size=CLASS_COUNT, init_ret=0):
+    lib.set_model(slices * CHANNELS, SCALE, ZERO_POINT, output_size, init_ret)
+    ret = lib.backend_init()
+    if ret == 0:
+        assert lib.backend_reset() == 0
+    return ret
+
+def process(samples):
+    block_size = lib.backend_block_size()
+    for i in range(0, len(samples), block_size):
+        block = np.ascontiguousarray(samples[i:i + block_size], dtype=np.int16)
+        assert lib.backend_process_block(ffi.cast("const int16_t *", block.ctypes.data)) == 0
+
+def probabilities(*p):
+    lib.set_probabilities(ffi.new("float[]", list(p)), len(p))
+
+def results():
+    ids = ffi.new("int32_t[64]")
+    n = lib.backend_results(ids, 64)
+    return list(ids)[:n]
+
+
+@pytest.fixture(scope="module")
+def build_uut():
+    # These are declared global so they may be used in the subsequent tests - bit of a hack
+    global ffi
+    global lib
+
+    build_ffi()
+
+    # Import the things we just built
+    from build import kws_api
+    from kws_api import ffi
+    import kws_api.lib as lib
+
+    yield
+
+    clean_ffi()
+
+# Test that the C front end gives the features of the Python reference models are trained on
+def test_features_match_reference(build_uut):
+    slices = 20
+    samples = audio(slices)
+    out = ffi.new("float[]", slices * CHANNELS)
+    lib.features_compute(ffi.cast("const int16_t *", samples.ctypes.data), slices, out)
+
+    feats = np.frombuffer(ffi.buffer(out), dtype=np.float32).reshape(slices, CHANNELS)
+    np.testing.assert_allclose(feats, kws_features.features(samples), atol=1e-3)
+
+# Test that the features of digital silence are the log floor
+def test_features_of_silence(build_uut):
+    out = ffi.new("float[]", CHANNELS)
+    lib.features_compute(ffi.new("int16_t[]", STEP_SIZE), 1, out)
+    np.testing.assert_allclose(list(out), np.log(kws_features.LOG_FLOOR), rtol=1e-6)
+
+# Test that models the backend cannot feed, or whose outputs do not match the classes, are rejected
+def test_init_rejects_bad_models(build_uut):
+    assert setup(init_ret=-1) != 0
+    assert setup(slices=MAX_SLICES + 1) != 0
+    assert setup(slices=0) != 0
+    assert setup(output_size=CLASS_COUNT - 1) != 0
+    lib.set_model(CHANNELS + 1, SCALE, ZERO_POINT, CLASS_COUNT, 0)
+    assert lib.backend_init() != 0
+    assert setup() == 0
+
+# Test that the model input holds the quantised features of the latest slices, oldest first, after silence
+def test_model_input_slides(build_uut):
+    assert setup() == 0
+    probabilities(1, 0, 0, 0)
+
+    for blocks in (3, MAX_SLICES + 4):
+        assert lib.backend_reset() == 0
+        samples = audio(blocks, seed=blocks)
+        process(samples)
+
+        expected = np.full((MAX_SLICES + blocks, CHANNELS), kws_features.quantise(np.log(kws_features.LOG_FLOOR), SCALE, ZERO_POINT))
+        expected[MAX_SLICES:] = kws_features.quantise(kws_features.features(samples), SCALE, ZERO_POINT)
+
+        dest = ffi.new("int8_t[]", MAX_SLICES * CHANNELS)
+        lib.backend_model_input(dest)
+        actual = np.frombuffer(ffi.buffer(dest), dtype=np.int8).reshape(MAX_SLICES, CHANNELS)
+        assert np.max(np.abs(actual.astype(int) - expected[-MAX_SLICES:])) <= 1
+
+    assert lib.backend_invokes() == 3 + MAX_SLICES + 4
+
+# Test that a keyword is reported once its average reaches the threshold, then suppressed
+def test_keyword_averaged_and_suppressed(build_uut):
+    assert setup() == 0
+    probabilities(0, 0.1, 0.9, 0)
+    silence = np.zeros(STEP_SIZE, dtype=np.int16)
+
+    for _ in range(3):
+        process(silence)
+    assert results() == []
+
+    process(silence)
+    assert results() == [1]
+
+    # Suppressed for the next 6 blocks only
+    for _ in range(6):
+        process(silence)
+    assert results() == [1]
+    process(silence)
+    assert results() == [1, 1]
+
+# Test that the most probable keyword is reported, and never a class that is not a keyword
+def test_best_keyword_reported(build_uut):
+    assert setup() == 0
+    silence = np.zeros(STEP_SIZE, dtype=np.int16)
+
+    probabilities(1.0, 1.0, 0, 0)
+    for _ in range(8):
+        process(silence)
+    assert results() == []
+
+    probabilities(0, 0, 0.85, 0.95)
+    for _ in range(4):
+        process(silence)
+    assert results() == [3]
+
+# Test that reset forgets the probabilities averaged so far, and that the backend may be initialised again
+def test_reset_clears_history(build_uut):
+    assert setup() == 0
+    probabilities(0, 0, 0.9, 0)
+    silence = np.zeros(STEP_SIZE, dtype=np.int16)
+
+    for _ in range(3):
+        process(silence)
+    assert lib.backend_reset() == 0
+    for _ in range(3):
+        process(silence)
+    assert results() == []
+    process(silence)
+    assert results() == [1]
+
+    assert setup() == 0
+    for _ in range(4):
+        process(silence)
+    assert results() == [1]
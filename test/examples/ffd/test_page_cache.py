@@ -0,0 +1,165 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import random
+import pytest
+
+from build_page_cache import build_ffi, clean_ffi
+
+PAGE_SIZE_LOG2 = 8
+PAGE_SIZE = 1 << PAGE_SIZE_LOG2
+PAGE_COUNT = 16
+
+def setup(size=PAGE_SIZE * 64, page_size_log2=PAGE_SIZE_LOG2, page_count=PAGE_COUNT):
+    data = bytes(random.randrange(256) for _ in range(size))
+    lib.init(page_size_log2, page_count, data, size)
+    return data
+
+def read(offset, size):
+    dest = ffi.new("uint8_t[]", max(size, 1))
+    n = lib.cache_read(dest, offset, size)
+    return bytes(ffi.buffer(dest, n))
+
+def stats():
+    out = ffi.new("uint32_t[10]")
+    lib.stats(out)
+    return dict(zip(["hits", "misses", "bypasses", "read_errors", "backing_reads", "backing_bytes",
+                     "prefetches", "prefetch_hits", "prefetch_wasted", "prefetch_saved"], out))
+
+
+@pytest.fixture(scope="module")
+def build_uut():
+    # These are declared global so they may be used in the subsequent tests - bit of a hack
+    global ffi
+    global lib
+
+    build_ffi()
+
+    # Import the things we just built
+    from build import page_cache_api
+    from page_cache_api import ffi
+    import page_cache_api.lib as lib
+
+    yield
+
+    clean_ffi()
+
+# Test that reads of any size and alignment return the backing data
+def test_random_reads(build_uut):
+    data = setup()
+    for _ in range(2000):
+        offset = random.randrange(len(data))
+        size = random.randint(0, 3 * PAGE_SIZE)
+        assert read(offset, size) == data[offset:offset + size]
+
+# Test that reads are cut short at the end of the backing store, including a short last page
+def test_end_of_backing(build_uut):
+    data = setup(size=PAGE_SIZE * 10 + 37)
+    assert read(len(data) - 10, 100) == data[-10:]
+    assert read(len(data), 1) == b""
+    assert read(PAGE_SIZE * 10, PAGE_SIZE) == data[PAGE_SIZE * 10:]
+    assert stats()["backing_bytes"] == 37
+
+# Test that once a working set that fits is loaded, it is read from the cache alone
+def test_working_set_hits(build_uut):
+    data = setup()
+    for _ in range(3):
+        for page in range(PAGE_COUNT):
+            assert read(page * PAGE_SIZE + 5, 40) == data[page * PAGE_SIZE + 5:page * PAGE_SIZE + 45]
+    s = stats()
+    assert s["misses"] == PAGE_COUNT
+    assert s["hits"] == 2 * PAGE_COUNT
+    assert s["backing_reads"] == PAGE_COUNT
+
+# Test that the least recently used page is the one replaced
+def test_lru_replacement(build_uut):
+    data = setup()
+    for page in range(PAGE_COUNT):
+        read(page * PAGE_SIZE, 1)
+    read(0, 1)                         # page 0 becomes the most recently used
+    read(PAGE_COUNT * PAGE_SIZE, 1)    # so this replaces page 1
+    assert stats()["misses"] == PAGE_COUNT + 1
+
+    read(0, 1)
+    assert stats()["misses"] == PAGE_COUNT + 1
+    assert read(PAGE_SIZE, 1) == data[PAGE_SIZE:PAGE_SIZE + 1]
+    assert stats()["misses"] == PAGE_COUNT + 2
+
+# Test that a sequence longer than the cache in order misses every time, as LRU must
+def test_cyclic_thrash(build_uut):
+    setup()
+    for _ in range(3):
+        for page in range(PAGE_COUNT + 1):
+            read(page * PAGE_SIZE, 1)
+    s = stats()
+    assert s["hits"] == 0
+    assert s["misses"] == 3 * (PAGE_COUNT + 1)
+
+# Test that a read larger than the whole cache goes straight to the backing store
+def test_bypass(build_uut):
+    data = setup()
+    read(0, 1)
+    size = PAGE_SIZE * PAGE_COUNT + 1
+    assert read(3, size) == data[3:3 + size]
+    s = stats()
+    assert s["bypasses"] == 1
+    assert s["backing_reads"] == 2
+    read(0, 1)
+    assert stats()["hits"] == 1
+
+# Test that a failed page read is reported, not cached, and retried on the next read
+def test_read_error(build_uut):
+    data = setup()
+    lib.set_fail_at(3 * PAGE_SIZE)
+    assert read(PAGE_SIZE, 3 * PAGE_SIZE) == data[PAGE_SIZE:3 * PAGE_SIZE]
+    assert stats()["read_errors"] == 1
+    lib.set_fail_at(-1)
+    assert read(2 * PAGE_SIZE, 2 * PAGE_SIZE) == data[2 * PAGE_SIZE:4 * PAGE_SIZE]
+    assert stats()["misses"] == 4
+
+# Test that invalidating the cache makes every page be read again
+def test_invalidate(build_uut):
+    setup()
+    read(0, 4 * PAGE_SIZE)
+    lib.invalidate()
+    read(0, 4 * PAGE_SIZE)
+    assert stats()["misses"] == 8
+
+# Test that prefetched pages are read from the cache, and their cost counted once used
+def test_prefetch(build_uut):
+    data = setup()
+    assert lib.insert(3, 100)
+    assert lib.insert(4, 50)
+    assert not lib.insert(3, 100)
+    assert not lib.insert(64, 100)     # past the end
+    assert lib.contains(3) and lib.contains(4) and not lib.contains(5)
+
+    assert read(3 * PAGE_SIZE + 10, PAGE_SIZE) == data[3 * PAGE_SIZE + 10:4 * PAGE_SIZE + 10]
+    assert read(3 * PAGE_SIZE, 1) == data[3 * PAGE_SIZE:3 * PAGE_SIZE + 1]
+    s = stats()
+    assert s["misses"] == 0
+    assert s["backing_reads"] == 0
+    assert s["prefetches"] == 2
+    assert s["prefetch_hits"] == 2
+    assert s["prefetch_saved"] == 150
+
+# Test that a prefetched page replaced before it is read counts as wasted
+def test_prefetch_wasted(build_uut):
+    setup()
+    lib.insert(60, 10)
+    for page in range(PAGE_COUNT):
+        read(page * PAGE_SIZE, 1)
+    s = stats()
+    assert not lib.contains(60)
+    assert s["prefetch_wasted"] == 1
+    assert s["prefetch_hits"] == 0
+    assert s["prefetch_saved"] == 0
+
+# Test other page sizes and counts, including a single page
+@pytest.mark.parametrize("page_size_log2, page_count", [(8, 1), (4, 16), (6, 3)])
+def test_geometry(build_uut, page_size_log2, page_count):
+    data = setup(size=5000, page_size_log2=page_size_log2, page_count=page_count)
+    for _ in range(500):
+        offset = random.randrange(len(data))
+        size = random.randint(0, 2 << page_size_log2)
+        assert read(offset, size) == data[offset:offset + size]
@@ -0,0 +1,127 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import random
+import pytest
+
+from build_page_trace import build_ffi, clean_ffi
+
+LEARN = 0
+RECORDING = 1
+FOLLOWING = 2
+OVERFLOWED = 3
+
+def run_pass(pages, depth=0):
+    """Runs one pass reading pages, returning the pages prefetched before each read"""
+    predicted = []
+    lib.pass_start()
+    predicted.append(prefetch(depth))
+    for page in pages:
+        lib.page_access(page)
+        predicted.append(prefetch(depth))
+    lib.pass_end()
+    return predicted
+
+def prefetch(depth):
+    if depth == 0:
+        return []
+    out = ffi.new("uint32_t[]", depth)
+    n = lib.prefetch(out, depth)
+    return list(out)[:n]
+
+def stats():
+    out = ffi.new("uint32_t[4]")
+    lib.stats(out)
+    return dict(zip(["passes", "learnt", "followed", "mispredicted"], out))
+
+
+@pytest.fixture(scope="module")
+def build_uut():
+    # These are declared global so they may be used in the subsequent tests - bit of a hack
+    global ffi
+    global lib
+
+    build_ffi()
+
+    # Import the things we just built
+    from build import page_trace_api
+    from page_trace_api import ffi
+    import page_trace_api.lib as lib
+
+    yield
+
+    clean_ffi()
+
+# Test that the first pass is learnt, with repeated reads of one page recorded once
+def test_learn(build_uut):
+    lib.init(64)
+    assert lib.state() == LEARN
+    assert run_pass([3, 3, 4, 9, 9, 9, 1], depth=4) == [[]] * 8
+    assert lib.state() == FOLLOWING
+    s = stats()
+    assert s["learnt"] == 1
+    assert s["passes"] == 1
+
+# Test that a repeated pass is predicted depth pages ahead, each page once
+def test_follow(build_uut):
+    lib.init(64)
+    order = [random.randrange(1000) for _ in range(40)]
+    order = [p for i, p in enumerate(order) if i == 0 or p != order[i - 1]]
+    run_pass(order)
+
+    for _ in range(3):
+        predicted = run_pass(order, depth=4)
+        assert predicted[0] == order[:4]
+        issued = [p for step in predicted for p in step]
+        assert issued == order
+
+    s = stats()
+    assert s["followed"] == 3 * len(order)
+    assert s["mispredicted"] == 0
+
+# Test that an extra read and a skipped read are resynchronised without relearning
+def test_resync(build_uut):
+    lib.init(64)
+    order = list(range(10, 40))
+    run_pass(order)
+
+    changed = order[:5] + [500] + order[5:12] + order[15:]
+    predicted = run_pass(changed, depth=2)
+    assert lib.state() == FOLLOWING
+    assert stats()["mispredicted"] == 2
+    # Once back in place, the prediction carries on from the read found
+    issued = [p for step in predicted for p in step]
+    assert issued[-len(order[16:]):] == order[16:]
+
+    predicted = run_pass(order, depth=2)
+    assert [p for step in predicted for p in step] == order
+
+# Test that a pass unlike the recording is learnt again on the next pass
+def test_relearn(build_uut):
+    lib.init(64)
+    run_pass(list(range(20)))
+    other = list(range(100, 120))
+    run_pass(other)
+    assert lib.state() == LEARN
+    run_pass(other)
+    assert lib.state() == FOLLOWING
+    assert stats()["learnt"] == 2
+    predicted = run_pass(other, depth=3)
+    assert [p for step in predicted for p in step] == other
+
+# Test that a pass that does not fit stops all prediction
+def test_overflow(build_uut):
+    lib.init(8)
+    run_pass(list(range(9)))
+    assert lib.state() == OVERFLOWED
+    assert run_pass(list(range(9)), depth=4) == [[]] * 10
+
+# Test that reads outside a pass are ignored
+def test_outside_pass(build_uut):
+    lib.init(64)
+    lib.page_access(7)
+    run_pass([1, 2, 3])
+    lib.page_access(9)
+    assert prefetch(4) == []
+    predicted = run_pass([1, 2, 3], depth=4)
+    assert predicted[0] == [1, 2, 3]
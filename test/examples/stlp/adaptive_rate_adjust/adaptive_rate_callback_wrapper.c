@@ -0,0 +1,205 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+// These match the x86 values in adaptive_rate_callback.c
+#define TOTAL_TAIL_SECONDS 16
+#define STORED_PER_SECOND 4
+#define EXPECTED_OUT_BYTES_PER_TRANSACTION  128
+#define EXPECTED_IN_BYTES_PER_TRANSACTION   192
+
+#define TOTAL_STORED (TOTAL_TAIL_SECONDS * STORED_PER_SECOND)
+#define REF_CLOCK_TICKS_PER_SECOND 100000000
+#define REF_CLOCK_TICKS_PER_STORED_AVG (REF_CLOCK_TICKS_PER_SECOND / STORED_PER_SECOND)
+#define NOMINAL_RATE (1 << 31)
+
+#define EXPECTED_OUT_BYTES_PER_BUCKET ((EXPECTED_OUT_BYTES_PER_TRANSACTION * 1000) / STORED_PER_SECOND)
+#define EXPECTED_IN_BYTES_PER_BUCKET ((EXPECTED_IN_BYTES_PER_TRANSACTION * 1000) / STORED_PER_SECOND)
+
+uint32_t determine_USB_audio_rate(uint32_t timestamp,
+                                    uint32_t data_length,
+                                    uint32_t direction,
+                                    bool update,
+                                    uint32_t * debug);
+void reset_state();
+uint32_t dsp_math_divide_unsigned(uint32_t dividend, uint32_t divisor, uint32_t q_format);
+uint32_t dsp_math_divide_unsigned_64(uint64_t dividend, uint32_t divisor, uint32_t q_format);
+
+/*
+ * Reference: the estimator as it was before it kept running totals, summing
+ * every stored bucket on each packet. Kept here to check the two are bit exact.
+ */
+static bool ref_first_time[2] = {true, true};
+static volatile bool ref_data_seen = false;
+static volatile bool ref_hold_average = false;
+static const uint32_t ref_expected[2] = {EXPECTED_OUT_BYTES_PER_TRANSACTION, EXPECTED_IN_BYTES_PER_TRANSACTION};
+static const uint32_t ref_bucket_expected[2] = {EXPECTED_OUT_BYTES_PER_BUCKET, EXPECTED_IN_BYTES_PER_BUCKET};
+
+static uint32_t ref_sum_array(uint32_t * array_to_sum, uint32_t array_length)
+{
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < array_length; i++)
+    {
+        acc += array_to_sum[i];
+    }
+    return acc;
+}
+
+void ref_reset_state()
+{
+    for (int direction = 0; direction < 2; direction++)
+    {
+        ref_first_time[direction] = true;
+    }
+}
+
+uint32_t ref_determine_USB_audio_rate(uint32_t timestamp,
+                                        uint32_t data_length,
+                                        uint32_t direction,
+                                        bool update,
+                                        uint32_t * debug)
+{
+    static uint32_t data_lengths[2][TOTAL_STORED];
+    static uint32_t time_buckets[2][TOTAL_STORED];
+    static uint32_t current_data_bucket_size[2];
+    static uint32_t first_timestamp[2];
+    static bool buckets_full[2];
+    static uint32_t times_overflowed[2];
+    static uint32_t previous_result[2] = {NOMINAL_RATE, NOMINAL_RATE};
+
+    if (ref_data_seen == false)
+    {
+        ref_data_seen = true;
+    }
+
+    if (ref_hold_average)
+    {
+        ref_hold_average = false;
+        first_timestamp[direction] = timestamp;
+        current_data_bucket_size[direction] = 0;
+        return previous_result[direction];
+    }
+
+    if (ref_first_time[direction])
+    {
+        ref_first_time[direction] = false;
+        first_timestamp[direction] = timestamp;
+
+        current_data_bucket_size[direction] = 0;
+        times_overflowed[direction] = 0;
+        buckets_full[direction] = false;
+
+        for (int i = 0; i < TOTAL_STORED - STORED_PER_SECOND; i++)
+        {
+            data_lengths[direction][i] = 0;
+            time_buckets[direction][i] = 0;
+        }
+        for (int i = TOTAL_STORED - STORED_PER_SECOND; i < TOTAL_STORED; i++)
+        {
+            data_lengths[direction][i] = ref_bucket_expected[direction];
+            time_buckets[direction][i] = REF_CLOCK_TICKS_PER_STORED_AVG;
+        }
+
+        return NOMINAL_RATE;
+    }
+
+    if (update)
+    {
+        current_data_bucket_size[direction] += data_length;
+    }
+
+    uint32_t timespan = timestamp - first_timestamp[direction];
+    uint32_t total_data_intermed = current_data_bucket_size[direction] + ref_sum_array(data_lengths[direction], TOTAL_STORED);
+    uint64_t total_data = (uint64_t)(total_data_intermed) * 12500;
+    uint32_t total_timespan = timespan + ref_sum_array(time_buckets[direction], TOTAL_STORED);
+
+    uint32_t data_per_sample = dsp_math_divide_unsigned_64(total_data, (total_timespan / 8), 19);
+    uint32_t result = dsp_math_divide_unsigned(data_per_sample, ref_expected[direction], 12);
+
+    if (update && (timespan >= REF_CLOCK_TICKS_PER_STORED_AVG))
+    {
+        if (buckets_full[direction])
+        {
+            uint32_t oldest_bucket = times_overflowed[direction] % TOTAL_STORED;
+
+            time_buckets[direction][oldest_bucket] = timespan;
+            data_lengths[direction][oldest_bucket] = current_data_bucket_size[direction];
+
+            current_data_bucket_size[direction] = 0;
+            first_timestamp[direction] = timestamp;
+
+            times_overflowed[direction]++;
+        }
+        else
+        {
+            time_buckets[direction][times_overflowed[direction]] = timespan;
+            data_lengths[direction][times_overflowed[direction]] = current_data_bucket_size[direction];
+
+            current_data_bucket_size[direction] = 0;
+            first_timestamp[direction] = timestamp;
+
+            times_overflowed[direction]++;
+            if (times_overflowed[direction] == TOTAL_STORED)
+            {
+                buckets_full[direction] = true;
+            }
+        }
+    }
+
+    debug[0] = result;
+    debug[1] = data_per_sample;
+    debug[2] = total_data_intermed;
+    debug[3] = total_timespan;
+
+    previous_result[direction] = result;
+    return result;
+}
+
+void ref_sof_toggle()
+{
+    static uint32_t sof_count;
+    if (ref_data_seen)
+    {
+        sof_count = 0;
+        ref_data_seen = false;
+    }
+    else
+    {
+        sof_count++;
+        if (sof_count > 8 && !ref_hold_average)
+        {
+            ref_hold_average = true;
+        }
+    }
+}
+
+/*
+ * Returns the CPU time in seconds taken to estimate the rate of num_packets
+ * OUT packets, one per millisecond.
+ */
+double ref_benchmark(uint32_t num_packets)
+{
+    uint32_t debug[4];
+    ref_reset_state();
+    clock_t start = clock();
+    for (uint32_t i = 1; i <= num_packets; i++)
+    {
+        ref_determine_USB_audio_rate(i * 100000, EXPECTED_OUT_BYTES_PER_TRANSACTION, 0, true, debug);
+    }
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+double uut_benchmark(uint32_t num_packets)
+{
+    uint32_t debug[4];
+    reset_state();
+    clock_t start = clock();
+    for (uint32_t i = 1; i <= num_packets; i++)
+    {
+        determine_USB_audio_rate(i * 100000, EXPECTED_OUT_BYTES_PER_TRANSACTION, 0, true, debug);
+    }
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
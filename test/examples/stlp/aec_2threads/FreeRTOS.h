@@ -0,0 +1,30 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/*
+ * Stands in for the FreeRTOS headers, of which aec_process_frame_2threads.c
+ * needs task creation and direct to task notifications. Tasks are pthreads.
+ */
+
+#ifndef FREERTOS_H_
+#define FREERTOS_H_
+
+#include <assert.h>
+#include <stdint.h>
+
+#define configASSERT(x) assert(x)
+
+#define pdTRUE          1
+#define portMAX_DELAY   0xFFFFFFFF
+
+#define RTOS_THREAD_STACK_SIZE(x)   0
+
+typedef struct task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+int xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_words, void *arg, unsigned priority, TaskHandle_t *handle);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(int clear, uint32_t ticks);
+
+#endif /* FREERTOS_H_ */
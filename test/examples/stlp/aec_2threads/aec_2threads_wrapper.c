@@ -0,0 +1,403 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "aec_api.h"
+
+extern void aec_process_frame_1thread(
+        aec_state_t *main_state,
+        aec_state_t *shadow_state,
+        int32_t (*output_main)[AEC_FRAME_ADVANCE],
+        int32_t (*output_shadow)[AEC_FRAME_ADVANCE],
+        const int32_t (*y_data)[AEC_FRAME_ADVANCE],
+        const int32_t (*x_data)[AEC_FRAME_ADVANCE]);
+
+extern void aec_process_frame_2threads_init(unsigned priority);
+extern void aec_process_frame_2threads(
+        aec_state_t *main_state,
+        aec_state_t *shadow_state,
+        int32_t (*output_main)[AEC_FRAME_ADVANCE],
+        int32_t (*output_shadow)[AEC_FRAME_ADVANCE],
+        const int32_t (*y_data)[AEC_FRAME_ADVANCE],
+        const int32_t (*x_data)[AEC_FRAME_ADVANCE]);
+
+/*
+ * Every read and write of the modelled state, by the stage task (0) and the
+ * worker task (1), since the stage task last started a parallel step.
+ */
+#define MAX_ACCESSES 4096
+
+typedef struct {
+    const void *cell;
+    int write;
+} access_t;
+
+static access_t accesses[2][MAX_ACCESSES];
+static int32_t access_count[2];
+static int32_t worker_accesses;
+static int32_t parallel_steps;
+static int32_t conflicts;
+
+static __thread int thread_id;
+
+static void record(const void *cell, int write)
+{
+    if (access_count[thread_id] < MAX_ACCESSES) {
+        accesses[thread_id][access_count[thread_id]].cell = cell;
+        accesses[thread_id][access_count[thread_id]].write = write;
+        access_count[thread_id]++;
+    }
+    if (thread_id == 1) {
+        worker_accesses++;
+    }
+}
+
+static void step_start(void)
+{
+    access_count[0] = 0;
+    access_count[1] = 0;
+    parallel_steps++;
+}
+
+/* Counts the cells one task wrote that the other task read or wrote during the step */
+static void step_end(void)
+{
+    for (int32_t i = 0; i < access_count[0]; i++) {
+        for (int32_t j = 0; j < access_count[1]; j++) {
+            if (accesses[0][i].cell == accesses[1][j].cell && (accesses[0][i].write || accesses[1][j].write)) {
+                conflicts++;
+            }
+        }
+    }
+}
+
+/* FreeRTOS, with tasks as pthreads */
+
+struct task {
+    int id;
+    sem_t notify;
+    TaskFunction_t fn;
+    void *arg;
+    pthread_t thread;
+};
+
+static struct task stage_task = {.id = 0};
+static struct task worker_task = {.id = 1};
+static __thread struct task *current_task;
+
+static void *task_start(void *arg)
+{
+    struct task *t = arg;
+
+    current_task = t;
+    thread_id = t->id;
+    t->fn(t->arg);
+    return NULL;
+}
+
+int xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_words, void *arg, unsigned priority, TaskHandle_t *handle)
+{
+    (void) name;
+    (void) stack_words;
+    (void) priority;
+
+    worker_task.fn = fn;
+    worker_task.arg = arg;
+    sem_init(&worker_task.notify, 0, 0);
+    *handle = &worker_task;
+    pthread_create(&worker_task.thread, NULL, task_start, &worker_task);
+    return 1;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return current_task != NULL ? current_task : &stage_task;
+}
+
+void xTaskNotifyGive(TaskHandle_t task)
+{
+    if (task == &worker_task) {
+        step_start();
+    }
+    sem_post(&task->notify);
+}
+
+uint32_t ulTaskNotifyTake(int clear, uint32_t ticks)
+{
+    struct task *t = xTaskGetCurrentTaskHandle();
+
+    (void) clear;
+    (void) ticks;
+
+    sem_wait(&t->notify);
+    if (t == &stage_task) {
+        step_end();
+    }
+    return 1;
+}
+
+/*
+ * The AEC, with each BFP vector or float modelled as a hash of everything
+ * it was computed from, in order. Two runs give the same hashes only if
+ * every function saw the same inputs in the same order.
+ */
+
+static uint32_t mix(uint32_t h, uint32_t v)
+{
+    return h ^ (v + 0x9E3779B9u + (h << 6) + (h >> 2));
+}
+
+static uint32_t rd(const void *cell)
+{
+    record(cell, 0);
+    return *(const uint32_t *) cell;
+}
+
+static void wr(void *cell, uint32_t v)
+{
+    record(cell, 1);
+    *(uint32_t *) cell = v;
+}
+
+static uint32_t rd_samples(const int32_t *data, unsigned length)
+{
+    uint32_t h = 0;
+
+    record(data, 0);
+    for (unsigned i = 0; i < length; i++) {
+        h = mix(h, (uint32_t) data[i]);
+    }
+    return h;
+}
+
+void bfp_s32_init(bfp_s32_t *a, int32_t *data, int exp, unsigned length, int calc_hr)
+{
+    (void) exp;
+    (void) calc_hr;
+    wr(a, rd_samples(data, length));
+}
+
+void aec_frame_init(aec_state_t *main_state, aec_state_t *shadow_state,
+                    const int32_t (*y_data)[AEC_FRAME_ADVANCE], const int32_t (*x_data)[AEC_FRAME_ADVANCE])
+{
+    aec_shared_state_t *shared = main_state->shared_state;
+
+    (void) shadow_state;
+    for (int ch = 0; ch < shared->num_y_channels; ch++) {
+        wr(&shared->y[ch], mix(rd(&shared->y[ch]), rd_samples(y_data[ch], AEC_FRAME_ADVANCE)));
+    }
+    for (int ch = 0; ch < shared->num_x_channels; ch++) {
+        wr(&shared->x[ch], mix(rd(&shared->x[ch]), rd_samples(x_data[ch], AEC_FRAME_ADVANCE)));
+    }
+}
+
+void aec_calc_time_domain_ema_energy(float_s32_t *ema_out, const bfp_s32_t *input, unsigned start_offset,
+                                     unsigned length, const aec_config_params_t *conf)
+{
+    wr(ema_out, mix(mix(mix(rd(ema_out), rd(input)), rd(conf)), start_offset * 1000 + length));
+}
+
+/* In place, so the input is written too */
+void aec_forward_fft(bfp_complex_s32_t *output, bfp_s32_t *input)
+{
+    const uint32_t h = mix(rd(input), 1);
+
+    wr(output, h);
+    wr(input, h);
+}
+
+void aec_inverse_fft(bfp_s32_t *output, bfp_complex_s32_t *input)
+{
+    const uint32_t h = mix(rd(input), 2);
+
+    wr(output, h);
+    wr(input, h);
+}
+
+void aec_calc_X_fifo_energy(aec_state_t *state, unsigned ch, unsigned recalc_bin)
+{
+    const uint32_t h = mix(mix(rd(&state->shared_state->X[ch]), rd(&state->shared_state->X_fifo[ch])), recalc_bin);
+
+    wr(&state->X_energy[ch], mix(rd(&state->X_energy[ch]), h));
+}
+
+void aec_update_X_fifo_and_calc_sigmaXX(aec_state_t *state, unsigned ch)
+{
+    aec_shared_state_t *shared = state->shared_state;
+
+    wr(&shared->X_fifo[ch], mix(rd(&shared->X_fifo[ch]), rd(&shared->X[ch])));
+    wr(&shared->sigma_XX[ch], mix(rd(&shared->sigma_XX[ch]), rd(&shared->X[ch])));
+}
+
+void aec_update_X_fifo_1d(aec_state_t *state)
+{
+    uint32_t h = rd(&state->X_fifo_1d);
+
+    for (int ch = 0; ch < state->shared_state->num_x_channels; ch++) {
+        h = mix(h, rd(&state->shared_state->X_fifo[ch]));
+    }
+    wr(&state->X_fifo_1d, h);
+}
+
+void aec_calc_Error_and_Y_hat(aec_state_t *state, unsigned ch)
+{
+    const uint32_t h = mix(mix(rd(&state->shared_state->Y[ch]), rd(&state->X_fifo_1d)), rd(&state->H_hat[ch]));
+
+    wr(&state->Error[ch], h);
+    wr(&state->Y_hat[ch], mix(h, 3));
+}
+
+void aec_calc_coherence(aec_state_t *state, unsigned ch)
+{
+    aec_shared_state_t *shared = state->shared_state;
+
+    wr(&shared->coh_mu_state[ch], mix(mix(rd(&shared->coh_mu_state[ch]), rd(&shared->y[ch])), rd(&state->y_hat[ch])));
+}
+
+/* Overlap adds the windowed error, which is also needed for the shadow filter when it has no output */
+void aec_calc_output(aec_state_t *state, int32_t (*output)[AEC_FRAME_ADVANCE], unsigned ch)
+{
+    const uint32_t h = mix(rd(&state->error[ch]), rd(&state->overlap[ch]));
+
+    wr(&state->overlap[ch], h);
+    wr(&state->error[ch], mix(h, 4));
+    if (output != NULL) {
+        record(output, 1);
+        for (int i = 0; i < AEC_FRAME_ADVANCE; i++) {
+            (*output)[i] = (int32_t) mix(h, i);
+        }
+    }
+}
+
+void aec_calc_freq_domain_energy(float_s32_t *output, const bfp_complex_s32_t *input)
+{
+    wr(output, mix(rd(input), 5));
+}
+
+void aec_compare_filters_and_calc_mu(aec_state_t *main_state, aec_state_t *shadow_state)
+{
+    aec_shared_state_t *shared = main_state->shared_state;
+    uint32_t h = rd(&shared->shadow_filter_params);
+
+    for (int ych = 0; ych < shared->num_y_channels; ych++) {
+        h = mix(h, rd(&main_state->overall_Error[ych]));
+        h = mix(h, rd(&shadow_state->overall_Error[ych]));
+        h = mix(h, rd(&shared->overall_Y[ych]));
+        h = mix(h, rd(&shared->coh_mu_state[ych]));
+    }
+    wr(&shared->shadow_filter_params, h);
+
+    for (int ych = 0; ych < shared->num_y_channels; ych++) {
+        wr(&main_state->H_hat[ych], mix(rd(&main_state->H_hat[ych]), h));
+        wr(&shadow_state->H_hat[ych], mix(rd(&shadow_state->H_hat[ych]), h));
+        wr(&main_state->Error[ych], mix(rd(&main_state->Error[ych]), h));
+        wr(&shadow_state->Error[ych], mix(rd(&shadow_state->Error[ych]), h));
+        for (int xch = 0; xch < shared->num_x_channels; xch++) {
+            wr(&main_state->mu[ych][xch], mix(h, 6));
+            wr(&shadow_state->mu[ych][xch], mix(h, 7));
+        }
+    }
+}
+
+void aec_calc_normalisation_spectrum(aec_state_t *state, unsigned ch, unsigned is_shadow)
+{
+    wr(&state->inv_X_energy[ch], mix(mix(rd(&state->X_energy[ch]), rd(&state->shared_state->sigma_XX[ch])), is_shadow));
+}
+
+void aec_calc_T(aec_state_t *state, unsigned y_ch, unsigned x_ch)
+{
+    wr(&state->T[x_ch], mix(mix(rd(&state->mu[y_ch][x_ch]), rd(&state->Error[y_ch])), rd(&state->inv_X_energy[x_ch])));
+}
+
+void aec_filter_adapt(aec_state_t *state, unsigned y_ch)
+{
+    uint32_t h = mix(rd(&state->H_hat[y_ch]), rd(&state->X_fifo_1d));
+
+    for (int xch = 0; xch < state->shared_state->num_x_channels; xch++) {
+        h = mix(h, rd(&state->T[xch]));
+    }
+    wr(&state->H_hat[y_ch], h);
+}
+
+/* The states run by the 1 and 2 thread frame processing, from the same starting point */
+
+static aec_shared_state_t shared_state[2];
+static aec_state_t main_state[2];
+static aec_state_t shadow_state[2];
+
+static void fill(void *p, size_t size, uint32_t *seed)
+{
+    uint32_t *w = p;
+
+    for (size_t i = 0; i < size / sizeof(uint32_t); i++) {
+        *seed = *seed * 1664525u + 1013904223u;
+        w[i] = *seed;
+    }
+}
+
+void aec_setup(int32_t num_y_channels, int32_t num_x_channels, uint32_t seed)
+{
+    static int started;
+
+    if (!started) {
+        sem_init(&stage_task.notify, 0, 0);
+        aec_process_frame_2threads_init(0);
+        started = 1;
+    }
+
+    fill(&shared_state[0], sizeof(shared_state[0]), &seed);
+    fill(&main_state[0], sizeof(main_state[0]), &seed);
+    fill(&shadow_state[0], sizeof(shadow_state[0]), &seed);
+    shared_state[0].num_y_channels = num_y_channels;
+    shared_state[0].num_x_channels = num_x_channels;
+
+    shared_state[1] = shared_state[0];
+    main_state[1] = main_state[0];
+    shadow_state[1] = shadow_state[0];
+    for (int i = 0; i < 2; i++) {
+        main_state[i].shared_state = &shared_state[i];
+        shadow_state[i].shared_state = &shared_state[i];
+    }
+
+    worker_accesses = 0;
+    parallel_steps = 0;
+    conflicts = 0;
+}
+
+/* Processes a frame of y and x, each a channel after another, with the given number of threads */
+void aec_run(int32_t threads, const int32_t *y, const int32_t *x, int32_t *output_main, int32_t *output_shadow)
+{
+    const int i = threads - 1;
+
+    (threads == 1 ? aec_process_frame_1thread : aec_process_frame_2threads)(
+            &main_state[i], &shadow_state[i],
+            (int32_t (*)[AEC_FRAME_ADVANCE]) output_main,
+            (int32_t (*)[AEC_FRAME_ADVANCE]) output_shadow,
+            (const int32_t (*)[AEC_FRAME_ADVANCE]) y,
+            (const int32_t (*)[AEC_FRAME_ADVANCE]) x);
+}
+
+/* Whether the 1 and 2 thread states are the same, other than their shared state pointers */
+int32_t aec_states_equal(void)
+{
+    const size_t offset = offsetof(aec_state_t, X_fifo_1d);
+
+    return memcmp(&shared_state[0], &shared_state[1], sizeof(aec_shared_state_t)) == 0 &&
+           memcmp((uint8_t *) &main_state[0] + offset, (uint8_t *) &main_state[1] + offset, sizeof(aec_state_t) - offset) == 0 &&
+           memcmp((uint8_t *) &shadow_state[0] + offset, (uint8_t *) &shadow_state[1] + offset, sizeof(aec_state_t) - offset) == 0;
+}
+
+void aec_counts(int32_t *out)
+{
+    out[0] = parallel_steps;
+    out[1] = conflicts;
+    out[2] = worker_accesses;
+}
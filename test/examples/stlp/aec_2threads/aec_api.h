@@ -0,0 +1,35 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/*
+ * Stands in for the fwk_voice AEC API, with the functions that the frame
+ * processing calls. aec_mock.c models each as reading and writing the state
+ * the fwk_voice documentation gives for it.
+ */
+
+#ifndef AEC_API_H_
+#define AEC_API_H_
+
+#include "aec_defines.h"
+
+void bfp_s32_init(bfp_s32_t *a, int32_t *data, int exp, unsigned length, int calc_hr);
+
+void aec_frame_init(aec_state_t *main_state, aec_state_t *shadow_state,
+                    const int32_t (*y_data)[AEC_FRAME_ADVANCE], const int32_t (*x_data)[AEC_FRAME_ADVANCE]);
+void aec_calc_time_domain_ema_energy(float_s32_t *ema_out, const bfp_s32_t *input, unsigned start_offset,
+                                     unsigned length, const aec_config_params_t *conf);
+void aec_forward_fft(bfp_complex_s32_t *output, bfp_s32_t *input);
+void aec_inverse_fft(bfp_s32_t *output, bfp_complex_s32_t *input);
+void aec_calc_X_fifo_energy(aec_state_t *state, unsigned ch, unsigned recalc_bin);
+void aec_update_X_fifo_and_calc_sigmaXX(aec_state_t *state, unsigned ch);
+void aec_update_X_fifo_1d(aec_state_t *state);
+void aec_calc_Error_and_Y_hat(aec_state_t *state, unsigned ch);
+void aec_calc_coherence(aec_state_t *state, unsigned ch);
+void aec_calc_output(aec_state_t *state, int32_t (*output)[AEC_FRAME_ADVANCE], unsigned ch);
+void aec_calc_freq_domain_energy(float_s32_t *output, const bfp_complex_s32_t *input);
+void aec_compare_filters_and_calc_mu(aec_state_t *main_state, aec_state_t *shadow_state);
+void aec_calc_normalisation_spectrum(aec_state_t *state, unsigned ch, unsigned is_shadow);
+void aec_calc_T(aec_state_t *state, unsigned y_ch, unsigned x_ch);
+void aec_filter_adapt(aec_state_t *state, unsigned y_ch);
+
+#endif /* AEC_API_H_ */
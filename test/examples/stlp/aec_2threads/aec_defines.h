@@ -0,0 +1,61 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* Stands in for the fwk_voice AEC defines */
+
+#ifndef AEC_DEFINES_H_
+#define AEC_DEFINES_H_
+
+#include <stdint.h>
+
+#define AEC_FRAME_ADVANCE       240
+#define AEC_PROC_FRAME_LENGTH   512
+
+#define AEC_MAX_Y_CHANNELS      3
+#define AEC_MAX_X_CHANNELS      3
+
+/*
+ * Each BFP vector and float of the AEC is modelled as a single value, a
+ * hash of everything it has been computed from.
+ */
+typedef struct { uint32_t v; } bfp_s32_t;
+typedef struct { uint32_t v; } bfp_complex_s32_t;
+typedef struct { uint32_t v; } float_s32_t;
+typedef struct { uint32_t v; } coherence_mu_params_t;
+typedef struct { uint32_t v; } aec_config_params_t;
+
+typedef struct {
+    int num_y_channels;
+    int num_x_channels;
+    aec_config_params_t config_params;
+    bfp_s32_t y[AEC_MAX_Y_CHANNELS];
+    bfp_s32_t x[AEC_MAX_X_CHANNELS];
+    bfp_complex_s32_t Y[AEC_MAX_Y_CHANNELS];
+    bfp_complex_s32_t X[AEC_MAX_X_CHANNELS];
+    bfp_complex_s32_t X_fifo[AEC_MAX_X_CHANNELS];
+    float_s32_t sigma_XX[AEC_MAX_X_CHANNELS];
+    float_s32_t y_ema_energy[AEC_MAX_Y_CHANNELS];
+    float_s32_t x_ema_energy[AEC_MAX_X_CHANNELS];
+    float_s32_t overall_Y[AEC_MAX_Y_CHANNELS];
+    coherence_mu_params_t coh_mu_state[AEC_MAX_Y_CHANNELS];
+    uint32_t shadow_filter_params;
+} aec_shared_state_t;
+
+typedef struct {
+    aec_shared_state_t *shared_state;
+    bfp_complex_s32_t X_fifo_1d;
+    bfp_complex_s32_t H_hat[AEC_MAX_Y_CHANNELS];
+    bfp_complex_s32_t Error[AEC_MAX_Y_CHANNELS];
+    bfp_complex_s32_t Y_hat[AEC_MAX_Y_CHANNELS];
+    bfp_complex_s32_t T[AEC_MAX_X_CHANNELS];
+    bfp_s32_t error[AEC_MAX_Y_CHANNELS];
+    bfp_s32_t y_hat[AEC_MAX_Y_CHANNELS];
+    bfp_s32_t overlap[AEC_MAX_Y_CHANNELS];
+    bfp_s32_t X_energy[AEC_MAX_X_CHANNELS];
+    bfp_s32_t inv_X_energy[AEC_MAX_X_CHANNELS];
+    float_s32_t mu[AEC_MAX_Y_CHANNELS][AEC_MAX_X_CHANNELS];
+    float_s32_t overall_Error[AEC_MAX_Y_CHANNELS];
+    float_s32_t error_ema_energy[AEC_MAX_Y_CHANNELS];
+} aec_state_t;
+
+#endif /* AEC_DEFINES_H_ */
@@ -0,0 +1,4 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* Declared in the FreeRTOS.h of this test */
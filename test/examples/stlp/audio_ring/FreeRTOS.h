@@ -0,0 +1,13 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* Stands in for the FreeRTOS header, of which audio_ring.c only needs configASSERT() */
+
+#ifndef FREERTOS_H_
+#define FREERTOS_H_
+
+#include <assert.h>
+
+#define configASSERT(x) assert(x)
+
+#endif /* FREERTOS_H_ */
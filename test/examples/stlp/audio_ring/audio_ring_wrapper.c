@@ -0,0 +1,80 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "audio_ring.h"
+
+#define MAX_SIZE 65536
+
+static audio_ring_t ring;
+static uint8_t storage[MAX_SIZE];
+
+void ring_init(int32_t size)
+{
+    audio_ring_init(&ring, storage, size);
+}
+
+/*
+ * Moves the free running counters of the empty ring to count, as if count
+ * bytes had already been through it, leaving the offsets where they are.
+ */
+void ring_set_count(uint32_t count)
+{
+    ring.head = count;
+    ring.tail = count;
+    ring.discard_pos = count;
+}
+
+uint32_t ring_head(void)
+{
+    return ring.head;
+}
+
+int32_t ring_write(const uint8_t *data, int32_t len)
+{
+    return audio_ring_write(&ring, data, len);
+}
+
+int32_t ring_read(uint8_t *data, int32_t len)
+{
+    return audio_ring_read(&ring, data, len);
+}
+
+/* Reads through a reserved region, returning how many bytes were taken */
+int32_t ring_read_reserved(uint8_t *data, int32_t max_len)
+{
+    size_t len;
+    const uint8_t *p = audio_ring_read_reserve(&ring, &len);
+
+    if (len > (size_t) max_len) {
+        len = max_len;
+    }
+    for (size_t i = 0; i < len; i++) {
+        data[i] = p[i];
+    }
+    audio_ring_read_commit(&ring, len);
+
+    return len;
+}
+
+void ring_flush(void)
+{
+    audio_ring_flush(&ring);
+}
+
+void ring_discard(void)
+{
+    audio_ring_discard(&ring);
+}
+
+int32_t ring_fill(void)
+{
+    return audio_ring_fill(&ring);
+}
+
+int32_t ring_space(void)
+{
+    return audio_ring_space(&ring);
+}
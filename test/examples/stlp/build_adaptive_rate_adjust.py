@@ -6,15 +6,19 @@ from shutil import rmtree
 
 def build_ffi():
     # One more ../ than necessary - builds in the 'build' subdirectory in this folder
-    APPLICATION_ROOT = "../../../../applications/stlp"
+    APPLICATION_ROOT = "../../../../examples/stlp"
+    TEST_ROOT = "../adaptive_rate_adjust"
 
     FLAGS = [
         '-std=c99',
-        '-fPIC'
+        '-fPIC',
+        '-O2',
+        '-DDEBUG_ADAPTIVE'
         ]
 
     # Source file
-    SRCS = [f"{APPLICATION_ROOT}/src/usb/adaptive_rate_callback.c"]
+    SRCS = [f"{APPLICATION_ROOT}/src/usb/adaptive_rate_callback.c",
+            f"{TEST_ROOT}/adaptive_rate_callback_wrapper.c"]
     INCLUDES = [f"{APPLICATION_ROOT}/src/usb/",
                 f"{APPLICATION_ROOT}/src/"]
 
@@ -28,6 +32,17 @@ def build_ffi():
                                     bool update,
                                     uint32_t * debug);
         void reset_state();
+        void set_expected_USB_audio_bytes(uint32_t direction, uint32_t bytes_per_transaction);
+        void sof_toggle();
+        uint32_t ref_determine_USB_audio_rate(uint32_t timestamp,
+                                    uint32_t data_length,
+                                    uint32_t direction,
+                                    bool update,
+                                    uint32_t * debug);
+        void ref_reset_state();
+        void ref_sof_toggle();
+        double ref_benchmark(uint32_t num_packets);
+        double uut_benchmark(uint32_t num_packets);
         """
     )
 
@@ -38,8 +53,19 @@ def build_ffi():
                                     uint32_t data_length,
                                     uint32_t direction,
                                     bool update,
-                                    uint32_t * debug); 
+                                    uint32_t * debug);
         void reset_state();
+        void set_expected_USB_audio_bytes(uint32_t direction, uint32_t bytes_per_transaction);
+        void sof_toggle();
+        uint32_t ref_determine_USB_audio_rate(uint32_t timestamp,
+                                    uint32_t data_length,
+                                    uint32_t direction,
+                                    bool update,
+                                    uint32_t * debug);
+        void ref_reset_state();
+        void ref_sof_toggle();
+        double ref_benchmark(uint32_t num_packets);
+        double uut_benchmark(uint32_t num_packets);
     """,
         sources=SRCS,
         include_dirs=INCLUDES,
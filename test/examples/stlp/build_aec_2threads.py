@@ -0,0 +1,56 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+from cffi import FFI
+from shutil import rmtree
+
+def build_ffi():
+    # One more ../ than necessary - builds in the 'build' subdirectory in this folder
+    MODULE_ROOT = "../../../../examples/stlp/audio_pipeline/src/adec/aec"
+    TEST_ROOT = "../aec_2threads"
+
+    FLAGS = [
+        '-std=c99',
+        '-fPIC',
+        '-O2'
+        ]
+
+    # Source file
+    SRCS = [f"{MODULE_ROOT}/aec_process_frame_1thread.c",
+            f"{MODULE_ROOT}/aec_process_frame_2threads.c",
+            f"{TEST_ROOT}/aec_2threads_wrapper.c"]
+    # The test directory provides the FreeRTOS and fwk_voice AEC headers, with a model of the AEC
+    INCLUDES = [f"{TEST_ROOT}/"]
+
+    # Units under test
+    ffibuilder = FFI()
+    ffibuilder.cdef(
+        """
+        void aec_setup(int32_t num_y_channels, int32_t num_x_channels, uint32_t seed);
+        void aec_run(int32_t threads, const int32_t *y, const int32_t *x, int32_t *output_main, int32_t *output_shadow);
+        int32_t aec_states_equal(void);
+        void aec_counts(int32_t *out);
+        """
+    )
+
+    ffibuilder.set_source("aec_2threads_api",
+    """
+        #include <stdint.h>
+        void aec_setup(int32_t num_y_channels, int32_t num_x_channels, uint32_t seed);
+        void aec_run(int32_t threads, const int32_t *y, const int32_t *x, int32_t *output_main, int32_t *output_shadow);
+        int32_t aec_states_equal(void);
+        void aec_counts(int32_t *out);
+    """,
+        sources=SRCS,
+        include_dirs=INCLUDES,
+        libraries=["pthread"],
+        extra_compile_args=FLAGS)
+
+    ffibuilder.compile(tmpdir="build", target="aec_2threads_api.*", verbose=True)
+
+def clean_ffi():
+    rmtree("./build")
+
+
+if __name__ == "__main__":
+    build_ffi()
@@ -0,0 +1,67 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+from cffi import FFI
+from shutil import rmtree
+
+def build_ffi():
+    # One more ../ than necessary - builds in the 'build' subdirectory in this folder
+    MODULE_ROOT = "../../../../modules/audio_ring"
+    TEST_ROOT = "../audio_ring"
+
+    FLAGS = [
+        '-std=c99',
+        '-fPIC',
+        '-O2'
+        ]
+
+    # Source file
+    SRCS = [f"{MODULE_ROOT}/src/audio_ring.c",
+            f"{TEST_ROOT}/audio_ring_wrapper.c"]
+    # The test directory provides the FreeRTOS.h that audio_ring.c includes
+    INCLUDES = [f"{TEST_ROOT}/",
+                f"{MODULE_ROOT}/api/"]
+
+    # Units under test
+    ffibuilder = FFI()
+    ffibuilder.cdef(
+        """
+        void ring_init(int32_t size);
+        void ring_set_count(uint32_t count);
+        uint32_t ring_head(void);
+        int32_t ring_write(const uint8_t *data, int32_t len);
+        int32_t ring_read(uint8_t *data, int32_t len);
+        int32_t ring_read_reserved(uint8_t *data, int32_t max_len);
+        void ring_flush(void);
+        void ring_discard(void);
+        int32_t ring_fill(void);
+        int32_t ring_space(void);
+        """
+    )
+
+    ffibuilder.set_source("audio_ring_api",
+    """
+        #include <stdint.h>
+        void ring_init(int32_t size);
+        void ring_set_count(uint32_t count);
+        uint32_t ring_head(void);
+        int32_t ring_write(const uint8_t *data, int32_t len);
+        int32_t ring_read(uint8_t *data, int32_t len);
+        int32_t ring_read_reserved(uint8_t *data, int32_t max_len);
+        void ring_flush(void);
+        void ring_discard(void);
+        int32_t ring_fill(void);
+        int32_t ring_space(void);
+    """,
+        sources=SRCS,
+        include_dirs=INCLUDES,
+        extra_compile_args=FLAGS)
+
+    ffibuilder.compile(tmpdir="build", target="audio_ring_api.*", verbose=True)
+
+def clean_ffi():
+    rmtree("./build")
+
+
+if __name__ == "__main__":
+    build_ffi()
@@ -0,0 +1,67 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+from cffi import FFI
+from shutil import rmtree
+
+def build_ffi():
+    # One more ../ than necessary - builds in the 'build' subdirectory in this folder
+    APPLICATION_ROOT = "../../../../examples/stlp"
+    TEST_ROOT = "../delay_buffer"
+
+    FLAGS = [
+        '-std=c99',
+        '-fPIC',
+        '-O2'
+        ]
+
+    # Source file
+    SRCS = [f"{APPLICATION_ROOT}/audio_pipeline/src/common/delay_buffer.c",
+            f"{TEST_ROOT}/delay_buffer_wrapper.c"]
+    # The test directory comes first so that its audio_pipeline_dsp.h is used
+    INCLUDES = [f"{TEST_ROOT}/",
+                f"{APPLICATION_ROOT}/audio_pipeline/src/common/"]
+
+    # Units under test
+    ffibuilder = FFI()
+    ffibuilder.cdef(
+        """
+        void ref_init(int32_t delay_samples);
+        void ref_set_delay(int32_t delay_samples);
+        void ref_process_frame(int32_t *y, int32_t *x);
+        void ref_process_block(int32_t *samples, int32_t ch, int32_t delay_samples, int32_t num_samples);
+        void uut_init(int32_t delay_samples);
+        void uut_set_delay(int32_t delay_q);
+        void uut_process_frame(int32_t *y, int32_t *x);
+        void uut_process_block(int32_t *samples, int32_t ch, int32_t delay_samples, int32_t num_samples);
+        double ref_benchmark(int32_t delay_samples, int32_t num_frames);
+        double uut_benchmark(int32_t delay_samples, int32_t num_frames);
+        """
+    )
+
+    ffibuilder.set_source("delay_buffer_api",
+    """
+        #include <stdint.h>
+        void ref_init(int32_t delay_samples);
+        void ref_set_delay(int32_t delay_samples);
+        void ref_process_frame(int32_t *y, int32_t *x);
+        void ref_process_block(int32_t *samples, int32_t ch, int32_t delay_samples, int32_t num_samples);
+        void uut_init(int32_t delay_samples);
+        void uut_set_delay(int32_t delay_q);
+        void uut_process_frame(int32_t *y, int32_t *x);
+        void uut_process_block(int32_t *samples, int32_t ch, int32_t delay_samples, int32_t num_samples);
+        double ref_benchmark(int32_t delay_samples, int32_t num_frames);
+        double uut_benchmark(int32_t delay_samples, int32_t num_frames);
+    """,
+        sources=SRCS,
+        include_dirs=INCLUDES,
+        extra_compile_args=FLAGS)
+
+    ffibuilder.compile(tmpdir="build", target="delay_buffer_api.*", verbose=True)
+
+def clean_ffi():
+    rmtree("./build")
+
+
+if __name__ == "__main__":
+    build_ffi()
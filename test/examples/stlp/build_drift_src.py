@@ -0,0 +1,58 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+from cffi import FFI
+from shutil import rmtree
+
+def build_ffi():
+    # One more ../ than necessary - builds in the 'build' subdirectory in this folder
+    MODULE_ROOT = "../../../../modules/drift_src"
+    TEST_ROOT = "../drift_src"
+
+    FLAGS = [
+        '-std=c99',
+        '-fPIC',
+        '-O2'
+        ]
+
+    # Source file
+    SRCS = [f"{MODULE_ROOT}/src/drift_src.c",
+            f"{MODULE_ROOT}/src/drift_src_coefs.c",
+            f"{TEST_ROOT}/drift_src_wrapper.c"]
+    INCLUDES = [f"{MODULE_ROOT}/api/"]
+
+    # Units under test
+    ffibuilder = FFI()
+    ffibuilder.cdef(
+        """
+        void init(int32_t channels);
+        void set_step(uint32_t step);
+        int32_t output_count(int32_t n_in);
+        int32_t input_count(int32_t n_out);
+        int32_t push(int32_t *out, int32_t out_stride, const int32_t *in, int32_t in_stride, int32_t n_in);
+        int32_t pull(int32_t *out, int32_t out_stride, const int32_t *in, int32_t in_stride, int32_t n_out);
+        """
+    )
+
+    ffibuilder.set_source("drift_src_api",
+    """
+        #include <stdint.h>
+        void init(int32_t channels);
+        void set_step(uint32_t step);
+        int32_t output_count(int32_t n_in);
+        int32_t input_count(int32_t n_out);
+        int32_t push(int32_t *out, int32_t out_stride, const int32_t *in, int32_t in_stride, int32_t n_in);
+        int32_t pull(int32_t *out, int32_t out_stride, const int32_t *in, int32_t in_stride, int32_t n_out);
+    """,
+        sources=SRCS,
+        include_dirs=INCLUDES,
+        extra_compile_args=FLAGS)
+
+    ffibuilder.compile(tmpdir="build", target="drift_src_api.*", verbose=True)
+
+def clean_ffi():
+    rmtree("./build")
+
+
+if __name__ == "__main__":
+    build_ffi()
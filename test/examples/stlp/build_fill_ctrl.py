@@ -0,0 +1,68 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+from cffi import FFI
+from shutil import rmtree
+
+def build_ffi():
+    # One more ../ than necessary - builds in the 'build' subdirectory in this folder
+    APPLICATION_ROOT = "../../../../examples/stlp"
+    TEST_ROOT = "../fill_ctrl"
+
+    FLAGS = [
+        '-std=c99',
+        '-fPIC',
+        '-O2'
+        ]
+
+    # Source file
+    SRCS = [f"{APPLICATION_ROOT}/src/usb/adaptive_rate_callback.c",
+            f"{APPLICATION_ROOT}/src/usb/adaptive_fill_ctrl.c",
+            f"{TEST_ROOT}/fill_ctrl_sim.c"]
+    INCLUDES = [f"{APPLICATION_ROOT}/src/usb/"]
+
+    CDEFS = """
+        typedef struct {
+            double drift_ppm;
+            uint32_t timestamp_jitter;
+            uint32_t frame_jitter_ms;
+            bool host_streaming_out;
+            bool fill_ctrl_enabled;
+            uint32_t seconds;
+            uint32_t seed;
+        } fill_sim_config_t;
+
+        typedef struct {
+            uint32_t overruns;
+            uint32_t underruns;
+            double mean_fill;
+            int32_t min_fill;
+            int32_t max_fill;
+            double mean_numerator;
+            int32_t min_numerator;
+            int32_t max_numerator;
+        } fill_sim_result_t;
+
+        void fill_sim_run(const fill_sim_config_t *cfg, fill_sim_result_t *res);
+        int32_t determine_fill_level_trim_from_host(int32_t fill_level);
+        void reset_fill_level_trim();
+        """
+
+    # Units under test
+    ffibuilder = FFI()
+    ffibuilder.cdef(CDEFS)
+
+    ffibuilder.set_source("fill_ctrl_api",
+        "#include <stdint.h>\n#include <stdbool.h>\n" + CDEFS,
+        sources=SRCS,
+        include_dirs=INCLUDES,
+        extra_compile_args=FLAGS)
+
+    ffibuilder.compile(tmpdir="build", target="fill_ctrl_api.*", verbose=True)
+
+def clean_ffi():
+    rmtree("./build")
+
+
+if __name__ == "__main__":
+    build_ffi()
@@ -0,0 +1,51 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+from cffi import FFI
+from shutil import rmtree
+
+def build_ffi():
+    # One more ../ than necessary - builds in the 'build' subdirectory in this folder
+    MODULE_ROOT = "../../../../modules/frame_codec"
+    TEST_ROOT = "../frame_codec"
+
+    FLAGS = [
+        '-std=c99',
+        '-fPIC',
+        '-O2'
+        ]
+
+    # Source file
+    SRCS = [f"{MODULE_ROOT}/src/frame_codec.c",
+            f"{TEST_ROOT}/frame_codec_wrapper.c"]
+    INCLUDES = [f"{MODULE_ROOT}/api/"]
+
+    # Units under test
+    ffibuilder = FFI()
+    ffibuilder.cdef(
+        """
+        int32_t codec_encoded_size(int32_t format, int32_t num_samples);
+        int32_t codec_encode(int32_t format, const int32_t *src, int32_t num_samples, uint8_t *dst);
+        int32_t codec_decode(int32_t format, const uint8_t *src, int32_t num_samples, int32_t *dst);
+        """
+    )
+
+    ffibuilder.set_source("frame_codec_api",
+    """
+        #include <stdint.h>
+        int32_t codec_encoded_size(int32_t format, int32_t num_samples);
+        int32_t codec_encode(int32_t format, const int32_t *src, int32_t num_samples, uint8_t *dst);
+        int32_t codec_decode(int32_t format, const uint8_t *src, int32_t num_samples, int32_t *dst);
+    """,
+        sources=SRCS,
+        include_dirs=INCLUDES,
+        extra_compile_args=FLAGS)
+
+    ffibuilder.compile(tmpdir="build", target="frame_codec_api.*", verbose=True)
+
+def clean_ffi():
+    rmtree("./build")
+
+
+if __name__ == "__main__":
+    build_ffi()
@@ -0,0 +1,73 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+from cffi import FFI
+from shutil import rmtree
+
+def build_ffi():
+    # One more ../ than necessary - builds in the 'build' subdirectory in this folder
+    MODULE_ROOT = "../../../../modules/src_block"
+    TEST_ROOT = "../src_block"
+
+    FLAGS = [
+        '-std=c99',
+        '-fPIC',
+        '-O2'
+        ]
+
+    # Source file
+    SRCS = [f"{MODULE_ROOT}/src/src_block.c",
+            f"{TEST_ROOT}/src_block_wrapper.c"]
+    # The test directory comes first so that its src.h is used
+    INCLUDES = [f"{TEST_ROOT}/",
+                f"{MODULE_ROOT}/api/"]
+
+    # Units under test
+    ffibuilder = FFI()
+    ffibuilder.cdef(
+        """
+        void set_filter(const int32_t *coefs, int32_t comp_ds, uint32_t comp_q_ds, int32_t comp_us, uint32_t comp_q_us);
+        void ref_init(void);
+        void uut_init(void);
+        void ref_ds3_s32(int32_t *out, const int32_t *in, int32_t channels, int32_t frames);
+        void ref_ds3_s16(int16_t *out, const int16_t *in, int32_t channels, int32_t frames);
+        void ref_us3_s32(int32_t *out, const int32_t *in, int32_t channels, int32_t frames);
+        void ref_us3_s16(int16_t *out, const int16_t *in, int32_t channels, int32_t frames);
+        void uut_ds3_s32(int32_t *out, const int32_t *in, int32_t channels, int32_t frames);
+        void uut_ds3_s16(int16_t *out, const int16_t *in, int32_t channels, int32_t frames);
+        void uut_us3_s32(int32_t *out, const int32_t *in, int32_t channels, int32_t frames);
+        void uut_us3_s16(int16_t *out, const int16_t *in, int32_t channels, int32_t frames);
+        double ref_benchmark(int32_t channels, int32_t num_frames);
+        double uut_benchmark(int32_t channels, int32_t num_frames);
+        """
+    )
+
+    ffibuilder.set_source("src_block_api",
+    """
+        #include <stdint.h>
+        void set_filter(const int32_t *coefs, int32_t comp_ds, uint32_t comp_q_ds, int32_t comp_us, uint32_t comp_q_us);
+        void ref_init(void);
+        void uut_init(void);
+        void ref_ds3_s32(int32_t *out, const int32_t *in, int32_t channels, int32_t frames);
+        void ref_ds3_s16(int16_t *out, const int16_t *in, int32_t channels, int32_t frames);
+        void ref_us3_s32(int32_t *out, const int32_t *in, int32_t channels, int32_t frames);
+        void ref_us3_s16(int16_t *out, const int16_t *in, int32_t channels, int32_t frames);
+        void uut_ds3_s32(int32_t *out, const int32_t *in, int32_t channels, int32_t frames);
+        void uut_ds3_s16(int16_t *out, const int16_t *in, int32_t channels, int32_t frames);
+        void uut_us3_s32(int32_t *out, const int32_t *in, int32_t channels, int32_t frames);
+        void uut_us3_s16(int16_t *out, const int16_t *in, int32_t channels, int32_t frames);
+        double ref_benchmark(int32_t channels, int32_t num_frames);
+        double uut_benchmark(int32_t channels, int32_t num_frames);
+    """,
+        sources=SRCS,
+        include_dirs=INCLUDES,
+        extra_compile_args=FLAGS)
+
+    ffibuilder.compile(tmpdir="build", target="src_block_api.*", verbose=True)
+
+def clean_ffi():
+    rmtree("./build")
+
+
+if __name__ == "__main__":
+    build_ffi()
@@ -0,0 +1,20 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* Stands in for the STLP audio_pipeline_dsp.h so that the delay buffer can be built without the voice libraries */
+
+#ifndef AUDIO_PIPELINE_DSP_H_
+#define AUDIO_PIPELINE_DSP_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define AP_MAX_Y_CHANNELS (2)
+#define AP_MAX_X_CHANNELS (2)
+#define AP_FRAME_ADVANCE (240)
+
+#define MAX_DELAY_BUF_CHANNELS (2)
+#define DELAY_BUF_MAX_DELAY_MS                ( 150 )
+#define DELAY_BUF_MAX_DELAY_SAMPLES           ( 16000*DELAY_BUF_MAX_DELAY_MS/1000 )
+
+#endif /* AUDIO_PIPELINE_DSP_H_ */
@@ -0,0 +1,121 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "delay_buffer.h"
+
+/*
+ * Reference: the per sample delay buffer and the stage 1 frame loop that the
+ * block implementation replaced, kept here to check it is bit exact.
+ */
+typedef struct {
+    int32_t delay_buffer[MAX_DELAY_BUF_CHANNELS][DELAY_BUF_MAX_DELAY_SAMPLES];
+    int32_t curr_idx[MAX_DELAY_BUF_CHANNELS];
+    int32_t delay_samples;
+} ref_delay_buf_state_t;
+
+static void ref_get_delayed_sample(ref_delay_buf_state_t *delay_state, int32_t *sample, int32_t ch) {
+    delay_state->delay_buffer[ch][delay_state->curr_idx[ch]] = *sample;
+    int32_t abs_delay_samples = (delay_state->delay_samples < 0) ? -delay_state->delay_samples : delay_state->delay_samples;
+    uint32_t delay_idx = (
+            (DELAY_BUF_MAX_DELAY_SAMPLES + delay_state->curr_idx[ch] - abs_delay_samples)
+            % DELAY_BUF_MAX_DELAY_SAMPLES
+            );
+    *sample = delay_state->delay_buffer[ch][delay_idx];
+    delay_state->curr_idx[ch] = (delay_state->curr_idx[ch] + 1) % DELAY_BUF_MAX_DELAY_SAMPLES;
+}
+
+static void ref_reset_partial_delay_buffer(ref_delay_buf_state_t *delay_state, int32_t ch) {
+    int32_t num_samples = delay_state->delay_samples;
+    if(!num_samples) {
+        return;
+    }
+    num_samples = (num_samples < 0) ? -num_samples : num_samples;
+    int32_t reset_start = (
+            (DELAY_BUF_MAX_DELAY_SAMPLES + delay_state->curr_idx[ch] - num_samples)
+            % DELAY_BUF_MAX_DELAY_SAMPLES
+            );
+    if(reset_start < delay_state->curr_idx[ch]) {
+        memset(&delay_state->delay_buffer[ch][reset_start], 0, num_samples*sizeof(int32_t));
+    }
+    else {
+        memset(&delay_state->delay_buffer[ch][0], 0, delay_state->curr_idx[ch]*sizeof(int32_t));
+        int remaining = num_samples - delay_state->curr_idx[ch];
+        memset(&delay_state->delay_buffer[ch][DELAY_BUF_MAX_DELAY_SAMPLES - remaining], 0, remaining*sizeof(int32_t));
+    }
+}
+
+static ref_delay_buf_state_t ref_state;
+static delay_buf_state_t uut_state;
+
+void ref_init(int32_t delay_samples) {
+    memset(&ref_state, 0, sizeof(ref_state));
+    ref_state.delay_samples = delay_samples;
+}
+
+void ref_set_delay(int32_t delay_samples) {
+    ref_state.delay_samples = delay_samples;
+    for(int ch=0; ch<AP_MAX_Y_CHANNELS; ch++) {
+        ref_reset_partial_delay_buffer(&ref_state, ch);
+    }
+}
+
+void ref_process_frame(int32_t *y, int32_t *x) {
+    int32_t *input = (ref_state.delay_samples >= 0) ? y : x;
+    for(int ch=0; ch<MAX_DELAY_BUF_CHANNELS; ch++) {
+        for(int i=0; i<AP_FRAME_ADVANCE; i++) {
+            ref_get_delayed_sample(&ref_state, &input[ch * AP_FRAME_ADVANCE + i], ch);
+        }
+    }
+}
+
+void ref_process_block(int32_t *samples, int32_t ch, int32_t delay_samples, int32_t num_samples) {
+    ref_state.delay_samples = delay_samples;
+    for(int i=0; i<num_samples; i++) {
+        ref_get_delayed_sample(&ref_state, &samples[i], ch);
+    }
+}
+
+void uut_init(int32_t delay_samples) {
+    delay_buffer_init(&uut_state, delay_samples);
+}
+
+void uut_set_delay(int32_t delay_q) {
+    delay_buffer_set_delay(&uut_state, delay_q);
+}
+
+void uut_process_frame(int32_t *y, int32_t *x) {
+    delay_buffer_process_frame(&uut_state, (int32_t (*)[AP_FRAME_ADVANCE])y, (int32_t (*)[AP_FRAME_ADVANCE])x);
+}
+
+void uut_process_block(int32_t *samples, int32_t ch, int32_t delay_samples, int32_t num_samples) {
+    delay_buffer_process_block(&uut_state, samples, ch, delay_samples, num_samples);
+}
+
+/* Returns the CPU time in seconds taken to delay num_frames frames */
+double ref_benchmark(int32_t delay_samples, int32_t num_frames) {
+    static int32_t y[MAX_DELAY_BUF_CHANNELS * AP_FRAME_ADVANCE];
+    static int32_t x[MAX_DELAY_BUF_CHANNELS * AP_FRAME_ADVANCE];
+    ref_init(delay_samples);
+    clock_t start = clock();
+    for (int i = 0; i < num_frames; i++) {
+        y[0] = i;
+        ref_process_frame(y, x);
+    }
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+double uut_benchmark(int32_t delay_samples, int32_t num_frames) {
+    static int32_t y[MAX_DELAY_BUF_CHANNELS * AP_FRAME_ADVANCE];
+    static int32_t x[MAX_DELAY_BUF_CHANNELS * AP_FRAME_ADVANCE];
+    uut_init(delay_samples);
+    clock_t start = clock();
+    for (int i = 0; i < num_frames; i++) {
+        y[0] = i;
+        uut_process_frame(y, x);
+    }
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
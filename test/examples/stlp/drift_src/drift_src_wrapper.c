@@ -0,0 +1,38 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+
+#include "drift_src.h"
+
+static drift_src_t ctx;
+
+void init(int32_t channels)
+{
+    drift_src_init(&ctx, channels);
+}
+
+void set_step(uint32_t step)
+{
+    drift_src_set_step(&ctx, step);
+}
+
+int32_t output_count(int32_t n_in)
+{
+    return drift_src_output_count(&ctx, n_in);
+}
+
+int32_t input_count(int32_t n_out)
+{
+    return drift_src_input_count(&ctx, n_out);
+}
+
+int32_t push(int32_t *out, int32_t out_stride, const int32_t *in, int32_t in_stride, int32_t n_in)
+{
+    return drift_src_push(&ctx, out, out_stride, in, in_stride, n_in);
+}
+
+int32_t pull(int32_t *out, int32_t out_stride, const int32_t *in, int32_t in_stride, int32_t n_out)
+{
+    return drift_src_pull(&ctx, out, out_stride, in, in_stride, n_out);
+}
@@ -0,0 +1,168 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "adaptive_rate_callback.h"
+#include "adaptive_fill_ctrl.h"
+
+/*
+ * Simulates the STLP USB microphone path against a host whose clock drifts
+ * from the device's crystal. Time advances one host USB frame (1 ms) per
+ * step. The device's audio clock comes from the app PLL, whose numerator is
+ * set from the packet rate estimate and the fill level trim exactly as
+ * usb_adaptive_clk_manager() sets it.
+ */
+
+#define SAMPLES_PER_MS          16
+#define FRAME_ADVANCE           240
+#define BUFFER_SAMPLES          (3 * FRAME_ADVANCE)
+#define OUT_BYTES_PER_MS        128
+#define TICKS_PER_MS            100000
+#define MAX_FRAMES_IN_FLIGHT    8
+
+typedef struct {
+    double drift_ppm;           // Device crystal error relative to the host
+    uint32_t timestamp_jitter;  // Peak jitter of the OUT packet timestamps, in reference clock ticks
+    uint32_t frame_jitter_ms;   // Peak extra delay of pipeline frames reaching the USB buffer
+    bool host_streaming_out;    // Whether the rate estimate sees OUT packets
+    bool fill_ctrl_enabled;     // Whether the fill level trim is applied
+    uint32_t seconds;
+    uint32_t seed;
+} fill_sim_config_t;
+
+typedef struct {
+    uint32_t overruns;          // "Oops buffer is full" resets and frames lost for lack of space
+    uint32_t underruns;         // "Oops buffer is empty" transfers
+    double mean_fill;           // Mean fill level over the final quarter of the run
+    int32_t min_fill;           // Over the final quarter, after each transfer
+    int32_t max_fill;
+    double mean_numerator;      // Mean app PLL numerator over the final quarter
+    int32_t min_numerator;
+    int32_t max_numerator;
+} fill_sim_result_t;
+
+static int32_t numerator_from_rate(int64_t rate)
+{
+    int64_t s = rate * 102400 - ((int64_t)102251 << 31);
+    s >>= 30;
+    s = (s % 2) ? (s >> 1) + 1 : s >> 1;
+    if (s > 255) {
+        s = 255;
+    } else if (s < 0) {
+        s = 0;
+    }
+    return (int32_t)s;
+}
+
+static int32_t jitter(uint32_t peak)
+{
+    return peak ? (int32_t)(rand() % (2 * peak + 1)) - (int32_t)peak : 0;
+}
+
+void fill_sim_run(const fill_sim_config_t *cfg, fill_sim_result_t *res)
+{
+    const uint32_t steps = cfg->seconds * 1000;
+    const uint32_t final_quarter = steps - steps / 4;
+    const double crystal = 1.0 + cfg->drift_ppm / 1000000.0;
+
+    uint32_t arrivals[MAX_FRAMES_IN_FLIGHT];
+    uint32_t in_flight = 0;
+    double produced = 0;
+    int32_t fill = 0;
+    bool ready = false;
+    uint32_t rate = 1u << 31;
+    int32_t trim = 0;
+    int32_t numerator = numerator_from_rate(rate);
+    double fill_total = 0;
+    double numerator_total = 0;
+
+    srand(cfg->seed);
+    reset_state();
+    reset_fill_level_trim();
+
+    res->overruns = 0;
+    res->underruns = 0;
+    res->min_fill = INT32_MAX;
+    res->max_fill = INT32_MIN;
+    res->min_numerator = INT32_MAX;
+    res->max_numerator = INT32_MIN;
+
+    for (uint32_t ms = 1; ms <= steps; ms++) {
+        /* The device's audio clock runs from the app PLL, itself from the device's crystal */
+        produced += SAMPLES_PER_MS * crystal * (numerator + 102251) / 102400.0;
+        while (produced >= FRAME_ADVANCE) {
+            produced -= FRAME_ADVANCE;
+            if (in_flight < MAX_FRAMES_IN_FLIGHT) {
+                arrivals[in_flight++] = ms + (cfg->frame_jitter_ms ? rand() % (cfg->frame_jitter_ms + 1) : 0);
+            }
+        }
+
+        /* usb_audio_send() */
+        for (uint32_t i = 0; i < in_flight; ) {
+            if (arrivals[i] <= ms) {
+                if (BUFFER_SAMPLES - fill >= FRAME_ADVANCE) {
+                    fill += FRAME_ADVANCE;
+                } else {
+                    res->overruns++;
+                }
+                arrivals[i] = arrivals[--in_flight];
+            } else {
+                i++;
+            }
+        }
+
+        /* tud_audio_tx_done_pre_load_cb() */
+        if (fill == BUFFER_SAMPLES) {
+            fill = 0;
+            ready = false;
+            res->overruns++;
+        } else {
+            if (fill >= 2 * FRAME_ADVANCE) {
+                ready = true;
+            }
+            if (ready) {
+                if (fill >= SAMPLES_PER_MS) {
+                    fill -= SAMPLES_PER_MS;
+                } else {
+                    res->underruns++;
+                }
+            }
+        }
+
+        /* usb_adaptive_clk_manager(), IN transfer */
+        if (cfg->fill_ctrl_enabled) {
+            trim = determine_fill_level_trim(ready ? fill : -1);
+        }
+
+        /* usb_adaptive_clk_manager(), OUT transfer timed by the device's reference clock */
+        if (cfg->host_streaming_out) {
+            uint32_t timestamp = (uint32_t)(int64_t)((double)ms * TICKS_PER_MS * crystal) + jitter(cfg->timestamp_jitter);
+            rate = determine_USB_audio_rate(timestamp, OUT_BYTES_PER_MS, 0, true);
+        }
+
+        numerator = numerator_from_rate((int64_t)rate + trim);
+
+        if (ms > final_quarter) {
+            fill_total += fill;
+            if (fill < res->min_fill) {
+                res->min_fill = fill;
+            }
+            if (fill > res->max_fill) {
+                res->max_fill = fill;
+            }
+            numerator_total += numerator;
+            if (numerator < res->min_numerator) {
+                res->min_numerator = numerator;
+            }
+            if (numerator > res->max_numerator) {
+                res->max_numerator = numerator;
+            }
+        }
+    }
+
+    res->mean_fill = fill_total / (steps - final_quarter);
+    res->mean_numerator = numerator_total / (steps - final_quarter);
+}
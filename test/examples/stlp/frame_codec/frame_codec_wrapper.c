@@ -0,0 +1,39 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "frame_codec.h"
+
+/* Two 240 sample stereo frames, the most a test block holds */
+#define MAX_SAMPLES 960
+
+/* The codec needs 4 byte aligned blocks */
+static int32_t encoded[MAX_SAMPLES + 1];
+
+int32_t codec_encoded_size(int32_t format, int32_t num_samples)
+{
+    return FRAME_CODEC_ENCODED_SIZE(format, num_samples);
+}
+
+int32_t codec_encode(int32_t format, const int32_t *src, int32_t num_samples, uint8_t *dst)
+{
+    const int32_t size = frame_codec_encode(format, (uint8_t *) encoded, src, num_samples);
+    const uint8_t *bytes = (const uint8_t *) encoded;
+
+    for (int32_t i = 0; i < size; i++) {
+        dst[i] = bytes[i];
+    }
+    return size;
+}
+
+int32_t codec_decode(int32_t format, const uint8_t *src, int32_t num_samples, int32_t *dst)
+{
+    uint8_t *bytes = (uint8_t *) encoded;
+
+    for (int32_t i = 0; i < codec_encoded_size(format, num_samples); i++) {
+        bytes[i] = src[i];
+    }
+    return frame_codec_decode(format, dst, (const uint8_t *) encoded, num_samples);
+}
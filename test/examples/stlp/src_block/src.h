@@ -0,0 +1,26 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* Stands in for the lib_src src.h so that the block SRC can be built without the SDK */
+
+#ifndef SRC_H_
+#define SRC_H_
+
+#include <stdint.h>
+
+#define SRC_FF3V_FIR_NUM_PHASES (3)
+#define SRC_FF3V_FIR_TAPS_PER_PHASE (24)
+
+/* Not const, so that the test can load its own filters */
+extern unsigned src_ff3v_fir_comp_q_ds;
+extern int32_t src_ff3v_fir_comp_ds;
+extern unsigned src_ff3v_fir_comp_q_us;
+extern int32_t src_ff3v_fir_comp_us;
+extern int32_t src_ff3v_fir_coefs[SRC_FF3V_FIR_NUM_PHASES][SRC_FF3V_FIR_TAPS_PER_PHASE];
+
+int64_t src_ds3_voice_add_sample(int64_t sum, int32_t data[], const int32_t coefs[], int32_t sample);
+int32_t src_ds3_voice_add_final_sample(int64_t sum, int32_t data[], const int32_t coefs[], int32_t sample);
+int32_t src_us3_voice_input_sample(int32_t data[], const int32_t coefs[], int32_t sample);
+int32_t src_us3_voice_get_next_sample(int32_t data[], const int32_t coefs[]);
+
+#endif /* SRC_H_ */
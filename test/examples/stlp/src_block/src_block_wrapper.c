@@ -0,0 +1,195 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "src_block.h"
+
+#define TAPS    SRC_FF3V_FIR_TAPS_PER_PHASE
+#define PHASES  SRC_FF3V_FIR_NUM_PHASES
+#define MAX_CHANNELS 8
+
+unsigned src_ff3v_fir_comp_q_ds;
+int32_t src_ff3v_fir_comp_ds;
+unsigned src_ff3v_fir_comp_q_us;
+int32_t src_ff3v_fir_comp_us;
+int32_t src_ff3v_fir_coefs[PHASES][TAPS];
+
+/*
+ * Reference: the lib_src fixed factor of 3 voice kernels, one sample of one
+ * channel per call, and the USB audio loops that called them before the
+ * block implementation replaced them.
+ */
+static int32_t ref_lsats_lextract(int64_t sum, unsigned shift)
+{
+    sum >>= shift;
+    if (sum > INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (sum < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t) sum;
+}
+
+static int64_t ref_fir(int32_t data[], const int32_t coefs[], int32_t sample, int64_t sum)
+{
+    for (int i = TAPS - 1; i > 0; i--) {
+        data[i] = data[i - 1];
+    }
+    data[0] = sample;
+
+    for (int i = 0; i < TAPS; i++) {
+        sum += (int64_t) data[i] * coefs[i];
+    }
+    return sum;
+}
+
+int64_t src_ds3_voice_add_sample(int64_t sum, int32_t data[], const int32_t coefs[], int32_t sample)
+{
+    return ref_fir(data, coefs, sample, sum);
+}
+
+int32_t src_ds3_voice_add_final_sample(int64_t sum, int32_t data[], const int32_t coefs[], int32_t sample)
+{
+    int32_t y = ref_lsats_lextract(ref_fir(data, coefs, sample, sum), 31);
+    return ref_lsats_lextract((int64_t) y * src_ff3v_fir_comp_ds, src_ff3v_fir_comp_q_ds);
+}
+
+int32_t src_us3_voice_input_sample(int32_t data[], const int32_t coefs[], int32_t sample)
+{
+    int32_t y = ref_lsats_lextract(ref_fir(data, coefs, sample, 0), 31);
+    return ref_lsats_lextract((int64_t) y * src_ff3v_fir_comp_us, src_ff3v_fir_comp_q_us);
+}
+
+int32_t src_us3_voice_get_next_sample(int32_t data[], const int32_t coefs[])
+{
+    int64_t sum = 0;
+    for (int i = 0; i < TAPS; i++) {
+        sum += (int64_t) data[i] * coefs[i];
+    }
+    int32_t y = ref_lsats_lextract(sum, 31);
+    return ref_lsats_lextract((int64_t) y * src_ff3v_fir_comp_us, src_ff3v_fir_comp_q_us);
+}
+
+static int32_t ref_ds3_data[MAX_CHANNELS][PHASES][TAPS];
+static int32_t ref_us3_data[MAX_CHANNELS][TAPS];
+static src_block_ds3_t uut_ds3_state[MAX_CHANNELS];
+static src_block_us3_t uut_us3_state[MAX_CHANNELS];
+
+void set_filter(const int32_t *coefs, int32_t comp_ds, uint32_t comp_q_ds, int32_t comp_us, uint32_t comp_q_us)
+{
+    memcpy(src_ff3v_fir_coefs, coefs, sizeof(src_ff3v_fir_coefs));
+    src_ff3v_fir_comp_ds = comp_ds;
+    src_ff3v_fir_comp_q_ds = comp_q_ds;
+    src_ff3v_fir_comp_us = comp_us;
+    src_ff3v_fir_comp_q_us = comp_q_us;
+}
+
+void ref_init(void)
+{
+    memset(ref_ds3_data, 0, sizeof(ref_ds3_data));
+    memset(ref_us3_data, 0, sizeof(ref_us3_data));
+}
+
+void uut_init(void)
+{
+    src_block_ds3_init(uut_ds3_state, MAX_CHANNELS);
+    src_block_us3_init(uut_us3_state, MAX_CHANNELS);
+}
+
+#define REF_DS3(out, in, channels, frames)                                                                          \
+    for (int i = 0; i < (frames); i++) {                                                                            \
+        for (int j = 0; j < (channels); j++) {                                                                      \
+            int64_t sum = 0;                                                                                        \
+            sum = src_ds3_voice_add_sample(sum, ref_ds3_data[j][0], src_ff3v_fir_coefs[0], in[(3*i + 0)*(channels) + j]); \
+            sum = src_ds3_voice_add_sample(sum, ref_ds3_data[j][1], src_ff3v_fir_coefs[1], in[(3*i + 1)*(channels) + j]); \
+            out[i*(channels) + j] = src_ds3_voice_add_final_sample(sum, ref_ds3_data[j][2], src_ff3v_fir_coefs[2], in[(3*i + 2)*(channels) + j]); \
+        }                                                                                                           \
+    }
+
+#define REF_US3(out, in, channels, frames)                                                                          \
+    for (int i = 0; i < (frames); i++) {                                                                            \
+        for (int j = 0; j < (channels); j++) {                                                                      \
+            out[(3*i + 0)*(channels) + j] = src_us3_voice_input_sample(ref_us3_data[j], src_ff3v_fir_coefs[2], (int32_t)in[i*(channels) + j]); \
+            out[(3*i + 1)*(channels) + j] = src_us3_voice_get_next_sample(ref_us3_data[j], src_ff3v_fir_coefs[1]); \
+            out[(3*i + 2)*(channels) + j] = src_us3_voice_get_next_sample(ref_us3_data[j], src_ff3v_fir_coefs[0]); \
+        }                                                                                                           \
+    }
+
+void ref_ds3_s32(int32_t *out, const int32_t *in, int32_t channels, int32_t frames)
+{
+    REF_DS3(out, in, channels, frames)
+}
+
+void ref_ds3_s16(int16_t *out, const int16_t *in, int32_t channels, int32_t frames)
+{
+    REF_DS3(out, in, channels, frames)
+}
+
+void ref_us3_s32(int32_t *out, const int32_t *in, int32_t channels, int32_t frames)
+{
+    REF_US3(out, in, channels, frames)
+}
+
+void ref_us3_s16(int16_t *out, const int16_t *in, int32_t channels, int32_t frames)
+{
+    REF_US3(out, in, channels, frames)
+}
+
+void uut_ds3_s32(int32_t *out, const int32_t *in, int32_t channels, int32_t frames)
+{
+    src_block_ds3_s32(uut_ds3_state, channels, out, in, frames);
+}
+
+void uut_ds3_s16(int16_t *out, const int16_t *in, int32_t channels, int32_t frames)
+{
+    src_block_ds3_s16(uut_ds3_state, channels, out, in, frames);
+}
+
+void uut_us3_s32(int32_t *out, const int32_t *in, int32_t channels, int32_t frames)
+{
+    src_block_us3_s32(uut_us3_state, channels, out, in, frames);
+}
+
+void uut_us3_s16(int16_t *out, const int16_t *in, int32_t channels, int32_t frames)
+{
+    src_block_us3_s16(uut_us3_state, channels, out, in, frames);
+}
+
+/* Converts num_frames 1 ms USB frames of channels channels down and back up again */
+static double benchmark(void (*ds3)(int16_t *, const int16_t *, int32_t, int32_t),
+                        void (*us3)(int16_t *, const int16_t *, int32_t, int32_t),
+                        int32_t channels, int32_t num_frames)
+{
+    int16_t usb_frame[48 * MAX_CHANNELS];
+    int16_t pipeline_frame[16 * MAX_CHANNELS];
+    volatile int16_t sink = 0;
+
+    for (int i = 0; i < 48 * channels; i++) {
+        usb_frame[i] = (int16_t) (i * 2749);
+    }
+
+    clock_t start = clock();
+    for (int n = 0; n < num_frames; n++) {
+        ds3(pipeline_frame, usb_frame, channels, 16);
+        us3(usb_frame, pipeline_frame, channels, 16);
+        sink += usb_frame[n % (48 * channels)];
+    }
+    (void) sink;
+    return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+double ref_benchmark(int32_t channels, int32_t num_frames)
+{
+    ref_init();
+    return benchmark(ref_ds3_s16, ref_us3_s16, channels, num_frames);
+}
+
+double uut_benchmark(int32_t channels, int32_t num_frames)
+{
+    uut_init();
+    return benchmark(uut_ds3_s16, uut_us3_s16, channels, num_frames);
+}
@@ -44,6 +44,7 @@ def build_uut():
     global ffi
     global uut
     global reset
+    global sof_toggle
 
     build_ffi()
 
@@ -53,6 +54,7 @@ def build_uut():
     import adaptive_rate_adjust_api.lib as adaptive_rate_adjust_lib
     determine_USB_audio_rate = adaptive_rate_adjust_lib.determine_USB_audio_rate
     reset = adaptive_rate_adjust_lib.reset_state
+    sof_toggle = adaptive_rate_adjust_lib.sof_toggle
 
     # The UUT returns values in UQ31 format. Cast this automagically
     uut = convert_uut
@@ -117,6 +119,22 @@ def test_one_second(build_uut):
     assert lobound <= retval
     assert retval <= hibound
 
+# Test that once the expected transfer size changes, as it does with the sample rate, transfers
+# of the new size give the nominal rate
+def test_expected_bytes_changed(build_uut):
+    lobound = NOMINAL_RATE - parts_per_million(NOMINAL_RATE, 1)
+    hibound = NOMINAL_RATE + parts_per_million(NOMINAL_RATE, 1)
+
+    adaptive_rate_adjust_lib.set_expected_USB_audio_bytes(DIR_OUT, 3 * EXPECTED_OUT_BYTES_PER_SAMPLE)
+    for millis in range(1, 1001):
+        retval = uut(millis*TICKS_PER_MILLISECOND, 3 * EXPECTED_OUT_BYTES_PER_SAMPLE, DIR_OUT, True)
+
+    adaptive_rate_adjust_lib.set_expected_USB_audio_bytes(DIR_OUT, EXPECTED_OUT_BYTES_PER_SAMPLE)
+    reset()
+
+    assert lobound <= retval
+    assert retval <= hibound
+
 # Test that time can loop without jump in data
 def test_one_second_with_loop(build_uut):
     lobound = NOMINAL_RATE - parts_per_million(NOMINAL_RATE, 1)
@@ -255,4 +273,65 @@ def test_one_part_per_million_jitter(build_uut):
     assert retval > lobound
     assert retval < hibound
 
-    reset()
\ No newline at end of file
+    reset()
+
+def compare_ref(timestamp, data_length, direction, update):
+    ref_debug = ffi.new("uint32_t[4]")
+    uut_debug = ffi.new("uint32_t[4]")
+    ref_result = adaptive_rate_adjust_lib.ref_determine_USB_audio_rate(timestamp, data_length, direction, update, ref_debug)
+    uut_result = determine_USB_audio_rate(timestamp, data_length, direction, update, uut_debug)
+    assert uut_result == ref_result
+    assert list(uut_debug) == list(ref_debug)
+
+def reset_both():
+    reset()
+    adaptive_rate_adjust_lib.ref_reset_state()
+
+# Test the running totals give bit exact results against summing every bucket, with both
+# endpoints interleaved, jittered packet sizes and times, and the timer wrapping
+def test_running_totals_match_reference(build_uut):
+    jitter = 100
+    offset = INTMAX_32 - (20 * TICKS_PER_SECOND)
+    reset_both()
+
+    for millis in range(1, 100001):
+        t = (offset + random.randint(-jitter, jitter) + (millis*TICKS_PER_MILLISECOND)) % INTMAX_32
+        compare_ref(t, EXPECTED_OUT_BYTES_PER_SAMPLE + random.randint(-1, 1), DIR_OUT, True)
+        compare_ref(t, EXPECTED_IN_BYTES_PER_SAMPLE + random.randint(-1, 1), DIR_IN, random.random() < 0.99)
+
+    reset_both()
+
+# Test the running totals stay bit exact through a reset part way through and through the
+# average being held while the host stops sending
+def test_running_totals_match_reference_hold_and_reset(build_uut):
+    reset_both()
+
+    millis = 0
+    for run in range(4):
+        for _ in range(random.randint(1000, 30000)):
+            millis += 1
+            t = (millis*TICKS_PER_MILLISECOND) % INTMAX_32
+            compare_ref(t, EXPECTED_OUT_BYTES_PER_SAMPLE, DIR_OUT, True)
+            sof_toggle()
+            adaptive_rate_adjust_lib.ref_sof_toggle()
+
+        # No data for a while, long enough for the average to be held
+        for _ in range(random.randint(10, 500)):
+            millis += 1
+            sof_toggle()
+            adaptive_rate_adjust_lib.ref_sof_toggle()
+
+        if run == 1:
+            reset_both()
+
+    reset_both()
+
+# Report the per packet cost of the running totals against summing every bucket. CPU time
+# depends on the load of the machine running the tests, so it is reported rather than checked.
+def test_benchmark(build_uut):
+    packets = 1000000
+    ref_time = adaptive_rate_adjust_lib.ref_benchmark(packets)
+    uut_time = adaptive_rate_adjust_lib.uut_benchmark(packets)
+    print(f"{packets} packets: reference {ref_time:.3f} s, running totals {uut_time:.3f} s, "
+          f"speedup {ref_time / max(uut_time, 1e-9):.1f}x")
+    reset_both()
@@ -0,0 +1,65 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import random
+import pytest
+
+from build_aec_2threads import build_ffi, clean_ffi
+
+# The fwk_voice AEC is not part of this repository, so the frame processing is run against a model of its API
+# in which every state vector is a hash of everything it was computed from, in order. The 2 thread output is bit
+# exact with the 1 thread output as long as every AEC function sees the same inputs in the same order, and the
+# two tasks never touch state that the other writes during a parallel step.
+
+FRAME_ADVANCE = 240
+PARALLEL_STEPS_PER_FRAME = 4
+
+def run(threads, y, x, num_y, shadow_output):
+    out_main = ffi.new("int32_t[]", num_y * FRAME_ADVANCE)
+    out_shadow = ffi.new("int32_t[]", num_y * FRAME_ADVANCE) if shadow_output else ffi.NULL
+    lib.aec_run(threads, y, x, out_main, out_shadow)
+    return list(out_main), (list(out_shadow) if shadow_output else None)
+
+def counts():
+    out = ffi.new("int32_t[3]")
+    lib.aec_counts(out)
+    return dict(zip(["parallel_steps", "conflicts", "worker_accesses"], out))
+
+
+@pytest.fixture(scope="module")
+def build_uut():
+    # These are declared global so they may be used in the subsequent tests - bit of a hack
+    global ffi
+    global lib
+
+    build_ffi()
+
+    # Import the things we just built
+    from build import aec_2threads_api
+    from aec_2threads_api import ffi
+    import aec_2threads_api.lib as lib
+
+    yield
+
+    clean_ffi()
+
+# Test that the 2 thread frame processing matches the 1 thread frame processing, frame after frame,
+# for the STLP channel counts and odd ones that split unevenly between the tasks
+@pytest.mark.parametrize("num_y, num_x", [(2, 2), (1, 1), (1, 2), (2, 1), (3, 3)])
+@pytest.mark.parametrize("shadow_output", [False, True])
+def test_bit_exact(build_uut, num_y, num_x, shadow_output):
+    random.seed(num_y * 10 + num_x)
+    frames = 20
+    lib.aec_setup(num_y, num_x, random.getrandbits(32))
+
+    for frame in range(frames):
+        y = ffi.new("int32_t[]", [random.randint(-2**31, 2**31 - 1) for _ in range(num_y * FRAME_ADVANCE)])
+        x = ffi.new("int32_t[]", [random.randint(-2**31, 2**31 - 1) for _ in range(num_x * FRAME_ADVANCE)])
+
+        assert run(2, y, x, num_y, shadow_output) == run(1, y, x, num_y, shadow_output), f"frame {frame}"
+        assert lib.aec_states_equal(), f"frame {frame}"
+
+    c = counts()
+    assert c["parallel_steps"] == PARALLEL_STEPS_PER_FRAME * frames
+    assert c["conflicts"] == 0
+    assert c["worker_accesses"] > 0
@@ -0,0 +1,116 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import random
+import pytest
+
+from build_audio_ring import build_ffi, clean_ffi
+
+# Three 48 kHz stereo 32 bit pipeline frames, which does not divide 2^32
+RING_SIZE = 17280
+UINT32_MAX = 2**32 - 1
+
+def random_bytes(n):
+    return bytes(random.randrange(256) for _ in range(n))
+
+def write(data):
+    return lib.ring_write(data, len(data))
+
+def read(n):
+    dest = ffi.new("uint8_t[]", max(n, 1))
+    got = lib.ring_read(dest, n)
+    return bytes(ffi.buffer(dest, got))
+
+def read_reserved(n):
+    dest = ffi.new("uint8_t[]", max(n, 1))
+    got = lib.ring_read_reserved(dest, n)
+    return bytes(ffi.buffer(dest, got))
+
+def stream(expected, total, max_chunk=2000):
+    # Writes and reads random amounts until total bytes have been written, checking what comes out
+    written = 0
+    while written < total:
+        n = random.randint(1, min(max_chunk, lib.ring_space()) or 1)
+        data = random_bytes(n)
+        if write(data) == n:
+            expected.extend(data)
+            written += n
+        while len(expected) > RING_SIZE // 2:
+            n = random.randint(1, len(expected))
+            got = read(n) if random.randrange(2) else read_reserved(n)
+            assert got == bytes(expected[:len(got)])
+            del expected[:len(got)]
+
+
+@pytest.fixture(scope="module")
+def build_uut():
+    # These are declared global so they may be used in the subsequent tests - bit of a hack
+    global ffi
+    global lib
+
+    build_ffi()
+
+    # Import the things we just built
+    from build import audio_ring_api
+    from audio_ring_api import ffi
+    import audio_ring_api.lib as lib
+
+    yield
+
+    clean_ffi()
+
+# Test that data comes out as it went in, whatever the sizes of the writes and reads,
+# including across the wrap of the free running counters
+@pytest.mark.parametrize("start", [0, UINT32_MAX - 5 * RING_SIZE, UINT32_MAX - 100])
+def test_stream(build_uut, start):
+    lib.ring_init(RING_SIZE)
+    lib.ring_set_count(start)
+    expected = bytearray()
+    stream(expected, 10 * RING_SIZE)
+    assert start == 0 or lib.ring_head() < start
+    assert lib.ring_fill() == len(expected)
+    assert lib.ring_space() == RING_SIZE - len(expected)
+
+# Test that the ring carries on correctly after a flush, with the counters having wrapped
+@pytest.mark.parametrize("start", [0, UINT32_MAX - 5 * RING_SIZE, UINT32_MAX - 100])
+def test_flush(build_uut, start):
+    lib.ring_init(RING_SIZE)
+    lib.ring_set_count(start)
+    expected = bytearray()
+    for _ in range(3):
+        stream(expected, 3 * RING_SIZE)
+        lib.ring_flush()
+        expected.clear()
+        assert lib.ring_fill() == 0
+        assert lib.ring_space() == RING_SIZE
+    stream(expected, 3 * RING_SIZE)
+    assert start == 0 or lib.ring_head() < start
+
+# Test that a discard empties the ring at once but only frees its space once the
+# consumer has read, and that the ring carries on correctly afterwards
+@pytest.mark.parametrize("start", [0, UINT32_MAX - 5 * RING_SIZE, UINT32_MAX - 100])
+def test_discard(build_uut, start):
+    lib.ring_init(RING_SIZE)
+    lib.ring_set_count(start)
+    expected = bytearray()
+    for _ in range(3):
+        stream(expected, 3 * RING_SIZE)
+        lib.ring_discard()
+        assert lib.ring_fill() == 0
+        assert lib.ring_space() == RING_SIZE - len(expected)
+        assert read(1) == b""
+        expected.clear()
+        assert lib.ring_space() == RING_SIZE
+    stream(expected, 3 * RING_SIZE)
+    assert start == 0 or lib.ring_head() < start
+
+# Test that data written after a discard, before the consumer has applied it, is kept
+def test_write_after_discard(build_uut):
+    lib.ring_init(RING_SIZE)
+    lib.ring_set_count(UINT32_MAX - 10)
+    assert write(random_bytes(1000)) == 1000
+    lib.ring_discard()
+    data = random_bytes(100)
+    assert write(data) == 100
+    assert lib.ring_fill() == 100
+    assert read(100) == data
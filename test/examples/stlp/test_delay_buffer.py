@@ -0,0 +1,144 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import random
+import pytest
+
+from build_delay_buffer import build_ffi, clean_ffi
+
+FRAME_ADVANCE = 240
+CHANNELS = 2
+MAX_DELAY_SAMPLES = 2400
+FRAC_BITS = 8
+INT32_MIN = -(2**31)
+INT32_MAX = 2**31 - 1
+
+def random_frame():
+    return [random.randint(INT32_MIN, INT32_MAX) for _ in range(CHANNELS * FRAME_ADVANCE)]
+
+def run_frame(process, y, x):
+    y_c = ffi.new("int32_t[]", y)
+    x_c = ffi.new("int32_t[]", x)
+    process(y_c, x_c)
+    return list(y_c), list(x_c)
+
+def delayed(signal, delay, n):
+    # signal holds one channel's history, oldest first; returns the last n samples delayed by delay
+    start = len(signal) - n - delay
+    return [signal[i] if i >= 0 else 0 for i in range(start, start + n)]
+
+
+@pytest.fixture(scope="module")
+def build_uut():
+    # These are declared global so they may be used in the subsequent tests - bit of a hack
+    global ffi
+    global lib
+
+    build_ffi()
+
+    # Import the things we just built
+    from build import delay_buffer_api
+    from delay_buffer_api import ffi
+    import delay_buffer_api.lib as lib
+
+    yield
+
+    clean_ffi()
+
+# Test the frame API matches the per sample implementation for fixed delays, including
+# delays shorter than, equal to and longer than a frame, and negative delays
+@pytest.mark.parametrize("delay", [0, 1, 17, 239, 240, 241, 1000, 2160, 2161, MAX_DELAY_SAMPLES - 2, -1, -240, -2000])
+def test_fixed_delay_bit_exact(build_uut, delay):
+    lib.ref_init(delay)
+    lib.uut_init(delay)
+
+    for _ in range(25):
+        y = random_frame()
+        x = random_frame()
+        assert run_frame(lib.uut_process_frame, y, x) == run_frame(lib.ref_process_frame, y, x)
+
+# Test the block API matches the per sample implementation for blocks of any length
+def test_block_bit_exact(build_uut):
+    lib.ref_init(0)
+    lib.uut_init(0)
+
+    for _ in range(200):
+        delay = random.randint(0, MAX_DELAY_SAMPLES - 2)
+        n = random.randint(1, FRAME_ADVANCE)
+        ch = random.randint(0, CHANNELS - 1)
+        block = [random.randint(INT32_MIN, INT32_MAX) for _ in range(n)]
+        ref = ffi.new("int32_t[]", block)
+        uut = ffi.new("int32_t[]", block)
+        lib.ref_process_block(ref, ch, delay, n)
+        lib.uut_process_block(uut, ch, delay, n)
+        assert list(uut) == list(ref)
+
+# Test that when the delayed channels swap, the output matches the old reset behaviour
+@pytest.mark.parametrize("delays", [(100, -50), (-300, 20), (0, -10), (-10, 0)])
+def test_sign_change_bit_exact(build_uut, delays):
+    lib.ref_init(delays[0])
+    lib.uut_init(delays[0])
+
+    for frame in range(20):
+        if frame == 10:
+            lib.ref_set_delay(delays[1])
+            lib.uut_set_delay(delays[1] << FRAC_BITS)
+        y = random_frame()
+        x = random_frame()
+        assert run_frame(lib.uut_process_frame, y, x) == run_frame(lib.ref_process_frame, y, x)
+
+# Test a half sample delay interpolates between the neighbouring samples
+def test_fractional_delay(build_uut):
+    delay_q = (10 << FRAC_BITS) + (1 << (FRAC_BITS - 1))
+    lib.uut_init(0)
+    lib.uut_set_delay(delay_q)
+
+    history = [[] for _ in range(CHANNELS)]
+    for frame in range(5):
+        y = [random.randint(-2**20, 2**20) for _ in range(CHANNELS * FRAME_ADVANCE)]
+        out, _ = run_frame(lib.uut_process_frame, y, random_frame())
+        for ch in range(CHANNELS):
+            history[ch] += y[ch * FRAME_ADVANCE:(ch + 1) * FRAME_ADVANCE]
+            a = delayed(history[ch], 10, FRAME_ADVANCE)
+            b = delayed(history[ch], 11, FRAME_ADVANCE)
+            expected = [(p + q) >> 1 for p, q in zip(a, b)]
+            # The first frame crossfades from the initial delay
+            if frame > 0:
+                assert out[ch * FRAME_ADVANCE:(ch + 1) * FRAME_ADVANCE] == expected
+
+# Test a delay change crossfades over one frame and then settles to the new delay exactly
+def test_crossfade(build_uut):
+    old_delay = 50
+    new_delay = 300
+    lib.uut_init(old_delay)
+
+    history = [[] for _ in range(CHANNELS)]
+    for frame in range(6):
+        if frame == 3:
+            lib.uut_set_delay(new_delay << FRAC_BITS)
+        y = random_frame()
+        out, _ = run_frame(lib.uut_process_frame, y, random_frame())
+        for ch in range(CHANNELS):
+            history[ch] += y[ch * FRAME_ADVANCE:(ch + 1) * FRAME_ADVANCE]
+            out_ch = out[ch * FRAME_ADVANCE:(ch + 1) * FRAME_ADVANCE]
+            old = delayed(history[ch], old_delay, FRAME_ADVANCE)
+            new = delayed(history[ch], new_delay, FRAME_ADVANCE)
+            if frame < 3:
+                assert out_ch == old
+            elif frame == 3:
+                for i in range(FRAME_ADVANCE):
+                    lo, hi = sorted((old[i], new[i]))
+                    assert lo <= out_ch[i] <= hi
+                assert out_ch[-1] == new[-1]
+            else:
+                assert out_ch == new
+
+# Report the CPU time of the block and per sample implementations. It depends on the load
+# of the machine running the tests, so it is not checked.
+@pytest.mark.parametrize("delay", [0, 100, 2000, -100])
+def test_benchmark(build_uut, delay):
+    frames = 20000
+    ref_time = lib.ref_benchmark(delay, frames)
+    uut_time = lib.uut_benchmark(delay, frames)
+    print(f"delay {delay}: per sample {1e6 * ref_time / frames:.2f} us/frame, block {1e6 * uut_time / frames:.2f} us/frame, "
+          f"speedup {ref_time / max(uut_time, 1e-9):.1f}x")
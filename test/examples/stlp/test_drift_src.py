@@ -0,0 +1,161 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import math
+import random
+import pytest
+
+from build_drift_src import build_ffi, clean_ffi
+
+FRAME_ADVANCE = 240
+STEP_ONE = 1 << 30
+TAPS = 24
+INT32_MIN = -(2**31)
+INT32_MAX = 2**31 - 1
+
+def step_ppm(ppm):
+    return int(round(STEP_ONE * (1 + ppm * 1e-6)))
+
+def sine(n, start, freq, amplitude=2**30):
+    # freq in cycles per sample
+    return [int(round(amplitude * math.sin(2 * math.pi * freq * (start + i)))) for i in range(n)]
+
+def push_block(block, channels=1):
+    n_in = len(block) // channels
+    n_out = lib.output_count(n_in)
+    out = ffi.new("int32_t[]", max(n_out * channels, 1))
+    assert lib.push(out, n_out, ffi.new("int32_t[]", block or [0]), n_in, n_in) == n_out
+    return [list(out)[ch * n_out:(ch + 1) * n_out] for ch in range(channels)]
+
+def pull_block(source, n_out):
+    # source yields input samples, one channel
+    n_in = lib.input_count(n_out)
+    block = [next(source) for _ in range(n_in)]
+    out = ffi.new("int32_t[]", max(n_out, 1))
+    assert lib.pull(out, n_out, ffi.new("int32_t[]", block or [0]), n_in, n_out) == n_in
+    return list(out)[:n_out]
+
+def snr_db(signal, reference):
+    noise = sum((s - r) ** 2 for s, r in zip(signal, reference))
+    power = sum(r ** 2 for r in reference)
+    return 10 * math.log10(power / noise) if noise else float("inf")
+
+
+@pytest.fixture(scope="module")
+def build_uut():
+    # These are declared global so they may be used in the subsequent tests - bit of a hack
+    global ffi
+    global lib
+
+    build_ffi()
+
+    # Import the things we just built
+    from build import drift_src_api
+    from drift_src_api import ffi
+    import drift_src_api.lib as lib
+
+    yield
+
+    clean_ffi()
+
+# Test that at a step of exactly one the output is the input delayed by whole samples, bit exact
+def test_unity_is_delay(build_uut):
+    lib.init(2)
+    x = [[random.randint(INT32_MIN, INT32_MAX) for _ in range(FRAME_ADVANCE * 10)] for _ in range(2)]
+    out = [[], []]
+    for f in range(10):
+        block = x[0][f * FRAME_ADVANCE:(f + 1) * FRAME_ADVANCE] + x[1][f * FRAME_ADVANCE:(f + 1) * FRAME_ADVANCE]
+        y = push_block(block, 2)
+        assert len(y[0]) == FRAME_ADVANCE
+        out[0] += y[0]
+        out[1] += y[1]
+    for ch in range(2):
+        assert out[ch] == ([0] * (TAPS // 2) + x[ch])[:len(out[ch])]
+
+# Test that splitting the input into blocks of any size makes no difference to the output
+@pytest.mark.parametrize("ppm", [-1000, -37, 0, 250, 1000])
+def test_block_size_independent(build_uut, ppm):
+    x = [random.randint(-2**30, 2**30) for _ in range(5000)]
+
+    lib.init(1)
+    lib.set_step(step_ppm(ppm))
+    whole = push_block(x)[0]
+
+    lib.init(1)
+    lib.set_step(step_ppm(ppm))
+    pieces = []
+    i = 0
+    while i < len(x):
+        n = random.randint(0, 300)
+        pieces += push_block(x[i:i + n])[0]
+        i += n
+
+    assert pieces == whole
+
+# Test that pulling a fixed number of outputs gives the same samples as pushing the whole input
+@pytest.mark.parametrize("ppm", [-500, 0, 120, 800])
+def test_pull_matches_push(build_uut, ppm):
+    x = [random.randint(-2**30, 2**30) for _ in range(FRAME_ADVANCE * 40)]
+
+    lib.init(1)
+    lib.set_step(step_ppm(ppm))
+    pushed = push_block(x)[0]
+
+    lib.init(1)
+    lib.set_step(step_ppm(ppm))
+    source = iter(x)
+    pulled = []
+    for _ in range(35):
+        pulled += pull_block(source, FRAME_ADVANCE)
+
+    assert pulled == pushed[:len(pulled)]
+
+# Test the number of inputs used per output follows the step over a long run
+@pytest.mark.parametrize("ppm", [-1000, -100, 100, 1000])
+def test_rate(build_uut, ppm):
+    lib.init(1)
+    lib.set_step(step_ppm(ppm))
+    frames = 2000
+    n_in = 0
+    for _ in range(frames):
+        n = lib.input_count(FRAME_ADVANCE)
+        out = ffi.new("int32_t[]", FRAME_ADVANCE)
+        lib.pull(out, FRAME_ADVANCE, ffi.new("int32_t[]", n or 1), n, FRAME_ADVANCE)
+        n_in += n
+    expected = frames * FRAME_ADVANCE * (1 + ppm * 1e-6)
+    assert abs(n_in - expected) <= 2
+
+# Test a drifting sine wave is resampled cleanly, including while the step changes
+@pytest.mark.parametrize("freq", [100 / 16000, 1000 / 16000, 3000 / 16000, 6000 / 16000])
+def test_sine_quality(build_uut, freq):
+    lib.init(1)
+    pos = -TAPS / 2  # position of the next output in input samples
+    n_in = 0
+    errors = []
+    refs = []
+    for f in range(50):
+        ppm = 300 * math.sin(f / 8)
+        step = step_ppm(ppm)
+        lib.set_step(step)
+        block = sine(FRAME_ADVANCE, n_in, freq)
+        y = push_block(block)[0]
+        ref = [2**30 * math.sin(2 * math.pi * freq * (pos + i * step / STEP_ONE)) for i in range(len(y))]
+        pos += len(y) * step / STEP_ONE
+        n_in += FRAME_ADVANCE
+        if f > 0:
+            errors += y
+            refs += ref
+
+    # The filter is flat to well within this up to 6 kHz at 16 kHz
+    assert snr_db(errors, refs) > (90 if freq < 0.2 else 75)
+
+# Test full scale input with overshoot saturates rather than wrapping
+def test_saturation(build_uut):
+    lib.init(1)
+    lib.set_step(step_ppm(0) + STEP_ONE // 2)
+    x = [INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN] * 200
+    y = push_block(x)[0]
+    assert INT32_MAX in y and INT32_MIN in y
+    # A wrapped value would flip sign right next to a saturated one
+    for a, b in zip(y, y[1:]):
+        assert not (a == INT32_MAX and b < 0 and abs(b) < 2**20)
@@ -0,0 +1,83 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import pytest
+
+from build_fill_ctrl import build_ffi, clean_ffi
+
+FILL_TARGET = 360
+FILL_FROM_HOST_TARGET = 240
+NOMINAL_NUMERATOR = 149
+TIMESTAMP_JITTER = 100
+FRAME_JITTER_MS = 2
+
+
+@pytest.fixture(scope="module")
+def build_uut():
+    # These are declared global so they may be used in the subsequent tests - bit of a hack
+    global ffi
+    global lib
+
+    build_ffi()
+
+    # Import the things we just built
+    from build import fill_ctrl_api
+    from fill_ctrl_api import ffi
+    import fill_ctrl_api.lib as lib
+
+    yield
+
+    clean_ffi()
+
+def simulate(drift_ppm, host_streaming_out, fill_ctrl_enabled, seconds, seed=1):
+    cfg = ffi.new("fill_sim_config_t *")
+    cfg.drift_ppm = drift_ppm
+    cfg.timestamp_jitter = TIMESTAMP_JITTER
+    cfg.frame_jitter_ms = FRAME_JITTER_MS
+    cfg.host_streaming_out = host_streaming_out
+    cfg.fill_ctrl_enabled = fill_ctrl_enabled
+    cfg.seconds = seconds
+    cfg.seed = seed
+    res = ffi.new("fill_sim_result_t *")
+    lib.fill_sim_run(cfg, res)
+    return res
+
+# Test that without the fill level trim a microphone only stream, which has no rate
+# estimate, drifts into resets - this is what the trim is for
+@pytest.mark.parametrize("drift_ppm", [100, -100])
+def test_drift_without_trim_glitches(build_uut, drift_ppm):
+    res = simulate(drift_ppm, False, False, 600)
+    assert res.overruns + res.underruns > 0
+
+# Test the buffer converges to its target with no overruns or underruns, whether or not
+# the host is streaming out, for drifts beyond the usual crystal tolerances
+@pytest.mark.parametrize("host_streaming_out", [False, True])
+@pytest.mark.parametrize("drift_ppm", [0, 30, -30, 100, -100, 300, -300])
+def test_converges_to_target(build_uut, drift_ppm, host_streaming_out):
+    res = simulate(drift_ppm, host_streaming_out, True, 1800)
+
+    assert res.overruns == 0
+    assert res.underruns == 0
+    assert abs(res.mean_fill - FILL_TARGET) < 2
+
+    # The app PLL numerator should centre on the one that cancels the drift, in steps of about 10ppm
+    expected_numerator = NOMINAL_NUMERATOR - drift_ppm / 9.77
+    assert abs(res.mean_numerator - expected_numerator) < 1
+    assert res.max_numerator - res.min_numerator <= 12
+
+# Test different jitter seeds all stay glitch free through the initial transient
+@pytest.mark.parametrize("seed", range(2, 6))
+def test_startup_transient(build_uut, seed):
+    res = simulate(-300, False, True, 300, seed)
+    assert res.overruns == 0
+    assert res.underruns == 0
+
+# Test that samples from the host backing up speed the device up, the opposite sense to
+# samples to the host, and that the trim stops when the host stops streaming out
+@pytest.mark.parametrize("offset", [-60, 60])
+def test_from_host_sense(build_uut, offset):
+    lib.reset_fill_level_trim()
+    for _ in range(600):
+        trim = lib.determine_fill_level_trim_from_host(FILL_FROM_HOST_TARGET + offset)
+    assert trim * offset > 0
+    assert lib.determine_fill_level_trim_from_host(-1) == 0
@@ -0,0 +1,120 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import random
+import struct
+import pytest
+
+from build_frame_codec import build_ffi, clean_ffi
+
+# Mirrors frame_codec.h
+FRAME_CODEC_INT32 = 0
+FRAME_CODEC_INT24 = 1
+FRAME_CODEC_INT16 = 2
+FRAME_CODEC_BFP16 = 3
+FORMATS = [FRAME_CODEC_INT32, FRAME_CODEC_INT24, FRAME_CODEC_INT16, FRAME_CODEC_BFP16]
+
+INT32_MIN = -2**31
+INT32_MAX = 2**31 - 1
+
+# A stereo pipeline frame, and odd lengths
+BLOCK_SIZES = [480, 240, 3, 1]
+
+def headroom(s):
+    # Redundant sign bits of a 32 bit sample, as __builtin_clrsb()
+    return 31 - (s if s >= 0 else ~s).bit_length()
+
+def expected(format, block):
+    # The samples the codec gives back, truncated to the bits each format keeps
+    if format == FRAME_CODEC_INT24:
+        shift = 8
+    elif format == FRAME_CODEC_INT16:
+        shift = 16
+    elif format == FRAME_CODEC_BFP16:
+        shift = max(0, 16 - min(headroom(s) for s in block))
+    else:
+        shift = 0
+    return [(s >> shift) << shift for s in block]
+
+def round_trip(format, block):
+    src = ffi.new("int32_t[]", block)
+    encoded = ffi.new("uint8_t[]", 4 * len(block) + 4)
+    encoded_size = lib.codec_encode(format, src, len(block), encoded)
+
+    dst = ffi.new("int32_t[]", len(block))
+    decoded_size = lib.codec_decode(format, encoded, len(block), dst)
+
+    assert encoded_size == lib.codec_encoded_size(format, len(block))
+    assert decoded_size == encoded_size
+    return list(dst), bytes(ffi.buffer(encoded, encoded_size))
+
+def check(block):
+    for format in FORMATS:
+        decoded, _ = round_trip(format, block)
+        assert decoded == expected(format, block), f"format {format}"
+
+
+@pytest.fixture(scope="module")
+def build_uut():
+    # These are declared global so they may be used in the subsequent tests - bit of a hack
+    global ffi
+    global lib
+
+    build_ffi()
+
+    # Import the things we just built
+    from build import frame_codec_api
+    from frame_codec_api import ffi
+    import frame_codec_api.lib as lib
+
+    yield
+
+    clean_ffi()
+
+# Test that the encoded sizes are those FRAME_DATA_WIRE_SIZE is built from, and keep stereo frames word aligned
+def test_encoded_size(build_uut):
+    for n in BLOCK_SIZES:
+        assert lib.codec_encoded_size(FRAME_CODEC_INT32, n) == 4 * n
+        assert lib.codec_encoded_size(FRAME_CODEC_INT24, n) == 3 * n
+        assert lib.codec_encoded_size(FRAME_CODEC_INT16, n) == 2 * n
+        assert lib.codec_encoded_size(FRAME_CODEC_BFP16, n) == 4 + 2 * n
+    for format in FORMATS:
+        assert lib.codec_encoded_size(format, 480) % 4 == 0
+
+# Test that silence is lossless in every format
+def test_all_zero(build_uut):
+    for n in BLOCK_SIZES:
+        check([0] * n)
+        decoded, encoded = round_trip(FRAME_CODEC_BFP16, [0] * n)
+        assert struct.unpack("<i", encoded[:4])[0] == 0
+
+# Test full scale samples of both signs, which leave BFP16 no headroom
+def test_full_scale(build_uut):
+    for n in BLOCK_SIZES:
+        check([INT32_MAX] * n)
+        check([INT32_MIN] * n)
+        check([INT32_MAX if i % 2 else INT32_MIN for i in range(n)])
+        _, encoded = round_trip(FRAME_CODEC_BFP16, [INT32_MIN] * n)
+        assert struct.unpack("<i", encoded[:4])[0] == 16
+
+# Test that BFP16 is lossless when every sample fits in 16 bits, and shares its exponent across the block
+def test_mixed_headroom(build_uut):
+    random.seed(8)
+    for n in BLOCK_SIZES:
+        for bits in range(1, 33):
+            block = [random.randint(-2**(bits - 1), 2**(bits - 1) - 1) for _ in range(n)]
+            check(block)
+            if bits <= 16:
+                assert round_trip(FRAME_CODEC_BFP16, block)[0] == block
+
+        # One loud sample costs the quiet ones their low order bits
+        block = [random.randint(-2**10, 2**10) for _ in range(n)]
+        block[n // 2] = 2**24
+        check(block)
+
+# Test random Q31 blocks
+def test_random(build_uut):
+    random.seed(24)
+    for _ in range(200):
+        n = random.choice(BLOCK_SIZES)
+        check([random.randint(INT32_MIN, INT32_MAX) for _ in range(n)])
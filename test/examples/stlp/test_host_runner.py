@@ -0,0 +1,83 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import os
+import subprocess
+import wave
+import numpy as np
+import pytest
+
+# Smoke runs of the STLP host runner, built by tools/ci/build_host_apps.sh or as described in examples/stlp/README.md.
+# STLP_HOST_RUNNER may be set to the path of the binary instead.
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "../../..")
+RUNNER_PATHS = [os.environ.get("STLP_HOST_RUNNER", ""),
+                os.path.join(ROOT, "dist_host/example_stlp_adec_host"),
+                os.path.join(ROOT, "build_host/example_stlp_adec_host")]
+
+SAMPLE_RATE = 16000
+FRAME_ADVANCE = 240
+
+# Test vector amplitudes, in the order process_wav.sh -c4 -a takes: Mic 1, Mic 0, Ref L, Ref R
+INPUT_AMPLITUDES = [0.1, 0.4, 0.0, 0.3]
+
+def runner():
+    for path in RUNNER_PATHS:
+        if path and os.path.isfile(path):
+            return path
+    pytest.skip("the STLP host runner has not been built")
+
+def write_wav(path, frames):
+    t = np.arange(frames) / SAMPLE_RATE
+    channels = [a * np.sin(2 * np.pi * (300 + 200 * ch) * t) for ch, a in enumerate(INPUT_AMPLITUDES)]
+    samples = (np.stack(channels, axis=1) * 32767).astype("<i2")
+    with wave.open(str(path), "wb") as wav:
+        wav.setnchannels(len(INPUT_AMPLITUDES))
+        wav.setsampwidth(2)
+        wav.setframerate(SAMPLE_RATE)
+        wav.writeframes(samples.tobytes())
+
+def read_wav(path):
+    with wave.open(str(path), "rb") as wav:
+        assert wav.getframerate() == SAMPLE_RATE
+        assert wav.getsampwidth() == 2
+        data = np.frombuffer(wav.readframes(wav.getnframes()), dtype="<i2")
+        return data.reshape(-1, wav.getnchannels()) / 32768.0
+
+def run(*args):
+    return subprocess.run([runner()] + [str(a) for a in args], capture_output=True, text=True, timeout=120)
+
+# Test that a short file is processed to a whole number of frames, with the passthrough channels in the output order
+def test_short_wav(tmp_path):
+    frames = SAMPLE_RATE // 2 + 17
+    write_wav(tmp_path / "in.wav", frames)
+
+    result = run(tmp_path / "in.wav", tmp_path / "out.wav")
+    assert result.returncode == 0, result.stderr
+
+    out = read_wav(tmp_path / "out.wav")
+    out_frames = -(-frames // FRAME_ADVANCE)
+    assert f"Processed {out_frames} frames" in result.stdout
+    assert out.shape == (out_frames * FRAME_ADVANCE, 6)
+
+    # Output is ASR, Comms, Ref L, Ref R, Mic 0, Mic 1
+    rms = np.sqrt(np.mean(out[FRAME_ADVANCE:frames - FRAME_ADVANCE] ** 2, axis=0))
+    expected = np.array([INPUT_AMPLITUDES[2], INPUT_AMPLITUDES[3], INPUT_AMPLITUDES[1], INPUT_AMPLITUDES[0]]) / np.sqrt(2)
+    np.testing.assert_allclose(rms[2:], expected, atol=0.02)
+
+# Test that a file shorter than its header says is reported as an error
+def test_truncated_wav(tmp_path):
+    write_wav(tmp_path / "in.wav", SAMPLE_RATE // 2)
+    data = (tmp_path / "in.wav").read_bytes()
+    (tmp_path / "truncated.wav").write_bytes(data[:len(data) // 2])
+
+    result = run(tmp_path / "truncated.wav", tmp_path / "out.wav")
+    assert result.returncode != 0
+    assert "Error reading" in result.stderr
+
+# Test that files that cannot be read or written are rejected
+def test_bad_paths(tmp_path):
+    write_wav(tmp_path / "in.wav", FRAME_ADVANCE)
+
+    assert run(tmp_path / "missing.wav", tmp_path / "out.wav").returncode != 0
+    assert run(tmp_path / "in.wav", tmp_path / "missing_dir" / "out.wav").returncode != 0
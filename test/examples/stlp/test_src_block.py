@@ -0,0 +1,118 @@
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+import math
+import random
+import pytest
+
+from build_src_block import build_ffi, clean_ffi
+
+PHASES = 3
+TAPS = 24
+MAX_CHANNELS = 8
+USB_FRAME = 48
+PIPELINE_FRAME = 240
+
+def lowpass_filter():
+    # A 72 tap windowed sinc at a third of the band, in Q31, split into the lib_src phase layout
+    n = PHASES * TAPS
+    h = []
+    for i in range(n):
+        t = i - (n - 1) / 2
+        sinc = 1.0 if t == 0 else math.sin(math.pi * t / PHASES) / (math.pi * t / PHASES)
+        window = 0.54 - 0.46 * math.cos(2 * math.pi * i / (n - 1))
+        h.append(int(round(sinc * window / PHASES * 2**31)))
+    return [h[PHASES * k + PHASES - 1 - p] for p in range(PHASES) for k in range(TAPS)]
+
+def random_filter():
+    # Large taps, so that the outputs saturate
+    return [random.randint(-2**29, 2**29) for _ in range(PHASES * TAPS)]
+
+def random_samples(width, n):
+    return [random.randint(-2**(width - 1), 2**(width - 1) - 1) for _ in range(n)]
+
+def run(process, width, data, out_len, channels, frames):
+    t = "int%d_t[]" % width
+    out = ffi.new(t, max(out_len, 1))
+    process(out, ffi.new(t, data if data else [0]), channels, frames)
+    return list(out)[:out_len]
+
+
+@pytest.fixture(scope="module")
+def build_uut():
+    # These are declared global so they may be used in the subsequent tests - bit of a hack
+    global ffi
+    global lib
+
+    build_ffi()
+
+    # Import the things we just built
+    from build import src_block_api
+    from src_block_api import ffi
+    import src_block_api.lib as lib
+
+    yield
+
+    clean_ffi()
+
+def load_filter(coefs, comp_ds=0x7FFFFFFF, comp_q_ds=31, comp_us=0x60000000, comp_q_us=29):
+    lib.set_filter(ffi.new("int32_t[]", coefs), comp_ds, comp_q_ds, comp_us, comp_q_us)
+    lib.ref_init()
+    lib.uut_init()
+
+# Test whole USB and pipeline frames match the per sample loops, at both sample widths
+@pytest.mark.parametrize("width", [16, 32])
+@pytest.mark.parametrize("channels", [1, 2, 6])
+@pytest.mark.parametrize("frames", [USB_FRAME, PIPELINE_FRAME])
+def test_frames_bit_exact(build_uut, width, channels, frames):
+    load_filter(lowpass_filter())
+    ref = getattr(lib, "ref_ds3_s%d" % width), getattr(lib, "ref_us3_s%d" % width)
+    uut = getattr(lib, "uut_ds3_s%d" % width), getattr(lib, "uut_us3_s%d" % width)
+
+    for _ in range(10):
+        x = random_samples(width, channels * frames)
+        n = frames // PHASES
+        assert run(uut[0], width, x, channels * n, channels, n) == run(ref[0], width, x, channels * n, channels, n)
+
+        x = random_samples(width, channels * n)
+        assert run(uut[1], width, x, channels * frames, channels, n) == run(ref[1], width, x, channels * frames, channels, n)
+
+# Test blocks of any length, including empty ones and ones longer than a chunk, carry the history over
+@pytest.mark.parametrize("width", [16, 32])
+def test_blocks_bit_exact(build_uut, width):
+    channels = 2
+    load_filter(lowpass_filter())
+
+    for _ in range(200):
+        n = random.randint(0, 40)
+        x = random_samples(width, channels * PHASES * n)
+        assert run(getattr(lib, "uut_ds3_s%d" % width), width, x, channels * n, channels, n) == \
+               run(getattr(lib, "ref_ds3_s%d" % width), width, x, channels * n, channels, n)
+
+        x = random_samples(width, channels * n)
+        assert run(getattr(lib, "uut_us3_s%d" % width), width, x, channels * PHASES * n, channels, n) == \
+               run(getattr(lib, "ref_us3_s%d" % width), width, x, channels * PHASES * n, channels, n)
+
+# Test saturation and the compensation gain match when the filter overflows
+def test_saturation_bit_exact(build_uut):
+    channels = MAX_CHANNELS
+
+    for _ in range(20):
+        load_filter(random_filter(), random.randint(2**28, 2**31 - 1), random.randint(28, 31),
+                    random.randint(2**28, 2**31 - 1), random.randint(28, 31))
+        x = random_samples(32, channels * USB_FRAME)
+        n = USB_FRAME // PHASES
+        assert run(lib.uut_ds3_s32, 32, x, channels * n, channels, n) == run(lib.ref_ds3_s32, 32, x, channels * n, channels, n)
+        assert run(lib.uut_us3_s32, 32, x[:channels * n], channels * USB_FRAME, channels, n) == \
+               run(lib.ref_us3_s32, 32, x[:channels * n], channels * USB_FRAME, channels, n)
+
+# Report the CPU time of the block and per sample implementations. It depends on the load
+# of the machine running the tests, so it is not checked.
+@pytest.mark.parametrize("channels", [1, 2, 6])
+def test_benchmark(build_uut, channels):
+    load_filter(lowpass_filter())
+    frames = 50000
+    ref_time = lib.ref_benchmark(channels, frames)
+    uut_time = lib.uut_benchmark(channels, frames)
+    print(f"{channels} channels: per sample {1e6 * ref_time / frames:.2f} us/ms, block {1e6 * uut_time / frames:.2f} us/ms, "
+          f"speedup {ref_time / max(uut_time, 1e-9):.1f}x")
@@ -23,3 +23,7 @@ echo '******************************************************'
 name=fatfs/host
 make_target=fatfs_mkimage
 (cd ${path}/build_host; cp xcore_sdk/modules/rtos/modules/sw_services/${name}/${make_target} ${DIST_DIR})
+
+# build and copy the STLP host runner to dist, for the smoke run in test/examples/stlp/test_host_runner.py
+(cd ${path}/build_host; log_errors make example_stlp_adec_host)
+(cd ${path}/build_host; cp example_stlp_adec_host ${DIST_DIR})
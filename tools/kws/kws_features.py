@@ -0,0 +1,90 @@
+#!/usr/bin/env python
+# Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+# XMOS Public License: Version 1
+"""
+Computes the log mel filterbank features of the FFD keyword spotting backend
+front end, examples/ffd/inference/kws/kws_features.c, which any model run by
+that backend must be trained on. The constants below must be kept in step
+with kws_features.h.
+
+To write the features of a 16 kHz mono wav file, one row per slice:
+
+    kws_features.py input.wav features.npy
+"""
+
+import argparse
+import wave
+
+import numpy as np
+
+SAMPLE_RATE = 16000
+WINDOW_SIZE = 480
+STEP_SIZE = 320
+FFT_SIZE = 512
+CHANNELS = 40
+LOWER_HZ = 125.0
+UPPER_HZ = 7500.0
+LOG_FLOOR = 1e-6
+
+
+def hz_to_mel(hz):
+    return 1127.0 * np.log(1.0 + hz / 700.0)
+
+
+def filterbank():
+    """Returns the weight of each FFT bin in each channel, as a [CHANNELS, FFT_SIZE // 2 + 1] array"""
+    mel = np.linspace(hz_to_mel(LOWER_HZ), hz_to_mel(UPPER_HZ), CHANNELS + 2)
+    bins = hz_to_mel(np.arange(FFT_SIZE // 2 + 1) * SAMPLE_RATE / FFT_SIZE)
+    weights = np.zeros((CHANNELS, len(bins)))
+
+    for c in range(CHANNELS):
+        rising = (bins - mel[c]) / (mel[c + 1] - mel[c])
+        falling = (mel[c + 2] - bins) / (mel[c + 2] - mel[c + 1])
+        weights[c] = np.maximum(0.0, np.minimum(rising, falling))
+    return weights
+
+
+def features(samples, history=None):
+    """
+    Returns the features of int16 samples, one row for each STEP_SIZE
+    samples, following history, the last WINDOW_SIZE samples before them,
+    or silence if None.
+    """
+    samples = np.asarray(samples, dtype=np.int16)
+    if history is None:
+        history = np.zeros(WINDOW_SIZE, dtype=np.int16)
+    audio = np.concatenate((history, samples)).astype(np.float64) / 32768.0
+
+    window = 0.5 - 0.5 * np.cos(2.0 * np.pi * np.arange(WINDOW_SIZE) / WINDOW_SIZE)
+    weights = filterbank()
+    slices = len(samples) // STEP_SIZE
+    out = np.zeros((slices, CHANNELS))
+
+    for s in range(slices):
+        end = WINDOW_SIZE + (s + 1) * STEP_SIZE
+        spectrum = np.fft.rfft(audio[end - WINDOW_SIZE:end] * window, FFT_SIZE)
+        out[s] = np.log(weights @ np.abs(spectrum) ** 2 + LOG_FLOOR)
+    return out
+
+
+def quantise(feats, scale, zero_point):
+    """Returns the int8 model input for features, as the C backend quantises them"""
+    return np.clip(np.round(feats / scale) + zero_point, -128, 127).astype(np.int8)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Computes the FFD KWS backend features of a wav file")
+    parser.add_argument("input", help="16 kHz mono 16 bit wav file")
+    parser.add_argument("output", help="numpy .npy file to write the features to")
+    args = parser.parse_args()
+
+    with wave.open(args.input, "rb") as wav:
+        if wav.getframerate() != SAMPLE_RATE or wav.getnchannels() != 1 or wav.getsampwidth() != 2:
+            parser.error("%s is not a 16 kHz mono 16 bit wav file" % args.input)
+        samples = np.frombuffer(wav.readframes(wav.getnframes()), dtype="<i2")
+
+    np.save(args.output, features(samples).astype(np.float32))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,220 @@
+#!/usr/bin/env python
+# Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+# XMOS Public License: Version 1
+"""
+Decodes the output path latency histograms sent by the latency_probe module.
+
+Live, from a device run with ``xrun --xscope-port localhost:10234 <xe>``:
+
+    latency_probe_decode.py --port localhost:10234 [--save latency.bin]
+
+Offline, from records previously saved with ``--save``:
+
+    latency_probe_decode.py --input latency.bin
+"""
+
+import argparse
+import ctypes
+import os
+import platform
+import struct
+import sys
+import time
+
+RECORD_MAGIC = 0x5054414C
+RECORD_VERSION = 1
+NAME_LEN = 12
+
+# Mirrors latency_probe_record_t, up to the histogram slice
+HEADER = struct.Struct("<4I%ds10I" % NAME_LEN)
+
+REF_CLOCK_HZ = 100000000
+PROBE_NAME = "latency_hist"
+
+
+def parse_record(data):
+    """Returns the fields of one latency_probe_record_t as a dict"""
+    if len(data) < HEADER.size:
+        raise ValueError("short record of %d bytes" % len(data))
+
+    (magic, version, tile, path, name, report, count, min_, max_, mean,
+     dropped, bin_ticks, total_bins, first_bin, bins) = HEADER.unpack_from(data)
+
+    if magic != RECORD_MAGIC:
+        raise ValueError("bad magic 0x%08x" % magic)
+    if version != RECORD_VERSION:
+        raise ValueError("unsupported record version %d" % version)
+    if len(data) < HEADER.size + 4 * bins:
+        raise ValueError("record truncated")
+
+    hist = struct.unpack_from("<%dI" % bins, data, HEADER.size)
+
+    return {
+        "tile": tile,
+        "path": path,
+        "name": name.split(b"\0", 1)[0].decode("ascii", "replace"),
+        "report": report,
+        "count": count,
+        "min": min_,
+        "max": max_,
+        "mean": mean,
+        "dropped": dropped,
+        "bin_ticks": bin_ticks,
+        "total_bins": total_bins,
+        "first_bin": first_bin,
+        "hist": hist,
+        "size": HEADER.size + 4 * bins,
+    }
+
+
+def split_records(data):
+    """Yields each record in a buffer of concatenated records"""
+    offset = 0
+    while offset < len(data):
+        record = parse_record(data[offset:])
+        offset += record["size"]
+        yield record
+
+
+def percentile(hist, bin_ticks, max_ticks, pct):
+    """Upper bound in ticks of the bin holding the given percentile"""
+    total = sum(hist)
+    if total == 0:
+        return 0
+    target = (total * pct + 99) // 100
+    seen = 0
+    for i, n in enumerate(hist):
+        seen += n
+        if seen >= target and seen > 0:
+            if i == len(hist) - 1:
+                return max_ticks
+            return min((i + 1) * bin_ticks, max_ticks)
+    return max_ticks
+
+
+def ms(ticks):
+    return 1000.0 * ticks / REF_CLOCK_HZ
+
+
+class Assembler:
+    """Collects the histogram slices of each path into complete reports"""
+
+    def __init__(self, show_hist):
+        self.pending = {}
+        self.show_hist = show_hist
+
+    def add(self, record):
+        key = (record["tile"], record["path"], record["report"])
+        entry = self.pending.setdefault(key, dict(record, hist=[0] * record["total_bins"], slices=0))
+        first = record["first_bin"]
+        entry["hist"][first:first + len(record["hist"])] = record["hist"]
+        entry["slices"] += len(record["hist"])
+
+        if entry["slices"] >= entry["total_bins"]:
+            del self.pending[key]
+            self.show(entry)
+
+    def show(self, r):
+        label = "tile %d %s" % (r["tile"], r["name"] or "path %d" % r["path"])
+        if r["count"] == 0:
+            print("%s: report %d: no frames" % (label, r["report"]))
+            return
+
+        print("%s: report %d: n=%d min=%.2f mean=%.2f p50=%.2f p99=%.2f max=%.2f ms dropped=%d" % (
+            label, r["report"], r["count"],
+            ms(r["min"]), ms(r["mean"]),
+            ms(percentile(r["hist"], r["bin_ticks"], r["max"], 50)),
+            ms(percentile(r["hist"], r["bin_ticks"], r["max"], 99)),
+            ms(r["max"]), r["dropped"]))
+
+        if self.show_hist:
+            peak = max(r["hist"])
+            for i, n in enumerate(r["hist"]):
+                if n:
+                    print("  %7.2f ms %6d %s" % (ms(i * r["bin_ticks"]), n, "#" * max(1, 50 * n // peak)))
+
+
+def decode_file(filename, assembler):
+    with open(filename, "rb") as f:
+        data = f.read()
+    for record in split_records(data):
+        assembler.add(record)
+
+
+def xscope_library():
+    tool_path = os.environ.get("XMOS_TOOL_PATH")
+    if tool_path is None:
+        sys.exit("XMOS_TOOL_PATH is not set, source the XTC tools environment first")
+    name = "xscope_endpoint.dll" if platform.system() == "Windows" else "xscope_endpoint.so"
+    return ctypes.cdll.LoadLibrary(os.path.join(tool_path, "lib", name))
+
+
+def decode_live(address, assembler, save):
+    host, port = address.rsplit(":", 1)
+    lib = xscope_library()
+    probes = {}
+
+    REGISTER_CB = ctypes.CFUNCTYPE(None, ctypes.c_uint, ctypes.c_uint, ctypes.c_uint, ctypes.c_uint,
+                                   ctypes.c_uint, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_uint,
+                                   ctypes.c_char_p)
+    RECORD_CB = ctypes.CFUNCTYPE(None, ctypes.c_uint, ctypes.c_ulonglong, ctypes.c_uint,
+                                 ctypes.c_ulonglong, ctypes.POINTER(ctypes.c_ubyte))
+
+    def on_register(id, type, r, g, b, name, unit, data_type, data_name):
+        probes[id] = name.decode("ascii", "replace")
+
+    def on_record(id, timestamp, length, dataval, databytes):
+        if probes.get(id) != PROBE_NAME or not databytes:
+            return
+        data = ctypes.string_at(databytes, length)
+        if save is not None:
+            save.write(data)
+            save.flush()
+        try:
+            assembler.add(parse_record(data))
+        except ValueError as e:
+            print("ignoring record: %s" % e, file=sys.stderr)
+
+    # Keep references to the callbacks for as long as the library may call them
+    register_cb = REGISTER_CB(on_register)
+    record_cb = RECORD_CB(on_record)
+    lib.xscope_ep_set_register_cb(register_cb)
+    lib.xscope_ep_set_record_cb(record_cb)
+
+    if lib.xscope_ep_connect(host.encode(), port.encode()) != 0:
+        sys.exit("Failed to connect to xscope on %s" % address)
+
+    print("Connected to %s, press Ctrl-C to stop" % address)
+    try:
+        while True:
+            time.sleep(0.1)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        lib.xscope_ep_disconnect()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="xscope server address, e.g. localhost:10234")
+    source.add_argument("--input", help="file of records saved with --save")
+    parser.add_argument("--save", help="append the raw records received live to this file")
+    parser.add_argument("--hist", action="store_true", help="print each histogram")
+    args = parser.parse_args()
+
+    assembler = Assembler(args.hist)
+
+    if args.input:
+        decode_file(args.input, assembler)
+    else:
+        save = open(args.save, "ab") if args.save else None
+        try:
+            decode_live(args.port, assembler, save)
+        finally:
+            if save is not None:
+                save.close()
+
+
+if __name__ == "__main__":
+    main()
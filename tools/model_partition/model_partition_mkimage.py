@@ -0,0 +1,124 @@
+#!/usr/bin/env python
+# Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+# XMOS Public License: Version 1
+"""
+Packs model data into a raw flash partition that the FFD application reads
+from a single base address, without going through the filesystem.
+
+Partition only:
+
+    model_partition_mkimage.py --model model.bin --output model_partition.bin
+
+A data image for ``xflash --data`` holding the filesystem image followed by
+the partition, which starts at --partition-offset into the data partition:
+
+    model_partition_mkimage.py --model model.bin --fs example_ffd_fat.fs \\
+        --partition-offset 0x200000 --output example_ffd_data.bin
+
+Print the header of an existing partition or data image:
+
+    model_partition_mkimage.py --info example_ffd_data.bin --partition-offset 0x200000
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+PARTITION_MAGIC = 0x4C444F4D
+PARTITION_VERSION = 1
+
+# Mirrors model_partition_header_t, up to header_crc
+HEADER = struct.Struct("<6I")
+HEADER_CRC = struct.Struct("<I")
+
+ERASED = b"\xff"
+
+
+def make_partition(data, model_version, sector_size):
+    """Returns the partition holding data, with its data starting on a sector boundary"""
+    data_offset = -(-(HEADER.size + HEADER_CRC.size) // sector_size) * sector_size
+    fields = HEADER.pack(PARTITION_MAGIC, PARTITION_VERSION, data_offset, len(data),
+                         zlib.crc32(data) & 0xFFFFFFFF, model_version)
+    header = fields + HEADER_CRC.pack(zlib.crc32(fields) & 0xFFFFFFFF)
+    return header + ERASED * (data_offset - len(header)) + data
+
+
+def parse_header(image):
+    """Returns the fields of the header at the start of image as a dict"""
+    size = HEADER.size + HEADER_CRC.size
+    if len(image) < size:
+        raise ValueError("short partition of %d bytes" % len(image))
+
+    fields = image[:HEADER.size]
+    magic, version, data_offset, data_size, data_crc, model_version = HEADER.unpack(fields)
+    (header_crc,) = HEADER_CRC.unpack(image[HEADER.size:size])
+
+    if magic != PARTITION_MAGIC:
+        raise ValueError("no model partition, magic is 0x%08x" % magic)
+    if version != PARTITION_VERSION:
+        raise ValueError("unsupported partition version %d" % version)
+    if header_crc != zlib.crc32(fields) & 0xFFFFFFFF:
+        raise ValueError("header CRC mismatch")
+
+    data = image[data_offset:data_offset + data_size]
+    return {
+        "data_offset": data_offset,
+        "data_size": data_size,
+        "data_crc": data_crc,
+        "data_crc_ok": len(data) == data_size and zlib.crc32(data) & 0xFFFFFFFF == data_crc,
+        "model_version": model_version,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--model", help="model data to pack")
+    parser.add_argument("--output", help="image to write")
+    parser.add_argument("--model-version", type=lambda s: int(s, 0), default=0,
+                        help="version number stored in the header, for reporting")
+    parser.add_argument("--sector-size", type=lambda s: int(s, 0), default=4096,
+                        help="flash sector size the model data is aligned to")
+    parser.add_argument("--fs", help="filesystem image to place before the partition")
+    parser.add_argument("--partition-offset", type=lambda s: int(s, 0), default=0,
+                        help="offset of the partition in the output, past the filesystem image")
+    parser.add_argument("--info", help="print the header of this partition or data image")
+    args = parser.parse_args()
+
+    if args.info:
+        with open(args.info, "rb") as f:
+            image = f.read()
+        try:
+            info = parse_header(image[args.partition_offset:])
+        except ValueError as e:
+            sys.exit("%s: %s" % (args.info, e))
+        for k, v in info.items():
+            print("%-14s %s" % (k, "0x%08x" % v if k == "data_crc" else v))
+        return
+
+    if not args.model or not args.output:
+        parser.error("--model and --output are required")
+    if args.partition_offset % args.sector_size:
+        parser.error("--partition-offset must be a multiple of the sector size")
+
+    with open(args.model, "rb") as f:
+        data = f.read()
+
+    image = b""
+    if args.fs:
+        with open(args.fs, "rb") as f:
+            image = f.read()
+    if len(image) > args.partition_offset:
+        sys.exit("filesystem image of %d bytes overlaps the partition at 0x%x" % (len(image), args.partition_offset))
+    image += ERASED * (args.partition_offset - len(image))
+    image += make_partition(data, args.model_version, args.sector_size)
+
+    with open(args.output, "wb") as f:
+        f.write(image)
+
+    print("model partition: %d bytes of model data at 0x%x, crc 0x%08x" %
+          (len(data), args.partition_offset, zlib.crc32(data) & 0xFFFFFFFF))
+
+
+if __name__ == "__main__":
+    main()
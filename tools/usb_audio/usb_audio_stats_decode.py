@@ -0,0 +1,159 @@
+#!/usr/bin/env python
+# Copyright (c) 2022 XMOS LIMITED. This Software is subject to the terms of the
+# XMOS Public License: Version 1
+"""
+Decodes the USB audio statistics sent by the stlp application every 5 seconds.
+
+Live, from a device run with ``xrun --xscope-port localhost:10234 <xe>``:
+
+    usb_audio_stats_decode.py --port localhost:10234 [--save usb_stats.bin]
+
+Offline, from records previously saved with ``--save``:
+
+    usb_audio_stats_decode.py --input usb_stats.bin
+"""
+
+import argparse
+import ctypes
+import os
+import platform
+import struct
+import sys
+import time
+
+RECORD_MAGIC = 0x41425355
+RECORD_VERSION = 1
+
+# Mirrors usb_audio_stats_t
+RECORD = struct.Struct("<4I3I2i3I2i2I")
+
+PROBE_NAME = "usb_audio_stats"
+
+
+def parse_record(data):
+    """Returns the fields of one usb_audio_stats_t as a dict"""
+    if len(data) < RECORD.size:
+        raise ValueError("short record of %d bytes" % len(data))
+
+    fields = RECORD.unpack_from(data)
+    magic, version, tile, report = fields[:4]
+
+    if magic != RECORD_MAGIC:
+        raise ValueError("bad magic 0x%08x" % magic)
+    if version != RECORD_VERSION:
+        raise ValueError("unsupported record version %d" % version)
+
+    def direction(f):
+        return {"underruns": f[0], "overruns": f[1], "resets": f[2], "min_fill": f[3], "max_fill": f[4]}
+
+    return {
+        "tile": tile,
+        "report": report,
+        "to_host": direction(fields[4:9]),
+        "from_host": direction(fields[9:14]),
+        "rate_ctrl_min": fields[14],
+        "rate_ctrl_max": fields[15],
+    }
+
+
+def split_records(data):
+    """Yields each record in a buffer of concatenated records"""
+    for offset in range(0, len(data) - RECORD.size + 1, RECORD.size):
+        yield parse_record(data[offset:offset + RECORD.size])
+
+
+def show(r):
+    parts = []
+    for name in ("to_host", "from_host"):
+        d = r[name]
+        fill = "-" if d["max_fill"] < 0 else "%d-%d" % (d["min_fill"], d["max_fill"])
+        parts.append("%s under=%d over=%d resets=%d fill=%s" % (
+            name, d["underruns"], d["overruns"], d["resets"], fill))
+
+    if r["rate_ctrl_max"]:
+        parts.append("rate_ctrl=%d-%d" % (r["rate_ctrl_min"], r["rate_ctrl_max"]))
+
+    print("tile %d: report %d: %s" % (r["tile"], r["report"], " ".join(parts)))
+
+
+def decode_file(filename):
+    with open(filename, "rb") as f:
+        data = f.read()
+    for record in split_records(data):
+        show(record)
+
+
+def xscope_library():
+    tool_path = os.environ.get("XMOS_TOOL_PATH")
+    if tool_path is None:
+        sys.exit("XMOS_TOOL_PATH is not set, source the XTC tools environment first")
+    name = "xscope_endpoint.dll" if platform.system() == "Windows" else "xscope_endpoint.so"
+    return ctypes.cdll.LoadLibrary(os.path.join(tool_path, "lib", name))
+
+
+def decode_live(address, save):
+    host, port = address.rsplit(":", 1)
+    lib = xscope_library()
+    probes = {}
+
+    REGISTER_CB = ctypes.CFUNCTYPE(None, ctypes.c_uint, ctypes.c_uint, ctypes.c_uint, ctypes.c_uint,
+                                   ctypes.c_uint, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_uint,
+                                   ctypes.c_char_p)
+    RECORD_CB = ctypes.CFUNCTYPE(None, ctypes.c_uint, ctypes.c_ulonglong, ctypes.c_uint,
+                                 ctypes.c_ulonglong, ctypes.POINTER(ctypes.c_ubyte))
+
+    def on_register(id, type, r, g, b, name, unit, data_type, data_name):
+        probes[id] = name.decode("ascii", "replace")
+
+    def on_record(id, timestamp, length, dataval, databytes):
+        if probes.get(id) != PROBE_NAME or not databytes:
+            return
+        data = ctypes.string_at(databytes, length)
+        if save is not None:
+            save.write(data)
+            save.flush()
+        try:
+            show(parse_record(data))
+        except ValueError as e:
+            print("ignoring record: %s" % e, file=sys.stderr)
+
+    # Keep references to the callbacks for as long as the library may call them
+    register_cb = REGISTER_CB(on_register)
+    record_cb = RECORD_CB(on_record)
+    lib.xscope_ep_set_register_cb(register_cb)
+    lib.xscope_ep_set_record_cb(record_cb)
+
+    if lib.xscope_ep_connect(host.encode(), port.encode()) != 0:
+        sys.exit("Failed to connect to xscope on %s" % address)
+
+    print("Connected to %s, press Ctrl-C to stop" % address)
+    try:
+        while True:
+            time.sleep(0.1)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        lib.xscope_ep_disconnect()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="xscope server address, e.g. localhost:10234")
+    source.add_argument("--input", help="file of records saved with --save")
+    parser.add_argument("--save", help="append the raw records received live to this file")
+    args = parser.parse_args()
+
+    if args.input:
+        decode_file(args.input)
+    else:
+        save = open(args.save, "ab") if args.save else None
+        try:
+            decode_live(args.port, save)
+        finally:
+            if save is not None:
+                save.close()
+
+
+if __name__ == "__main__":
+    main()